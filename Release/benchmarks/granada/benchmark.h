@@ -0,0 +1,149 @@
+/**
+  * Copyright (c) <2016> Web App SDK granada <afernandez@cookinapps.io>
+  *
+  * This source code is licensed under the MIT license.
+  *
+  * Permission is hereby granted, free of charge, to any person obtaining a copy
+  * of this software and associated documentation files (the "Software"), to deal
+  * in the Software without restriction, including without limitation the rights
+  * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  * copies of the Software, and to permit persons to whom the Software is
+  * furnished to do so, subject to the following conditions:
+  *
+  * The above copyright notice and this permission notice shall be included in
+  * all copies or substantial portions of the Software.
+  *
+  * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  * SOFTWARE.
+  *
+  * Minimal harness shared by the microbenchmarks: runs an operation a number
+  * of times from one or more threads started at the same time, and prints
+  * one line per run with the operations, nanoseconds per operation and
+  * operations per second, so the results of two builds can be compared.
+  *
+  */
+
+#pragma once
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <stdexcept>
+
+namespace granada{
+  namespace benchmark{
+
+    /**
+     * Sum of the values returned by the benchmarked operations, printed
+     * at the end so the compiler cannot discard the operations.
+     * @return Checksum.
+     */
+    inline std::atomic<std::size_t>& checksum(){
+      static std::atomic<std::size_t> checksum(0);
+      return checksum;
+    };
+
+
+    /**
+     * Returns the integer argument at the given position, or
+     * a default value if it is not given or not a number.
+     * @param  argc          Number of arguments.
+     * @param  argv          Arguments.
+     * @param  index         Position of the argument.
+     * @param  default_value Value returned if the argument is not valid.
+     * @return               Value of the argument.
+     */
+    inline long Argument(int argc, char* argv[], const int index, const long default_value){
+      if (argc > index){
+        try{
+          return std::stol(argv[index]);
+        }catch(const std::logic_error& e){}
+      }
+      return default_value;
+    };
+
+
+    /**
+     * Prints the header of the results table.
+     */
+    inline void PrintHeader(){
+      std::cout << std::left << std::setw(44) << "benchmark"
+                << std::setw(9) << "threads"
+                << std::setw(14) << "operations"
+                << std::setw(12) << "ns/op"
+                << std::setw(14) << "op/s" << std::endl;
+    };
+
+
+    /**
+     * Prints the checksum of the operations.
+     */
+    inline void PrintFooter(){
+      std::cout << "(" << checksum().load() << ")" << std::endl;
+    };
+
+
+    /**
+     * Calls an operation "iterations" times from each of the given number
+     * of threads and prints the results. The nanoseconds per operation
+     * are measured per thread, so they grow when the threads contend.
+     *
+     * Example:
+     *    granada::benchmark::Run("split", 1, 100000, [&](int thread, long i){
+     *      std::vector<std::string> elems;
+     *      granada::util::string::split(text, '&', elems);
+     *      return elems.size();
+     *    });
+     *
+     * @param name        Name of the benchmark.
+     * @param threads     Number of threads.
+     * @param iterations  Number of calls per thread.
+     * @param operation   Function receiving the number of the thread and the
+     *                    iteration and returning a value added to the checksum.
+     */
+    template <typename Operation>
+    void Run(const std::string& name, const int threads, const long iterations, Operation operation){
+      std::atomic<int> ready(0);
+      std::atomic<bool> start(false);
+      std::vector<std::thread> workers;
+      for (int thread = 0; thread < threads; ++thread){
+        workers.push_back(std::thread([&, thread](){
+          std::size_t sum = 0;
+          ready++;
+          while (!start.load()){
+            std::this_thread::yield();
+          }
+          for (long i = 0; i < iterations; ++i){
+            sum += (std::size_t)operation(thread, i);
+          }
+          checksum() += sum;
+        }));
+      }
+      while (ready.load() < threads){
+        std::this_thread::yield();
+      }
+      const auto begin = std::chrono::steady_clock::now();
+      start = true;
+      for (auto it = workers.begin(); it != workers.end(); ++it){
+        it->join();
+      }
+      const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+      const double operations = (double)iterations * threads;
+
+      std::cout << std::left << std::setw(44) << name
+                << std::setw(9) << threads
+                << std::setw(14) << (long)operations
+                << std::setw(12) << std::fixed << std::setprecision(1) << seconds * 1e9 * threads / operations
+                << std::setw(14) << std::setprecision(0) << operations / seconds << std::endl;
+    };
+
+  }
+}
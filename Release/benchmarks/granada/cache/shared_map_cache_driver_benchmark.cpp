@@ -0,0 +1,83 @@
+/**
+  * Copyright (c) <2016> Web App SDK granada <afernandez@cookinapps.io>
+  *
+  * This source code is licensed under the MIT license.
+  *
+  * Permission is hereby granted, free of charge, to any person obtaining a copy
+  * of this software and associated documentation files (the "Software"), to deal
+  * in the Software without restriction, including without limitation the rights
+  * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  * copies of the Software, and to permit persons to whom the Software is
+  * furnished to do so, subject to the following conditions:
+  *
+  * The above copyright notice and this permission notice shall be included in
+  * all copies or substantial portions of the Software.
+  *
+  * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  * SOFTWARE.
+  *
+  * Microbenchmark of SharedMapCacheDriver under contention: reads, writes,
+  * a mix of both and key matching, from 1 thread up to the given number of
+  * threads, all using the same driver.
+  *
+  * Usage: shared_map_cache_driver_benchmark [iterations] [threads] [keys]
+  */
+#include <string>
+#include <vector>
+#include "granada/cache/shared_map_cache_driver.h"
+#include "../benchmark.h"
+
+
+int main(int argc, char* argv[]){
+  const long iterations = granada::benchmark::Argument(argc, argv, 1, 200000);
+  const int max_threads = (int)granada::benchmark::Argument(argc, argv, 2, 8);
+  const long key_count = granada::benchmark::Argument(argc, argv, 3, 10000);
+
+  granada::cache::SharedMapCacheDriver cache;
+
+  // keys similar to the ones of the sessions.
+  std::vector<std::string> keys;
+  for (long i = 0; i < key_count; ++i){
+    keys.push_back("session:value:" + std::to_string(i * 2654435761UL % 100000000));
+    cache.Write(keys.back(), "roles", "{\"user\":{\"name\":\"john\"}}");
+  }
+  const std::string value = "{\"user\":{\"name\":\"john\"},\"cart\":[1,2,3]}";
+
+  granada::benchmark::PrintHeader();
+  for (int threads = 1; threads <= max_threads; threads *= 2){
+
+    granada::benchmark::Run("SharedMapCacheDriver::Read", threads, iterations, [&](int thread, long i){
+      return cache.Read(keys[(i * 7 + thread * 13) % key_count], "roles").size();
+    });
+
+    granada::benchmark::Run("SharedMapCacheDriver::Write", threads, iterations, [&](int thread, long i){
+      cache.Write(keys[(i * 7 + thread * 13) % key_count], "roles", value);
+      return 1;
+    });
+
+    // 9 reads for every write.
+    granada::benchmark::Run("SharedMapCacheDriver::Read/Write 90/10", threads, iterations, [&](int thread, long i){
+      const std::string& key = keys[(i * 7 + thread * 13) % key_count];
+      if (i % 10 == 0){
+        cache.Write(key, "roles", value);
+        return (std::size_t)1;
+      }
+      return cache.Read(key, "roles").size();
+    });
+
+    // matching visits all the keys, so it is run less times.
+    granada::benchmark::Run("SharedMapCacheDriver::Match", threads, iterations / key_count + 1, [&](int thread, long i){
+      std::vector<std::string> matched;
+      cache.Match("session:value:1*", matched);
+      return matched.size();
+    });
+  }
+  granada::benchmark::PrintFooter();
+
+  return 0;
+}
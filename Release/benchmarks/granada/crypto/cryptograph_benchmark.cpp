@@ -0,0 +1,101 @@
+/**
+  * Copyright (c) <2016> Web App SDK granada <afernandez@cookinapps.io>
+  *
+  * This source code is licensed under the MIT license.
+  *
+  * Permission is hereby granted, free of charge, to any person obtaining a copy
+  * of this software and associated documentation files (the "Software"), to deal
+  * in the Software without restriction, including without limitation the rights
+  * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  * copies of the Software, and to permit persons to whom the Software is
+  * furnished to do so, subject to the following conditions:
+  *
+  * The above copyright notice and this permission notice shall be included in
+  * all copies or substantial portions of the Software.
+  *
+  * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  * SOFTWARE.
+  *
+  * Throughput benchmark of the cryptographs: OpensslAESCryptograph against
+  * OpensslEVPCryptograph (AES-256-GCM), encrypting and decrypting the same
+  * kind of short texts the OAuth 2.0 clients and users use as keys, and
+  * longer texts.
+  *
+  * Usage: cryptograph_benchmark [iterations]
+  */
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <string>
+#include "granada/crypto/openssl_aes_cryptograph.h"
+#include "granada/crypto/openssl_evp_cryptograph.h"
+
+
+/**
+ * Encrypts and decrypts a text a number of times with the given
+ * cryptograph and prints the operations per second.
+ * @param name          Name of the cryptograph.
+ * @param cryptograph   Cryptograph.
+ * @param text          Text to encrypt.
+ * @param iterations    Number of encryptions and decryptions.
+ */
+void run(const std::string& name, granada::crypto::Cryptograph& cryptograph, const std::string& text, const int iterations){
+  const std::string password = "L05l6pFaPFgZbtP9";
+  std::size_t checksum = 0;
+
+  auto start = std::chrono::steady_clock::now();
+  std::string encrypted;
+  for (int i = 0; i < iterations; ++i){
+    encrypted = cryptograph.Encrypt(text, password);
+    checksum += encrypted.size();
+  }
+  const double encrypt_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  start = std::chrono::steady_clock::now();
+  for (int i = 0; i < iterations; ++i){
+    checksum += cryptograph.Decrypt(encrypted, password).size();
+  }
+  const double decrypt_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  std::cout << std::left << std::setw(24) << name
+            << std::setw(10) << text.size()
+            << std::setw(16) << (long)(iterations / encrypt_seconds)
+            << std::setw(16) << (long)(iterations / decrypt_seconds)
+            << std::setw(12) << (iterations * text.size()) / encrypt_seconds / (1024 * 1024)
+            << " (" << checksum << ")" << std::endl;
+}
+
+
+int main(int argc, char* argv[]){
+  int iterations = 200000;
+  if (argc > 1){
+    try{
+      iterations = std::stoi(argv[1]);
+    }catch(const std::logic_error e){}
+  }
+
+  granada::crypto::OpensslAESCryptograph aes_cryptograph;
+  granada::crypto::OpensslEVPCryptograph evp_cryptograph;
+
+  std::cout << std::left << std::setw(24) << "cryptograph"
+            << std::setw(10) << "bytes"
+            << std::setw(16) << "encrypt/s"
+            << std::setw(16) << "decrypt/s"
+            << std::setw(12) << "MB/s" << std::endl;
+
+  // OpensslAESCryptograph only encrypts one 16 bytes block,
+  // so it is only compared with texts up to 15 bytes.
+  const std::string short_text = "gida8fZEFh9abpk";
+  run("OpensslAESCryptograph", aes_cryptograph, short_text, iterations);
+  run("OpensslEVPCryptograph", evp_cryptograph, short_text, iterations);
+
+  const std::string long_text(4096, 'x');
+  run("OpensslEVPCryptograph", evp_cryptograph, long_text, iterations / 10);
+
+  return 0;
+}
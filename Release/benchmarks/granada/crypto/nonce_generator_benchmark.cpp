@@ -0,0 +1,53 @@
+/**
+  * Copyright (c) <2016> Web App SDK granada <afernandez@cookinapps.io>
+  *
+  * This source code is licensed under the MIT license.
+  *
+  * Permission is hereby granted, free of charge, to any person obtaining a copy
+  * of this software and associated documentation files (the "Software"), to deal
+  * in the Software without restriction, including without limitation the rights
+  * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  * copies of the Software, and to permit persons to whom the Software is
+  * furnished to do so, subject to the following conditions:
+  *
+  * The above copyright notice and this permission notice shall be included in
+  * all copies or substantial portions of the Software.
+  *
+  * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  * SOFTWARE.
+  *
+  * Microbenchmark of the nonce generator used for the session tokens,
+  * the OAuth 2.0 codes and the plugin ids, with the lengths used by them.
+  * All CPPRESTNonceGenerator instances share the same generator, so it
+  * is only measured from one thread.
+  *
+  * Usage: nonce_generator_benchmark [iterations]
+  */
+#include <string>
+#include "granada/crypto/nonce_generator.h"
+#include "../benchmark.h"
+
+
+int main(int argc, char* argv[]){
+  const long iterations = granada::benchmark::Argument(argc, argv, 1, 200000);
+
+  granada::crypto::CPPRESTNonceGenerator generator;
+
+  granada::benchmark::PrintHeader();
+
+  for (int length : {16, 32, 64}){
+    granada::benchmark::Run("CPPRESTNonceGenerator::generate (" + std::to_string(length) + ")", 1, iterations, [&](int thread, long i){
+      int nonce_length = length;
+      return generator.generate(nonce_length).size();
+    });
+  }
+
+  granada::benchmark::PrintFooter();
+
+  return 0;
+}
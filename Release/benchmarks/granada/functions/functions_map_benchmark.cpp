@@ -0,0 +1,75 @@
+/**
+  * Copyright (c) <2016> Web App SDK granada <afernandez@cookinapps.io>
+  *
+  * This source code is licensed under the MIT license.
+  *
+  * Permission is hereby granted, free of charge, to any person obtaining a copy
+  * of this software and associated documentation files (the "Software"), to deal
+  * in the Software without restriction, including without limitation the rights
+  * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  * copies of the Software, and to permit persons to whom the Software is
+  * furnished to do so, subject to the following conditions:
+  *
+  * The above copyright notice and this permission notice shall be included in
+  * all copies or substantial portions of the Software.
+  *
+  * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  * SOFTWARE.
+  *
+  * Microbenchmark of FunctionsMap: lookup of existing and missing
+  * functions, and calls by name, in a map with as many functions as
+  * a plugin usually registers.
+  *
+  * Usage: functions_map_benchmark [iterations] [functions]
+  */
+#include <string>
+#include <vector>
+#include "granada/functions.h"
+#include "../benchmark.h"
+
+
+int main(int argc, char* argv[]){
+  const long iterations = granada::benchmark::Argument(argc, argv, 1, 1000000);
+  const long function_count = granada::benchmark::Argument(argc, argv, 2, 32);
+
+  granada::FunctionsMap functions;
+  std::vector<std::string> names;
+  for (long i = 0; i < function_count; ++i){
+    names.push_back("plugin.function" + std::to_string(i));
+    functions.Add(names.back(), [](const web::json::value& data){
+      return data;
+    });
+  }
+  const web::json::value parameters = web::json::value::object();
+
+  granada::benchmark::PrintHeader();
+
+  granada::benchmark::Run("FunctionsMap::Has", 1, iterations, [&](int thread, long i){
+    return functions.Has(names[i % function_count]) ? 1 : 0;
+  });
+
+  granada::benchmark::Run("FunctionsMap::Has (missing)", 1, iterations, [&](int thread, long i){
+    return functions.Has("plugin.missing") ? 1 : 0;
+  });
+
+  granada::benchmark::Run("FunctionsMap::Get", 1, iterations, [&](int thread, long i){
+    return functions.Get(names[i % function_count]) ? 1 : 0;
+  });
+
+  granada::benchmark::Run("FunctionsMap::Call", 1, iterations, [&](int thread, long i){
+    std::size_t size = 0;
+    functions.Call(names[i % function_count], parameters, [&size](const web::json::value& data){
+      size = data.size();
+    });
+    return size + 1;
+  });
+
+  granada::benchmark::PrintFooter();
+
+  return 0;
+}
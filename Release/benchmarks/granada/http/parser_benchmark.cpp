@@ -0,0 +1,79 @@
+/**
+  * Copyright (c) <2016> Web App SDK granada <afernandez@cookinapps.io>
+  *
+  * This source code is licensed under the MIT license.
+  *
+  * Permission is hereby granted, free of charge, to any person obtaining a copy
+  * of this software and associated documentation files (the "Software"), to deal
+  * in the Software without restriction, including without limitation the rights
+  * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  * copies of the Software, and to permit persons to whom the Software is
+  * furnished to do so, subject to the following conditions:
+  *
+  * The above copyright notice and this permission notice shall be included in
+  * all copies or substantial portions of the Software.
+  *
+  * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  * SOFTWARE.
+  *
+  * Microbenchmark of the HTTP parser: cookies, query strings and
+  * multipart/form-data bodies. The multipart/form-data body is consumed
+  * when it is parsed, so the request is created in every iteration and
+  * its creation is measured too.
+  *
+  * Usage: parser_benchmark [iterations]
+  */
+#include <string>
+#include <vector>
+#include "cpprest/http_msg.h"
+#include "granada/http/parser.h"
+#include "../benchmark.h"
+
+
+int main(int argc, char* argv[]){
+  const long iterations = granada::benchmark::Argument(argc, argv, 1, 100000);
+
+  web::http::http_request cookies_request(web::http::methods::GET);
+  cookies_request.headers().add(U("Cookie"), U("token=cc9sKWG6Bhh8RYe5nKCA6hTwXGqPwH8SMzbUV7WpDgHbEzMPlcJaXUQUZbf5; lang=en; theme=dark; _ga=GA1.2.1412393481.1466519045"));
+
+  const std::string query_string = "response_type=code&client_id=myfNv849Z1GNuPAN&redirect_uri=http%3A%2F%2Flocalhost%3A80%2Fclient&scope=msg.select&state=Zv9ocCjGYS5Cz8As";
+
+  // form with a text field and a 4KB file.
+  const std::string boundary = "----WebKitFormBoundarymBItcSVphgAjmbJC";
+  const std::string form = "--" + boundary + "\r\n"
+                           "Content-Disposition: form-data; name=\"plugin-id\"\r\n\r\n"
+                           "myfNv849Z1GNuPAN\r\n"
+                           "--" + boundary + "\r\n"
+                           "Content-Disposition: form-data; name=\"file\"; filename=\"plugin.js\"\r\n"
+                           "Content-Type: application/javascript\r\n\r\n"
+                           + std::string(4096, 'x') + "\r\n"
+                           "--" + boundary + "--\r\n";
+  const std::vector<unsigned char> body(form.begin(), form.end());
+  const utility::string_t content_type = U("multipart/form-data; boundary=") + utility::conversions::to_string_t(boundary);
+
+  granada::benchmark::PrintHeader();
+
+  granada::benchmark::Run("parser::ParseCookies", 1, iterations, [&](int thread, long i){
+    return granada::http::parser::ParseCookies(cookies_request).size();
+  });
+
+  granada::benchmark::Run("parser::ParseQueryString", 1, iterations, [&](int thread, long i){
+    return granada::http::parser::ParseQueryString(query_string).size();
+  });
+
+  granada::benchmark::Run("parser::ParseMultipartFormData (4KB)", 1, iterations / 10, [&](int thread, long i){
+    web::http::http_request request(web::http::methods::POST);
+    request.set_body(body);
+    request.headers().set_content_type(content_type);
+    return granada::http::parser::ParseMultipartFormData(request).size();
+  });
+
+  granada::benchmark::PrintFooter();
+
+  return 0;
+}
@@ -0,0 +1,558 @@
+/**
+  * Copyright (c) <2016> Web App SDK granada <afernandez@cookinapps.io>
+  *
+  * This source code is licensed under the MIT license.
+  *
+  * Permission is hereby granted, free of charge, to any person obtaining a copy
+  * of this software and associated documentation files (the "Software"), to deal
+  * in the Software without restriction, including without limitation the rights
+  * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  * copies of the Software, and to permit persons to whom the Software is
+  * furnished to do so, subject to the following conditions:
+  *
+  * The above copyright notice and this permission notice shall be included in
+  * all copies or substantial portions of the Software.
+  *
+  * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  * SOFTWARE.
+  *
+  * Load generator for the sample servers: N virtual users, each one with
+  * its own HTTP client and cookies, replay a user journey against a running
+  * sample for a number of seconds:
+  *
+  *   cart    sessions-login-and-cart: logs in, adds two products to the
+  *           cart, lists them, counts them and logs out.
+  *   plugin  plugin-server: loads the page, fires the "calculate" event and
+  *           runs the math.square and math.sum plug-ins.
+  *   oauth2  oauth2-server: registers a client and a user once per virtual
+  *           user, then gets an access token with the user credentials,
+  *           inserts a message and lists the messages.
+  *
+  * Connections are kept alive between the requests of a virtual user, with
+  * "close" every request asks the server to close the connection.
+  *
+  * Reports per request and for the whole journey the completed requests,
+  * errors, error rate, requests per second and p50/p90/p99/p99.9 latency.
+  * A request fails if it cannot be sent, if the status is not the expected
+  * one, if the response does not have the expected content or if it has
+  * an "error" field or redirects with an "error" parameter.
+  *
+  * Usage: load_generator <cart|plugin|oauth2> [users] [seconds] [url] [keep-alive|close]
+  *
+  * Example, with sessions-login-and-cart listening on port 80:
+  *        load_generator cart 32 30 http://localhost:80
+  */
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <map>
+#include <random>
+#include <sstream>
+#include <thread>
+#include <algorithm>
+#include "cpprest/http_client.h"
+
+
+/**
+ * Returns a random number between 0 and max - 1, each thread
+ * has its own generator.
+ * @param  max Upper bound, excluded.
+ * @return     Random number.
+ */
+std::size_t random_number(const std::size_t max){
+  static thread_local std::mt19937 engine(std::random_device{}());
+  return std::uniform_int_distribution<std::size_t>(0, max - 1)(engine);
+}
+
+
+/**
+ * Returns a random string of letters and digits.
+ * @param  length Length of the string.
+ * @return        Random string.
+ */
+std::string random_string(const std::size_t length){
+  static const char characters[] = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789";
+  std::string str;
+  for (std::size_t i = 0; i < length; ++i){
+    str += characters[random_number(sizeof(characters) - 1)];
+  }
+  return str;
+}
+
+
+/**
+ * Returns the value of a parameter of the query string or the
+ * fragment of an URI.
+ * @param  uri  URI, example: http://localhost/callback#access_token=Tn9A...&token_type=bearer
+ * @param  name Name of the parameter.
+ * @return      Value of the parameter, empty if not found.
+ */
+std::string uri_parameter(const std::string& uri, const std::string& name){
+  const std::size_t query_start = uri.find_first_of("?#");
+  if (query_start != std::string::npos){
+    std::size_t pos = query_start;
+    while (pos != std::string::npos){
+      ++pos;
+      if (uri.compare(pos, name.length() + 1, name + "=") == 0){
+        pos += name.length() + 1;
+        return uri.substr(pos, uri.find('&', pos) - pos);
+      }
+      pos = uri.find('&', pos);
+    }
+  }
+  return std::string();
+}
+
+
+/**
+ * Latencies in milliseconds of the successful requests
+ * and number of failed requests.
+ */
+struct Results{
+  std::vector<double> latencies;
+  long errors = 0;
+};
+
+
+/**
+ * Virtual user: sends the requests of a journey with its own
+ * HTTP client and cookies, and records the results by request name.
+ */
+class VirtualUser{
+
+  public:
+
+    /**
+     * Constructor.
+     * @param url         Address of the sample server.
+     * @param keep_alive  False to ask the server to close the connection
+     *                    after every request.
+     * @param results     Results by request name, filled by the virtual user.
+     * @param names       Names of the requests in the order they are first sent.
+     */
+    VirtualUser(const utility::string_t& url, const bool keep_alive, std::map<std::string,Results>& results, std::vector<std::string>& names)
+      : client_(url), keep_alive_(keep_alive), results_(results), names_(names){};
+
+
+    /**
+     * Sends a request and records its latency if the response has the
+     * expected status, contains the expected text and has no "error" field
+     * or redirection parameter, or an error if not.
+     * @param  name           Name of the request in the report.
+     * @param  method         HTTP method.
+     * @param  path           Path and query of the request.
+     * @param  body           Body, not sent if empty.
+     * @param  content_type   Content type of the body.
+     * @param  status         Expected status code.
+     * @param  expected       Text the body of the response has to contain, nothing is
+     *                        checked if empty.
+     * @param  response_body  Body of the response.
+     * @param  location       Location header of the response.
+     * @return                True if the request succeeded.
+     */
+    bool Send(const std::string& name,
+              const web::http::method& method,
+              const std::string& path,
+              const std::string& body,
+              const std::string& content_type,
+              const web::http::status_code status,
+              const std::string& expected,
+              std::string& response_body,
+              std::string& location){
+
+      web::http::http_request request(method);
+      request.set_request_uri(utility::conversions::to_string_t(path));
+      if (!body.empty()){
+        request.set_body(body, content_type);
+      }
+      if (!cookies_.empty()){
+        std::string cookie;
+        for (auto it = cookies_.begin(); it != cookies_.end(); ++it){
+          if (!cookie.empty()){
+            cookie += "; ";
+          }
+          cookie += it->first + "=" + it->second;
+        }
+        request.headers().add(U("Cookie"), utility::conversions::to_string_t(cookie));
+      }
+      if (!keep_alive_){
+        request.headers().add(web::http::header_names::connection, U("close"));
+      }
+
+      bool success = false;
+      const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+      try{
+        web::http::http_response response = client_.request(request).get();
+        response_body = utility::conversions::to_utf8string(response.extract_string(true).get());
+        const double latency = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        StoreCookies(response.headers());
+        location = utility::conversions::to_utf8string(response.headers()[web::http::header_names::location]);
+        success = response.status_code() == status &&
+                  (expected.empty() || response_body.find(expected) != std::string::npos) &&
+                  response_body.find("\"error\"") == std::string::npos &&
+                  uri_parameter(location, "error").empty();
+        if (success){
+          Record(name).latencies.push_back(latency);
+        }
+      }catch(const std::exception& e){}
+
+      if (!success){
+        Record(name).errors++;
+      }
+      return success;
+    };
+
+
+    /**
+     * Same as Send but without returning the Location header.
+     */
+    bool Send(const std::string& name, const web::http::method& method, const std::string& path, const std::string& body, const std::string& content_type, const web::http::status_code status, const std::string& expected, std::string& response_body){
+      std::string location;
+      return Send(name, method, path, body, content_type, status, expected, response_body, location);
+    };
+
+
+    /**
+     * Records the latency of a whole journey.
+     * @param latency Latency in milliseconds, negative if the journey failed.
+     */
+    void RecordJourney(const double latency){
+      Results& results = Record("journey");
+      if (latency < 0){
+        results.errors++;
+      }else{
+        results.latencies.push_back(latency);
+      }
+    };
+
+
+    /**
+     * Removes all the cookies, so the next request starts a new session.
+     */
+    void ClearCookies(){
+      cookies_.clear();
+    };
+
+
+  private:
+
+    /**
+     * HTTP client, keeps the connection to the server open.
+     */
+    web::http::client::http_client client_;
+
+
+    /**
+     * Cookies received from the server.
+     */
+    std::map<std::string,std::string> cookies_;
+
+
+    /**
+     * False to ask the server to close the connection after every request.
+     */
+    bool keep_alive_;
+
+
+    /**
+     * Results by request name.
+     */
+    std::map<std::string,Results>& results_;
+
+
+    /**
+     * Names of the requests in the order they are first sent.
+     */
+    std::vector<std::string>& names_;
+
+
+    /**
+     * Returns the results of the request with the given name.
+     * @param  name Name of the request.
+     * @return      Results.
+     */
+    Results& Record(const std::string& name){
+      auto it = results_.find(name);
+      if (it == results_.end()){
+        names_.push_back(name);
+        it = results_.insert(std::make_pair(name, Results())).first;
+      }
+      return it->second;
+    };
+
+
+    /**
+     * Stores the cookies of the Set-Cookie header, only their
+     * name and value are kept, example: token=cc9sKWG6; path=/
+     * @param headers Headers of the response.
+     */
+    void StoreCookies(const web::http::http_headers& headers){
+      auto it = headers.find(U("Set-Cookie"));
+      if (it != headers.end()){
+        // several Set-Cookie headers are joined with commas.
+        std::stringstream ss(utility::conversions::to_utf8string(it->second));
+        std::string cookie;
+        while (std::getline(ss, cookie, ',')){
+          cookie = cookie.substr(0, cookie.find(';'));
+          const std::size_t equal = cookie.find('=');
+          if (equal != std::string::npos){
+            std::string name = cookie.substr(0, equal);
+            name.erase(0, name.find_first_not_of(' '));
+            cookies_[name] = cookie.substr(equal + 1);
+          }
+        }
+      }
+    };
+};
+
+
+/**
+ * Journey of the sessions-login-and-cart sample.
+ * @param  user Virtual user.
+ * @return      True if all the requests succeeded.
+ */
+bool cart_journey(VirtualUser& user){
+  const std::string boundary = "----GranadaLoadGenerator" + random_string(16);
+  const std::string login_form = "--" + boundary + "\r\n"
+                                 "Content-Disposition: form-data; name=\"username\"\r\n\r\n"
+                                 "user\r\n"
+                                 "--" + boundary + "\r\n"
+                                 "Content-Disposition: form-data; name=\"password\"\r\n\r\n"
+                                 "pass\r\n"
+                                 "--" + boundary + "--\r\n";
+  const std::string form = "application/x-www-form-urlencoded";
+  std::string body;
+
+  // every journey is a new visitor with a new session.
+  user.ClearCookies();
+  return user.Send("POST /auth/login", web::http::methods::POST, "/auth/login", login_form, "multipart/form-data; boundary=" + boundary, web::http::status_codes::OK, "\"status\":1", body)
+      && user.Send("PUT /cart/add", web::http::methods::PUT, "/cart/add", "id=" + std::to_string(random_number(1000)) + "&quantity=1", form, web::http::status_codes::OK, "count", body)
+      && user.Send("PUT /cart/add", web::http::methods::PUT, "/cart/add", "id=" + std::to_string(random_number(1000)) + "&quantity=2", form, web::http::status_codes::OK, "count", body)
+      && user.Send("GET /cart/list", web::http::methods::GET, "/cart/list", "", "", web::http::status_codes::OK, "\"data\"", body)
+      && user.Send("GET /cart/count", web::http::methods::GET, "/cart/count", "", "", web::http::status_codes::OK, "count", body)
+      && user.Send("POST /auth/logout", web::http::methods::POST, "/auth/logout", "", "", web::http::status_codes::OK, "\"status\":0", body);
+}
+
+
+/**
+ * Journey of the plugin-server sample.
+ * @param  user Virtual user.
+ * @return      True if all the requests succeeded.
+ */
+bool plugin_journey(VirtualUser& user){
+  const std::string number = std::to_string(random_number(100));
+  const std::string json = "application/json";
+  std::string body;
+
+  user.ClearCookies();
+  return user.Send("GET /", web::http::methods::GET, "/", "", "", web::http::status_codes::OK, "", body)
+      && user.Send("POST /plugin (event)", web::http::methods::POST, "/plugin?state=" + random_string(8), "{\"event\":\"calculate\",\"parameters\":{\"number\":\"" + number + "\",\"addend1\":\"" + number + "\",\"addend2\":\"3\",\"factor1\":\"" + number + "\",\"factor2\":\"4\"}}", json, web::http::status_codes::OK, "", body)
+      && user.Send("POST /plugin (math.square)", web::http::methods::POST, "/plugin?state=" + random_string(8), "{\"plugin_id\":\"math.square\",\"parameters\":{\"number\":\"" + number + "\"}}", json, web::http::status_codes::OK, "", body)
+      && user.Send("POST /plugin (math.sum)", web::http::methods::POST, "/plugin?state=" + random_string(8), "{\"plugin_id\":\"math.sum\",\"parameters\":{\"addend1\":\"" + number + "\",\"addend2\":\"3\"}}", json, web::http::status_codes::OK, "", body);
+}
+
+
+/**
+ * Path of the authorization endpoint of the oauth2-server sample,
+ * "oauth2_authorize_uri" property of its server.conf.
+ */
+const std::string oauth2_authorize_path = "/oauth2/auth";
+
+
+/**
+ * Registered client and user of an oauth2-server virtual user.
+ */
+struct OAuth2Credentials{
+  std::string client_id;
+  std::string redirect_uri = "http://localhost/callback";
+  std::string username;
+  std::string password;
+};
+
+
+/**
+ * Registers a client and a user in the oauth2-server sample, the
+ * requests are not part of the journey but they are reported.
+ * @param  user         Virtual user.
+ * @param  credentials  Registered client and user.
+ * @return              True if the client and the user were registered.
+ */
+bool oauth2_setup(VirtualUser& user, OAuth2Credentials& credentials){
+  const std::string form = "application/x-www-form-urlencoded";
+  credentials.username = "load" + random_string(8);
+  credentials.password = random_string(12);
+  std::string client_body;
+  std::string body;
+  if (user.Send("POST /client (setup)", web::http::methods::POST, "/client/", "redirect_uri=" + utility::conversions::to_utf8string(web::uri::encode_data_string(utility::conversions::to_string_t(credentials.redirect_uri))) + "&application_name=load_generator&roles=msg.select+msg.insert", form, web::http::status_codes::OK, "client_id", client_body)
+      && user.Send("POST /user (setup)", web::http::methods::POST, "/user/", "username=" + credentials.username + "&password=" + credentials.password + "&password2=" + credentials.password, form, web::http::status_codes::Found, "", body)){
+    const web::json::value& json = web::json::value::parse(utility::conversions::to_string_t(client_body));
+    credentials.client_id = utility::conversions::to_utf8string(json.at(U("client_id")).as_string());
+    return true;
+  }
+  return false;
+}
+
+
+/**
+ * Journey of the oauth2-server sample.
+ * @param  user         Virtual user.
+ * @param  credentials  Registered client and user.
+ * @param  path         Authorization endpoint path, example: /oauth2/auth
+ * @return              True if all the requests succeeded.
+ */
+bool oauth2_journey(VirtualUser& user, const OAuth2Credentials& credentials, const std::string& path){
+  const std::string form = "application/x-www-form-urlencoded";
+  std::string body;
+  std::string location;
+
+  user.ClearCookies();
+  if (!user.Send("POST /oauth2/auth (token)", web::http::methods::POST, path,
+                 "response_type=token&client_id=" + credentials.client_id +
+                 "&redirect_uri=" + utility::conversions::to_utf8string(web::uri::encode_data_string(utility::conversions::to_string_t(credentials.redirect_uri))) +
+                 "&username=" + credentials.username + "&password=" + credentials.password + "&scope=msg.select+msg.insert",
+                 form, web::http::status_codes::Found, "", body, location)){
+    return false;
+  }
+  const std::string& token = uri_parameter(location, "access_token");
+  return !token.empty()
+      && user.Send("PUT /message", web::http::methods::PUT, "/message/", "token=" + token + "&message=" + random_string(32), form, web::http::status_codes::OK, "\"data\"", body)
+      && user.Send("POST /message/list", web::http::methods::POST, "/message/list", "token=" + token, form, web::http::status_codes::OK, "\"data\"", body);
+}
+
+
+/**
+ * Replays the journey until the deadline.
+ * @param journey     Name of the journey: cart, plugin or oauth2.
+ * @param url         Address of the sample server.
+ * @param keep_alive  False to ask the server to close the connection after every request.
+ * @param deadline    Time to stop.
+ * @param results     Results by request name.
+ * @param names       Names of the requests in the order they are first sent.
+ */
+void drive(const std::string& journey,
+           const utility::string_t& url,
+           const bool keep_alive,
+           const std::chrono::steady_clock::time_point& deadline,
+           std::map<std::string,Results>& results,
+           std::vector<std::string>& names){
+
+  VirtualUser user(url, keep_alive, results, names);
+
+  OAuth2Credentials credentials;
+  if (journey == "oauth2" && !oauth2_setup(user, credentials)){
+    return;
+  }
+
+  while (std::chrono::steady_clock::now() < deadline){
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    bool success;
+    if (journey == "cart"){
+      success = cart_journey(user);
+    }else if (journey == "plugin"){
+      success = plugin_journey(user);
+    }else{
+      success = oauth2_journey(user, credentials, oauth2_authorize_path);
+    }
+    user.RecordJourney(success ? std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() : -1);
+  }
+}
+
+
+/**
+ * Returns the given percentile of sorted latencies.
+ * @param  latencies Sorted latencies.
+ * @param  p         Percentile between 0 and 1.
+ * @return           Latency.
+ */
+double percentile(const std::vector<double>& latencies, const double p){
+  if (latencies.empty()){
+    return 0;
+  }
+  const std::size_t index = std::min(latencies.size() - 1, (std::size_t)(p * latencies.size()));
+  return latencies[index];
+}
+
+
+int main(int argc, char* argv[]){
+  std::string journey = argc > 1 ? argv[1] : "";
+  int users = 8;
+  int seconds = 10;
+  try{
+    if (argc > 2) users = std::stoi(argv[2]);
+    if (argc > 3) seconds = std::stoi(argv[3]);
+  }catch(const std::logic_error& e){}
+  const std::string url = argc > 4 ? argv[4] : "http://localhost:80";
+  const std::string connection = argc > 5 ? argv[5] : "keep-alive";
+
+  if ((journey != "cart" && journey != "plugin" && journey != "oauth2") || users < 1 || seconds < 1 || (connection != "keep-alive" && connection != "close")){
+    std::cout << "Usage: " << argv[0] << " <cart|plugin|oauth2> [users] [seconds] [url] [keep-alive|close]" << std::endl;
+    return 1;
+  }
+
+  // results of each virtual user, merged at the end.
+  std::vector<std::map<std::string,Results>> results(users);
+  std::vector<std::vector<std::string>> names(users);
+  std::vector<std::thread> clients;
+  const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  const std::chrono::steady_clock::time_point deadline = start + std::chrono::seconds(seconds);
+  for (int i = 0; i < users; ++i){
+    clients.emplace_back(drive, std::cref(journey), utility::conversions::to_string_t(url), connection == "keep-alive", std::cref(deadline), std::ref(results[i]), std::ref(names[i]));
+  }
+  for (auto it = clients.begin(); it != clients.end(); ++it){
+    it->join();
+  }
+  const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  // requests in the order they were first sent, the journey last.
+  std::vector<std::string> order;
+  for (auto it = names.begin(); it != names.end(); ++it){
+    for (auto name = it->begin(); name != it->end(); ++name){
+      if (*name != "journey" && std::find(order.begin(), order.end(), *name) == order.end()){
+        order.push_back(*name);
+      }
+    }
+  }
+  order.push_back("journey");
+
+  std::cout << journey << ": " << users << " users, " << connection << ", " << std::fixed << std::setprecision(1) << elapsed << " s" << std::endl;
+  std::cout << std::left << std::setw(30) << "request"
+            << std::setw(12) << "requests"
+            << std::setw(10) << "errors"
+            << std::setw(10) << "error %"
+            << std::setw(12) << "req/s"
+            << std::setw(10) << "p50 ms"
+            << std::setw(10) << "p90 ms"
+            << std::setw(10) << "p99 ms"
+            << std::setw(10) << "p99.9 ms" << std::endl;
+  for (auto name = order.begin(); name != order.end(); ++name){
+    std::vector<double> latencies;
+    long errors = 0;
+    for (int i = 0; i < users; ++i){
+      auto it = results[i].find(*name);
+      if (it != results[i].end()){
+        latencies.insert(latencies.end(), it->second.latencies.begin(), it->second.latencies.end());
+        errors += it->second.errors;
+      }
+    }
+    const long requests = (long)latencies.size() + errors;
+    std::sort(latencies.begin(), latencies.end());
+    std::cout << std::left << std::setw(30) << *name
+              << std::setw(12) << requests
+              << std::setw(10) << errors
+              << std::setw(10) << std::setprecision(2) << (requests > 0 ? 100.0 * errors / requests : 0)
+              << std::setw(12) << std::setprecision(1) << latencies.size() / elapsed
+              << std::setw(10) << std::setprecision(2) << percentile(latencies, 0.50)
+              << std::setw(10) << percentile(latencies, 0.90)
+              << std::setw(10) << percentile(latencies, 0.99)
+              << std::setw(10) << percentile(latencies, 0.999) << std::endl;
+  }
+
+  return 0;
+}
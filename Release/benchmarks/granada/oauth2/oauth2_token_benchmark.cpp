@@ -0,0 +1,321 @@
+/**
+  * Copyright (c) <2016> Web App SDK granada <afernandez@cookinapps.io>
+  *
+  * This source code is licensed under the MIT license.
+  *
+  * Permission is hereby granted, free of charge, to any person obtaining a copy
+  * of this software and associated documentation files (the "Software"), to deal
+  * in the Software without restriction, including without limitation the rights
+  * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  * copies of the Software, and to permit persons to whom the Software is
+  * furnished to do so, subject to the following conditions:
+  *
+  * The above copyright notice and this permission notice shall be included in
+  * all copies or substantial portions of the Software.
+  *
+  * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  * SOFTWARE.
+  *
+  * Load and latency benchmark of the OAuth 2.0 authorization and token
+  * endpoint: starts an OAuth2Controller with the map (or redis) sessions and
+  * OAuth 2.0 entities, registers a client and a user, and drives grants from
+  * N client threads through HTTP for a number of seconds:
+  *
+  *   password            response_type=token with the user credentials.
+  *   authorization_code  response_type=code with the user credentials, then
+  *                       the code is exchanged for an access token.
+  *   refresh_token       a refresh token is exchanged for a new access token,
+  *                       needs use_refresh_token=true in server.conf.
+  *
+  * Reports per grant type the completed grants, errors, grants per second
+  * and p50/p99 latency of a whole grant.
+  *
+  * Usage: oauth2_token_benchmark [threads] [seconds] [password|code|refresh|all] [port]
+  *        redis_oauth2_token_benchmark [threads] [seconds] [password|code|refresh|all] [port]
+  *
+  * The redis variant needs a redis-server listening on the address configured
+  * in server.conf (localhost:6379 by default). The server.conf next to this file
+  * enables refresh tokens, copy it next to the executable.
+  */
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <string>
+#include <ctime>
+#include <vector>
+#include <thread>
+#include <algorithm>
+#include "cpprest/http_client.h"
+#include "granada/http/controller/oauth2_controller.h"
+#ifdef GRANADA_BENCHMARK_REDIS
+#include "granada/http/session/redis_session.h"
+#include "granada/http/oauth2/redis_oauth2.h"
+#else
+#include "granada/http/session/map_session.h"
+#include "granada/http/oauth2/map_oauth2.h"
+#endif
+
+
+/**
+ * Grant types driven by the benchmark.
+ */
+enum GrantType{
+  PASSWORD_GRANT = 0,
+  AUTHORIZATION_CODE_GRANT,
+  REFRESH_TOKEN_GRANT,
+  GRANT_TYPES
+};
+
+const char* grant_type_names[GRANT_TYPES] = { "password", "authorization_code", "refresh_token" };
+
+
+/**
+ * Registered client and user used by all the threads.
+ */
+struct Credentials{
+  std::string client_id;
+  std::string client_secret;
+  std::string redirect_uri;
+  std::string username;
+  std::string password;
+  std::string scope;
+};
+
+
+/**
+ * Latencies in milliseconds of the successful grants
+ * and number of failed grants of a thread.
+ */
+struct GrantResults{
+  std::vector<double> latencies;
+  long errors = 0;
+};
+
+
+/**
+ * Posts an OAuth 2.0 form to the authorization endpoint and fills the
+ * OAuth 2.0 parameters of the response, taken from the query string of
+ * the redirection or from the json body.
+ * @param  client     HTTP client of the OAuth 2.0 controller.
+ * @param  path       Authorization endpoint path, example: auth
+ * @param  body       Form body.
+ * @param  oauth2_response  OAuth 2.0 parameters of the response.
+ * @return            True if the response has no error.
+ */
+bool post(web::http::client::http_client& client, const std::string& path, const std::string& body, granada::http::oauth2::OAuth2Parameters& oauth2_response){
+  web::http::http_request request(web::http::methods::POST);
+  request.set_request_uri(utility::conversions::to_string_t(path));
+  request.set_body(utility::conversions::to_string_t(body), U("application/x-www-form-urlencoded"));
+  try{
+    web::http::http_response response = client.request(request).get();
+    if (response.status_code() == web::http::status_codes::Found){
+      const std::string& location = utility::conversions::to_utf8string(response.headers()[web::http::header_names::location]);
+      const std::size_t query_start = location.find('?');
+      if (query_start == std::string::npos){
+        return false;
+      }
+      oauth2_response = granada::http::oauth2::OAuth2Parameters(location.substr(query_start + 1));
+    }else if (response.status_code() == web::http::status_codes::OK){
+      const web::json::value& json = response.extract_json(true).get();
+      if (!json.is_object()){
+        return false;
+      }
+      const web::json::object& fields = json.as_object();
+      for (auto it = fields.cbegin(); it != fields.cend(); ++it){
+        if (it->second.is_string()){
+          oauth2_response.Parse(utility::conversions::to_utf8string(it->first) + "=" + utility::conversions::to_utf8string(web::uri::encode_data_string(it->second.as_string())));
+        }
+      }
+    }else{
+      return false;
+    }
+  }catch(const std::exception& e){
+    return false;
+  }
+  return oauth2_response.error.empty();
+}
+
+
+/**
+ * Drives grants of the given types until the deadline.
+ * @param address     Address of the OAuth 2.0 controller.
+ * @param path        Authorization endpoint path.
+ * @param credentials Client and user credentials.
+ * @param grant_types Grant types to run, in turns.
+ * @param deadline    Time to stop.
+ * @param results     Results by grant type.
+ */
+void drive(const utility::string_t& address,
+           const std::string& path,
+           const Credentials& credentials,
+           const std::vector<GrantType>& grant_types,
+           const std::chrono::steady_clock::time_point& deadline,
+           std::vector<GrantResults>& results){
+
+  web::http::client::http_client client(address);
+
+  const std::string& client_params = "&client_id=" + credentials.client_id +
+                                     "&redirect_uri=" + utility::conversions::to_utf8string(web::uri::encode_data_string(utility::conversions::to_string_t(credentials.redirect_uri)));
+  const std::string& user_params = "&username=" + credentials.username + "&password=" + credentials.password + "&scope=" + credentials.scope;
+  const std::string& secret_param = "&client_secret=" + credentials.client_secret;
+
+  std::string refresh_token;
+  std::size_t turn = 0;
+  while (std::chrono::steady_clock::now() < deadline){
+    GrantType grant_type = grant_types[turn++ % grant_types.size()];
+    if (grant_type == REFRESH_TOKEN_GRANT && refresh_token.empty()){
+      // run an authorization code grant to get a refresh token first.
+      grant_type = AUTHORIZATION_CODE_GRANT;
+    }
+
+    granada::http::oauth2::OAuth2Parameters oauth2_response;
+    bool success = false;
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    if (grant_type == PASSWORD_GRANT){
+      success = post(client, path, "response_type=token" + client_params + user_params, oauth2_response);
+    }else if (grant_type == AUTHORIZATION_CODE_GRANT){
+      granada::http::oauth2::OAuth2Parameters code_response;
+      success = post(client, path, "response_type=code" + client_params + user_params, code_response) && !code_response.code.empty() &&
+                post(client, path, "grant_type=authorization_code&code=" + code_response.code + client_params + secret_param, oauth2_response);
+    }else{
+      success = post(client, path, "grant_type=refresh_token&refresh_token=" + refresh_token + client_params + secret_param, oauth2_response);
+    }
+    const double latency = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    if (grant_type != PASSWORD_GRANT){
+      refresh_token.assign(oauth2_response.refresh_token);
+    }
+    if (success && !oauth2_response.access_token.empty()){
+      results[grant_type].latencies.push_back(latency);
+    }else{
+      results[grant_type].errors++;
+    }
+  }
+}
+
+
+/**
+ * Returns the given percentile of sorted latencies.
+ * @param  latencies Sorted latencies.
+ * @param  p         Percentile between 0 and 1.
+ * @return           Latency.
+ */
+double percentile(const std::vector<double>& latencies, const double p){
+  if (latencies.empty()){
+    return 0;
+  }
+  const std::size_t index = std::min(latencies.size() - 1, (std::size_t)(p * latencies.size()));
+  return latencies[index];
+}
+
+
+int main(int argc, char* argv[]){
+  int threads = 8;
+  int seconds = 10;
+  std::string grants = "all";
+  std::string port = "8089";
+  try{
+    if (argc > 1) threads = std::stoi(argv[1]);
+    if (argc > 2) seconds = std::stoi(argv[2]);
+  }catch(const std::logic_error e){}
+  if (argc > 3) grants.assign(argv[3]);
+  if (argc > 4) port.assign(argv[4]);
+
+  std::vector<GrantType> grant_types;
+  if (grants == "password" || grants == "all") grant_types.push_back(PASSWORD_GRANT);
+  if (grants == "code" || grants == "all") grant_types.push_back(AUTHORIZATION_CODE_GRANT);
+  if (grants == "refresh" || grants == "all") grant_types.push_back(REFRESH_TOKEN_GRANT);
+  if (grant_types.empty() || threads < 1 || seconds < 1){
+    std::cout << "Usage: " << argv[0] << " [threads] [seconds] [password|code|refresh|all] [port]" << std::endl;
+    return 1;
+  }
+
+#ifdef GRANADA_BENCHMARK_REDIS
+  std::shared_ptr<granada::http::session::SessionFactory> session_factory(new granada::http::session::RedisSessionFactory());
+  std::shared_ptr<granada::http::oauth2::OAuth2Factory> oauth2_factory(new granada::http::oauth2::RedisOAuth2Factory());
+#else
+  std::shared_ptr<granada::http::session::SessionFactory> session_factory(new granada::http::session::MapSessionFactory());
+  std::shared_ptr<granada::http::oauth2::OAuth2Factory> oauth2_factory(new granada::http::oauth2::MapOAuth2Factory());
+#endif
+
+  const utility::string_t& address = utility::conversions::to_string_t("http://localhost:" + port + "/oauth2");
+  granada::http::controller::OAuth2Controller oauth2_controller(address, session_factory, oauth2_factory);
+  oauth2_controller.open().wait();
+
+  std::string path = granada::util::application::GetProperty(entity_keys::oauth2_authorize_uri);
+  if (path.empty()){
+    path.assign(default_strings::oauth2_authorize_uri);
+  }
+
+  // register the client and the user.
+  Credentials credentials;
+  credentials.client_secret = "L05l6pFaPFgZbtP9";
+  credentials.redirect_uri = "http://localhost/callback";
+  credentials.username = "benchmark" + std::to_string(std::time(nullptr));
+  credentials.password = "gida8fZEFh9abpkg";
+  credentials.scope = "msg.select+msg.insert";
+
+  std::vector<std::string> redirect_uris{ credentials.redirect_uri };
+  std::vector<std::string> client_roles{ "msg.select", "msg.insert" };
+  std::unique_ptr<granada::http::oauth2::OAuth2Client> oauth2_client = oauth2_factory->OAuth2Client_unique_ptr();
+  oauth2_client->Create(oauth2_client_types::confidential, redirect_uris, "oauth2_token_benchmark", client_roles, credentials.client_secret);
+  credentials.client_id = oauth2_client->GetId();
+
+  const web::json::value& user_roles = web::json::value::parse(U("{\"msg.select\":{},\"msg.insert\":{}}"));
+  std::unique_ptr<granada::http::oauth2::OAuth2User> oauth2_user = oauth2_factory->OAuth2User_unique_ptr();
+  std::string user_password = credentials.password;
+  if (credentials.client_id.empty() || !oauth2_user->Create(credentials.username, user_password, user_roles)){
+    std::cout << "Error registering the benchmark client and user." << std::endl;
+    oauth2_controller.close().wait();
+    return 1;
+  }
+
+  // drive the grants.
+  std::vector<std::vector<GrantResults>> results(threads, std::vector<GrantResults>(GRANT_TYPES));
+  std::vector<std::thread> clients;
+  const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  const std::chrono::steady_clock::time_point deadline = start + std::chrono::seconds(seconds);
+  for (int i = 0; i < threads; ++i){
+    clients.emplace_back(drive, std::cref(address), std::cref(path), std::cref(credentials), std::cref(grant_types), std::cref(deadline), std::ref(results[i]));
+  }
+  for (auto it = clients.begin(); it != clients.end(); ++it){
+    it->join();
+  }
+  const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  std::cout << threads << " threads, " << std::fixed << std::setprecision(1) << elapsed << " s" << std::endl;
+  std::cout << std::left << std::setw(22) << "grant"
+            << std::setw(12) << "grants"
+            << std::setw(10) << "errors"
+            << std::setw(14) << "grants/s"
+            << std::setw(12) << "p50 ms"
+            << std::setw(12) << "p99 ms" << std::endl;
+  for (int grant_type = 0; grant_type < GRANT_TYPES; ++grant_type){
+    std::vector<double> latencies;
+    long errors = 0;
+    for (int i = 0; i < threads; ++i){
+      const GrantResults& grant_results = results[i][grant_type];
+      latencies.insert(latencies.end(), grant_results.latencies.begin(), grant_results.latencies.end());
+      errors += grant_results.errors;
+    }
+    if (latencies.empty() && errors == 0){
+      continue;
+    }
+    std::sort(latencies.begin(), latencies.end());
+    std::cout << std::left << std::setw(22) << grant_type_names[grant_type]
+              << std::setw(12) << latencies.size()
+              << std::setw(10) << errors
+              << std::setw(14) << std::setprecision(1) << latencies.size() / elapsed
+              << std::setw(12) << std::setprecision(2) << percentile(latencies, 0.50)
+              << std::setw(12) << percentile(latencies, 0.99) << std::endl;
+  }
+
+  oauth2_user->Delete(credentials.password);
+  oauth2_controller.close().wait();
+  return 0;
+}
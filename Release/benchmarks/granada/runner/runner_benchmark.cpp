@@ -0,0 +1,188 @@
+/**
+  * Copyright (c) <2016> Web App SDK granada <afernandez@cookinapps.io>
+  *
+  * This source code is licensed under the MIT license.
+  *
+  * Permission is hereby granted, free of charge, to any person obtaining a copy
+  * of this software and associated documentation files (the "Software"), to deal
+  * in the Software without restriction, including without limitation the rights
+  * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  * copies of the Software, and to permit persons to whom the Software is
+  * furnished to do so, subject to the following conditions:
+  *
+  * The above copyright notice and this permission notice shall be included in
+  * all copies or substantial portions of the Software.
+  *
+  * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  * SOFTWARE.
+  *
+  * Side by side benchmark of the javascript runners: latency of a run of
+  * the math plug-ins of the plugin-server sample, built as
+  * SpidermonkeyPluginHandler builds them, and memory used by each context.
+  * The QuickJS runner is only benchmarked when built with GRANADA_QUICKJS.
+  *
+  * Usage: runner_benchmark [iterations] [plug-ins directory]
+  */
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "granada/defaults.h"
+#include "granada/util/string.h"
+#include "granada/runner/javascript_runner.h"
+#include "../benchmark.h"
+
+
+namespace{
+
+  /**
+   * Javascript basic functions of the plug-ins.
+   */
+  const std::string javascript_plugin_core =
+    #include "granada/plugin/javascript-plugin-core.min.js"
+  ;
+
+
+  /**
+   * Reads a file, empty string if it does not exist.
+   */
+  std::string ReadFile(const std::string& path){
+    std::ifstream file(path);
+    std::stringstream content;
+    content << file.rdbuf();
+    return content.str();
+  }
+
+
+  /**
+   * Builds the script run by SpidermonkeyPluginHandler::Run for a plug-in.
+   */
+  std::string PluginScript(const std::string& plugin_id, const std::string& plugin_script, const std::string& parameters){
+    std::string core = javascript_plugin_core;
+    std::deque<std::pair<std::string,std::string>> values;
+    values.push_back(std::make_pair(entity_keys::plugin_parameter_plugin_id, plugin_id));
+    values.push_back(std::make_pair(entity_keys::plugin_parameter_plugin_handler_id, "benchmark"));
+    values.push_back(std::make_pair(entity_keys::plugin_parameter_configuration, "{}"));
+    granada::util::string::replace(core, values);
+    return core + " var __PLUGIN = " + plugin_script + "; __wrappedRun(" + parameters + ",null);";
+  }
+
+
+  /**
+   * Adds the c++ functions the plug-ins call, answering
+   * as the plug-in handler does when there is nothing to do.
+   */
+  void AddFunctions(granada::runner::Runner* runner){
+    const std::string names[] = {entity_keys::plugin_script_function_send_message, entity_keys::plugin_script_function_set_value,
+                                 entity_keys::plugin_script_function_get_value, entity_keys::plugin_script_function_destroy_value,
+                                 entity_keys::plugin_script_function_clear_values, entity_keys::plugin_script_function_fire,
+                                 entity_keys::plugin_script_function_run_plugin, entity_keys::plugin_script_function_remove,
+                                 entity_keys::plugin_script_function_remove_events};
+    for (const std::string& name : names){
+      runner->functions()->Add(name, [](const web::json::value& parameters){
+        web::json::value response = web::json::value::object();
+        response[entity_keys::plugin_parameter_data] = web::json::value::object();
+        return response;
+      });
+    }
+  }
+
+
+  /**
+   * Runs the scripts with the given runner.
+   */
+  void Benchmark(const std::string& runner_name, granada::runner::Runner* runner, const std::vector<std::pair<std::string,std::string>>& scripts, const long iterations){
+    AddFunctions(runner);
+    granada::benchmark::Run(runner_name + " (empty script)", 1, iterations, [&](int thread, long i){
+      return runner->Run("\"{}\"").size();
+    });
+    for (auto it = scripts.begin(); it != scripts.end(); ++it){
+      const std::string& script = it->second;
+      granada::benchmark::Run(runner_name + " " + it->first, 1, iterations, [&](int thread, long i){
+        return runner->Run(script).size();
+      });
+    }
+  }
+
+
+  JSClass global_class = {"global", JSCLASS_GLOBAL_FLAGS, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr};
+
+
+  /**
+   * Bytes of the garbage collected heap of a SpiderMonkey runtime
+   * with a context and a global object with the standard classes,
+   * as created by SpiderMonkeyJavascriptRunner::Run.
+   */
+  std::size_t SpiderMonkeyContextBytes(){
+    std::size_t bytes = 0;
+    JSRuntime* rt = JS_NewRuntime(default_numbers::runner_spidermonkey_runtime_maxbytes);
+    JSContext* cx = JS_NewContext(rt, default_numbers::runner_spidermonkey_context_stackchunksize);
+    JS_BeginRequest(cx);
+    {
+      JS::RootedObject global(cx, JS_NewGlobalObject(cx, &global_class, nullptr, JS::FireOnNewGlobalHook));
+      JSAutoCompartment ac(cx, global);
+      JS_InitStandardClasses(cx, global);
+      bytes = JS_GetGCParameter(rt, JSGC_BYTES);
+    }
+    JS_EndRequest(cx);
+    JS_DestroyContext(cx);
+    JS_DestroyRuntime(rt);
+    return bytes;
+  }
+
+
+#ifdef GRANADA_QUICKJS
+  /**
+   * Bytes allocated by a QuickJS context, as created
+   * by QuickJSJavascriptRunner::Run.
+   */
+  std::size_t QuickJSContextBytes(){
+    JSRuntime* rt = granada::runner::QuickJSJavascriptRunner::runtime();
+    JSMemoryUsage before;
+    JSMemoryUsage after;
+    JS_ComputeMemoryUsage(rt, &before);
+    JSContext* cx = JS_NewContext(rt);
+    JS_ComputeMemoryUsage(rt, &after);
+    JS_FreeContext(cx);
+    return after.malloc_size - before.malloc_size;
+  }
+#endif
+
+}
+
+
+int main(int argc, char* argv[]){
+  const long iterations = granada::benchmark::Argument(argc, argv, 1, 2000);
+  const std::string plugins_directory = argc > 2 ? argv[2] : GRANADA_PLUGIN_SERVER_PLUGINS_DIR;
+
+  std::vector<std::pair<std::string,std::string>> scripts;
+  scripts.push_back(std::make_pair("math.sum", PluginScript("math.sum", ReadFile(plugins_directory + "/math/server/sum.js"), "{\"addend1\":2,\"addend2\":3}")));
+  scripts.push_back(std::make_pair("math.square", PluginScript("math.square", ReadFile(plugins_directory + "/math/server/square.js"), "{\"number\":7}")));
+  scripts.push_back(std::make_pair("math.multiplication", PluginScript("math.multiplication", ReadFile(plugins_directory + "/math/server/multiplication.js"), "{\"factor1\":6,\"factor2\":7}")));
+
+  granada::benchmark::PrintHeader();
+
+  granada::runner::SpiderMonkeyJavascriptRunner spidermonkey;
+  Benchmark(default_strings::runner_spidermonkey, &spidermonkey, scripts, iterations);
+
+#ifdef GRANADA_QUICKJS
+  granada::runner::QuickJSJavascriptRunner quickjs;
+  Benchmark(default_strings::runner_quickjs, &quickjs, scripts, iterations);
+#endif
+
+  granada::benchmark::PrintFooter();
+
+  std::cout << "\nmemory per context\n";
+  std::cout << default_strings::runner_spidermonkey << "\t" << SpiderMonkeyContextBytes() << " bytes\n";
+#ifdef GRANADA_QUICKJS
+  std::cout << default_strings::runner_quickjs << "\t" << QuickJSContextBytes() << " bytes\n";
+#endif
+
+  return 0;
+}
@@ -0,0 +1,90 @@
+/**
+  * Copyright (c) <2016> Web App SDK granada <afernandez@cookinapps.io>
+  *
+  * This source code is licensed under the MIT license.
+  *
+  * Permission is hereby granted, free of charge, to any person obtaining a copy
+  * of this software and associated documentation files (the "Software"), to deal
+  * in the Software without restriction, including without limitation the rights
+  * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  * copies of the Software, and to permit persons to whom the Software is
+  * furnished to do so, subject to the following conditions:
+  *
+  * The above copyright notice and this permission notice shall be included in
+  * all copies or substantial portions of the Software.
+  *
+  * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  * SOFTWARE.
+  *
+  * Microbenchmark of the JSON read paths: event loaders and plug-in
+  * headers read from the cache, parsed into a web::json::value and
+  * into a granada::util::json::document.
+  *
+  * Usage: json_benchmark [iterations]
+  */
+#include <string>
+#include "granada/util/string.h"
+#include "granada/util/json_document.h"
+#include "../benchmark.h"
+
+
+int main(int argc, char* argv[]){
+  const long iterations = granada::benchmark::Argument(argc, argv, 1, 100000);
+
+  const std::string header = "{\"id\":\"product.tax\",\"events\":[\"calculate-tax\",\"save-product-before\"],\"extends\":[\"math.multiplication\"],\"order\":10}";
+
+  // event loaders of 16 plug-ins, like the ones stored by PluginHandler::AddLoadEvent.
+  std::string event_loaders = "{";
+  for (int i = 0; i < 16; ++i){
+    if (i > 0){
+      event_loaders += ",";
+    }
+    event_loaders += "\"plugin." + std::to_string(i) + "\":{\"header\":\"/plugins/plugin" + std::to_string(i) + "/header.json\",\"script\":\"/plugins/plugin" + std::to_string(i) + "/script.js\"}";
+  }
+  event_loaders += "}";
+
+  granada::benchmark::PrintHeader();
+
+  granada::benchmark::Run("to_json (header)", 1, iterations, [&](int thread, long i){
+    return granada::util::string::to_json(header).size();
+  });
+
+  granada::benchmark::Run("json::parse (header)", 1, iterations, [&](int thread, long i){
+    return granada::util::json::parse(header).size();
+  });
+
+  granada::benchmark::Run("to_json (event loaders keys)", 1, iterations, [&](int thread, long i){
+    std::size_t size = 0;
+    const web::json::value& json = granada::util::string::to_json(event_loaders);
+    for (auto it = json.as_object().cbegin(); it != json.as_object().cend(); ++it){
+      size += utility::conversions::to_utf8string(it->first).size();
+    }
+    return size;
+  });
+
+  granada::benchmark::Run("json::document (event loaders keys)", 1, iterations, [&](int thread, long i){
+    std::size_t size = 0;
+    const granada::util::json::document doc(event_loaders);
+    for (auto it = doc.root().begin(); it != doc.root().end(); ++it){
+      size += it.key().as_string().size();
+    }
+    return size;
+  });
+
+  granada::benchmark::Run("to_json (empty)", 1, iterations, [&](int thread, long i){
+    return granada::util::string::to_json("").size();
+  });
+
+  granada::benchmark::Run("json::document (empty)", 1, iterations, [&](int thread, long i){
+    return (std::size_t)granada::util::json::document("").valid();
+  });
+
+  granada::benchmark::PrintFooter();
+
+  return 0;
+}
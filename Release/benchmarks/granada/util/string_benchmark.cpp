@@ -0,0 +1,82 @@
+/**
+  * Copyright (c) <2016> Web App SDK granada <afernandez@cookinapps.io>
+  *
+  * This source code is licensed under the MIT license.
+  *
+  * Permission is hereby granted, free of charge, to any person obtaining a copy
+  * of this software and associated documentation files (the "Software"), to deal
+  * in the Software without restriction, including without limitation the rights
+  * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  * copies of the Software, and to permit persons to whom the Software is
+  * furnished to do so, subject to the following conditions:
+  *
+  * The above copyright notice and this permission notice shall be included in
+  * all copies or substantial portions of the Software.
+  *
+  * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  * SOFTWARE.
+  *
+  * Microbenchmark of the string utilities: split of query strings, into
+  * strings and into views, and replacement of the tags of an HTML template,
+  * with one tag and with a map of values.
+  *
+  * Usage: string_benchmark [iterations]
+  */
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include "granada/util/string.h"
+#include "../benchmark.h"
+
+
+int main(int argc, char* argv[]){
+  const long iterations = granada::benchmark::Argument(argc, argv, 1, 200000);
+
+  const std::string query_string = "response_type=code&client_id=myfNv849Z1GNuPAN&redirect_uri=http%3A%2F%2Flocalhost%3A80%2Fclient&scope=msg.select&state=Zv9ocCjGYS5Cz8As";
+
+  // template with 8 tags, like the ones of the samples.
+  std::string html;
+  std::unordered_map<std::string,std::string> values;
+  for (int i = 0; i < 8; ++i){
+    const std::string name = "tag" + std::to_string(i);
+    html += "<div class=\"row\"><span>{{" + name + "}}</span><p>Lorem ipsum dolor sit amet, consectetur adipiscing elit.</p></div>\n";
+    values.insert(std::make_pair(name, "value of " + name));
+  }
+
+  granada::benchmark::PrintHeader();
+
+  granada::benchmark::Run("string::split", 1, iterations, [&](int thread, long i){
+    std::vector<std::string> elems;
+    granada::util::string::split(query_string, '&', elems);
+    return elems.size();
+  });
+
+  granada::benchmark::Run("string::splitter", 1, iterations, [&](int thread, long i){
+    std::size_t size = 0;
+    for (const granada::util::string::view& part : granada::util::string::splitter(query_string, '&')){
+      size += part.size();
+    }
+    return size;
+  });
+
+  granada::benchmark::Run("string::replace (one tag)", 1, iterations, [&](int thread, long i){
+    std::string content = html;
+    granada::util::string::replace(content, "{{tag3}}", "value of tag3");
+    return content.size();
+  });
+
+  granada::benchmark::Run("string::replace (map of 8 tags)", 1, iterations, [&](int thread, long i){
+    std::string content = html;
+    granada::util::string::replace(content, values);
+    return content.size();
+  });
+
+  granada::benchmark::PrintFooter();
+
+  return 0;
+}
@@ -26,6 +26,7 @@
   *
   */
 #pragma once
+#include <map>
 #include <memory>
 #include <mutex>
 #include <string>
@@ -200,6 +201,42 @@ namespace granada{
         };
 
 
+        /**
+         * Fills a vector of strings with the keys of the key-value pairs
+         * stored in a set with the given name.
+         *
+         * @param hash    Name of the set.
+         * @param fields  Vector of strings that should be filled with the keys
+         *                of the set.
+         *                  Example:
+         *                      hash: oauth2.authorization.index:johndoe
+         *                      fields: gida8fZEFh9abpkg, L05l6pFaPFgZbtP9
+         */
+        virtual void Fields(const std::string& hash, std::vector<std::string>& fields) = 0;
+
+
+        /**
+         * Fills a map with all the key-value pairs stored in a set
+         * with the given name. Drivers should override it to retrieve
+         * all the pairs at once instead of reading them one by one.
+         *
+         * @param hash    Name of the set.
+         * @param values  Map that should be filled with the key-value pairs
+         *                of the set.
+         *                  Example:
+         *                      hash: oauth2.authorization.tokens.index:myfNv849Z1GNuPAN:johndoe
+         *                      values: { L05l6pFaPFgZbtP9 => gida8fZEFh9abpkg }
+         */
+        virtual void ReadAll(const std::string& hash, std::map<std::string,std::string>& values){
+          values.clear();
+          std::vector<std::string> fields;
+          Fields(hash,fields);
+          for (auto it = fields.begin(); it != fields.end(); ++it){
+            values[*it] = Read(hash,*it);
+          }
+        };
+
+
         /**
          * Sets a value in the cache associated with a given key.
          * @param key   Key of the value.
@@ -225,6 +262,19 @@ namespace granada{
         virtual void Destroy(const std::string& key) = 0;
 
 
+        /**
+         * Removes several key-value pairs or sets from the cache. Keys
+         * are taken literally, no expression is matched. Drivers should
+         * override it to remove the keys in as few operations as possible.
+         * @param keys  Keys to remove.
+         */
+        virtual void Destroy(const std::vector<std::string>& keys){
+          for (auto it = keys.begin(); it != keys.end(); ++it){
+            Destroy(*it);
+          }
+        };
+
+
         /**
          * Destroys a key-value pair stored in a set.
          * @param hash Name of the set where the key-value pair is stored.
@@ -246,6 +296,20 @@ namespace granada{
         virtual bool Rename(const std::string& old_key, const std::string& new_key) = 0;
 
 
+        /**
+         * Returns the part of the keys identifying a group of keys that
+         * must be stored in the same server, for example the keys of a session.
+         * Drivers spreading the keys over several servers wrap it in a hash
+         * tag, the others return it as it is, so the keys do not change
+         * until the keys are spread.
+         * @param  id Identifier of the group, example: a session token.
+         * @return    Identifier to use in the keys, example: cc9sKWG6 or {cc9sKWG6}
+         */
+        virtual const std::string Tag(const std::string& id){
+          return id;
+        };
+
+
         /**
          * Returns an iterator to iterate over keys with an expression.
          */
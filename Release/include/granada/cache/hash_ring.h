@@ -0,0 +1,211 @@
+/**
+  * Copyright (c) <2016> granada <afernandez@cookinapps.io>
+  *
+  * This source code is licensed under the MIT license.
+  *
+  * Permission is hereby granted, free of charge, to any person obtaining a copy
+  * of this software and associated documentation files (the "Software"), to deal
+  * in the Software without restriction, including without limitation the rights
+  * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  * copies of the Software, and to permit persons to whom the Software is
+  * furnished to do so, subject to the following conditions:
+  *
+  * The above copyright notice and this permission notice shall be included in
+  * all copies or substantial portions of the Software.
+  *
+  * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  * SOFTWARE.
+  *
+  * Consistent hash ring used to distribute cache keys over several nodes.
+  *
+  */
+
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace granada{
+  namespace cache{
+
+    /**
+     * Consistent hash ring, maps keys to nodes so that adding or removing
+     * a node only moves the keys of that node. Each node is placed in the
+     * ring several times (virtual nodes) to spread the keys evenly.
+     *
+     * Keys are routed by their hash tag, the part between the first "{"
+     * and the next "}" as in Redis Cluster, so keys that are used together
+     * are stored in the same node. Keys without a hash tag are routed by
+     * the whole key.
+     *
+     * Example:
+     *    HashRing ring;
+     *    ring.Add("127.0.0.1:6379", 160);
+     *    ring.Add("127.0.0.1:6380", 160);
+     *    ring.Node("session:value:{cc9sKWG6}") == ring.Node("session:roles:{cc9sKWG6}:user");
+     *
+     * The ring must not be modified while other threads use it.
+     */
+    class HashRing{
+
+      public:
+
+        /**
+         * Constructor
+         */
+        HashRing(){};
+
+
+        /**
+         * Destructor
+         */
+        virtual ~HashRing(){};
+
+
+        /**
+         * Adds a node to the ring.
+         * @param name          Unique name of the node, for example "127.0.0.1:6379".
+         *                      The positions of the node in the ring only depend on it.
+         * @param virtual_nodes Number of times the node is placed in the ring.
+         * @return              Index of the node, nodes are numbered in the order
+         *                      they are added starting from 0.
+         */
+        std::size_t Add(const std::string& name, const int virtual_nodes){
+          const std::size_t index = size_++;
+          const int points = virtual_nodes < 1 ? 1 : virtual_nodes;
+          for (int i = 0; i < points; ++i){
+            ring_.push_back(std::make_pair(Hash(name + "#" + std::to_string(i)), index));
+          }
+          std::sort(ring_.begin(), ring_.end());
+          return index;
+        };
+
+
+        /**
+         * Returns the number of nodes in the ring.
+         * @return Number of nodes.
+         */
+        std::size_t size() const{
+          return size_;
+        };
+
+
+        /**
+         * Returns the index of the node a key belongs to, 0 if
+         * the ring is empty.
+         * @param  key Key.
+         * @return     Index of the node.
+         */
+        std::size_t Node(const std::string& key) const{
+          if (ring_.empty()){
+            return 0;
+          }
+          const uint64_t hash = Hash(Tag(key));
+          auto it = std::lower_bound(ring_.begin(), ring_.end(), std::make_pair(hash, (std::size_t)0));
+          if (it == ring_.end()){
+            it = ring_.begin();
+          }
+          return it->second;
+        };
+
+
+        /**
+         * Returns the index of the node all the keys matching an expression
+         * belong to. This is only possible when the expression has a hash tag
+         * without wildcards.
+         * @param  expression Expression, wildcards are "*", "?" and "[".
+         *                      Example:
+         *                          session:roles:{cc9sKWG6}:*
+         * @param  node       Index of the node, set only if true is returned.
+         * @return            True if all the keys are in the same node, false if
+         *                    they can be in any node.
+         */
+        bool Node(const std::string& expression, std::size_t& node) const{
+          std::string tag;
+          if (!HashTag(expression, tag) || tag.find_first_of("*?[\\") != std::string::npos){
+            return false;
+          }
+          node = Node(expression);
+          return true;
+        };
+
+
+        /**
+         * Returns the hash tag of a key, or the whole key if it has none.
+         * @param  key Key.
+         * @return     Part of the key used for routing.
+         */
+        static std::string Tag(const std::string& key){
+          std::string tag;
+          if (HashTag(key, tag)){
+            return tag;
+          }
+          return key;
+        };
+
+
+        /**
+         * Extracts the hash tag of a key: the content of the first "{" and
+         * the next "}", empty tags like in "{}" are ignored.
+         * @param  key Key.
+         * @param  tag Hash tag, set only if true is returned.
+         * @return     True if the key has a hash tag.
+         */
+        static bool HashTag(const std::string& key, std::string& tag){
+          const std::size_t open = key.find('{');
+          if (open != std::string::npos){
+            const std::size_t close = key.find('}', open + 1);
+            if (close != std::string::npos && close > open + 1){
+              tag.assign(key, open + 1, close - open - 1);
+              return true;
+            }
+          }
+          return false;
+        };
+
+
+        /**
+         * 64 bits FNV-1a hash followed by a finalizer mixing
+         * the bits so that similar strings are far in the ring.
+         * @param  value String to hash.
+         * @return       Hash.
+         */
+        static uint64_t Hash(const std::string& value){
+          uint64_t hash = 14695981039346656037ULL;
+          for (auto it = value.begin(); it != value.end(); ++it){
+            hash ^= (unsigned char)*it;
+            hash *= 1099511628211ULL;
+          }
+          hash ^= hash >> 33;
+          hash *= 0xff51afd7ed558ccdULL;
+          hash ^= hash >> 33;
+          hash *= 0xc4ceb9fe1a85ec53ULL;
+          hash ^= hash >> 33;
+          return hash;
+        };
+
+
+      private:
+
+        /**
+         * Positions in the ring and the index of the node
+         * they belong to, sorted by position.
+         */
+        std::vector<std::pair<uint64_t,std::size_t>> ring_;
+
+
+        /**
+         * Number of nodes.
+         */
+        std::size_t size_ = 0;
+
+    };
+  }
+}
@@ -0,0 +1,253 @@
+/**
+  * Copyright (c) <2016> granada <afernandez@cookinapps.io>
+  *
+  * This source code is licensed under the MIT license.
+  *
+  * Permission is hereby granted, free of charge, to any person obtaining a copy
+  * of this software and associated documentation files (the "Software"), to deal
+  * in the Software without restriction, including without limitation the rights
+  * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  * copies of the Software, and to permit persons to whom the Software is
+  * furnished to do so, subject to the following conditions:
+  *
+  * The above copyright notice and this permission notice shall be included in
+  * all copies or substantial portions of the Software.
+  *
+  * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  * SOFTWARE.
+  *
+  * Process-local cache of already decoded records, each record expires
+  * after a given number of seconds. Used to avoid reading the same
+  * rarely modified values again and again from a remote cache.
+  * This code is multi-thread safe.
+  *
+  */
+
+#pragma once
+#include <string>
+#include <mutex>
+#include <chrono>
+#include <unordered_map>
+
+namespace granada{
+  namespace cache{
+
+    /**
+     * Process-local cache of decoded records with a time to live.
+     * Records are identified by a string key, usually the key of the
+     * record in the CacheHandler it has been read from.
+     *
+     * Example:
+     *    LocalRecordCache<OAuth2ClientRecord> records;
+     *    records.set_ttl(60);
+     *    records.Write("oauth2.client:value:myfNv849Z1GNuPAN", record);
+     *    if (records.Read("oauth2.client:value:myfNv849Z1GNuPAN", record)){ ... }
+     *
+     * This code is multi-thread safe.
+     */
+    template <typename T>
+    class LocalRecordCache{
+
+      public:
+
+        /**
+         * Constructor
+         */
+        LocalRecordCache(){};
+
+
+        /**
+         * Destructor
+         */
+        virtual ~LocalRecordCache(){};
+
+
+        /**
+         * Sets the number of seconds a record is kept. If the ttl
+         * is 0 or less records are not cached at all.
+         * @param ttl Time to live of the records in seconds.
+         */
+        void set_ttl(const long ttl){
+          std::lock_guard<std::mutex> lg(mtx_);
+          ttl_ = ttl;
+          if (ttl_ < 1){
+            records_.clear();
+          }
+        };
+
+
+        /**
+         * Sets the maximum number of records kept, when the limit is
+         * reached expired records are removed, and if there are none
+         * all records are.
+         * @param max_size Maximum number of records.
+         */
+        void set_max_size(const std::size_t max_size){
+          std::lock_guard<std::mutex> lg(mtx_);
+          max_size_ = max_size;
+        };
+
+
+        /**
+         * Copies the record associated with the given key if it exists
+         * and it has not expired.
+         * @param  key    Key of the record.
+         * @param  record Record to fill.
+         * @return        True if the record was found, false if it was not.
+         */
+        bool Read(const std::string& key, T& record){
+          std::lock_guard<std::mutex> lg(mtx_);
+          auto it = records_.find(key);
+          if (it != records_.end()){
+            if (std::chrono::steady_clock::now() < it->second.expiration){
+              record = it->second.record;
+              return true;
+            }
+            records_.erase(it);
+          }
+          return false;
+        };
+
+
+        /**
+         * Inserts or replaces the record associated with the given key.
+         * @param key    Key of the record.
+         * @param record Record.
+         */
+        void Write(const std::string& key, const T& record){
+          std::lock_guard<std::mutex> lg(mtx_);
+          Insert(key, record, ttl_);
+        };
+
+
+        /**
+         * Inserts or replaces the record associated with the given key,
+         * with its own time to live instead of the one set with set_ttl.
+         * @param key    Key of the record.
+         * @param record Record.
+         * @param ttl    Time to live of the record in seconds, if it is
+         *               0 or less the record is not cached.
+         */
+        void Write(const std::string& key, const T& record, const long ttl){
+          std::lock_guard<std::mutex> lg(mtx_);
+          Insert(key, record, ttl);
+        };
+
+
+        /**
+         * Removes the record associated with the given key, used
+         * to invalidate the record when it is modified or deleted.
+         * @param key Key of the record.
+         */
+        void Destroy(const std::string& key){
+          std::lock_guard<std::mutex> lg(mtx_);
+          records_.erase(key);
+        };
+
+
+        /**
+         * Removes the records whose key starts with the given prefix,
+         * used to invalidate a whole family of records at once.
+         * @param prefix Prefix of the keys of the records.
+         */
+        void DestroyPrefix(const std::string& prefix){
+          std::lock_guard<std::mutex> lg(mtx_);
+          for (auto it = records_.begin(); it != records_.end();){
+            if (it->first.compare(0, prefix.size(), prefix) == 0){
+              it = records_.erase(it);
+            }else{
+              ++it;
+            }
+          }
+        };
+
+
+        /**
+         * Removes all the records.
+         */
+        void Clear(){
+          std::lock_guard<std::mutex> lg(mtx_);
+          records_.clear();
+        };
+
+
+      private:
+
+        /**
+         * Record and the time it expires.
+         */
+        struct Entry{
+          T record;
+          std::chrono::steady_clock::time_point expiration;
+        };
+
+
+        /**
+         * Records by key.
+         */
+        std::unordered_map<std::string,Entry> records_;
+
+
+        /**
+         * Time to live of the records in seconds.
+         */
+        long ttl_ = 0;
+
+
+        /**
+         * Maximum number of records kept.
+         */
+        std::size_t max_size_ = 10000;
+
+
+        /**
+         * Mutex for thread safety.
+         */
+        std::mutex mtx_;
+
+
+        /**
+         * Inserts or replaces a record. Must be called with the mutex locked.
+         * @param key    Key of the record.
+         * @param record Record.
+         * @param ttl    Time to live of the record in seconds.
+         */
+        void Insert(const std::string& key, const T& record, const long ttl){
+          if (ttl > 0){
+            const std::chrono::steady_clock::time_point& now = std::chrono::steady_clock::now();
+            if (records_.size() >= max_size_ && records_.find(key) == records_.end()){
+              Purge(now);
+            }
+            Entry& entry = records_[key];
+            entry.record = record;
+            entry.expiration = now + std::chrono::seconds(ttl);
+          }
+        };
+
+
+        /**
+         * Removes the expired records, if there are none removes all
+         * the records. Must be called with the mutex locked.
+         * @param now Current time.
+         */
+        void Purge(const std::chrono::steady_clock::time_point& now){
+          for (auto it = records_.begin(); it != records_.end();){
+            if (it->second.expiration <= now){
+              it = records_.erase(it);
+            }else{
+              ++it;
+            }
+          }
+          if (records_.size() >= max_size_){
+            records_.clear();
+          }
+        };
+
+    };
+  }
+}
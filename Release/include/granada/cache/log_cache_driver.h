@@ -0,0 +1,281 @@
+/**
+  * Copyright (c) <2016> granada <afernandez@cookinapps.io>
+  *
+  * This source code is licensed under the MIT license.
+  *
+  * Permission is hereby granted, free of charge, to any person obtaining a copy
+  * of this software and associated documentation files (the "Software"), to deal
+  * in the Software without restriction, including without limitation the rights
+  * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  * copies of the Software, and to permit persons to whom the Software is
+  * furnished to do so, subject to the following conditions:
+  *
+  * The above copyright notice and this permission notice shall be included in
+  * all copies or substantial portions of the Software.
+  *
+  * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  * SOFTWARE.
+  *
+  * Manages the cache storing key-value pairs in an unordered map, like
+  * SharedMapCacheDriver, and persists every modification in an append-only
+  * log file, so the data survives restarts.
+  *
+  * This code is multi-thread safe.
+  *
+  */
+
+#pragma once
+#include <cstdio>
+#include <cstdint>
+#include <ctime>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "granada/defaults.h"
+#include "granada/util/mutex.h"
+#include "granada/util/application.h"
+#include "shared_map_cache_driver.h"
+
+namespace granada{
+  namespace cache{
+
+    /**
+     * Manages the cache storing key-value pairs in an unordered map,
+     * every modification is also appended to a log file. When the driver
+     * is created the log is replayed to rebuild the map.
+     *
+     * Each record of the log has its length and a CRC-32 checksum, if the
+     * application crashed while writing a record the incomplete or corrupted
+     * tail is discarded when the log is replayed.
+     *
+     * Records are written to the operating system after each modification
+     * so they are not lost if the application crashes, and flushed to the disk
+     * every "log_cache_driver_fsync_frequency" seconds.
+     *
+     * When the log has at least "log_cache_driver_compaction_min_records" records
+     * and twice the records needed to store the current data, it is rewritten
+     * with the current data only.
+     *
+     * Reads do not touch the file and are as fast as in SharedMapCacheDriver.
+     * Each log file must be used by only one driver at a time.
+     *
+     * Example:
+     *    granada::cache::LogCacheDriver cache("/var/lib/myapp/sessions.log");
+     *
+     * This code is multi-thread safe.
+     */
+    class LogCacheDriver : public SharedMapCacheDriver
+    {
+      public:
+
+        /**
+         * Constructor. Replays the log file, creating it if it does not exist.
+         * @param file_path Path of the log file.
+         */
+        LogCacheDriver(const std::string& file_path);
+
+
+        /**
+         * Destructor. Flushes the log to the disk and closes it.
+         */
+        virtual ~LogCacheDriver();
+
+
+        /**
+         * Set a value in the cache associated with a given key.
+         * @param key   Key of the value.
+         * @param value Value.
+         */
+        virtual void Write(const std::string& key,const std::string& value) override;
+
+
+        /**
+         * Inserts or rewrite a key-value pair in a map with the given name.
+         * If the set does not exist, it creates it.
+         * @param  hash Name of the map.
+         * @param  key  Key to identify the value.
+         * @param       Value.
+         */
+        virtual void Write(const std::string& hash,const std::string& key,const std::string& value) override;
+
+
+        /**
+         * Destroys a set of key-value pairs with the given name.
+         * @param key Name of the unordered map containing the key-value pairs,
+         *            if it contains "*" all the maps matching it are destroyed.
+         */
+        virtual void Destroy(const std::string& key) override;
+
+
+        /**
+         * Destroys several sets of key-value pairs, appending
+         * all the records to the log in one write.
+         * @param keys Names of the unordered maps to destroy.
+         */
+        virtual void Destroy(const std::vector<std::string>& keys) override;
+
+
+        /**
+         * Destroys a key value pair of a given set.
+         * @param hash Name of the unordered map containing the key-value pair to destroy.
+         * @param key  Key associated with the value to destroy.
+         */
+        virtual void Destroy(const std::string& hash,const std::string& key) override;
+
+
+        /**
+         * Renames a key if it does not already exists.
+         *
+         * @param old_key Old key to rename.
+         * @param new_key New key.
+         *
+         * @return        True if the key could be renamed, false if not.
+         */
+        virtual bool Rename(const std::string& old_key, const std::string& new_key) override;
+
+
+        /**
+         * Rewrites the log with only the records needed to store
+         * the current data.
+         */
+        void Compact();
+
+
+        /**
+         * Returns the path of the log file with the given name, in the directory
+         * given by the "log_cache_driver_directory" property, or in the application
+         * directory if the property is not found. Relative directories are taken
+         * from the application directory.
+         *
+         * Example: FilePath("session") => /path/to/application/directory/session.log
+         *
+         * @param  name Name of the log, without extension.
+         * @return      Path of the log file.
+         */
+        static std::string FilePath(const std::string& name);
+
+
+      protected:
+
+        /**
+         * Types of the log records.
+         */
+        enum Operation : unsigned char {WRITE = 1, WRITE_HASH = 2, DESTROY = 3, DESTROY_HASH = 4, RENAME = 5};
+
+
+        /**
+         * Path of the log file.
+         */
+        std::string file_path_;
+
+
+        /**
+         * Log file, opened for appending.
+         */
+        std::FILE* file_ = nullptr;
+
+
+        /**
+         * Records in the log file.
+         */
+        std::size_t records_ = 0;
+
+
+        /**
+         * Records needed to store the data after the last compaction
+         * or replay, the log is compacted when there are twice as many.
+         */
+        std::size_t compacted_records_ = 0;
+
+
+        /**
+         * Time the log was last flushed to the disk.
+         */
+        std::time_t last_fsync_ = 0;
+
+
+        /**
+         * Mutex ensuring modifications are appended to
+         * the log in the same order they are applied.
+         */
+        std::mutex log_mtx_;
+
+
+        /**
+         * Used for loading the properties only once.
+         */
+        static granada::util::mutex::call_once load_properties_call_once_;
+
+
+        /**
+         * Seconds between two flushes of the log to the disk, 0 to flush after
+         * every modification, -1 to let the operating system decide.
+         * Loaded in LoadProperties() function, will take the value of the
+         * "log_cache_driver_fsync_frequency" property. If the property is not
+         * provided default_numbers::log_cache_driver_fsync_frequency will be taken instead.
+         */
+        static int fsync_frequency_;
+
+
+        /**
+         * Minimum number of records the log must have to be compacted.
+         * Loaded in LoadProperties() function, will take the value of the
+         * "log_cache_driver_compaction_min_records" property. If the property is not
+         * provided default_numbers::log_cache_driver_compaction_min_records will be taken instead.
+         */
+        static int compaction_min_records_;
+
+
+        /**
+         * Loads the properties.
+         */
+        virtual void LoadProperties();
+
+
+        /**
+         * Replays the log file filling the map. If the end of the
+         * log is corrupted the log is compacted to discard it.
+         */
+        void Replay();
+
+
+        /**
+         * Adds a record to a buffer.
+         * @param buffer    Buffer.
+         * @param operation Type of record.
+         * @param values    Keys and values of the record.
+         */
+        static void Encode(std::string& buffer, const Operation operation, const std::vector<const std::string*>& values);
+
+
+        /**
+         * Appends records to the log, flushes it to the disk if it is time to,
+         * and compacts it if it has too many records. Must be called with
+         * log_mtx_ locked.
+         * @param buffer  Encoded records.
+         * @param records Number of records.
+         */
+        void Append(const std::string& buffer, const std::size_t records);
+
+
+        /**
+         * Writes the current data to the given file.
+         * @param  file File opened for writing.
+         * @return      Number of records written.
+         */
+        std::size_t Dump(std::FILE* file);
+
+
+        /**
+         * Compacts the log. Must be called with log_mtx_ locked.
+         */
+        void CompactLog();
+
+    };
+  }
+}
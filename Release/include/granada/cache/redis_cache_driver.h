@@ -22,18 +22,25 @@
   * SOFTWARE.
   *
   * Manages the cache storing key-value pairs or sets of key-value pairs using redis
-  * data structure server (http://redis.io/).
+  * data structure server (http://redis.io/), in one redis server or sharded
+  * over several servers.
   * It uses redisclient by Alex Nekipelov https://github.com/nekipelov/redisclient
   * This code is multi-thread safe.
   *
   */
 #pragma once
 
+#include <algorithm>
+#include <deque>
 #include <string>
+#include <vector>
 #include "granada/defaults.h"
 #include "granada/util/mutex.h"
+#include "granada/util/string.h"
 #include "granada/util/application.h"
+#include "granada/util/tracing.h"
 #include "cache_handler.h"
+#include "hash_ring.h"
 #include "redisclient/redissyncclient.h"
 
 
@@ -45,7 +52,17 @@ namespace granada{
 
     /**
      * Redis Sync client wrapper to ensure multithread safety by
-     * having only one Redis client per application.
+     * having only one Redis client per redis server and application.
+     *
+     * If the "redis_cache_driver_nodes" property lists several servers
+     * the keys are sharded over them with a consistent hash ring, keys
+     * with the same hash tag, the part of the key between "{" and "}",
+     * are stored in the same server:
+     *
+     *    redis_cache_driver_nodes=127.0.0.1:7001,127.0.0.1:7002,127.0.0.1:7003
+     *
+     * Each server has its own client and mutex, so commands to
+     * different servers do not wait for each other.
      */
     class RedisSyncClientWrapper{
 
@@ -58,16 +75,92 @@ namespace granada{
 
 
         /**
-         * Returns redis sync client pointer.
+         * Returns redis sync client pointer of the first server.
          * @return Redis sync client Pointer.
          */
         redisclient::RedisSyncClient* get(){
-          return redis_.get();
+          return nodes_.front()->redis.get();
+        };
+
+
+        /**
+         * Returns the addresses and ports of the redis servers.
+         * @return Addresses and ports of the redis servers.
+         */
+        static const std::vector<std::pair<std::string,unsigned short>>& servers();
+
+
+        /**
+         * Returns the number of redis servers.
+         * @return Number of redis servers.
+         */
+        std::size_t size(){
+          return nodes_.size();
+        };
+
+
+        /**
+         * Returns the index of the redis server where a key is stored.
+         * @param  key Key.
+         * @return     Index of the redis server.
+         */
+        std::size_t node(const std::string& key){
+          return ring_.Node(key);
+        };
+
+
+        /**
+         * Returns the index of the redis server where all the keys
+         * matching an expression are stored, if there is only one.
+         * @param  expression Expression, example: session:roles:{cc9sKWG6}:*
+         * @param  node       Index of the redis server, set only if true is returned.
+         * @return            True if all the keys matching the expression are
+         *                    stored in the same redis server.
+         */
+        bool node(const std::string& expression, std::size_t& node){
+          return ring_.Node(expression, node);
+        };
+
+
+        /**
+         * Sends a command to the redis server with the given index.
+         * @param  node Index of the redis server.
+         * @param  cmd  Command, example: HGET.
+         * @param  args Arguments of the command.
+         * @return      Result of the command.
+         */
+        redisclient::RedisValue command(const std::size_t node, const std::string& cmd, std::deque<redisclient::RedisBuffer> args){
+          granada::util::tracing::Span span("cache.redis.command");
+          Node* redis_node = nodes_.at(node).get();
+          std::lock_guard<std::mutex> lg(redis_node->mtx);
+          return redis_node->redis->command(cmd, args);
+        };
+
+
+        /**
+         * Sends a command to the redis server where the given key is stored.
+         * @param  key  Key used for choosing the redis server.
+         * @param  cmd  Command, example: HGET.
+         * @param  args Arguments of the command.
+         * @return      Result of the command.
+         */
+        redisclient::RedisValue command(const std::string& key, const std::string& cmd, std::deque<redisclient::RedisBuffer> args){
+          return command(node(key), cmd, std::move(args));
         };
 
 
       private:
 
+        /**
+         * Connection to a redis server.
+         */
+        struct Node{
+          boost::asio::io_service io_service;
+          std::unique_ptr<redisclient::RedisSyncClient> redis;
+          std::mutex mtx;
+        };
+
+
         /**
          * Used for loading the properties only once.
          */
@@ -75,9 +168,15 @@ namespace granada{
 
 
         /**
-         * Redis sync client.
+         * Connections to the redis servers, in the order they are listed.
+         */
+        std::vector<std::unique_ptr<Node>> nodes_;
+
+
+        /**
+         * Consistent hash ring choosing the redis server of each key.
          */
-        std::unique_ptr<redisclient::RedisSyncClient> redis_;
+        granada::cache::HashRing ring_;
 
 
         /**
@@ -96,10 +195,27 @@ namespace granada{
         static unsigned short redis_port_;
 
 
+        /**
+         * Loaded in LoadProperties() function, addresses and ports of the redis
+         * servers listed in the "redis_cache_driver_nodes" property. If the property
+         * is not provided it only contains redis_address_ and redis_port_.
+         */
+        static std::vector<std::pair<std::string,unsigned short>> redis_nodes_;
+
+
+        /**
+         * Loaded in LoadProperties() function, number of times each redis server
+         * is placed in the hash ring, will take the value of the
+         * "redis_cache_driver_virtual_nodes" property. If the property is not provided
+         * default_numbers::redis_cache_driver_virtual_nodes will be taken instead.
+         */
+        static int redis_virtual_nodes_;
+
+
         /**
          * Load properties for configuring the redis server connection.
          */
-        void LoadProperties();
+        static void LoadProperties();
 
 
         /**
@@ -222,6 +338,18 @@ namespace granada{
         int index_ = 0;
 
 
+        /**
+         * Index of the redis server being searched.
+         */
+        std::size_t node_ = 0;
+
+
+        /**
+         * Index of the last redis server to search.
+         */
+        std::size_t last_node_ = 0;
+
+
         /**
          * If SCAN search the cursor of the SCAN set we are in.
          */
@@ -241,7 +369,8 @@ namespace granada{
 
 
         /**
-         * Get the next vector with data of SCAN or KEYS
+         * Get the next vector with data of SCAN or KEYS, moving to the
+         * next redis server when the current one has no more keys.
          */
         void GetNextVector();
     };
@@ -249,7 +378,8 @@ namespace granada{
 
     /**
      * Manages the cache storing key-value pairs or sets of key-value pairs using redis
-     * data structure server (http://redis.io/).
+     * data structure server (http://redis.io/). Keys may be sharded over several
+     * redis servers, see RedisSyncClientWrapper.
      * It uses redisclient by Alex Nekipelov https://github.com/nekipelov/redisclient
      * This code is multi-thread safe.
      */
@@ -302,6 +432,24 @@ namespace granada{
         virtual const std::string Read(const std::string& hash, const std::string& key);
 
 
+        /**
+         * Fills a vector with the keys of the key-value pairs stored
+         * in a set with the given name (HKEYS).
+         * @param hash    Name of the set.
+         * @param fields  Vector to fill with the keys of the set.
+         */
+        virtual void Fields(const std::string& hash, std::vector<std::string>& fields);
+
+
+        /**
+         * Fills a map with all the key-value pairs stored in a set
+         * with the given name in one round trip (HGETALL).
+         * @param hash    Name of the set.
+         * @param values  Map to fill with the key-value pairs.
+         */
+        virtual void ReadAll(const std::string& hash, std::map<std::string,std::string>& values);
+
+
         /**
          * Inserts a key-value pair, rewrites it if it already exists.
          * @param key   Key to identify the value.
@@ -323,10 +471,21 @@ namespace granada{
         /**
          * Destroys a key-value pair or a set of values.
          * @param key Key of the value or name of the set to destroy.
+         *            If it contains "*" all the keys matching it are destroyed.
          */
         virtual void Destroy(const std::string& key);
 
 
+        /**
+         * Destroys several key-value pairs or sets of values, sending
+         * the keys of each redis server in multi-key DEL commands of
+         * default_numbers::redis_cache_driver_batch_size keys each instead
+         * of one command per key.
+         * @param keys Keys of the values or names of the sets to destroy.
+         */
+        virtual void Destroy(const std::vector<std::string>& keys);
+
+
         /**
          * Destroys a key-value pair stored in a set.
          * @param hash Name of the set where the key-value pair is stored.
@@ -336,7 +495,9 @@ namespace granada{
 
 
         /**
-         * Renames a key if it does not already exists.
+         * Renames a key if it does not already exists. If the keys
+         * are stored in different redis servers the value is moved
+         * with DUMP and RESTORE.
          * 
          * @param old_key Old key to rename.
          * @param new_key New key.
@@ -348,10 +509,48 @@ namespace granada{
 
 
         /**
-         * Returns a RedisValue containing a group of keys of the
-         * cache that match a given expression for a given cursor,
+         * Wraps the identifier in a hash tag if "redis_cache_driver_nodes"
+         * lists more than one redis server.
+         * @param  id Identifier of the group, example: a session token.
+         * @return    Identifier to use in the keys, example: {cc9sKWG6}
+         */
+        virtual const std::string Tag(const std::string& id){
+          if (RedisSyncClientWrapper::servers().size() > 1){
+            return "{" + id + "}";
+          }
+          return id;
+        };
+
+
+        /**
+         * Returns the number of redis servers the keys are sharded over.
+         * @return Number of redis servers.
+         */
+        std::size_t nodes(){
+          return redis_->size();
+        };
+
+
+        /**
+         * Returns the index of the redis server where all the keys matching
+         * an expression are stored, if there is only one.
+         * @param  expression Expression, example: session:roles:{cc9sKWG6}:*
+         * @param  node       Index of the redis server, set only if true is returned.
+         * @return            True if all the keys matching the expression are
+         *                    stored in the same redis server.
+         */
+        bool node(const std::string& expression, std::size_t& node){
+          return redis_->node(expression, node);
+        };
+
+
+        /**
+         * Returns a RedisValue containing a group of keys of a redis
+         * server that match a given expression for a given cursor,
          * returns also a new cursor to obtain a new group of keys.
          * 
+         * @param node        Index of the redis server.
+         * @param cursor      Cursor, "0" for the first group.
          * @param expression  Expression used to match keys.
          *                    
          *                    Example of expression:
@@ -366,13 +565,14 @@ namespace granada{
          *                         
          * @return            RedisValue containing a group keys and a new cursor.
          */
-        redisclient::RedisValue Scan(const std::string& cursor, const std::string& expression_);
+        redisclient::RedisValue Scan(const std::size_t node, const std::string& cursor, const std::string& expression_);
 
 
         /**
-         * Returns a RedisValue containing all the keys of the
-         * cache that match a given expression.
+         * Returns a RedisValue containing all the keys of a redis
+         * server that match a given expression.
          * 
+         * @param node        Index of the redis server.
          * @param expression  Expression used to match keys.
          *                    
          *                    Example of expression:
@@ -387,7 +587,7 @@ namespace granada{
          *                         
          * @return            RedisValue containing all the keys.
          */
-        redisclient::RedisValue Keys(const std::string& expression_);
+        redisclient::RedisValue Keys(const std::size_t node, const std::string& expression_);
 
 
         /**
@@ -404,17 +604,11 @@ namespace granada{
       protected:
 
         /**
-         * Redis client.
+         * Redis clients.
          */
         static std::unique_ptr<RedisSyncClientWrapper> redis_;
 
 
-        /**
-         * Mutex for thread safety.
-         */
-        static std::mutex mtx_;
-
-
     };
   }
 }
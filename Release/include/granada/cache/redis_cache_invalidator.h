@@ -0,0 +1,246 @@
+/**
+  * Copyright (c) <2016> granada <afernandez@cookinapps.io>
+  *
+  * This source code is licensed under the MIT license.
+  *
+  * Permission is hereby granted, free of charge, to any person obtaining a copy
+  * of this software and associated documentation files (the "Software"), to deal
+  * in the Software without restriction, including without limitation the rights
+  * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  * copies of the Software, and to permit persons to whom the Software is
+  * furnished to do so, subject to the following conditions:
+  *
+  * The above copyright notice and this permission notice shall be included in
+  * all copies or substantial portions of the Software.
+  *
+  * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  * SOFTWARE.
+  *
+  *
+  * Tells the tiered cache handlers which redis keys have been
+  * modified, using redis client side caching or pub/sub messages.
+  *
+  */
+
+#pragma once
+#include <array>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "granada/defaults.h"
+#include "granada/util/mutex.h"
+#include "granada/util/application.h"
+#include "redis_cache_driver.h"
+#include "tiered_cache_handler.h"
+#include "redisclient/redisasyncclient.h"
+#include "redisclient/redisparser.h"
+
+namespace granada{
+  namespace cache{
+
+    /**
+     * Receives the invalidations of the redis keys kept in process
+     * by a TieredCacheHandler. There are two modes, chosen with the
+     * "redis_cache_invalidation" property:
+     *
+     *    tracking  Redis client side caching (redis 6 or later), each redis server
+     *              sends the modified keys starting with the prefixes through
+     *              the "__redis__:invalidate" channel, whoever modifies them.
+     *    pubsub    The tiered cache handlers publish the keys they modify in the
+     *              "granada:cache:invalidate" channel of the first redis server.
+     *              Keys modified without a tiered cache handler are not invalidated.
+     *
+     * In tracking mode the invalidation messages are read from a plain socket,
+     * because they carry an array of keys, or null when redis flushes or
+     * forgets its tracking table, then all the keys are invalidated.
+     *
+     * Example:
+     *    granada::cache::TieredCacheHandler cache(new granada::cache::RedisCacheDriver(), new granada::cache::RedisCacheInvalidator());
+     *
+     * This code is multi-thread safe.
+     */
+    class RedisCacheInvalidator : public CacheInvalidator
+    {
+      public:
+
+        /**
+         * Constructor
+         */
+        RedisCacheInvalidator(){};
+
+
+        /**
+         * Destructor, closes the subscriptions.
+         */
+        virtual ~RedisCacheInvalidator();
+
+
+        /**
+         * Subscribes to the invalidation messages of all the redis servers
+         * listed in "redis_cache_driver_nodes" or "redis_cache_driver_address".
+         * @param  prefixes   Prefixes of the keys, example: plugin:value:
+         * @param  invalidate Function called with each modified key, an empty
+         *                    key means that any key may have been modified.
+         * @param  disconnect Function called if a subscription is lost.
+         * @return            True if all the subscriptions succeeded.
+         */
+        virtual bool Subscribe(const std::vector<std::string>& prefixes, std::function<void(const std::string&)> invalidate, std::function<void()> disconnect) override;
+
+
+        /**
+         * Publishes a modified key in pubsub mode, in tracking
+         * mode redis does it by itself.
+         * @param key Modified key.
+         */
+        virtual void Publish(const std::string& key) override;
+
+
+      protected:
+
+        /**
+         * Subscription to a redis server.
+         */
+        struct Node{
+
+          /**
+           * Runs the subscriber.
+           */
+          boost::asio::io_service io_service;
+          std::unique_ptr<boost::asio::io_service::work> work;
+          std::thread thread;
+
+
+          /**
+           * Connection receiving the invalidation messages in pubsub mode.
+           */
+          std::unique_ptr<redisclient::RedisAsyncClient> subscriber;
+
+
+          /**
+           * Connection receiving the invalidation messages in tracking mode,
+           * with the buffer and the parser of the replies.
+           */
+          std::unique_ptr<boost::asio::ip::tcp::socket> socket;
+          std::array<char,4096> buffer;
+          redisclient::RedisParser parser;
+
+
+          /**
+           * Connection with client side caching enabled, the
+           * invalidations of its keys are sent to the socket.
+           */
+          std::unique_ptr<redisclient::RedisAsyncClient> tracker;
+        };
+
+
+        /**
+         * Subscriptions, one per redis server.
+         */
+        std::vector<std::unique_ptr<Node>> nodes_;
+
+
+        /**
+         * Connection used for publishing the modified keys in pubsub mode.
+         */
+        boost::asio::io_service publisher_io_service_;
+        std::unique_ptr<redisclient::RedisSyncClient> publisher_;
+        std::mutex publisher_mtx_;
+
+
+        /**
+         * Used for loading the properties only once.
+         */
+        static granada::util::mutex::call_once load_properties_call_once_;
+
+
+        /**
+         * True in tracking mode, false in pubsub mode.
+         * Loaded in LoadProperties() function, will take the value of the
+         * "redis_cache_invalidation" property. If the property is not
+         * provided default_strings::redis_cache_invalidation will be taken instead.
+         */
+        static bool tracking_;
+
+
+        /**
+         * Loads the properties.
+         */
+        static void LoadProperties();
+
+
+        /**
+         * Subscribes to the invalidation messages of a redis server.
+         * @param  node       Subscription.
+         * @param  address    Address of the redis server.
+         * @param  port       Port of the redis server.
+         * @param  prefixes   Prefixes of the keys.
+         * @param  invalidate Function called with each modified key.
+         * @param  disconnect Function called if the subscription is lost.
+         * @return            True if the subscription succeeded.
+         */
+        bool Subscribe(Node* node, const std::string& address, const unsigned short port, const std::vector<std::string>& prefixes, std::function<void(const std::string&)> invalidate, std::function<void()> disconnect);
+
+
+        /**
+         * Subscribes to the pubsub channel of a redis server.
+         * @param  node       Subscription.
+         * @param  address    Address of the redis server.
+         * @param  port       Port of the redis server.
+         * @param  invalidate Function called with each modified key.
+         * @param  disconnect Function called if the subscription is lost.
+         * @param  done       Function called with the result of the subscription.
+         */
+        void SubscribePubsub(Node* node, const std::string& address, const unsigned short port, std::function<void(const std::string&)> invalidate, std::function<void()> disconnect, std::function<void(bool)> done);
+
+
+        /**
+         * Subscribes to the client side caching invalidations of a redis
+         * server, then enables the tracking in another connection.
+         * Losing any of the two connections calls disconnect.
+         * @param  node       Subscription.
+         * @param  address    Address of the redis server.
+         * @param  port       Port of the redis server.
+         * @param  prefixes   Prefixes of the keys.
+         * @param  invalidate Function called with each modified key.
+         * @param  disconnect Function called if the subscription is lost.
+         * @param  done       Function called with the result of the subscription.
+         */
+        void SubscribeTracking(Node* node, const std::string& address, const unsigned short port, const std::vector<std::string>& prefixes, std::function<void(const std::string&)> invalidate, std::function<void()> disconnect, std::function<void(bool)> done);
+
+
+        /**
+         * Reads the replies received by the socket of a node until it fails.
+         * @param node    Subscription.
+         * @param receive Function called with each reply.
+         * @param lost    Function called if the connection fails.
+         */
+        static void Read(Node* node, std::function<void(const redisclient::RedisValue&)> receive, std::function<void(const std::string&)> lost);
+
+
+        /**
+         * Calls invalidate with the keys of a client side caching
+         * invalidation message, or with an empty key if it is null.
+         * @param message    ["message", "__redis__:invalidate", keys]
+         * @param invalidate Function called with each modified key.
+         */
+        static void Invalidate(const redisclient::RedisValue& message, const std::function<void(const std::string&)>& invalidate);
+
+
+        /**
+         * Returns a command encoded in the redis protocol.
+         * @param  args Name and arguments of the command.
+         * @return      Encoded command.
+         */
+        static std::string Command(const std::vector<std::string>& args);
+
+    };
+  }
+}
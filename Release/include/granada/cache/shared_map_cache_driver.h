@@ -30,6 +30,9 @@
   * 								|_ key1 => value3
   * 							 	|_ key2 => value4
   *
+  * The map can be saved periodically in a snapshot file and
+  * loaded again when the application restarts.
+  *
   * This code is multi-thread safe.
   *
   */
@@ -37,11 +40,20 @@
 #pragma once
 #include "cache_handler.h"
 #include <regex>
+#include <cstring>
 #include <string>
 #include <deque>
 #include <unordered_map>
 #include <map>
+#include <memory>
+#include <thread>
+#include <condition_variable>
+#include "granada/defaults.h"
+#include "granada/util/mutex.h"
 #include "granada/util/string.h"
+#include "granada/util/application.h"
+#include "granada/util/metrics.h"
+#include "hash_ring.h"
 
 namespace granada{
   namespace cache{
@@ -143,6 +155,20 @@ namespace granada{
      *                 |_ key1 => value3
      *                 |_ key2 => value4
      *
+     * The unordered map is split in shards, each with its own mutex.
+     *
+     * A driver created with a name is saved in the snapshot file
+     * <shared_map_cache_driver_snapshot_directory>/<name>.snapshot
+     * every "shared_map_cache_driver_snapshot_frequency" seconds and when
+     * it is destroyed, and it is loaded from that file the first time the
+     * driver is used, so drivers can be created during static initialization.
+     * Snapshots are only taken if the "shared_map_cache_driver_snapshot_directory"
+     * property is set.
+     *
+     * Taking a snapshot does not block the driver: the shards are copied
+     * on write, the snapshot keeps the version of the shards it started with
+     * and the first modification of each shard afterwards makes a new copy.
+     *
      * This code is multi-thread safe.
      */
     class SharedMapCacheDriver : public CacheHandler
@@ -156,9 +182,18 @@ namespace granada{
 
 
         /**
-         * Destructor
+         * Constructor, the snapshot of the driver with the given name is
+         * loaded and periodic snapshots are started the first time it is used.
+         * @param name  Name of the driver, used as name of the snapshot file.
+         *              Example: session => session.snapshot
+         */
+        SharedMapCacheDriver(const std::string& name);
+
+
+        /**
+         * Destructor, takes a last snapshot if snapshots are enabled.
          */
-        virtual ~SharedMapCacheDriver(){};
+        virtual ~SharedMapCacheDriver();
 
 
         /**
@@ -195,6 +230,24 @@ namespace granada{
         virtual const std::string Read(const std::string& hash,const std::string& key);
 
 
+        /**
+         * Fills a vector with the keys of the key-value pairs stored
+         * in the map with the given name.
+         * @param hash    Name of the map.
+         * @param fields  Vector to fill with the keys of the map.
+         */
+        virtual void Fields(const std::string& hash, std::vector<std::string>& fields);
+
+
+        /**
+         * Fills a map with all the key-value pairs stored in the
+         * map with the given name.
+         * @param hash    Name of the map.
+         * @param values  Map to fill with the key-value pairs.
+         */
+        virtual void ReadAll(const std::string& hash, std::map<std::string,std::string>& values);
+
+
         /**
          * Set a value in the cache associated with a given key.
          * @param key   Key of the value.
@@ -220,6 +273,13 @@ namespace granada{
         virtual void Destroy(const std::string& key);
 
 
+        /**
+         * Destroys several sets of key-value pairs holding the lock once.
+         * @param keys Names of the unordered maps to destroy.
+         */
+        virtual void Destroy(const std::vector<std::string>& keys);
+
+
         /**
          * Destroys a key value pair of a given set.
          * @param hash Name of the unordered map containing the key-value pair to destroy.
@@ -272,17 +332,202 @@ namespace granada{
         };
 
 
+        /**
+         * Saves all the data in a snapshot file. The file is written
+         * with another name and then renamed, so a crash while saving
+         * does not damage the previous snapshot.
+         * @param  file_path Path of the snapshot file.
+         * @return           True if the snapshot was saved.
+         */
+        bool SaveSnapshot(const std::string& file_path);
+
+
+        /**
+         * Loads a snapshot file, the sections of the file are decoded
+         * in parallel. The loaded keys replace the existing ones.
+         * @param  file_path Path of the snapshot file.
+         * @return           True if the snapshot was loaded, false if the
+         *                   file does not exist or it is corrupted, in that
+         *                   case nothing is loaded.
+         */
+        bool LoadSnapshot(const std::string& file_path);
+
+
+        /**
+         * Returns the path of the snapshot file of this driver,
+         * empty if snapshots are not enabled.
+         * @return Path of the snapshot file.
+         */
+        const std::string& snapshot_path(){
+          Start();
+          return snapshot_path_;
+        };
+
+
       protected:
 
         /**
-         * Map where all data is stored.
+         * Data of a shard: sets of key-value pairs by name.
+         */
+        typedef std::unordered_map<std::string,std::map<std::string,std::string>> Data;
+
+
+        /**
+         * Part of the data, with its own mutex.
+         */
+        struct Shard{
+
+          /**
+           * Data of the shard.
+           */
+          std::shared_ptr<Data> data;
+
+          /**
+           * True if a snapshot has a reference to the data,
+           * it has to be copied before being modified.
+           */
+          bool frozen = false;
+
+          /**
+           * Mutex for thread safety.
+           */
+          std::mutex mtx;
+        };
+
+
+        /**
+         * Shards where all data is stored, keys are
+         * assigned to shards by their hash.
+         */
+        std::vector<std::unique_ptr<Shard>> shards_;
+
+
+        /**
+         * Returns the shard where a key is stored.
+         * @param  key Key.
+         * @return     Shard.
+         */
+        Shard& shard(const std::string& key);
+
+
+        /**
+         * Returns the data of a shard ready to be modified, copying
+         * it if a snapshot has a reference to it. Must be called
+         * with the mutex of the shard locked.
+         * @param  shard Shard.
+         * @return       Data of the shard.
+         */
+        static Data& writable(Shard& shard);
+
+
+        /**
+         * Fills a vector with the current data of all the shards, the
+         * data will not be modified while there is a reference to it.
+         * @param data Vector to fill, one element per shard.
+         */
+        void Freeze(std::vector<std::shared_ptr<const Data>>& data);
+
+
+        /**
+         * Loads the snapshot and starts the snapshot thread if the driver
+         * has a name and snapshots are enabled. Called before accessing the
+         * data, only the first call has effect.
+         */
+        void Start();
+
+
+        /**
+         * Sets the counters of the read, write and destroy operations.
+         * @param driver Value of the "driver" label of the counters.
+         */
+        void CountOperations(const std::string& driver);
+
+
+        /**
+         * Counters of the operations, see granada::util::metrics.
+         */
+        granada::util::metrics::Counter* reads_;
+        granada::util::metrics::Counter* writes_;
+        granada::util::metrics::Counter* destroys_;
+
+
+        /**
+         * Name of the driver, empty if it has no snapshots.
+         */
+        std::string name_;
+
+
+        /**
+         * Used for calling Start() only once.
+         */
+        std::once_flag start_once_;
+
+
+        /**
+         * True once the snapshot of a named driver has been loaded.
+         */
+        bool started_ = false;
+
+
+        /**
+         * Path of the snapshot file, empty if snapshots are disabled.
+         */
+        std::string snapshot_path_;
+
+
+        /**
+         * Thread taking snapshots periodically.
+         */
+        std::thread snapshot_thread_;
+
+
+        /**
+         * Used for waking up and stopping the snapshot thread.
+         */
+        std::mutex snapshot_thread_mtx_;
+        std::condition_variable snapshot_thread_cv_;
+        bool snapshot_thread_stop_ = false;
+
+
+        /**
+         * Ensures only one snapshot is saved at a time.
+         */
+        std::mutex snapshot_mtx_;
+
+
+        /**
+         * Used for loading the properties only once.
+         */
+        static granada::util::mutex::call_once load_properties_call_once_;
+
+
+        /**
+         * Directory where snapshots are saved, snapshots are disabled if empty.
+         * Loaded in LoadProperties() function, will take the value of the
+         * "shared_map_cache_driver_snapshot_directory" property.
+         */
+        static std::string snapshot_directory_;
+
+
+        /**
+         * Seconds between two snapshots, no periodic snapshots if 0 or less.
+         * Loaded in LoadProperties() function, will take the value of the
+         * "shared_map_cache_driver_snapshot_frequency" property. If the property is not
+         * provided default_numbers::shared_map_cache_driver_snapshot_frequency will be taken instead.
          */
-        std::unique_ptr<std::unordered_map<std::string,std::map<std::string,std::string>>> data_;
+        static int snapshot_frequency_;
+
+
+        /**
+         * Loads the snapshot properties.
+         */
+        static void LoadProperties();
+
 
         /**
-         * Mutex for thread safety.
+         * Creates the shards.
          */
-        std::mutex mtx_;
+        void CreateShards();
 
 
     };
@@ -0,0 +1,502 @@
+/**
+  * Copyright (c) <2016> granada <afernandez@cookinapps.io>
+  *
+  * This source code is licensed under the MIT license.
+  *
+  * Permission is hereby granted, free of charge, to any person obtaining a copy
+  * of this software and associated documentation files (the "Software"), to deal
+  * in the Software without restriction, including without limitation the rights
+  * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  * copies of the Software, and to permit persons to whom the Software is
+  * furnished to do so, subject to the following conditions:
+  *
+  * The above copyright notice and this permission notice shall be included in
+  * all copies or substantial portions of the Software.
+  *
+  * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  * SOFTWARE.
+  *
+  *
+  * Cache handler keeping the most read keys of another cache handler
+  * in process, so they can be read without crossing the network.
+  *
+  */
+
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <map>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "granada/defaults.h"
+#include "granada/util/mutex.h"
+#include "granada/util/string.h"
+#include "granada/util/application.h"
+#include "cache_handler.h"
+
+namespace granada{
+  namespace cache{
+
+    /**
+     * Interface. Tells the processes using a cache which keys have
+     * been modified, so they can remove them from their in process copies.
+     */
+    class CacheInvalidator{
+
+      public:
+
+        /**
+         * Constructor
+         */
+        CacheInvalidator(){};
+
+
+        /**
+         * Destructor
+         */
+        virtual ~CacheInvalidator(){};
+
+
+        /**
+         * Starts receiving the invalidations of the keys starting with
+         * the given prefixes.
+         * @param  prefixes   Prefixes of the keys, example: plugin:value:
+         * @param  invalidate Function called with each modified key, an empty
+         *                    key means that any key may have been modified.
+         * @param  disconnect Function called if the invalidations stop
+         *                    being received.
+         * @return            True if invalidations will be received, false if not.
+         */
+        virtual bool Subscribe(const std::vector<std::string>& prefixes, std::function<void(const std::string&)> invalidate, std::function<void()> disconnect) = 0;
+
+
+        /**
+         * Tells the other processes that a key has been modified,
+         * if the cache does not do it by itself.
+         * @param key Modified key, may contain "*" if several keys
+         *            have been modified.
+         */
+        virtual void Publish(const std::string& key){};
+
+    };
+
+
+    /**
+     * Cache handler in front of another cache handler, keeps a bounded
+     * in process copy (L1) of the keys it reads, so reading them again
+     * does not cross the network. Only keys of the namespaces listed in
+     * the "tiered_cache_handler_namespaces" property are kept, they should
+     * be keys read much more often than they are written:
+     *
+     *    tiered_cache_handler_namespaces=oauth2.client:value:*,plugin:value:*
+     *
+     * Maps are copied completely the first time one of their values is read.
+     * Writes go directly to the other cache handler and remove the key
+     * from the in process copy.
+     *
+     * Modifications made by other processes are received through a
+     * CacheInvalidator, if it fails to subscribe or the subscription is
+     * lost no key is kept in process. Without invalidator the copy is
+     * only coherent if this handler is the only one modifying the keys.
+     *
+     * Example:
+     *    granada::cache::TieredCacheHandler cache(new granada::cache::RedisCacheDriver(), new granada::cache::RedisCacheInvalidator());
+     *
+     * This code is multi-thread safe.
+     */
+    class TieredCacheHandler : public CacheHandler
+    {
+      public:
+
+        /**
+         * Constructor, the namespaces kept in process are taken
+         * from the "tiered_cache_handler_namespaces" property.
+         * @param cache       Cache handler the values are stored in,
+         *                    owned by the tiered cache handler.
+         * @param invalidator Invalidator telling which keys have been modified
+         *                    by other processes, owned by the tiered cache handler.
+         *                    May be nullptr.
+         */
+        TieredCacheHandler(CacheHandler* cache, CacheInvalidator* invalidator);
+
+
+        /**
+         * Constructor.
+         * @param cache       Cache handler the values are stored in,
+         *                    owned by the tiered cache handler.
+         * @param invalidator Invalidator telling which keys have been modified
+         *                    by other processes, owned by the tiered cache handler.
+         *                    May be nullptr.
+         * @param namespaces  Expressions of the keys kept in process, only "*" at the
+         *                    end is supported. Example: plugin:value:*
+         * @param max_size    Maximum number of keys kept in process.
+         */
+        TieredCacheHandler(CacheHandler* cache, CacheInvalidator* invalidator, const std::vector<std::string>& namespaces, const std::size_t max_size);
+
+
+        /**
+         * Destructor, stops the invalidator first: its threads call
+         * Invalidate() and the disconnect callback until it is destroyed.
+         */
+        virtual ~TieredCacheHandler(){
+          invalidator_.reset();
+        };
+
+
+        /**
+         * Checks if a key exist in the cache.
+         * @param  key  Key to check.
+         */
+        virtual const bool Exists(const std::string& key) override;
+
+
+        /**
+         * Checks if a key exist in a set with given hash.
+         * @param  hash Name of the set of key-value.
+         * @param  key  Key of the value
+         * @return      True if exist, false if it does not.
+         */
+        virtual const bool Exists(const std::string& hash,const std::string& key) override;
+
+
+        /**
+         * Returns value from the cache.
+         * @param  key Key of the value.
+         * @return     Value
+         */
+        virtual const std::string Read(const std::string& key) override;
+
+
+        /**
+         * Returns the value of a key-value pair stored in
+         * a map with the given name.
+         * @param  hash Name of the map.
+         * @param  key  Key to identify the value.
+         * @return      Value.
+         */
+        virtual const std::string Read(const std::string& hash,const std::string& key) override;
+
+
+        /**
+         * Fills a vector with the keys of the key-value pairs stored
+         * in the map with the given name.
+         * @param hash    Name of the map.
+         * @param fields  Vector to fill with the keys of the map.
+         */
+        virtual void Fields(const std::string& hash, std::vector<std::string>& fields) override;
+
+
+        /**
+         * Fills a map with all the key-value pairs stored in the
+         * map with the given name.
+         * @param hash    Name of the map.
+         * @param values  Map to fill with the key-value pairs.
+         */
+        virtual void ReadAll(const std::string& hash, std::map<std::string,std::string>& values) override;
+
+
+        /**
+         * Set a value in the cache associated with a given key.
+         * @param key   Key of the value.
+         * @param value Value.
+         */
+        virtual void Write(const std::string& key,const std::string& value) override;
+
+
+        /**
+         * Inserts or rewrite a key-value pair in a map with the given name.
+         * If the set does not exist, it creates it.
+         * @param  hash Name of the map.
+         * @param  key  Key to identify the value.
+         * @param       Value.
+         */
+        virtual void Write(const std::string& hash,const std::string& key,const std::string& value) override;
+
+
+        /**
+         * Destroys a set of key-value pairs with the given name.
+         * @param key Name of the map, if it contains "*" all
+         *            the maps matching it are destroyed.
+         */
+        virtual void Destroy(const std::string& key) override;
+
+
+        /**
+         * Destroys several sets of key-value pairs.
+         * @param keys Names of the maps to destroy.
+         */
+        virtual void Destroy(const std::vector<std::string>& keys) override;
+
+
+        /**
+         * Destroys a key value pair of a given set.
+         * @param hash Name of the map containing the key-value pair to destroy.
+         * @param key  Key associated with the value to destroy.
+         */
+        virtual void Destroy(const std::string& hash,const std::string& key) override;
+
+
+        /**
+         * Renames a key.
+         *
+         * @param old_key Old key to rename.
+         * @param new_key New key.
+         *
+         * @return        True if the key could be renamed, false if not.
+         */
+        virtual bool Rename(const std::string& old_key, const std::string& new_key) override;
+
+
+        /**
+         * Returns the tag of the other cache handler.
+         * @param  id Identifier of the group, example: a session token.
+         * @return    Identifier to use in the keys.
+         */
+        virtual const std::string Tag(const std::string& id) override{
+          return cache_->Tag(id);
+        };
+
+
+        /**
+         * Fills a vector with the keys matching an expression, always
+         * searched in the other cache handler.
+         * @param expression  Expression, example: session:value:*
+         * @param keys        Vector to fill with the keys.
+         */
+        virtual const void Match(const std::string& expression, std::vector<std::string>& keys) override;
+
+
+        /**
+         * Returns an iterator to iterate over keys with an expression,
+         * the keys are searched in the other cache handler.
+         * @param   Expression to be use to iterate over keys that match this expression.
+         *          Example: "user*" => we will iterate over all the keys that start with "user"
+         * @return  Iterator.
+         */
+        virtual std::unique_ptr<granada::cache::CacheHandlerIterator> make_iterator(const std::string& expression) override;
+
+
+        /**
+         * Removes a key from the in process copy. Called when the key
+         * has been modified by another process.
+         * @param key Key, if it contains "*" all the keys starting with the
+         *            part before the "*" are removed, if it is empty all the
+         *            keys are removed.
+         */
+        void Invalidate(const std::string& key);
+
+
+        /**
+         * Returns true if the keys of the namespaces are being
+         * kept in process.
+         * @return True | False
+         */
+        bool enabled(){
+          Start();
+          return enabled_;
+        };
+
+
+        /**
+         * Returns the number of keys kept in process.
+         * @return Number of keys.
+         */
+        std::size_t size(){
+          std::lock_guard<std::mutex> lg(mtx_);
+          return entries_.size();
+        };
+
+
+      protected:
+
+        /**
+         * In process copy of a key.
+         */
+        struct Entry{
+
+          /**
+           * True if the key is a map, false if it is a single value.
+           */
+          bool hash = false;
+
+
+          /**
+           * Value of a single value key.
+           */
+          std::string value;
+
+
+          /**
+           * Key-value pairs of a map, empty if the map does not exist.
+           */
+          std::map<std::string,std::string> values;
+
+
+          /**
+           * Position of the key in lru_.
+           */
+          std::list<std::string>::iterator lru;
+        };
+
+
+        /**
+         * Cache handler the values are stored in.
+         */
+        std::unique_ptr<CacheHandler> cache_;
+
+
+        /**
+         * Invalidator telling which keys have been modified by other processes.
+         */
+        std::unique_ptr<CacheInvalidator> invalidator_;
+
+
+        /**
+         * Prefixes of the keys kept in process.
+         */
+        std::vector<std::string> prefixes_;
+
+
+        /**
+         * Maximum number of keys kept in process.
+         */
+        std::size_t max_size_ = 0;
+
+
+        /**
+         * True if the namespaces and the maximum size have been given
+         * in the constructor instead of taken from the properties.
+         */
+        bool configured_ = false;
+
+
+        /**
+         * Keys kept in process.
+         */
+        std::unordered_map<std::string,Entry> entries_;
+
+
+        /**
+         * Keys kept in process, the most recently used first.
+         */
+        std::list<std::string> lru_;
+
+
+        /**
+         * Number of invalidations received, a value read from the other
+         * cache handler is only kept if there has been no invalidation
+         * while it was read, as it could be already outdated.
+         */
+        uint64_t invalidations_ = 0;
+
+
+        /**
+         * Mutex for thread safety of entries_ and lru_.
+         */
+        std::mutex mtx_;
+
+
+        /**
+         * True if keys are being kept in process.
+         */
+        std::atomic<bool> enabled_{false};
+
+
+        /**
+         * Used for calling Start() only once.
+         */
+        std::once_flag start_once_;
+
+
+        /**
+         * Used for loading the properties only once.
+         */
+        static granada::util::mutex::call_once load_properties_call_once_;
+
+
+        /**
+         * Prefixes of the keys kept in process.
+         * Loaded in LoadProperties() function, will take the value of the
+         * "tiered_cache_handler_namespaces" property. If the property is not
+         * provided default_strings::tiered_cache_handler_namespaces will be taken instead.
+         */
+        static std::vector<std::string> default_prefixes_;
+
+
+        /**
+         * Maximum number of keys kept in process.
+         * Loaded in LoadProperties() function, will take the value of the
+         * "tiered_cache_handler_max_size" property. If the property is not
+         * provided default_numbers::tiered_cache_handler_max_size will be taken instead.
+         */
+        static std::size_t default_max_size_;
+
+
+        /**
+         * Loads the properties.
+         */
+        static void LoadProperties();
+
+
+        /**
+         * Takes the configuration and subscribes to the invalidations.
+         * Called before each operation, only the first call has effect.
+         */
+        void Start();
+
+
+        /**
+         * Returns true if the given key is kept in process.
+         * @param  key Key.
+         * @return     True | False
+         */
+        bool Cached(const std::string& key);
+
+
+        /**
+         * Reads a map from the other cache handler and keeps it in process
+         * if it has not been invalidated meanwhile.
+         * @param  hash   Name of the map.
+         * @param  values Map to fill with the key-value pairs.
+         */
+        void Load(const std::string& hash, std::map<std::string,std::string>& values);
+
+
+        /**
+         * Returns the in process copy of a key and marks it as the most
+         * recently used. Must be called with mtx_ locked.
+         * @param  key  Key.
+         * @param  hash True if the key is a map, false if it is a single value.
+         * @return      Entry of the key, nullptr if it is not kept in process.
+         */
+        Entry* Find(const std::string& key, const bool hash);
+
+
+        /**
+         * Inserts a key in the in process copy, removing the least recently
+         * used keys if there are too many. Must be called with mtx_ locked.
+         * @param  key Key.
+         * @return     Entry of the key.
+         */
+        Entry& Insert(const std::string& key);
+
+
+        /**
+         * Removes a key from the in process copy and tells the other
+         * processes it has been modified.
+         * @param key Key, may contain "*".
+         */
+        void Modified(const std::string& key);
+
+    };
+  }
+}
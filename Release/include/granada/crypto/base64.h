@@ -0,0 +1,141 @@
+/**
+  * Copyright (c) <2016> granada <afernandez@cookinapps.io>
+  *
+  * This source code is licensed under the MIT license.
+  *
+  * Permission is hereby granted, free of charge, to any person obtaining a copy
+  * of this software and associated documentation files (the "Software"), to deal
+  * in the Software without restriction, including without limitation the rights
+  * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  * copies of the Software, and to permit persons to whom the Software is
+  * furnished to do so, subject to the following conditions:
+  *
+  * The above copyright notice and this permission notice shall be included in
+  * all copies or substantial portions of the Software.
+  *
+  * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  * SOFTWARE.
+  *
+  * Base64 and base64url encoding (RFC 4648).
+  *
+  */
+
+#pragma once
+#include <string>
+
+namespace granada{
+  namespace crypto{
+
+    /**
+     * Base64 and base64url encoding (RFC 4648), without padding.
+     */
+    namespace base64{
+
+      /**
+       * Encodes a text in base64 without padding.
+       * @param  text     Text to encode.
+       * @param  url_safe True to use the base64url alphabet (section 5),
+       *                  false to use the standard alphabet.
+       * @return          Encoded text.
+       */
+      static std::string encode(const std::string& text, const bool url_safe){
+        static const char standard_alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+        static const char url_alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+        const char* alphabet = url_safe ? url_alphabet : standard_alphabet;
+        std::string encoded;
+        encoded.reserve(((text.size() + 2) / 3) * 4);
+        std::size_t i = 0;
+        for (; i + 2 < text.size(); i += 3){
+          const unsigned int n = ((unsigned char)text[i] << 16) | ((unsigned char)text[i+1] << 8) | (unsigned char)text[i+2];
+          encoded.push_back(alphabet[(n >> 18) & 63]);
+          encoded.push_back(alphabet[(n >> 12) & 63]);
+          encoded.push_back(alphabet[(n >> 6) & 63]);
+          encoded.push_back(alphabet[n & 63]);
+        }
+        if (i + 1 == text.size()){
+          const unsigned int n = ((unsigned char)text[i] << 16);
+          encoded.push_back(alphabet[(n >> 18) & 63]);
+          encoded.push_back(alphabet[(n >> 12) & 63]);
+        }else if (i + 2 == text.size()){
+          const unsigned int n = ((unsigned char)text[i] << 16) | ((unsigned char)text[i+1] << 8);
+          encoded.push_back(alphabet[(n >> 18) & 63]);
+          encoded.push_back(alphabet[(n >> 12) & 63]);
+          encoded.push_back(alphabet[(n >> 6) & 63]);
+        }
+        return encoded;
+      };
+
+
+      /**
+       * Decodes a base64 or base64url text without padding.
+       * @param  encoded  Encoded text.
+       * @param  text     Decoded text.
+       * @param  url_safe True if the text uses the base64url alphabet,
+       *                  false if it uses the standard alphabet.
+       * @return          True if the text could be decoded, false if it
+       *                  contains characters out of the alphabet.
+       */
+      static bool decode(const std::string& encoded, std::string& text, const bool url_safe){
+        text.clear();
+        if (encoded.size() % 4 == 1){
+          return false;
+        }
+        const char c62 = url_safe ? '-' : '+';
+        const char c63 = url_safe ? '_' : '/';
+        text.reserve((encoded.size() * 3) / 4);
+        unsigned int n = 0;
+        int bits = 0;
+        for (auto it = encoded.begin(); it != encoded.end(); ++it){
+          const char c = *it;
+          int value;
+          if (c >= 'A' && c <= 'Z'){
+            value = c - 'A';
+          }else if (c >= 'a' && c <= 'z'){
+            value = c - 'a' + 26;
+          }else if (c >= '0' && c <= '9'){
+            value = c - '0' + 52;
+          }else if (c == c62){
+            value = 62;
+          }else if (c == c63){
+            value = 63;
+          }else{
+            return false;
+          }
+          n = (n << 6) | value;
+          bits += 6;
+          if (bits >= 8){
+            bits -= 8;
+            text.push_back((char)((n >> bits) & 0xFF));
+          }
+        }
+        return true;
+      };
+
+
+      /**
+       * Encodes a text in base64url without padding.
+       * @param  text Text to encode.
+       * @return      Encoded text.
+       */
+      static inline std::string url_encode(const std::string& text){
+        return encode(text, true);
+      };
+
+
+      /**
+       * Decodes a base64url text without padding.
+       * @param  encoded Encoded text.
+       * @param  text    Decoded text.
+       * @return         True if the text could be decoded.
+       */
+      static inline bool url_decode(const std::string& encoded, std::string& text){
+        return decode(encoded, text, true);
+      };
+    }
+  }
+}
@@ -0,0 +1,284 @@
+/**
+  * Copyright (c) <2016> granada <afernandez@cookinapps.io>
+  *
+  * This source code is licensed under the MIT license.
+  *
+  * Permission is hereby granted, free of charge, to any person obtaining a copy
+  * of this software and associated documentation files (the "Software"), to deal
+  * in the Software without restriction, including without limitation the rights
+  * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  * copies of the Software, and to permit persons to whom the Software is
+  * furnished to do so, subject to the following conditions:
+  *
+  * The above copyright notice and this permission notice shall be included in
+  * all copies or substantial portions of the Software.
+  *
+  * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  * SOFTWARE.
+  *
+  * Authenticated encryption using the openssl EVP AEAD interface,
+  * AES-256-GCM by default (hardware accelerated with AES-NI when available).
+  *
+  * Encrypted text format:
+  *   version (1 byte) | IV (12 bytes) | cipher text (same length as text) | tag (16 bytes)
+  *
+  * The key is derived from the password with HKDF-SHA256 (RFC 5869), which
+  * does not slow down guessing: the password must already be a high-entropy
+  * random key, such as the generated OAuth 2.0 client secrets. Passwords chosen
+  * by people must be hashed with a PasswordVerifier instead.
+  * The initialized cipher contexts are cached per thread, per password digest and
+  * per cipher, so neither the key nor its schedule are computed again each time
+  * the same password is used.
+  * IVs are 96 bits drawn with RAND_bytes for each message, as in NIST SP
+  * 800-38D 8.2.2, so they do not depend on the cached contexts being kept.
+  *
+  * Texts encrypted with OpensslAESCryptograph can still be decrypted.
+  *
+  */
+
+#pragma once
+#include <string>
+#include <memory>
+#include <unordered_map>
+#include <cstring>
+#include "cryptograph.h"
+#include "openssl_aes_cryptograph.h"
+#include <openssl/evp.h>
+#include <openssl/kdf.h>
+#include <openssl/rand.h>
+#include <openssl/sha.h>
+
+namespace granada{
+  namespace crypto{
+    class OpensslEVPCryptograph : public Cryptograph{
+      public:
+
+        /**
+         * Constructor
+         * @param cipher  AEAD cipher with a 12 bytes IV and a 16 bytes tag,
+         *                for example EVP_aes_256_gcm() or EVP_chacha20_poly1305().
+         */
+        OpensslEVPCryptograph(const EVP_CIPHER* cipher = EVP_aes_256_gcm()){
+          cipher_ = cipher;
+        };
+
+
+        /**
+         * Destructor
+         */
+        virtual ~OpensslEVPCryptograph(){};
+
+
+        // override
+        std::string Encrypt(const std::string& text, std::string password) override {
+          Contexts* contexts = context(password);
+          if (contexts == nullptr){
+            return std::string();
+          }
+          EVP_CIPHER_CTX* ctx = contexts->encrypt.get();
+
+          std::string encrypted(1 + IV_LENGTH + text.size() + TAG_LENGTH, '\0');
+          unsigned char* out = reinterpret_cast<unsigned char*>(&encrypted[0]);
+          out[0] = VERSION;
+          unsigned char* iv = out + 1;
+
+          int length = 0;
+          if (RAND_bytes(iv, IV_LENGTH) != 1 ||
+              EVP_EncryptInit_ex(ctx, nullptr, nullptr, nullptr, iv) != 1 ||
+              EVP_EncryptUpdate(ctx, iv + IV_LENGTH, &length, reinterpret_cast<const unsigned char*>(text.data()), (int)text.size()) != 1 ||
+              EVP_EncryptFinal_ex(ctx, iv + IV_LENGTH + length, &length) != 1 ||
+              EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_GCM_GET_TAG, TAG_LENGTH, iv + IV_LENGTH + text.size()) != 1){
+            return std::string();
+          }
+          return encrypted;
+        };
+
+
+        // override
+        std::string Decrypt(const std::string& text, std::string password) override {
+          if (text.size() < 1 + IV_LENGTH + TAG_LENGTH || (unsigned char)text[0] != VERSION){
+            return DecryptLegacy(text, password);
+          }
+
+          Contexts* contexts = context(password);
+          if (contexts == nullptr){
+            return std::string();
+          }
+          EVP_CIPHER_CTX* ctx = contexts->decrypt.get();
+
+          const unsigned char* in = reinterpret_cast<const unsigned char*>(text.data());
+          const unsigned char* iv = in + 1;
+          const std::size_t text_length = text.size() - 1 - IV_LENGTH - TAG_LENGTH;
+          std::string decrypted(text_length, '\0');
+          unsigned char* out = reinterpret_cast<unsigned char*>(&decrypted[0]);
+          unsigned char tag[TAG_LENGTH];
+          memcpy(tag, iv + IV_LENGTH + text_length, TAG_LENGTH);
+
+          int length = 0;
+          if (EVP_DecryptInit_ex(ctx, nullptr, nullptr, nullptr, iv) != 1 ||
+              EVP_DecryptUpdate(ctx, out, &length, iv + IV_LENGTH, (int)text_length) != 1 ||
+              EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_GCM_SET_TAG, TAG_LENGTH, tag) != 1 ||
+              EVP_DecryptFinal_ex(ctx, out + length, &length) != 1){
+            // wrong password or altered text.
+            return DecryptLegacy(text, password);
+          }
+          return decrypted;
+        };
+
+
+      private:
+
+        /**
+         * Format version, first byte of the encrypted texts.
+         */
+        static const unsigned char VERSION = 0x01;
+
+
+        /**
+         * Length of the IV in bytes.
+         */
+        static const int IV_LENGTH = 12;
+
+
+        /**
+         * Length of the authentication tag in bytes.
+         */
+        static const int TAG_LENGTH = 16;
+
+
+        /**
+         * Maximum number of cached contexts per thread.
+         */
+        static const std::size_t MAX_CACHED_CONTEXTS = 64;
+
+
+        /**
+         * Deletes openssl cipher contexts.
+         */
+        struct ContextDeleter{
+          void operator()(EVP_CIPHER_CTX* ctx) const {
+            EVP_CIPHER_CTX_free(ctx);
+          };
+        };
+
+
+        /**
+         * Encryption and decryption contexts initialized with the same key.
+         */
+        struct Contexts{
+          std::unique_ptr<EVP_CIPHER_CTX,ContextDeleter> encrypt;
+          std::unique_ptr<EVP_CIPHER_CTX,ContextDeleter> decrypt;
+        };
+
+
+        /**
+         * AEAD cipher.
+         */
+        const EVP_CIPHER* cipher_;
+
+
+        /**
+         * Cryptograph used to decrypt texts encrypted with the
+         * previous fixed 256 bytes format.
+         */
+        OpensslAESCryptograph legacy_;
+
+
+        /**
+         * Returns the encryption and decryption contexts initialized with the key
+         * derived from the given password, ready to receive an IV. Contexts are
+         * cached per thread, as they can not be shared between threads, and are
+         * found by the SHA-256 digest of the password and the cipher nid, so the
+         * passwords are not kept in memory.
+         * @param  password Password.
+         * @return          Contexts, nullptr if they could not be initialized.
+         */
+        Contexts* context(const std::string& password){
+          static thread_local std::unordered_map<std::string,Contexts> contexts;
+          // password digest and cipher nid, the digest has a fixed length.
+          const int nid = EVP_CIPHER_nid(cipher_);
+          std::string cache_key(SHA256_DIGEST_LENGTH, '\0');
+          SHA256(reinterpret_cast<const unsigned char*>(password.data()), password.size(), reinterpret_cast<unsigned char*>(&cache_key[0]));
+          cache_key.append(std::to_string(nid));
+          auto it = contexts.find(cache_key);
+          if (it != contexts.end()){
+            return &it->second;
+          }
+
+          if (contexts.size() >= MAX_CACHED_CONTEXTS){
+            contexts.clear();
+          }
+
+          // key derived from the password, one key per cipher.
+          unsigned char key[EVP_MAX_KEY_LENGTH];
+          if (!DeriveKey(password, nid, key, EVP_CIPHER_key_length(cipher_))){
+            OPENSSL_cleanse(key, EVP_MAX_KEY_LENGTH);
+            return nullptr;
+          }
+
+          Contexts new_contexts;
+          new_contexts.encrypt.reset(EVP_CIPHER_CTX_new());
+          new_contexts.decrypt.reset(EVP_CIPHER_CTX_new());
+          const bool initialized = new_contexts.encrypt != nullptr && new_contexts.decrypt != nullptr &&
+              EVP_EncryptInit_ex(new_contexts.encrypt.get(), cipher_, nullptr, nullptr, nullptr) == 1 &&
+              EVP_CIPHER_CTX_ctrl(new_contexts.encrypt.get(), EVP_CTRL_GCM_SET_IVLEN, IV_LENGTH, nullptr) == 1 &&
+              EVP_EncryptInit_ex(new_contexts.encrypt.get(), nullptr, nullptr, key, nullptr) == 1 &&
+              EVP_DecryptInit_ex(new_contexts.decrypt.get(), cipher_, nullptr, nullptr, nullptr) == 1 &&
+              EVP_CIPHER_CTX_ctrl(new_contexts.decrypt.get(), EVP_CTRL_GCM_SET_IVLEN, IV_LENGTH, nullptr) == 1 &&
+              EVP_DecryptInit_ex(new_contexts.decrypt.get(), nullptr, nullptr, key, nullptr) == 1;
+          OPENSSL_cleanse(key, EVP_MAX_KEY_LENGTH);
+          if (!initialized){
+            return nullptr;
+          }
+          return &contexts.insert(std::make_pair(cache_key, std::move(new_contexts))).first->second;
+        };
+
+
+        /**
+         * Derives a key from a high-entropy password with HKDF-SHA256,
+         * the cipher nid is part of the info so each cipher gets its own key.
+         * @param  password   Password.
+         * @param  nid        Cipher nid.
+         * @param  key        Derived key.
+         * @param  key_length Length of the key in bytes.
+         * @return            True if the key could be derived.
+         */
+        static bool DeriveKey(const std::string& password, const int nid, unsigned char* key, const int key_length){
+          // binds the derived keys to this format and cipher.
+          const std::string info = "granada.crypto.OpensslEVPCryptograph.1:" + std::to_string(nid);
+          std::size_t length = (std::size_t)key_length;
+          EVP_PKEY_CTX* pctx = EVP_PKEY_CTX_new_id(EVP_PKEY_HKDF, nullptr);
+          const bool derived = pctx != nullptr &&
+              EVP_PKEY_derive_init(pctx) == 1 &&
+              EVP_PKEY_CTX_set_hkdf_md(pctx, EVP_sha256()) == 1 &&
+              EVP_PKEY_CTX_set1_hkdf_key(pctx, reinterpret_cast<const unsigned char*>(password.data()), (int)password.size()) == 1 &&
+              EVP_PKEY_CTX_add1_hkdf_info(pctx, reinterpret_cast<const unsigned char*>(info.data()), (int)info.size()) == 1 &&
+              EVP_PKEY_derive(pctx, key, &length) == 1 &&
+              length == (std::size_t)key_length;
+          EVP_PKEY_CTX_free(pctx);
+          return derived;
+        };
+
+
+        /**
+         * Decrypts a text encrypted with OpensslAESCryptograph.
+         * @param  text     Encrypted text.
+         * @param  password Password.
+         * @return          Decrypted text, empty if the text does not have
+         *                  the previous format.
+         */
+        std::string DecryptLegacy(const std::string& text, const std::string& password){
+          if (text.size() == 256){
+            return legacy_.Decrypt(text, password);
+          }
+          return std::string();
+        };
+
+    };
+  }
+}
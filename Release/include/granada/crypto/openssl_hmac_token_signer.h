@@ -0,0 +1,209 @@
+/**
+  * Copyright (c) <2016> granada <afernandez@cookinapps.io>
+  *
+  * This source code is licensed under the MIT license.
+  *
+  * Permission is hereby granted, free of charge, to any person obtaining a copy
+  * of this software and associated documentation files (the "Software"), to deal
+  * in the Software without restriction, including without limitation the rights
+  * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  * copies of the Software, and to permit persons to whom the Software is
+  * furnished to do so, subject to the following conditions:
+  *
+  * The above copyright notice and this permission notice shall be included in
+  * all copies or substantial portions of the Software.
+  *
+  * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  * SOFTWARE.
+  *
+  * Signs and verifies compact JWS tokens (RFC 7515) with HMAC SHA-256
+  * using openssl.
+  *
+  * Several keys can be registered, each one identified by a key id sent
+  * in the "kid" header of the token. Tokens are always signed with the
+  * signing key, and are verified with the key their header names, so keys
+  * can be rotated: add the new key and make it the signing key, then remove
+  * the old key once the tokens signed with it have expired.
+  *
+  * This code is multi-thread safe.
+  *
+  */
+
+#pragma once
+#include <string>
+#include <mutex>
+#include <unordered_map>
+#include "token_signer.h"
+#include "base64.h"
+#include <openssl/crypto.h>
+#include <openssl/evp.h>
+#include <openssl/hmac.h>
+
+namespace granada{
+  namespace crypto{
+    class OpensslHMACTokenSigner : public TokenSigner{
+      public:
+
+        /**
+         * Constructor
+         */
+        OpensslHMACTokenSigner(){};
+
+
+        /**
+         * Destructor
+         */
+        virtual ~OpensslHMACTokenSigner(){};
+
+
+        // override
+        void AddKey(const std::string& kid, const std::string& secret) override {
+          std::lock_guard<std::mutex> lg(mtx_);
+          keys_[kid] = secret;
+        };
+
+
+        // override
+        void RemoveKey(const std::string& kid) override {
+          std::lock_guard<std::mutex> lg(mtx_);
+          keys_.erase(kid);
+          if (signing_kid_ == kid){
+            signing_kid_.clear();
+          }
+        };
+
+
+        // override
+        bool SetSigningKey(const std::string& kid) override {
+          std::lock_guard<std::mutex> lg(mtx_);
+          if (keys_.find(kid) != keys_.end()){
+            signing_kid_ = kid;
+            return true;
+          }
+          return false;
+        };
+
+
+        // override
+        bool CanSign() override {
+          std::lock_guard<std::mutex> lg(mtx_);
+          return !signing_kid_.empty();
+        };
+
+
+        // override
+        std::string Sign(const std::string& payload) override {
+          std::string kid;
+          std::string secret;
+          {
+            std::lock_guard<std::mutex> lg(mtx_);
+            if (signing_kid_.empty()){
+              return std::string();
+            }
+            kid = signing_kid_;
+            secret = keys_[kid];
+          }
+          const std::string& header = "{\"alg\":\"HS256\",\"typ\":\"JWT\",\"kid\":\"" + kid + "\"}";
+          const std::string& signing_input = base64::url_encode(header) + "." + base64::url_encode(payload);
+          return signing_input + "." + base64::url_encode(HMAC256(secret,signing_input));
+        };
+
+
+        // override
+        bool Verify(const std::string& token, std::string& payload) override {
+          const std::size_t first_dot = token.find('.');
+          if (first_dot == std::string::npos){
+            return false;
+          }
+          const std::size_t second_dot = token.find('.',first_dot + 1);
+          if (second_dot == std::string::npos || token.find('.',second_dot + 1) != std::string::npos){
+            return false;
+          }
+
+          // retrieve the key id from the header.
+          std::string header;
+          if (!base64::url_decode(token.substr(0,first_dot),header)){
+            return false;
+          }
+          if (header.find("\"alg\":\"HS256\"") == std::string::npos){
+            return false;
+          }
+          const std::string kid_label = "\"kid\":\"";
+          const std::size_t kid_begin = header.find(kid_label);
+          if (kid_begin == std::string::npos){
+            return false;
+          }
+          const std::size_t kid_end = header.find('"',kid_begin + kid_label.size());
+          if (kid_end == std::string::npos){
+            return false;
+          }
+          const std::string& kid = header.substr(kid_begin + kid_label.size(), kid_end - kid_begin - kid_label.size());
+
+          std::string secret;
+          {
+            std::lock_guard<std::mutex> lg(mtx_);
+            auto it = keys_.find(kid);
+            if (it == keys_.end()){
+              return false;
+            }
+            secret = it->second;
+          }
+
+          // compare signatures in constant time.
+          std::string signature;
+          if (!base64::url_decode(token.substr(second_dot + 1),signature)){
+            return false;
+          }
+          const std::string& expected_signature = HMAC256(secret,token.substr(0,second_dot));
+          if (signature.size() != expected_signature.size() ||
+              CRYPTO_memcmp(signature.data(),expected_signature.data(),signature.size()) != 0){
+            return false;
+          }
+
+          return base64::url_decode(token.substr(first_dot + 1,second_dot - first_dot - 1),payload);
+        };
+
+
+      private:
+
+        /**
+         * Keys by key id.
+         */
+        std::unordered_map<std::string,std::string> keys_;
+
+
+        /**
+         * Id of the key used to sign new tokens.
+         */
+        std::string signing_kid_;
+
+
+        /**
+         * Mutex for thread safety.
+         */
+        std::mutex mtx_;
+
+
+        /**
+         * Returns the HMAC SHA-256 of a text.
+         * @param  secret Secret key.
+         * @param  text   Text to sign.
+         * @return        Raw 32 bytes signature.
+         */
+        static std::string HMAC256(const std::string& secret, const std::string& text){
+          unsigned char out[EVP_MAX_MD_SIZE];
+          unsigned int out_length = 0;
+          HMAC(EVP_sha256(), secret.data(), (int)secret.size(),
+               reinterpret_cast<const unsigned char*>(text.data()), text.size(),
+               out, &out_length);
+          return std::string(reinterpret_cast<const char*>(out),out_length);
+        };
+
+    };
+  }
+}
@@ -0,0 +1,172 @@
+/**
+  * Copyright (c) <2016> granada <afernandez@cookinapps.io>
+  *
+  * This source code is licensed under the MIT license.
+  *
+  * Permission is hereby granted, free of charge, to any person obtaining a copy
+  * of this software and associated documentation files (the "Software"), to deal
+  * in the Software without restriction, including without limitation the rights
+  * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  * copies of the Software, and to permit persons to whom the Software is
+  * furnished to do so, subject to the following conditions:
+  *
+  * The above copyright notice and this permission notice shall be included in
+  * all copies or substantial portions of the Software.
+  *
+  * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  * SOFTWARE.
+  *
+  * Hashes and verifies passwords with the scrypt memory-hard key derivation
+  * function (RFC 7914) of openssl, or PBKDF2-HMAC-SHA256 when openssl is older
+  * than 1.1.0 and does not provide scrypt.
+  *
+  * Hash format:
+  *   $scrypt$ln=14,r=8,p=1$<base64 salt>$<base64 key>
+  *   $pbkdf2-sha256$i=100000$<base64 salt>$<base64 key>
+  *
+  * The key derivations run on a dedicated pool of threads with a bounded
+  * queue, so a burst of logins can not use more threads or memory than
+  * configured, verifications are rejected when the queue is full. Successful
+  * verifications are remembered for a few seconds, so retries do not derive
+  * the key again.
+  *
+  * Properties (server.conf):
+  *   password_verifier_scrypt_ln     log2 of the scrypt CPU/memory cost N.
+  *   password_verifier_scrypt_r      scrypt block size.
+  *   password_verifier_scrypt_p      scrypt parallelization.
+  *   password_verifier_pbkdf2_iterations  PBKDF2 iterations, only used without scrypt.
+  *   password_verifier_threads       Threads of the verification pool.
+  *   password_verifier_queue         Maximum verifications waiting for a thread.
+  *   password_verifier_cache_ttl     Seconds a successful verification is remembered.
+  *
+  * This code is multi-thread safe.
+  *
+  */
+
+#pragma once
+#include <string>
+#include <memory>
+#include "granada/defaults.h"
+#include "granada/util/mutex.h"
+#include "granada/util/application.h"
+#include "granada/util/thread_pool.h"
+#include "granada/cache/local_record_cache.h"
+#include "password_verifier.h"
+#include <openssl/opensslv.h>
+
+namespace granada{
+  namespace crypto{
+    class OpensslScryptPasswordVerifier : public PasswordVerifier{
+      public:
+
+        /**
+         * Constructor
+         * Properties are loaded the first time a password is hashed
+         * or verified, verifiers are usually static members and the
+         * configuration file may not be read yet when they are built.
+         */
+        OpensslScryptPasswordVerifier(){};
+
+
+        /**
+         * Destructor
+         */
+        virtual ~OpensslScryptPasswordVerifier(){};
+
+
+        // override
+        virtual std::string Hash(const std::string& password) override;
+
+
+        // override
+        virtual bool Verify(const std::string& password, const std::string& hash) override;
+
+
+        // override
+        virtual bool IsHash(const std::string& hash) override;
+
+
+      private:
+
+        /**
+         * Used for loading the properties only once.
+         */
+        static granada::util::mutex::call_once load_properties_call_once_;
+
+
+        /**
+         * log2 of the scrypt CPU/memory cost parameter N.
+         */
+        static int scrypt_ln_;
+
+
+        /**
+         * scrypt block size parameter r.
+         */
+        static int scrypt_r_;
+
+
+        /**
+         * scrypt parallelization parameter p.
+         */
+        static int scrypt_p_;
+
+
+        /**
+         * PBKDF2 iterations, used when openssl does not provide scrypt.
+         */
+        static int pbkdf2_iterations_;
+
+
+        /**
+         * Dedicated pool where the keys are derived.
+         */
+        static std::unique_ptr<granada::util::thread::BoundedThreadPool> pool_;
+
+
+        /**
+         * Successful verifications: digest of hash and password => true.
+         */
+        static granada::cache::LocalRecordCache<bool> verifications_;
+
+
+        /**
+         * Loads properties given in the configuration file, if properties
+         * are not found, then default values included in granada/defaults.dat
+         * file are used.
+         */
+        void LoadProperties();
+
+
+        /**
+         * Derives the key of a password as described by the parameters
+         * of a hash, in the calling thread.
+         * @param  password   Password.
+         * @param  algorithm  "scrypt" or "pbkdf2-sha256".
+         * @param  parameters Cost parameters, example: ln=14,r=8,p=1
+         * @param  salt       Raw salt.
+         * @param  key        Derived raw key.
+         * @return            True if the key could be derived.
+         */
+        static bool Derive(const std::string& password,
+                           const std::string& algorithm,
+                           const std::string& parameters,
+                           const std::string& salt,
+                           std::string& key);
+
+
+        /**
+         * Runs a key derivation in the verification pool and waits for it.
+         * @param  fn Key derivation.
+         * @return    Result of the key derivation, false if the pool
+         *            rejected it because its queue is full.
+         */
+        static bool RunInPool(std::function<bool()> fn);
+    };
+  }
+}
@@ -0,0 +1,75 @@
+/**
+  * Copyright (c) <2016> granada <afernandez@cookinapps.io>
+  *
+  * This source code is licensed under the MIT license.
+  *
+  * Permission is hereby granted, free of charge, to any person obtaining a copy
+  * of this software and associated documentation files (the "Software"), to deal
+  * in the Software without restriction, including without limitation the rights
+  * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  * copies of the Software, and to permit persons to whom the Software is
+  * furnished to do so, subject to the following conditions:
+  *
+  * The above copyright notice and this permission notice shall be included in
+  * all copies or substantial portions of the Software.
+  *
+  * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  * SOFTWARE.
+  *
+  * Hashes and verifies passwords.
+  *
+  */
+
+#pragma once
+#include <string>
+
+namespace granada{
+  namespace crypto{
+    class PasswordVerifier{
+      public:
+
+        /**
+         * Constructor
+         */
+        PasswordVerifier(){};
+
+
+        /**
+         * Destructor
+         */
+        virtual ~PasswordVerifier(){};
+
+
+        /**
+         * Returns a self-describing hash of a password: algorithm,
+         * cost parameters, salt and derived key.
+         * @param  password Password to hash.
+         * @return          Hash of the password, empty if it could not be computed.
+         */
+        virtual std::string Hash(const std::string& password){ return std::string(); };
+
+
+        /**
+         * Checks a password against a hash returned by Hash.
+         * @param  password Password to check.
+         * @param  hash     Stored hash of the password.
+         * @return          True if the password matches the hash, false if not.
+         */
+        virtual bool Verify(const std::string& password, const std::string& hash){ return false; };
+
+
+        /**
+         * Returns true if the given text is a hash this verifier can check,
+         * used to tell hashes from keys stored in a previous format.
+         * @param  hash Stored hash or key.
+         * @return      True if the text is a hash of this verifier.
+         */
+        virtual bool IsHash(const std::string& hash){ return false; };
+    };
+  }
+}
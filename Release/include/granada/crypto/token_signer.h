@@ -0,0 +1,97 @@
+/**
+  * Copyright (c) <2016> granada <afernandez@cookinapps.io>
+  *
+  * This source code is licensed under the MIT license.
+  *
+  * Permission is hereby granted, free of charge, to any person obtaining a copy
+  * of this software and associated documentation files (the "Software"), to deal
+  * in the Software without restriction, including without limitation the rights
+  * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  * copies of the Software, and to permit persons to whom the Software is
+  * furnished to do so, subject to the following conditions:
+  *
+  * The above copyright notice and this permission notice shall be included in
+  * all copies or substantial portions of the Software.
+  *
+  * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  * SOFTWARE.
+  *
+  * Signs and verifies self-contained tokens.
+  *
+  */
+
+#pragma once
+#include <string>
+
+namespace granada{
+  namespace crypto{
+    class TokenSigner{
+      public:
+
+        /**
+         * Constructor
+         */
+        TokenSigner(){};
+
+
+        /**
+         * Destructor
+         */
+        virtual ~TokenSigner(){};
+
+
+        /**
+         * Adds or replaces a key used to sign and verify tokens.
+         * @param kid     Key id, identifies the key used to sign a token.
+         * @param secret  Secret key.
+         */
+        virtual void AddKey(const std::string& kid, const std::string& secret){};
+
+
+        /**
+         * Removes a key, tokens signed with it will not be valid anymore.
+         * @param kid Key id.
+         */
+        virtual void RemoveKey(const std::string& kid){};
+
+
+        /**
+         * Sets the key used to sign new tokens.
+         * @param  kid Key id, the key must have been added before.
+         * @return     True if the key exists, false if it does not.
+         */
+        virtual bool SetSigningKey(const std::string& kid){ return false; };
+
+
+        /**
+         * Returns true if the signer has a key to sign tokens with.
+         * @return True if tokens can be signed, false if not.
+         */
+        virtual bool CanSign(){ return false; };
+
+
+        /**
+         * Signs a payload and returns a self-contained token
+         * carrying the payload and its signature.
+         * @param  payload  Payload to sign.
+         * @return          Signed token, empty if it could not be signed.
+         */
+        virtual std::string Sign(const std::string& payload){ return std::string(); };
+
+
+        /**
+         * Verifies the signature of a token and extracts its payload.
+         * @param  token    Signed token.
+         * @param  payload  Payload of the token, only filled if the
+         *                  signature is valid.
+         * @return          True if the signature is valid, false if not.
+         */
+        virtual bool Verify(const std::string& token, std::string& payload){ return false; };
+    };
+  }
+}
@@ -0,0 +1,81 @@
+/**
+  * Copyright (c) <2016> Web App SDK granada <afernandez@cookinapps.io>
+  *
+  * This source code is licensed under the MIT license.
+  *
+  * Permission is hereby granted, free of charge, to any person obtaining a copy
+  * of this software and associated documentation files (the "Software"), to deal
+  * in the Software without restriction, including without limitation the rights
+  * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  * copies of the Software, and to permit persons to whom the Software is
+  * furnished to do so, subject to the following conditions:
+  *
+  * The above copyright notice and this permission notice shall be included in
+  * all copies or substantial portions of the Software.
+  *
+  * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  * SOFTWARE.
+  *
+  * Responds with the metrics of the application in the
+  * Prometheus text format, and with the recorded traces.
+  *
+  */
+#pragma once
+#include "cpprest/details/basic_types.h"
+#include "granada/http/controller/controller.h"
+#include "granada/util/metrics.h"
+#include "granada/util/tracing.h"
+
+namespace granada{
+  namespace http{
+    namespace controller{
+
+      /**
+       * Responds to GET requests with the metrics registered in
+       * granada::util::metrics in the Prometheus text format, so
+       * they can be read by a scraper.
+       *
+       * Responds to GET requests to the "trace" sub-path with the spans
+       * recorded by granada::util::tracing in the Chrome trace event format.
+       *
+       * The metrics are not protected, the controller should listen
+       * to an address only reachable from the local network.
+       *
+       * Example:
+       *    MetricsController metrics_controller(U("http://127.0.0.1:9100/metrics"));
+       *    metrics_controller.open().wait();
+       */
+      class MetricsController : public Controller
+      {
+
+      public:
+
+
+        /**
+         * Constructor
+         * @param   url  URI the controller listens to.
+         */
+        MetricsController(utility::string_t url);
+
+
+        /**
+         * Destructor
+         */
+        virtual ~MetricsController(){};
+
+
+      private:
+
+
+        // override
+        void handle_get(web::http::http_request request);
+
+      };
+    }
+  }
+}
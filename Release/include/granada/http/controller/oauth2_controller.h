@@ -33,6 +33,7 @@
 #include "cpprest/json.h"
 #include "granada/util/mutex.h"
 #include "granada/util/string.h"
+#include "granada/util/html.h"
 #include "granada/util/file.h"
 #include "granada/http/parser.h"
 #include "granada/http/http_msg.h"
@@ -93,17 +94,17 @@ namespace granada{
 
 
           /**
-           * HTML of the authorizing login page to show when the user
+           * Parsed HTML of the authorizing login page to show when the user
            * is not already logged.
            */
-          static std::string oauth2_authorizing_login_template_;
+          static granada::util::html::Template oauth2_authorizing_login_template_;
 
 
           /**
-           * HTML of the authorizing login page to show when the user
+           * Parsed HTML of the authorizing login page to show when the user
            * is already logged.
            */
-          static std::string oauth2_authorizing_message_template_;
+          static granada::util::html::Template oauth2_authorizing_message_template_;
 
 
           /**
@@ -115,9 +116,9 @@ namespace granada{
 
           /**
            * HTML of the page to show when a user tries to access a wrong
-           * URL.
+           * URL, rendered once when the properties are loaded.
            */
-          static std::string oauth2_authorizing_error_template_;
+          static std::string oauth2_forbidden_page_;
 
 
           /**
@@ -33,7 +33,9 @@
 #include "granada/http/oauth2/oauth2.h"
 #include "granada/cache/shared_map_cache_driver.h"
 #include "granada/crypto/nonce_generator.h"
-#include "granada/crypto/openssl_aes_cryptograph.h"
+#include "granada/crypto/openssl_evp_cryptograph.h"
+#include "granada/crypto/openssl_hmac_token_signer.h"
+#include "granada/crypto/openssl_scrypt_password_verifier.h"
 
 namespace granada{
 
@@ -150,6 +152,11 @@ namespace granada{
             return n_generator_.get();
           };
 
+          // override
+          virtual granada::crypto::PasswordVerifier* password_verifier() override {
+            return password_verifier_.get();
+          };
+
 
 
         private:
@@ -177,6 +184,12 @@ namespace granada{
            * Generate a nonce string containing random alphanumeric characters (A-Za-z0-9).
            */
           static std::unique_ptr<granada::crypto::NonceGenerator> n_generator_;
+
+
+          /**
+           * Password verifier to hash and verify user passwords.
+           */
+          static std::unique_ptr<granada::crypto::PasswordVerifier> password_verifier_;
       };
 
 
@@ -273,6 +286,16 @@ namespace granada{
             return cache_.get();
           };
 
+          // override
+          virtual granada::crypto::NonceGenerator* nonce_generator() override {
+            return n_generator_.get();
+          };
+
+          // override
+          virtual granada::crypto::TokenSigner* token_signer() override {
+            return token_signer_.get();
+          };
+
 
         protected:
 
@@ -302,6 +325,18 @@ namespace granada{
           static std::unique_ptr<granada::cache::CacheHandler> cache_;
 
 
+          /**
+           * Nonce string generator, used to generate the ids of the signed access tokens.
+           */
+          static std::unique_ptr<granada::crypto::NonceGenerator> n_generator_;
+
+
+          /**
+           * Signer used to sign and verify self-contained access tokens.
+           */
+          static std::unique_ptr<granada::crypto::TokenSigner> token_signer_;
+
+
           
       };
 
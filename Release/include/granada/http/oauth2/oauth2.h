@@ -31,6 +31,7 @@
 #pragma once
 
 #include <string>
+#include <algorithm>
 #include <deque>
 #include <unordered_map>
 #include "cpprest/details/basic_types.h"
@@ -45,8 +46,11 @@
 #include "granada/http/parser.h"
 #include "granada/http/session/session.h"
 #include "granada/cache/cache_handler.h"
+#include "granada/cache/local_record_cache.h"
 #include "granada/crypto/cryptograph.h"
+#include "granada/crypto/password_verifier.h"
 #include "granada/crypto/nonce_generator.h"
+#include "granada/crypto/token_signer.h"
 
 /**
  * OAuth 2.0 authorization errors.
@@ -153,29 +157,23 @@ namespace granada{
            * @param query_string Query string from HTTP request.
            */
           OAuth2Parameters(const std::string& query_string){
-            try{
-              std::unordered_map<std::string, std::string>  parsed_data =	granada::http::parser::ParseQueryString(query_string);
-              username.assign(parsed_data[oauth2_strings_2::username]);
-              password.assign(parsed_data[oauth2_strings_2::password]);
-			  code.assign(parsed_data[utility::conversions::to_utf8string(oauth2_strings::code)]);
-              authorize.assign(parsed_data[oauth2_strings_2::authorize]);
-			  access_token.assign(parsed_data[utility::conversions::to_utf8string(oauth2_strings::access_token)]);
-			  expires_in.assign(parsed_data[utility::conversions::to_utf8string(oauth2_strings::expires_in)]);
-			  refresh_token.assign(parsed_data[utility::conversions::to_utf8string(oauth2_strings::refresh_token)]);
-			  token_type.assign(parsed_data[utility::conversions::to_utf8string(oauth2_strings::token_type)]);
-			  grant_type.assign(parsed_data[utility::conversions::to_utf8string(oauth2_strings::grant_type)]);
-			  response_type.assign(parsed_data[utility::conversions::to_utf8string(oauth2_strings::response_type)]);
-			  client_id.assign(parsed_data[utility::conversions::to_utf8string(oauth2_strings::client_id)]);
-			  client_secret.assign(parsed_data[utility::conversions::to_utf8string(oauth2_strings::client_secret)]);
-			  redirect_uri.assign(parsed_data[utility::conversions::to_utf8string(oauth2_strings::redirect_uri)]);
-			  scope.assign(parsed_data[utility::conversions::to_utf8string(oauth2_strings::scope)]);
-			  state.assign(parsed_data[utility::conversions::to_utf8string(oauth2_strings::state)]);
-              error.assign(parsed_data[oauth2_errors::error]);
-              error_description.assign(parsed_data[oauth2_errors::error_description]);
-            }catch(const std::exception e){}
+            Parse(query_string);
           };
 
 
+          /**
+           * Parses a query string or an application/x-www-form-urlencoded body
+           * and fills the OAuth 2.0 parameters it contains, in a single pass
+           * and without intermediate maps: each known field name is looked up
+           * in a table of parameter slots and its value is percent-decoded
+           * directly into the slot. Unknown fields and empty values are ignored,
+           * if a field is repeated the last value is kept.
+           * @param query_string Query string or form body, example:
+           *                     grant_type=authorization_code&code=SplxlOBeZQQYbYS6WxSbIA
+           */
+          void Parse(const std::string& query_string);
+
+
           /**
            * Convert OAuth 2.0 parameters into a unordered_map.
            *
@@ -183,17 +181,17 @@ namespace granada{
            */
           std::unordered_map<std::string,std::string> to_unordered_map(){
             std::unordered_map<std::string,std::string> map;
-			if (!code.empty()){ map.insert(std::make_pair(utility::conversions::to_utf8string(oauth2_strings::code), code)); }
-			if (!access_token.empty()){ map.insert(std::make_pair(utility::conversions::to_utf8string(oauth2_strings::access_token), access_token)); }
-			if (!expires_in.empty()){ map.insert(std::make_pair(utility::conversions::to_utf8string(oauth2_strings::expires_in), expires_in)); }
-			if (!refresh_token.empty()){ map.insert(std::make_pair(utility::conversions::to_utf8string(oauth2_strings::refresh_token), refresh_token)); }
-			if (!token_type.empty()){ map.insert(std::make_pair(utility::conversions::to_utf8string(oauth2_strings::token_type), token_type)); }
-			if (!grant_type.empty()){ map.insert(std::make_pair(utility::conversions::to_utf8string(oauth2_strings::grant_type), grant_type)); }
-			if (!response_type.empty()){ map.insert(std::make_pair(utility::conversions::to_utf8string(oauth2_strings::response_type), response_type)); }
-			if (!client_id.empty()){ map.insert(std::make_pair(utility::conversions::to_utf8string(oauth2_strings::client_id), client_id)); }
-			if (!redirect_uri.empty()){ map.insert(std::make_pair(utility::conversions::to_utf8string(oauth2_strings::redirect_uri), redirect_uri)); }
-			if (!scope.empty()){ map.insert(std::make_pair(utility::conversions::to_utf8string(oauth2_strings::scope), scope)); }
-			if (!state.empty()){ map.insert(std::make_pair(utility::conversions::to_utf8string(oauth2_strings::state), state)); }
+			if (!code.empty()){ map.insert(std::make_pair(oauth2_strings_2::code, code)); }
+			if (!access_token.empty()){ map.insert(std::make_pair(oauth2_strings_2::access_token, access_token)); }
+			if (!expires_in.empty()){ map.insert(std::make_pair(oauth2_strings_2::expires_in, expires_in)); }
+			if (!refresh_token.empty()){ map.insert(std::make_pair(oauth2_strings_2::refresh_token, refresh_token)); }
+			if (!token_type.empty()){ map.insert(std::make_pair(oauth2_strings_2::token_type, token_type)); }
+			if (!grant_type.empty()){ map.insert(std::make_pair(oauth2_strings_2::grant_type, grant_type)); }
+			if (!response_type.empty()){ map.insert(std::make_pair(oauth2_strings_2::response_type, response_type)); }
+			if (!client_id.empty()){ map.insert(std::make_pair(oauth2_strings_2::client_id, client_id)); }
+			if (!redirect_uri.empty()){ map.insert(std::make_pair(oauth2_strings_2::redirect_uri, redirect_uri)); }
+			if (!scope.empty()){ map.insert(std::make_pair(oauth2_strings_2::scope, scope)); }
+			if (!state.empty()){ map.insert(std::make_pair(oauth2_strings_2::state, state)); }
             if (!error.empty()){ map.insert(std::make_pair(oauth2_errors::error,error)); }
             if (!error_description.empty()){ map.insert(std::make_pair(oauth2_errors::error_description,error_description)); }
             return map;
@@ -209,17 +207,17 @@ namespace granada{
            */
           std::string to_query_string(){
             std::string query_string = "";
-			if (!code.empty()){ query_string += "&" + utility::conversions::to_utf8string(oauth2_strings::code) + "=" + code; }
-			if (!access_token.empty()){ query_string += "&" + utility::conversions::to_utf8string(oauth2_strings::access_token) + "=" + access_token; }
-			if (!expires_in.empty()){ query_string += "&" + utility::conversions::to_utf8string(oauth2_strings::expires_in) + "=" + expires_in; }
-			if (!refresh_token.empty()){ query_string += "&" + utility::conversions::to_utf8string(oauth2_strings::refresh_token) + "=" + refresh_token; }
-			if (!token_type.empty()){ query_string += "&" + utility::conversions::to_utf8string(oauth2_strings::token_type) + "=" + token_type; }
-			if (!grant_type.empty()){ query_string += "&" + utility::conversions::to_utf8string(oauth2_strings::grant_type) + "=" + grant_type; }
-			if (!response_type.empty()){ query_string += "&" + utility::conversions::to_utf8string(oauth2_strings::response_type) + "=" + response_type; }
-			if (!client_id.empty()){ query_string += "&" + utility::conversions::to_utf8string(oauth2_strings::client_id) + "=" + client_id; }
-			if (!redirect_uri.empty()){ query_string += "&" + utility::conversions::to_utf8string(oauth2_strings::redirect_uri) + "=" + redirect_uri; }
-			if (!scope.empty()){ query_string += "&" + utility::conversions::to_utf8string(oauth2_strings::scope) + "=" + scope; }
-			if (!state.empty()){ query_string += "&" + utility::conversions::to_utf8string(oauth2_strings::state) + "=" + state; }
+			if (!code.empty()){ query_string += "&" + oauth2_strings_2::code + "=" + code; }
+			if (!access_token.empty()){ query_string += "&" + oauth2_strings_2::access_token + "=" + access_token; }
+			if (!expires_in.empty()){ query_string += "&" + oauth2_strings_2::expires_in + "=" + expires_in; }
+			if (!refresh_token.empty()){ query_string += "&" + oauth2_strings_2::refresh_token + "=" + refresh_token; }
+			if (!token_type.empty()){ query_string += "&" + oauth2_strings_2::token_type + "=" + token_type; }
+			if (!grant_type.empty()){ query_string += "&" + oauth2_strings_2::grant_type + "=" + grant_type; }
+			if (!response_type.empty()){ query_string += "&" + oauth2_strings_2::response_type + "=" + response_type; }
+			if (!client_id.empty()){ query_string += "&" + oauth2_strings_2::client_id + "=" + client_id; }
+			if (!redirect_uri.empty()){ query_string += "&" + oauth2_strings_2::redirect_uri + "=" + redirect_uri; }
+			if (!scope.empty()){ query_string += "&" + oauth2_strings_2::scope + "=" + scope; }
+			if (!state.empty()){ query_string += "&" + oauth2_strings_2::state + "=" + state; }
             if (!error.empty()){ query_string+="&"+oauth2_errors::error+"="+error; }
             if (!error_description.empty()){ query_string+="&"+oauth2_errors::error_description+"="+error_description; }
             if (!query_string.empty()){
@@ -244,17 +242,17 @@ namespace granada{
            */
           web::json::value to_json(){
             std::string json_str = "";
-			if (!code.empty()){ json_str += ",\"" + utility::conversions::to_utf8string(oauth2_strings::code) + "\":\"" + code + "\""; }
-			if (!access_token.empty()){ json_str += ",\"" + utility::conversions::to_utf8string(oauth2_strings::access_token) + "\":\"" + access_token + "\""; }
-			if (!expires_in.empty()){ json_str += ",\"" + utility::conversions::to_utf8string(oauth2_strings::expires_in) + "\":\"" + expires_in + "\""; }
-			if (!refresh_token.empty()){ json_str += ",\"" + utility::conversions::to_utf8string(oauth2_strings::refresh_token) + "\":\"" + refresh_token + "\""; }
-			if (!token_type.empty()){ json_str += ",\"" + utility::conversions::to_utf8string(oauth2_strings::token_type) + "\":\"" + token_type + "\""; }
-			if (!grant_type.empty()){ json_str += ",\"" + utility::conversions::to_utf8string(oauth2_strings::grant_type) + "\":\"" + grant_type + "\""; }
-			if (!response_type.empty()){ json_str += ",\"" + utility::conversions::to_utf8string(oauth2_strings::response_type) + "\":\"" + response_type + "\""; }
-			if (!client_id.empty()){ json_str += ",\"" + utility::conversions::to_utf8string(oauth2_strings::client_id) + "\":\"" + client_id + "\""; }
-			if (!redirect_uri.empty()){ json_str += ",\"" + utility::conversions::to_utf8string(oauth2_strings::redirect_uri) + "\":\"" + redirect_uri + "\""; }
-			if (!scope.empty()){ json_str += ",\"" + utility::conversions::to_utf8string(oauth2_strings::scope) + "\":\"" + scope + "\""; }
-			if (!state.empty()){ json_str += ",\"" + utility::conversions::to_utf8string(oauth2_strings::state) + "\":\"" + state + "\""; }
+			if (!code.empty()){ json_str += ",\"" + oauth2_strings_2::code + "\":\"" + code + "\""; }
+			if (!access_token.empty()){ json_str += ",\"" + oauth2_strings_2::access_token + "\":\"" + access_token + "\""; }
+			if (!expires_in.empty()){ json_str += ",\"" + oauth2_strings_2::expires_in + "\":\"" + expires_in + "\""; }
+			if (!refresh_token.empty()){ json_str += ",\"" + oauth2_strings_2::refresh_token + "\":\"" + refresh_token + "\""; }
+			if (!token_type.empty()){ json_str += ",\"" + oauth2_strings_2::token_type + "\":\"" + token_type + "\""; }
+			if (!grant_type.empty()){ json_str += ",\"" + oauth2_strings_2::grant_type + "\":\"" + grant_type + "\""; }
+			if (!response_type.empty()){ json_str += ",\"" + oauth2_strings_2::response_type + "\":\"" + response_type + "\""; }
+			if (!client_id.empty()){ json_str += ",\"" + oauth2_strings_2::client_id + "\":\"" + client_id + "\""; }
+			if (!redirect_uri.empty()){ json_str += ",\"" + oauth2_strings_2::redirect_uri + "\":\"" + redirect_uri + "\""; }
+			if (!scope.empty()){ json_str += ",\"" + oauth2_strings_2::scope + "\":\"" + scope + "\""; }
+			if (!state.empty()){ json_str += ",\"" + oauth2_strings_2::state + "\":\"" + state + "\""; }
             if (!error.empty()){ json_str+=",\""+oauth2_errors::error+"\":\""+error+"\""; }
             if (!error_description.empty()){ json_str+=",\""+oauth2_errors::error_description+"\":\""+error_description+"\""; }
             if (json_str.empty()){
@@ -526,6 +524,28 @@ namespace granada{
           static int client_id_length_;
 
 
+          /**
+           * Already loaded client values, used to avoid reading them
+           * from the cache each time a client is loaded.
+           */
+          struct Record{
+            std::string key;
+            std::string type;
+            std::string application_name;
+            std::vector<std::string> redirect_uris;
+            std::vector<std::string> roles;
+            std::time_t creation_time;
+          };
+
+
+          /**
+           * Process-local cache of the loaded clients, records expire after
+           * "oauth2_client_cache_ttl" seconds and are invalidated when the
+           * client is created or deleted in this process.
+           */
+          static granada::cache::LocalRecordCache<Record> records_;
+
+
           /**
            * Client id. Unique alphanumeric hash.
            */
@@ -706,6 +726,17 @@ namespace granada{
           };
 
 
+          /**
+           * Returns the password verifier used to hash the user passwords,
+           * if there is none the key of the user is the username encrypted
+           * with the password by the cryptograph.
+           * return Password verifier.
+           */
+          virtual granada::crypto::PasswordVerifier* password_verifier(){
+            return nullptr;
+          };
+
+
         protected:
 
           /**
@@ -723,6 +754,25 @@ namespace granada{
           static std::string cache_namespace_;
 
 
+          /**
+           * Already loaded user values, used to avoid reading them
+           * from the cache each time a user is loaded.
+           */
+          struct Record{
+            std::string key;
+            web::json::value roles;
+            std::time_t creation_time;
+          };
+
+
+          /**
+           * Process-local cache of the loaded users, records expire after
+           * "oauth2_user_cache_ttl" seconds and are invalidated when the
+           * user is created or deleted in this process.
+           */
+          static granada::cache::LocalRecordCache<Record> records_;
+
+
           /**
            * Username. Unique identifier of the user.
            */
@@ -730,7 +780,9 @@ namespace granada{
 
 
           /**
-           * Crypted key, used with the user password to verify the client credentials
+           * Hash of the user password given by the password verifier, or for users
+           * created without password verifier the username encrypted with the
+           * password. Used with the user password to verify the user credentials
            * when needed.
            */
           std::string key_;
@@ -847,6 +899,14 @@ namespace granada{
           virtual void Delete();
 
 
+          /**
+           * Delete several codes from where they are stored at once.
+           * Changes the code of this object.
+           * @param codes Codes to delete.
+           */
+          virtual void Delete(const std::vector<std::string>& codes);
+
+
           virtual const std::string GetCode(){
             return code_;
           };
@@ -954,6 +1014,121 @@ namespace granada{
 
       };
 
+      /**
+       * Access token presented to a resource server: the token of a server
+       * session or a verified signed access token, see
+       * OAuth2Authorization::AccessToken. Gives the roles granted to the
+       * client the same way as granada::http::session::SessionRoles, so
+       * resource servers do not depend on the type of access token.
+       */
+      class OAuth2AccessToken{
+        public:
+
+          /**
+           * Constructor
+           * @param session   Server session loaded with the access token.
+           */
+          OAuth2AccessToken(std::unique_ptr<granada::http::session::Session> session) : session_(std::move(session)), claims_(web::json::value::null()){};
+
+
+          /**
+           * Constructor
+           * @param claims    Claims of a verified signed access token,
+           *                  null if the token could not be verified.
+           */
+          OAuth2AccessToken(const web::json::value& claims) : claims_(claims){};
+
+
+          /**
+           * Returns true if the access token is a valid session token or
+           * a signed token that has been verified.
+           * @return  True if the access token is valid.
+           */
+          bool IsValid(){
+            if (session_){
+              return !session_->GetToken().empty() && session_->IsValid();
+            }
+            return claims_.is_object();
+          };
+
+
+          /**
+           * Returns true if the access token grants the given role.
+           * @param  role_name  Name of the role. Example: "msg.select".
+           * @return            True if the role is granted.
+           */
+          bool Is(const std::string& role_name){
+            if (session_){
+              return session_->roles()->Is(role_name);
+            }
+            return role_properties(role_name).is_object();
+          };
+
+
+          /**
+           * Returns the value of a property of a granted role.
+           * @param  role_name  Name of the role. Example: "msg.select".
+           * @param  key        Key of the property. Example: "username".
+           * @return            Value of the property, empty if the role is not
+           *                    granted or does not have the property.
+           */
+          std::string GetProperty(const std::string& role_name, const std::string& key){
+            if (session_){
+              return session_->roles()->GetProperty(role_name,key);
+            }
+            const web::json::value& properties = role_properties(role_name);
+            const utility::string_t& key_t = utility::conversions::to_string_t(key);
+            if (properties.is_object() && properties.has_field(key_t) && properties.at(key_t).is_string()){
+              return utility::conversions::to_utf8string(properties.at(key_t).as_string());
+            }
+            return std::string();
+          };
+
+
+          /**
+           * Returns the server session of the access token.
+           * @return  Server session, nullptr if the access token is a signed token.
+           */
+          granada::http::session::Session* session(){
+            return session_.get();
+          };
+
+
+          /**
+           * Returns the claims of a signed access token: sub, client_id, scope, roles, iat, exp and jti.
+           * @return  Claims, null if the access token is a session token or could not be verified.
+           */
+          const web::json::value& claims(){
+            return claims_;
+          };
+
+
+        private:
+
+          std::unique_ptr<granada::http::session::Session> session_;
+
+          web::json::value claims_;
+
+
+          /**
+           * Returns the properties of a role in the claims.
+           * @param  role_name  Name of the role.
+           * @return            JSON object with the properties, null if the role is not granted.
+           */
+          web::json::value role_properties(const std::string& role_name){
+            const utility::string_t& roles_key = utility::conversions::to_string_t(entity_keys::oauth2_claim_roles);
+            const utility::string_t& role_key = utility::conversions::to_string_t(role_name);
+            if (claims_.is_object() && claims_.has_field(roles_key)){
+              const web::json::value& roles = claims_.at(roles_key);
+              if (roles.is_object() && roles.has_field(role_key)){
+                return roles.at(role_key);
+              }
+            }
+            return web::json::value::null();
+          };
+      };
+
+
       /**
        * Authorize a client.
        * Authorization Code Grant and Implicit Grant.
@@ -988,6 +1163,8 @@ namespace granada{
            * Returns information about the clients authorized by a given user
            * or the codes used by a client to obtain access_tokens. The username and
            * the client_id are taken from the oauth2_parameters_ member.
+           * The first call for a user indexes the authorizations granted
+           * before the indexes existed, see MigrateIndex().
            * @return JSON containing an array with the clients authorized by a user
            *         or a list with the codes used by a client.
            */
@@ -1003,6 +1180,54 @@ namespace granada{
           virtual web::json::value Delete();
 
 
+          /**
+           * Verifies a signed access token: its signature, its expiration time
+           * and, unless "oauth2_access_token_check_revocation" property is false, that
+           * it has not been revoked. Used by resource servers to validate signed
+           * access tokens without reading a session from the cache.
+           * @param  access_token Signed access token.
+           * @param  claims       JSON object filled with the claims of the token:
+           *                      sub, client_id, scope, roles, iat, exp and jti.
+           * @return              True if the access token is valid, false if not.
+           */
+          virtual bool VerifyAccessToken(const std::string& access_token, web::json::value& claims);
+
+
+          /**
+           * Returns the access token presented to a resource server, whatever its type:
+           * signed access tokens are verified with VerifyAccessToken, the other tokens
+           * are server sessions loaded with the session factory.
+           * Example:@code
+           *   std::unique_ptr<granada::http::oauth2::OAuth2AccessToken> access_token = oauth2_authorization->AccessToken(token);
+           *   if (access_token->Is("msg.select")){
+           *     std::string username = access_token->GetProperty("msg.select","username");
+           *   }@endcode
+           * @param  access_token Access token.
+           * @return              Access token, check it with IsValid or Is.
+           */
+          virtual std::unique_ptr<granada::http::oauth2::OAuth2AccessToken> AccessToken(const std::string& access_token);
+
+
+          /**
+           * Returns true if the given access token is a signed access token
+           * and not the token of a server session.
+           * @param  access_token Access token.
+           * @return              True if the access token is a signed token.
+           */
+          static bool IsSignedAccessToken(const std::string& access_token){
+            return access_token.find('.') != std::string::npos;
+          };
+
+
+          /**
+           * Returns the signer used to sign and verify self-contained access tokens.
+           * @return Token signer.
+           */
+          virtual granada::crypto::TokenSigner* token_signer(){
+            return nullptr;
+          };
+
+
         protected:
 
 
@@ -1015,12 +1240,44 @@ namespace granada{
           static std::string cache_namespace_;
 
 
+          /**
+           * Namespace of the indexes used to find the authorizations given by a user
+           * without scanning the cache keys.
+           * Example:
+           *  oauth2.authorization.index:johndoe                         => clients authorized by johndoe.
+           *  oauth2.authorization.index:johndoe:gida8fZEFh9abpkg:codes  => codes of the client.
+           *  oauth2.authorization.index:johndoe:gida8fZEFh9abpkg:tokens => access tokens of the client.
+           */
+          static std::string index_namespace_;
+
+
           /**
            * If true when client request an access token a refresh token is also delivered.
            * The refresh token can be used to obtain new access tokens using the same
            * authorization grant.
            */
           static bool oauth2_use_refresh_token_;
+
+
+          /**
+           * If true access tokens are self-contained tokens signed with the
+           * token signer instead of server sessions. Taken from the
+           * "oauth2_access_token_type" property, "signed" or "session".
+           */
+          static bool oauth2_signed_access_token_;
+
+
+          /**
+           * Seconds a signed access token is valid.
+           */
+          static long oauth2_access_token_timeout_;
+
+
+          /**
+           * If true signed access tokens are checked against the list of
+           * revoked tokens when verified. This costs a read in the cache.
+           */
+          static bool oauth2_access_token_check_revocation_;
           
 
           /**
@@ -1028,7 +1285,7 @@ namespace granada{
            * It is used to create a new session without knowing its type.
            * Used to create OAuth 2.0 user sessions and OAuth 2.0 client sessions.
            */
-          granada::http::session::SessionFactory* session_factory_;
+          granada::http::session::SessionFactory* session_factory_ = nullptr;
 
 
           /**
@@ -1062,10 +1319,79 @@ namespace granada{
            * @return Key made with the user, the client, the code and the session identifiers.
            */
           virtual const std::string hash() override {
-            return cache_namespace_ + oauth2_parameters_.username + ":" + oauth2_parameters_.client_id + ":" + oauth2_parameters_.code + ":" + oauth2_parameters_.access_token;
+            return authorization_hash(oauth2_parameters_.code, oauth2_parameters_.access_token);
+          };
+
+
+          /**
+           * Returns the key made with the user and the client of the OAuth 2.0 parameters
+           * and the given code and access token.
+           * @param  code         OAuth 2.0 code, may be empty.
+           * @param  access_token Access token, may be empty.
+           * @return              Key made with the user, the client, the code and the session identifiers.
+           */
+          virtual const std::string authorization_hash(const std::string& code, const std::string& access_token){
+            return cache_namespace_ + oauth2_parameters_.username + ":" + oauth2_parameters_.client_id + ":" + code + ":" + access_token;
+          };
+
+
+          /**
+           * Returns the key of the index containing the ids of the clients
+           * authorized by the user, its empty field is set once the user's
+           * authorizations are indexed, see MigrateIndex().
+           * Example:
+           * 			oauth2.authorization.index:johndoe
+           * @return Key of the user's clients index.
+           */
+          virtual const std::string clients_index_hash(){
+            return index_namespace_ + oauth2_parameters_.username;
+          };
+
+
+          /**
+           * Returns the key of the index containing the codes (and refresh tokens)
+           * given to a client by the user.
+           * Example:
+           * 			oauth2.authorization.index:johndoe:gida8fZEFh9abpkg:codes
+           * @return Key of the client's codes index.
+           */
+          virtual const std::string codes_index_hash(){
+            return index_namespace_ + oauth2_parameters_.username + ":" + oauth2_parameters_.client_id + ":" + entity_keys::oauth2_authorization_index_codes;
+          };
+
+
+          /**
+           * Returns the key of the index containing the access tokens given to a
+           * client by the user, each access token is associated with the code used
+           * to obtain it, if any.
+           * Example:
+           * 			oauth2.authorization.index:johndoe:gida8fZEFh9abpkg:tokens
+           * @return Key of the client's access tokens index.
+           */
+          virtual const std::string tokens_index_hash(){
+            return index_namespace_ + oauth2_parameters_.username + ":" + oauth2_parameters_.client_id + ":" + entity_keys::oauth2_authorization_index_tokens;
           };
 
 
+          /**
+           * Stores the user, client, code and access token relation of the
+           * OAuth 2.0 parameters in the authorization indexes, so the clients
+           * authorized by a user and their codes and tokens can be retrieved
+           * and revoked without scanning the cache.
+           */
+          virtual void Index();
+
+
+          /**
+           * Indexes the authorizations of the user granted before the
+           * authorization indexes existed, otherwise they would not be listed
+           * by Information() nor revoked by Delete(). The cache keys of the user
+           * are scanned once, then the empty field of the user's clients index
+           * marks the user as indexed.
+           */
+          virtual void MigrateIndex();
+
+
           /**
            * Checks the validity of a client based on the client URI and the client id.
            * If something is wrong explicit it in oauth2_response filling the error and
@@ -1155,11 +1481,65 @@ namespace granada{
                                           web::http::http_response& response);
 
 
+          /**
+           * Creates a self-contained access token signed with the token signer,
+           * carrying the user, the client, the scope, the roles with their properties
+           * and the expiration time, so resource servers can validate it without
+           * reading a session from the cache.
+           * @param roles           Roles asked for the access token.
+           * @param user_roles      Roles of the user with their properties.
+           * @param oauth2_response OAuth 2.0 parameters containing the response: error or generated access token.
+           */
+          virtual void CreateSignedAccessToken(std::vector<std::string>& roles,
+                                               const web::json::value& user_roles,
+                                               granada::http::oauth2::OAuth2Parameters& oauth2_response);
+
+
+          /**
+           * Adds a signed access token to the list of revoked tokens until it expires.
+           * Expired tokens are removed from the list.
+           * @param access_token Signed access token.
+           */
+          virtual void RevokeSignedAccessToken(const std::string& access_token);
+
+
+          /**
+           * Adds several signed access tokens to the list of revoked tokens until
+           * they expire. Each token is a field of the list of the tokens expiring in
+           * the same period, lists that have expired are removed once for all of them.
+           * @param access_tokens Signed access tokens.
+           */
+          virtual void RevokeSignedAccessTokens(const std::vector<std::string>& access_tokens);
+
+
+          /**
+           * Removes the lists of revoked signed access tokens whose tokens have all
+           * expired, without reading them: the first list not yet removed is kept
+           * in the cache and only the lists from that one to the current period are removed.
+           * @param now Current time.
+           */
+          virtual void PruneRevokedAccessTokens(const int64_t now);
+
+
+          /**
+           * Returns the key of the list of revoked signed access tokens expiring
+           * in the same period as the given expiration time.
+           * Example:
+           *  oauth2.access_token.revoked:24681357
+           * @param  expiration Expiration time of the signed access token.
+           * @return            Key of the list of revoked signed access tokens.
+           */
+          virtual const std::string revoked_hash(const int64_t expiration){
+            return cache_namespaces::oauth2_access_token_revoked + ":" + std::to_string(expiration / default_numbers::oauth2_access_token_revoked_period);
+          };
+
+
           /**
            * Creates a refresh token. The refresh token can be used to obtain new access tokens using the same
            * authorization grant.
            * @param oauth2_client_session OAuth 2.0 client session created when creating an access token.
            *                              So it is the session that allows the client to access the user's resources.
+           *                              nullptr in case of a signed access token.
            * @param oauth2_code           It is the refresh token. Refresh tokens are in our case the same as an
            *                              OAuth 2.0 code
            * @param oauth2_response       OAuth 2.0 parameters containing the response: error or generated code.
@@ -29,6 +29,7 @@
 #include <memory>
 #include <mutex>
 #include <string>
+#include <vector>
 #include "cpprest/details/basic_types.h"
 #include "cpprest/json.h"
 #include "cpprest/http_listener.h"
@@ -431,11 +432,10 @@ namespace granada{
 
           /**
            * Returns the key to identify the session data
-           * in the cache.
+           * in the cache. The token is tagged so all the keys of a session
+           * are stored in the same server, see CacheHandler::Tag().
            */
-          virtual const std::string session_data_hash(){
-            return cache_namespaces::session_data + token_;
-          };
+          virtual const std::string session_data_hash();
 
 
           /**
@@ -588,9 +588,7 @@ namespace granada{
            * @param role_name Name of the role.
            * @return          Returns the key to access a role data.
            */
-          virtual const std::string session_roles_hash(const std::string& role_name){
-            return cache_namespaces::session_roles + session_->GetToken() + ":" + role_name;
-          };
+          virtual const std::string session_roles_hash(const std::string& role_name);
       };
 
 
@@ -647,6 +645,20 @@ namespace granada{
           virtual void DeleteSession(granada::http::session::Session* session);
 
 
+          /**
+           * Closes several sessions at once. The sessions are removed from
+           * wherever they are stored with a single bulk operation, so their
+           * tokens stop being valid before this function returns, then the close
+           * callbacks are called and the roles removed in a separate thread.
+           * The close callbacks receive the token of the session and, as update
+           * time, the time the sessions were closed, the values stored with
+           * the session have already been removed. Exceptions thrown while
+           * closing a session are ignored.
+           * @param tokens Tokens of the sessions to close.
+           */
+          virtual void CloseSessions(const std::vector<std::string>& tokens);
+
+
           /**
            * Remove garbage sessions from wherever sessions are stored.
            * It can be called from an application control panel, or better
@@ -737,7 +749,7 @@ namespace granada{
            * @return      Key used to identify the session data in the cache.
            */
           virtual const std::string session_value_hash(const std::string& token){
-            return cache_namespaces::session_value + token;
+            return cache_namespaces::session_value + cache()->Tag(token);
           }
       };
 
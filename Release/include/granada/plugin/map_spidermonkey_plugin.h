@@ -114,6 +114,9 @@ namespace granada{
           MapSpidermonkeyPluginHandler::load_properties_call_once_.call([this](){
             this->LoadProperties();
           });
+          MapSpidermonkeyPluginHandler::runner_call_once_.call([](){
+            MapSpidermonkeyPluginHandler::runner_ = granada::runner::JavascriptRunner_unique_ptr();
+          });
         };
 
 
@@ -129,6 +132,9 @@ namespace granada{
           MapSpidermonkeyPluginHandler::load_properties_call_once_.call([this](){
             this->LoadProperties();
           });
+          MapSpidermonkeyPluginHandler::runner_call_once_.call([](){
+            MapSpidermonkeyPluginHandler::runner_ = granada::runner::JavascriptRunner_unique_ptr();
+          });
           MapSpidermonkeyPluginHandler::functions_to_runner_call_once_.call([this](){
             this->AddFunctionsToRunner();
           });
@@ -170,6 +176,16 @@ namespace granada{
         };
 
 
+        /**
+         * Returns a pointer to the responsible of running the native plug-ins,
+         * shared objects implementing the interface of granada/plugin/native_plugin.h.
+         * @return Pointer to the native plug-ins runner.
+         */
+        virtual granada::runner::NativeRunner* native_runner() override {
+          return MapSpidermonkeyPluginHandler::native_runner_.get();
+        };
+
+
       protected:
 
         /**
@@ -187,10 +203,23 @@ namespace granada{
 
         /**
          * Pointer to the responsible of running or executing the
-         * plug-in scripts/executables.
+         * plug-in scripts/executables. Created by the first Plug-in Handler
+         * as the runner depends on the "plugin_javascript_runner" property.
          */
         static std::unique_ptr<granada::runner::Runner> runner_;
 
+
+        /**
+         * Used for creating the runner only once.
+         */
+        static granada::util::mutex::call_once runner_call_once_;
+
+
+        /**
+         * Pointer to the responsible of running the native plug-ins.
+         */
+        static std::unique_ptr<granada::runner::NativeRunner> native_runner_;
+
     };
 
 
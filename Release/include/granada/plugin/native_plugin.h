@@ -0,0 +1,158 @@
+/**
+  * Copyright (c) <2016> Web App SDK granada <afernandez@cookinapps.io>
+  *
+  * This source code is licensed under the MIT license.
+  *
+  * Permission is hereby granted, free of charge, to any person obtaining a copy
+  * of this software and associated documentation files (the "Software"), to deal
+  * in the Software without restriction, including without limitation the rights
+  * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  * copies of the Software, and to permit persons to whom the Software is
+  * furnished to do so, subject to the following conditions:
+  *
+  * The above copyright notice and this permission notice shall be included in
+  * all copies or substantial portions of the Software.
+  *
+  * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  * SOFTWARE.
+  *
+  * C interface of the native plug-ins: shared objects (.so) placed
+  * in the server directory of a plug-in package next to their header,
+  * run by granada::runner::NativeRunner instead of a javascript runner.
+  * Native plug-ins run inside the server process, so they are only
+  * loaded when the "plugin_native" property is on, and only from the
+  * repositories listed in "plugin_native_repositories".
+  *
+  * Example of a package:
+  *    math/server/cube.json   {"id":"math.cube","events":["calculate"]}
+  *    math/server/cube.so
+  *
+  * Parameters, messages, configurations and responses are stringified
+  * JSON, encoded in UTF-8 and null terminated.
+  */
+
+#ifndef GRANADA_PLUGIN_NATIVE_PLUGIN_H
+#define GRANADA_PLUGIN_NATIVE_PLUGIN_H
+
+/**
+ * Version of the interface, passed to granada_plugin_init.
+ */
+#define GRANADA_NATIVE_PLUGIN_ABI_VERSION 1
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+  /**
+   * Information about the plug-in being called and the functions
+   * of the Plug-in Handler it can call, valid during the call.
+   */
+  typedef struct granada_plugin_context{
+
+    /**
+     * Id of the plug-in, example: "math.cube".
+     */
+    const char* plugin_id;
+
+    /**
+     * Id of the Plug-in Handler running the plug-in.
+     */
+    const char* plugin_handler_id;
+
+    /**
+     * Stringified JSON with the plug-in configuration.
+     */
+    const char* configuration;
+
+    /**
+     * Opaque pointer to pass to call.
+     */
+    void* host;
+
+    /**
+     * Calls one of the Plug-in Handler functions also available for
+     * the javascript plug-ins: "__sendMessage", "__setValue",
+     * "__getValue", "__destroyValue", "__clearValues", "__fire",
+     * "__runPlugin", "__remove" or "__removeEvents". The parameters
+     * are the same as the javascript plug-ins send, including the
+     * "__PLUGIN_ID" and "__PLUGIN_HANDLER_ID" fields.
+     * Returns a stringified JSON that has to be freed with release.
+     */
+    char* (*call)(void* host, const char* function_name, const char* parameters);
+
+    /**
+     * Frees a string returned by call.
+     */
+    void (*release)(char* str);
+
+  } granada_plugin_context;
+
+
+  /**
+   * Optional. Called once, when the shared object is loaded.
+   *
+   * @param abi_version   GRANADA_NATIVE_PLUGIN_ABI_VERSION of the server.
+   * @return              0 if the plug-in can be used, any other value if not.
+   */
+  int granada_plugin_init(unsigned int abi_version);
+
+
+  /**
+   * Required. Runs the plug-in, same as the "run" function of the
+   * javascript plug-ins.
+   *
+   * @param context     Plug-in being called.
+   * @param parameters  Stringified JSON with the parameters.
+   * @param event_name  Name of the fired event, NULL if the plug-in
+   *                    was not run by an event.
+   * @return            Stringified JSON with the response, freed with
+   *                    granada_plugin_free, or NULL for an empty response.
+   */
+  char* granada_plugin_run(const granada_plugin_context* context, const char* parameters, const char* event_name);
+
+
+  /**
+   * Optional. Called instead of granada_plugin_run when one of the
+   * events the plug-in listens to is fired.
+   *
+   * @param context     Plug-in being called.
+   * @param event_name  Name of the fired event.
+   * @param parameters  Stringified JSON with the event parameters.
+   * @return            Stringified JSON with the response, freed with
+   *                    granada_plugin_free, or NULL for an empty response.
+   */
+  char* granada_plugin_on_event(const granada_plugin_context* context, const char* event_name, const char* parameters);
+
+
+  /**
+   * Optional. Responds to a message sent by another plug-in, same
+   * as the "onMessage" function of the javascript plug-ins.
+   *
+   * @param context   Plug-in receiving the message.
+   * @param message   Stringified JSON with the message.
+   * @param from      Id of the sender of the message.
+   * @return          Stringified JSON with the response, freed with
+   *                  granada_plugin_free, or NULL if the plug-in does
+   *                  not respond.
+   */
+  char* granada_plugin_on_message(const granada_plugin_context* context, const char* message, const char* from);
+
+
+  /**
+   * Optional. Frees the responses returned by the plug-in,
+   * if it is not exported the responses are freed with free().
+   *
+   * @param response  Response returned by the plug-in.
+   */
+  void granada_plugin_free(char* response);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // GRANADA_PLUGIN_NATIVE_PLUGIN_H
@@ -45,8 +45,10 @@
 #include "granada/util/file.h"
 #include "granada/util/time.h"
 #include "granada/util/application.h"
+#include "granada/util/thread_pool.h"
 #include "granada/cache/cache_handler.h"
 #include "granada/runner/runner.h"
+#include "granada/runner/native_runner.h"
 
 
 namespace granada{
@@ -776,6 +778,46 @@ namespace granada{
         virtual void Fire(const std::string& event_name, web::json::value& parameters, function_void_json success, function_void_json failure);
 
 
+        /**
+         * Fires an event without waiting for the plug-ins listening to it,
+         * for the callers that do not need their responses.
+         * The event is queued and fired later by a background thread, through
+         * a Plug-in Handler with the same id created by the plugin_factory().
+         * The events of a Plug-in Handler are fired in the order they were
+         * queued, one after the other.
+         * 
+         * If there are no background threads ("plugin_event_workers" property
+         * is 0), there is no plugin_factory(), or too many events are waiting
+         * ("plugin_event_queue_size" property), the event is fired immediately
+         * as with Fire. If the "plugin_event_queue_persist" property is on, the
+         * waiting events are also kept in the cache, and fired when the Plug-in
+         * Handler is initialized again if the server stopped before firing them.
+         * 
+         * The order is only kept among the queued events: an event fired in the
+         * caller because too many events are waiting runs before the events of
+         * the same Plug-in Handler that are still waiting.
+         * The events queued before the Plug-in Handler is stopped or reset are
+         * not fired, they belong to the previous generation of the Plug-in Handler.
+         * 
+         * @param event_name  Name of the event. Example: "plugin_remove-after".
+         * @param parameters  Parameters in form of JSON object that are passed to the plug-ins
+         *                    that listen to the event.
+         */
+        virtual void FireAsync(const std::string& event_name, const web::json::value& parameters);
+
+
+        /**
+         * Stops the background threads of FireAsync: the events that are being
+         * fired are finished and the events waiting are dropped, those kept in
+         * the cache ("plugin_event_queue_persist" property) are fired when the
+         * Plug-in Handler is initialized again. Events fired with FireAsync
+         * afterwards are fired in the caller.
+         * It is called when the process exits, it can also be called before,
+         * example: when the server is shutting down.
+         */
+        static void StopAsyncEvents();
+
+
         /**
          * Plug-in function: This function can be called from the plug-in script. It fires an event. All the plug-ins
          * listening to the event will be run.
@@ -1046,6 +1088,31 @@ namespace granada{
         };
 
 
+        /**
+         * Returns a pointer to the responsible of running the native plug-ins,
+         * shared objects implementing the interface of granada/plugin/native_plugin.h.
+         * @return Pointer to the native plug-ins runner, nullptr if the
+         *         Plug-in Handler does not run native plug-ins.
+         */
+        virtual granada::runner::NativeRunner* native_runner(){
+          return nullptr;
+        };
+
+
+        /**
+         * Returns true if the shared object with the given path can be run as
+         * a native plug-in: native plug-ins are enabled ("plugin_native" property),
+         * there is a native_runner() and the shared object is inside one of the
+         * trusted repositories ("plugin_native_repositories" property, by default
+         * the public plug-ins directory). Symbolic links are resolved first, so
+         * the shared objects of the users repositories are never trusted.
+         * 
+         * @param library_path    Path of the shared object.
+         * @return                True if the native plug-in can be run.
+         */
+        virtual bool IsTrustedNativePath(const std::string& library_path);
+
+
         /**
          * Return the hash used to store the Plug-in Handler
          * values in the cache.
@@ -1101,6 +1168,19 @@ namespace granada{
         };
 
 
+        /**
+         * Return the hash used to store the events waiting
+         * to be fired asynchronously in the cache.
+         * @param event_key   Key of the waiting event, in the order the events were
+         *                    queued, or "*" to match all the waiting events.
+         * @return  Hash used to store the waiting events
+         *          in the cache.
+         */
+        virtual std::string plugin_event_queue_hash(const std::string& event_key){
+          return cache_namespaces::plugin_event_queue + id_ + ":" + event_key;
+        };
+
+
       protected:
 
         /**
@@ -1138,6 +1218,22 @@ namespace granada{
          * Used for setting the runner's functions only once.
          */
         static granada::util::mutex::call_once functions_to_runner_call_once_;
+
+
+        /**
+         * Background threads firing the events of FireAsync, the events of
+         * a Plug-in Handler are always fired by the same thread.
+         * nullptr if the events are fired in the caller.
+         * It is never deleted, StopAsyncEvents stops it when the process
+         * exits, so no event is fired while the static objects are destroyed.
+         */
+        static granada::util::thread::OrderedThreadPool* event_pool_;
+
+
+        /**
+         * Used for creating the event_pool_ only once.
+         */
+        static granada::util::mutex::call_once event_pool_call_once_;
         
 
         /**
@@ -1182,6 +1278,33 @@ namespace granada{
         virtual std::string GetUID();
 
 
+        /**
+         * Fires the events kept in the cache that were waiting to be fired
+         * asynchronously when the server stopped, in the order they were queued.
+         * Called when the Plug-in Handler is initialized.
+         */
+        virtual void FireQueuedEvents();
+
+
+        /**
+         * Fires an event queued by FireAsync, in a background thread.
+         * 
+         * @param plugin_factory      Plug-in Factory creating the Plug-in Handler.
+         * The event is not fired if the Plug-in Handler has been stopped or
+         * initialized again since the event was queued.
+         * 
+         * @param plugin_factory      Plug-in Factory creating the Plug-in Handler.
+         * @param plugin_handler_id   Id of the Plug-in Handler.
+         * @param generation          Generation of the Plug-in Handler when the event
+         *                            was queued, written in the cache by Init.
+         * @param event_name          Name of the event.
+         * @param parameters          Parameters passed to the plug-ins.
+         * @param event_hash          Hash of the event in the cache, empty if
+         *                            the event is not kept in the cache.
+         */
+        static void FireQueuedEvent(granada::plugin::PluginFactory* plugin_factory, const std::string& plugin_handler_id, const std::string& generation, const std::string& event_name, web::json::value parameters, const std::string& event_hash);
+
+
         /**
          * Preload the plug-ins of the given repositories,
          * so it is faster to load them when needed.
@@ -1505,6 +1628,53 @@ namespace granada{
         };
 
 
+        /**
+         * Returns true if the plug-in is a native plug-in, its header has
+         * "native":true and its script is the path of a shared object.
+         * @return  True if the plug-in is a native plug-in, false if it is not.
+         */
+        const bool IsNative(){
+          if (header_.is_object() && header_.has_field(entity_keys::plugin_header_native)){
+            const web::json::value& native = header_.at(entity_keys::plugin_header_native);
+            return native.is_boolean() && native.as_bool();
+          }
+          return false;
+        };
+
+
+        /**
+         * Returns true if the plug-in is a resident plug-in, its header
+         * has "resident":true, see granada/plugin/resident_plugin.h.
+         * Native plug-ins are never resident.
+         * @return  True if the plug-in is a resident plug-in, false if it is not.
+         */
+        const bool IsResident(){
+          if (header_.is_object() && header_.has_field(entity_keys::plugin_header_resident)){
+            const web::json::value& resident = header_.at(entity_keys::plugin_header_resident);
+            return resident.is_boolean() && resident.as_bool() && !IsNative();
+          }
+          return false;
+        };
+
+
+        /**
+         * Returns the number of seconds the results of the plug-in can be
+         * reused, its header has "cacheable":<seconds>. Only for plug-ins whose
+         * results depend on nothing but their parameters and configuration.
+         * Resident plug-ins keep a state, so they are never cacheable.
+         * @return  Seconds the results are kept, 0 if they are not.
+         */
+        const long CacheTTL(){
+          if (header_.is_object() && header_.has_field(entity_keys::plugin_header_cacheable)){
+            const web::json::value& cacheable = header_.at(entity_keys::plugin_header_cacheable);
+            if (cacheable.is_number() && cacheable.as_integer() > 0 && !IsResident()){
+              return cacheable.as_integer();
+            }
+          }
+          return 0;
+        };
+
+
       protected:
 
         /**
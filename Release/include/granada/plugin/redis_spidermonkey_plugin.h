@@ -30,6 +30,8 @@
 #pragma once
 #include "granada/plugin/spidermonkey_plugin.h"
 #include "granada/cache/redis_cache_driver.h"
+#include "granada/cache/redis_cache_invalidator.h"
+#include "granada/cache/tiered_cache_handler.h"
 
 
 namespace granada{
@@ -113,6 +115,9 @@ namespace granada{
           RedisSpidermonkeyPluginHandler::load_properties_call_once_.call([this](){
             this->LoadProperties();
           });
+          RedisSpidermonkeyPluginHandler::runner_call_once_.call([](){
+            RedisSpidermonkeyPluginHandler::runner_ = granada::runner::JavascriptRunner_unique_ptr();
+          });
         };
 
 
@@ -128,6 +133,9 @@ namespace granada{
           RedisSpidermonkeyPluginHandler::load_properties_call_once_.call([this](){
             this->LoadProperties();
           });
+          RedisSpidermonkeyPluginHandler::runner_call_once_.call([](){
+            RedisSpidermonkeyPluginHandler::runner_ = granada::runner::JavascriptRunner_unique_ptr();
+          });
           RedisSpidermonkeyPluginHandler::functions_to_runner_call_once_.call([this](){
             this->AddFunctionsToRunner();
           });
@@ -169,6 +177,16 @@ namespace granada{
         };
 
 
+        /**
+         * Returns a pointer to the responsible of running the native plug-ins,
+         * shared objects implementing the interface of granada/plugin/native_plugin.h.
+         * @return Pointer to the native plug-ins runner.
+         */
+        virtual granada::runner::NativeRunner* native_runner() override{
+          return RedisSpidermonkeyPluginHandler::native_runner_.get();
+        };
+
+
       protected:
 
 
@@ -187,10 +205,23 @@ namespace granada{
 
         /**
          * Pointer to the responsible of running or executing the
-         * plug-in scripts/executables.
+         * plug-in scripts/executables. Created by the first Plug-in Handler
+         * as the runner depends on the "plugin_javascript_runner" property.
          */
         static std::unique_ptr<granada::runner::Runner> runner_;
 
+
+        /**
+         * Used for creating the runner only once.
+         */
+        static granada::util::mutex::call_once runner_call_once_;
+
+
+        /**
+         * Pointer to the responsible of running the native plug-ins.
+         */
+        static std::unique_ptr<granada::runner::NativeRunner> native_runner_;
+
     };
 
 
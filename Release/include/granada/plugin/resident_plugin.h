@@ -0,0 +1,279 @@
+/**
+  * Copyright (c) <2016> Web App SDK granada <afernandez@cookinapps.io>
+  *
+  * This source code is licensed under the MIT license.
+  *
+  * Permission is hereby granted, free of charge, to any person obtaining a copy
+  * of this software and associated documentation files (the "Software"), to deal
+  * in the Software without restriction, including without limitation the rights
+  * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  * copies of the Software, and to permit persons to whom the Software is
+  * furnished to do so, subject to the following conditions:
+  *
+  * The above copyright notice and this permission notice shall be included in
+  * all copies or substantial portions of the Software.
+  *
+  * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  * SOFTWARE.
+  *
+  * Resident plug-in: a plug-in kept alive in a script instance, running
+  * its calls one after the other and keeping its state in memory.
+  *
+  * Example of a header:
+  *    {"id":"shop.counter","events":["product-sold"],"resident":true}
+  *
+  * Example of a script:
+  *    {
+  *      run : function(parameters){
+  *        if (!this.state){ this.state = {"sold":0}; }
+  *        this.state.sold++;
+  *        return JSON.stringify(this.state);
+  *      }
+  *    }
+  */
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "cpprest/json.h"
+#include "granada/defaults.h"
+#include "granada/runner/runner.h"
+
+namespace granada{
+  namespace plugin{
+
+    /**
+     * Resident plug-in: a plug-in kept alive in an instance of a javascript
+     * runner (see granada::runner::Instance), created once instead of in
+     * every run.
+     *
+     * The instance lives in a thread of its own, the calls are queued in a
+     * bounded mailbox and run one after the other, so the plug-in can keep
+     * its state in memory without locks. The __PLUGIN.state object is
+     * checkpointed periodically through the checkpoint function, when it
+     * has changed, and when the resident plug-in stops. A new instance
+     * starts with the last checkpointed state.
+     *
+     * The state lives in one process: when several servers share the cache,
+     * each one has its own instance and the last checkpoint written wins.
+     *
+     * A call made from the instance itself, for example a plug-in firing an
+     * event it listens to, runs immediately instead of being queued.
+     * With SpiderMonkeyJavascriptRunner the c++ functions run in another
+     * thread, so such call is queued and fails after the timeout.
+     */
+    class ResidentPlugin
+    {
+
+      public:
+
+        /**
+         * Constructor.
+         * Starts the thread of the resident plug-in, which creates the
+         * instance and runs the script defining the plug-in in it.
+         *
+         * @param runner                Runner creating the instance, has to
+         *                              outlive the resident plug-in.
+         * @param script                Script defining the plug-in in a __PLUGIN
+         *                              variable, with the javascript plug-in core.
+         * @param state                 Stringified JSON with the last checkpointed
+         *                              state, empty if there is none.
+         * @param checkpoint            Function storing the stringified state, called
+         *                              in the thread of the resident plug-in.
+         * @param mailbox_size          Maximum number of calls waiting.
+         * @param timeout               Milliseconds a call waits for its response,
+         *                              0 or less to wait without limit.
+         * @param checkpoint_interval   Minimum milliseconds between two checkpoints,
+         *                              0 or less to checkpoint after every call.
+         */
+        ResidentPlugin(granada::runner::Runner* runner, const std::string& script, const std::string& state, std::function<void(const std::string&)> checkpoint, const int mailbox_size, const int timeout, const int checkpoint_interval);
+
+
+        /**
+         * Destructor.
+         * Stops the resident plug-in.
+         */
+        virtual ~ResidentPlugin();
+
+
+        /**
+         * Runs a script in the instance of the plug-in, after the calls
+         * already waiting in the mailbox, and returns its response.
+         *
+         * @param script  Script, example: __wrappedRun("{}",null);
+         * @return        Response of the script, or a stringified JSON with an error
+         *                if the mailbox is full, the response has not come in time
+         *                or the resident plug-in has been stopped:
+         *                {"error":"resident_timeout","error_description":"..."}
+         */
+        std::string Run(const std::string& script);
+
+
+        /**
+         * Stops the resident plug-in: the calls already in the mailbox
+         * are run, the state is checkpointed and the instance is destroyed.
+         * Waits for the thread of the resident plug-in to end, unless it is
+         * called from that thread.
+         */
+        void Stop();
+
+
+        /**
+         * Returns the script defining the plug-in.
+         * @return  Script defining the plug-in.
+         */
+        const std::string& script(){
+          return script_;
+        };
+
+
+      protected:
+
+        /**
+         * Call waiting in the mailbox.
+         */
+        struct Call{
+
+          std::string script;
+
+          std::promise<std::string> response;
+
+        };
+
+
+        /**
+         * Members shared by the resident plug-in and its thread,
+         * which may outlive the resident plug-in when it is stopped
+         * from its own thread.
+         */
+        struct Worker{
+
+          /**
+           * Protects the mailbox and stopped.
+           */
+          std::mutex mtx;
+
+          /**
+           * Notified when a call is added or the resident plug-in stops.
+           */
+          std::condition_variable cv;
+
+          std::deque<std::unique_ptr<Call>> mailbox;
+
+          bool stopped = false;
+
+          /**
+           * Id of the thread of the resident plug-in.
+           */
+          std::thread::id thread_id;
+
+          /**
+           * Instance of the plug-in, only used in the thread of
+           * the resident plug-in, like the members below.
+           */
+          std::unique_ptr<granada::runner::Instance> instance;
+
+          std::function<void(const std::string&)> checkpoint;
+
+          std::chrono::milliseconds checkpoint_interval;
+
+          std::chrono::steady_clock::time_point last_checkpoint;
+
+          /**
+           * True if a call has run since the last checkpoint.
+           */
+          bool dirty = false;
+
+          /**
+           * Last checkpointed state.
+           */
+          std::string state;
+
+        };
+
+
+        /**
+         * Script returning the __PLUGIN.state stringified and prefixed
+         * with "state:", to tell it apart from the runner errors.
+         */
+        static const std::string checkpoint_script_;
+
+
+        /**
+         * Script defining the plug-in.
+         */
+        std::string script_;
+
+
+        /**
+         * Maximum number of calls waiting in the mailbox.
+         */
+        std::size_t mailbox_size_;
+
+
+        /**
+         * Milliseconds a call waits for its response.
+         */
+        int timeout_;
+
+
+        std::shared_ptr<Worker> worker_;
+
+
+        std::thread thread_;
+
+
+        /**
+         * Body of the thread of the resident plug-in: creates the instance,
+         * runs the calls of the mailbox until the resident plug-in stops
+         * and checkpoints the state.
+         *
+         * @param worker    Members shared with the resident plug-in.
+         * @param runner    Runner creating the instance.
+         * @param script    Script defining the plug-in and restoring its state.
+         */
+        static void Work(std::shared_ptr<Worker> worker, granada::runner::Runner* runner, const std::string script);
+
+
+        /**
+         * Runs a script in the instance, in the thread of the resident plug-in.
+         *
+         * @param worker  Members shared with the resident plug-in.
+         * @param script  Script.
+         * @return        Response of the script.
+         */
+        static std::string Execute(Worker& worker, const std::string& script);
+
+
+        /**
+         * Checkpoints the state if a call has run since the last checkpoint
+         * and it has changed. Called in the thread of the resident plug-in.
+         *
+         * @param worker  Members shared with the resident plug-in.
+         */
+        static void Checkpoint(Worker& worker);
+
+
+        /**
+         * Returns a stringified JSON with an error code and an error description.
+         *
+         * @param error               Error code.
+         * @param error_description   Error description.
+         * @return                    Stringified JSON.
+         */
+        static std::string Error(const std::string& error, const std::string& error_description);
+
+    };
+  }
+}
@@ -28,9 +28,13 @@
 
 #pragma once
 #include <deque>
+#include <map>
+#include <mutex>
 #include "granada/plugin/plugin.h"
+#include "granada/plugin/resident_plugin.h"
 #include "granada/cache/cache_handler.h"
-#include "granada/runner/spidermonkey_javascript_runner.h"
+#include "granada/cache/local_record_cache.h"
+#include "granada/runner/javascript_runner.h"
 
 
 namespace granada{
@@ -259,6 +263,24 @@ namespace granada{
         virtual web::json::value SendMessage(const std::string& from, const std::vector<std::string>& to_ids, const web::json::value& message) override;
 
 
+        using PluginHandler::Remove;
+
+
+        /**
+         * Removes a plug-in, stopping it first if it is a resident plug-in.
+         * 
+         * @param plugin_id   Id of the plug-in to remove.
+         */
+        virtual void Remove(const std::string& plugin_id) override;
+
+
+        /**
+         * Stops the resident plug-ins of the Plug-in Handler
+         * and stops the Plug-in Handler.
+         */
+        virtual void Stop() override;
+
+
       protected:
 
         /**
@@ -328,6 +350,18 @@ namespace granada{
         virtual std::string MultiplePluginScript(const std::vector<std::string>& plugin_ids);
 
 
+        /**
+         * Joins and returns multiple plug-in scripts and configurations
+         * in one script. The native, resident and cacheable plug-ins are not
+         * joined, they run separately and are returned in separate_plugins.
+         * 
+         * @param plugin_ids        Vector with the ids of the plug-in.
+         * @param separate_plugins  Vector where the native, resident and cacheable plug-ins are added.
+         * @return                  Joined plug-in scripts and configurations.
+         */
+        virtual std::string MultiplePluginScript(const std::vector<std::string>& plugin_ids, std::vector<std::unique_ptr<granada::plugin::Plugin>>& separate_plugins);
+
+
         /**
          * Run multiple plug-ins at a time using a script containing more than one plug-in.
          * Used by the Fire function to run the cached script of plug-ins listening to a
@@ -341,6 +375,135 @@ namespace granada{
         virtual web::json::value Run(std::string& script, const std::string& event_name, web::json::value& parameters);
 
 
+        /**
+         * Runs a plug-in and returns its response. If the plug-in is cacheable
+         * (see Plugin::CacheTTL) and has already run with the same parameters,
+         * the kept result is returned without running it, and without firing
+         * its before, in-process and after events.
+         * 
+         * @param plugin      Pointer to the plug-in.
+         * @param parameters  JSON with the parameters to pass to the plug-in.
+         * @param event_name  Name of the event that has triggered the plug-in,
+         *                    empty if the plug-in was not triggered firing an event.
+         * @return            JSON returned by the plug-in, or JSON with an error.
+         */
+        virtual web::json::value RunPlugin(granada::plugin::Plugin* plugin, web::json::value& parameters, const std::string& event_name);
+
+
+        /**
+         * Runs a native plug-in with the native_runner(), firing the same
+         * before, in-process and after events as the javascript plug-ins.
+         * The javascript runner is not used, so RunnerLock is not called.
+         * 
+         * @param plugin      Pointer to the native plug-in.
+         * @param parameters  JSON with the parameters to pass to the plug-in.
+         * @param event_name  Name of the event that has triggered the plug-in,
+         *                    empty if the plug-in was not triggered firing an event.
+         * @return            JSON returned by the plug-in, or JSON with an error.
+         */
+        virtual web::json::value RunNative(granada::plugin::Plugin* plugin, web::json::value& parameters, const std::string& event_name);
+
+
+        /**
+         * Runs a resident plug-in in its instance, starting it if it is not
+         * running yet. The javascript runner is not used, so RunnerLock is
+         * not called.
+         * 
+         * @param plugin      Pointer to the resident plug-in.
+         * @param parameters  JSON with the parameters to pass to the plug-in.
+         * @param event_name  Name of the event that has triggered the plug-in,
+         *                    empty if the plug-in was not triggered firing an event.
+         * @return            JSON returned by the plug-in, or JSON with an error.
+         */
+        virtual web::json::value RunResident(granada::plugin::Plugin* plugin, web::json::value& parameters, const std::string& event_name);
+
+
+        /**
+         * Runs a native, resident or cacheable plug-in and adds its response to
+         * the response of multiple plug-ins, as the javascript plug-ins run by an event.
+         * Example:@code
+         *     {"math.cube" : {"data":{"response":27}}}@endcode
+         * 
+         * @param plugin      Pointer to the plug-in.
+         * @param parameters  JSON with the parameters to pass to the plug-in.
+         * @param event_name  Name of the event, or empty string if there is no event.
+         * @param response    JSON object where the response is added.
+         */
+        virtual void RunSeparately(granada::plugin::Plugin* plugin, web::json::value& parameters, const std::string& event_name, web::json::value& response);
+
+
+        /**
+         * Returns the running resident plug-in of the given plug-in, starting
+         * it with its last checkpointed state if it is not running yet or if
+         * its script or configuration have changed.
+         * 
+         * @param plugin    Pointer to the resident plug-in.
+         * @return          Resident plug-in.
+         */
+        virtual std::shared_ptr<granada::plugin::ResidentPlugin> GetResidentPlugin(granada::plugin::Plugin* plugin);
+
+
+        /**
+         * Stops the resident plug-in of the plug-in with the given id,
+         * if it is running.
+         * 
+         * @param plugin_id   Id of the plug-in.
+         */
+        virtual void StopResidentPlugin(const std::string& plugin_id);
+
+
+        /**
+         * Loads the Plug-in Handler properties and the
+         * maximum number of plug-in results kept.
+         */
+        virtual void LoadProperties() override;
+
+
+        /**
+         * Returns the key of the result of a cacheable plug-in: its id, a hash
+         * of its script and configuration, the event name and the parameters
+         * with their fields sorted.
+         * 
+         * @param plugin      Pointer to the plug-in.
+         * @param parameters  JSON with the parameters passed to the plug-in.
+         * @param event_name  Name of the event, or empty string if there is no event.
+         * @return            Key of the result.
+         */
+        virtual std::string PluginResultKey(granada::plugin::Plugin* plugin, const web::json::value& parameters, const std::string& event_name);
+
+
+        /**
+         * Returns the beginning of the keys of all the results
+         * of a plug-in, used to forget them.
+         * 
+         * @param plugin_id   Id of the plug-in.
+         * @return            Beginning of the keys of the results.
+         */
+        virtual std::string plugin_result_prefix(const std::string& plugin_id){
+          return plugin_value_hash(plugin_id) + "|";
+        };
+
+
+        /**
+         * Results of the cacheable plug-ins of all the
+         * Plug-in Handlers, by PluginResultKey.
+         */
+        static granada::cache::LocalRecordCache<web::json::value> plugin_results_;
+
+
+        /**
+         * Running resident plug-ins of all the Plug-in Handlers,
+         * by plug-in value hash.
+         */
+        static std::map<std::string,std::shared_ptr<granada::plugin::ResidentPlugin>> resident_plugins_;
+
+
+        /**
+         * Mutex protecting resident_plugins_.
+         */
+        static std::mutex resident_plugins_mtx_;
+
+
         /**
          * Returns the Javascript basic functions for parsing communications
          * between javascript plug-ins and C++ functions. Inserts the values of
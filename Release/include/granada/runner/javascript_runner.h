@@ -0,0 +1,63 @@
+/**
+  * Copyright (c) <2016> Web App SDK granada <afernandez@cookinapps.io>
+  *
+  * This source code is licensed under the MIT license.
+  *
+  * Permission is hereby granted, free of charge, to any person obtaining a copy
+  * of this software and associated documentation files (the "Software"), to deal
+  * in the Software without restriction, including without limitation the rights
+  * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  * copies of the Software, and to permit persons to whom the Software is
+  * furnished to do so, subject to the following conditions:
+  *
+  * The above copyright notice and this permission notice shall be included in
+  * all copies or substantial portions of the Software.
+  *
+  * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  * SOFTWARE.
+  *
+  * Creates the runner of the javascript plug-ins selected in the
+  * server configuration.
+  */
+#pragma once
+#include <memory>
+#include <string>
+#include "granada/defaults.h"
+#include "granada/util/application.h"
+#include "runner.h"
+#include "spidermonkey_javascript_runner.h"
+#ifdef GRANADA_QUICKJS
+#include "quickjs_javascript_runner.h"
+#endif
+
+namespace granada{
+  namespace runner{
+
+    /**
+     * Creates the javascript runner selected with the "plugin_javascript_runner"
+     * property: "spidermonkey" (default) or "quickjs". QuickJS is only
+     * available when granada is built with GRANADA_QUICKJS defined, if not
+     * SpiderMonkey is used.
+     *
+     * Example of server.conf:
+     *    plugin_javascript_runner=quickjs
+     *
+     * @return  Javascript runner.
+     */
+    static inline std::unique_ptr<granada::runner::Runner> JavascriptRunner_unique_ptr(){
+#ifdef GRANADA_QUICKJS
+      const std::string& runner = granada::util::application::GetProperty(entity_keys::plugin_javascript_runner);
+      if (runner == default_strings::runner_quickjs){
+        return std::unique_ptr<granada::runner::Runner>(new granada::runner::QuickJSJavascriptRunner());
+      }
+#endif
+      return std::unique_ptr<granada::runner::Runner>(new granada::runner::SpiderMonkeyJavascriptRunner());
+    }
+
+  }
+}
@@ -0,0 +1,319 @@
+/**
+  * Copyright (c) <2016> Web App SDK granada <afernandez@cookinapps.io>
+  *
+  * This source code is licensed under the MIT license.
+  *
+  * Permission is hereby granted, free of charge, to any person obtaining a copy
+  * of this software and associated documentation files (the "Software"), to deal
+  * in the Software without restriction, including without limitation the rights
+  * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  * copies of the Software, and to permit persons to whom the Software is
+  * furnished to do so, subject to the following conditions:
+  *
+  * The above copyright notice and this permission notice shall be included in
+  * all copies or substantial portions of the Software.
+  *
+  * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  * SOFTWARE.
+  *
+  * Run native plug-ins: shared objects implementing the C interface
+  * of granada/plugin/native_plugin.h.
+  */
+#pragma once
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+#include "cpprest/json.h"
+#include "granada/defaults.h"
+#include "granada/plugin/native_plugin.h"
+#include "runner.h"
+
+namespace granada{
+  namespace runner{
+
+    /**
+     * Run native plug-ins: shared objects implementing the C interface
+     * of granada/plugin/native_plugin.h.
+     *
+     * Each shared object is opened with dlopen the first time one of its
+     * plug-ins runs and stays loaded while it is not replaced, later runs
+     * call its functions directly, with no script to build or interpret.
+     * When the file is replaced (another device, inode, size or modification
+     * time), the new version is opened through a private copy, so dlopen does
+     * not return the version already loaded with the same path, and the old
+     * one is closed when the runs using it end. Shared objects that could not
+     * be opened are tried again in the next run.
+     * The plug-in functions can be called from several threads at
+     * the same time.
+     *
+     * The c++ functions of functions() can be called from the plug-ins
+     * through the call function of the granada_plugin_context.
+     */
+    class NativeRunner : public Runner
+    {
+
+      public:
+
+        /**
+         * Constructor.
+         */
+        NativeRunner() : functions_(new granada::FunctionsMap()){};
+
+
+        /**
+         * Destructor.
+         */
+        virtual ~NativeRunner(){};
+
+
+        /**
+         * @override
+         * Runs the plug-in of the given shared object with empty parameters
+         * and without plug-in and Plug-in Handler ids.
+         *
+         * @param _script   Path of the shared object.
+         * @return          Stringified JSON returned by the plug-in.
+         */
+        std::string Run(const std::string& _script);
+
+
+        /**
+         * Runs a native plug-in, calling its granada_plugin_on_event function
+         * if the plug-in has been run by an event and exports it, or its
+         * granada_plugin_run function if not.
+         *
+         * @param library_path        Path of the shared object.
+         * @param plugin_id           Id of the plug-in.
+         * @param plugin_handler_id   Id of the Plug-in Handler.
+         * @param configuration       Stringified JSON with the plug-in configuration.
+         * @param parameters          Stringified JSON with the parameters.
+         * @param event_name          Name of the fired event, empty if the
+         *                            plug-in has not been run by an event.
+         * @return                    Stringified JSON returned by the plug-in, or
+         *                            with an error if the plug-in could not be run:
+         *                            {"error":"runner_initialization_error","error_description":"..."}
+         */
+        std::string Run(const std::string& library_path, const std::string& plugin_id, const std::string& plugin_handler_id, const std::string& configuration, const std::string& parameters, const std::string& event_name);
+
+
+        /**
+         * Sends a message to a native plug-in, calling its
+         * granada_plugin_on_message function.
+         *
+         * @param library_path        Path of the shared object.
+         * @param plugin_id           Id of the plug-in.
+         * @param plugin_handler_id   Id of the Plug-in Handler.
+         * @param configuration       Stringified JSON with the plug-in configuration.
+         * @param message             Stringified JSON with the message.
+         * @param from                Id of the sender of the message.
+         * @return                    Stringified JSON returned by the plug-in, or
+         *                            with an error if the plug-in could not be run
+         *                            or does not respond to messages.
+         */
+        std::string OnMessage(const std::string& library_path, const std::string& plugin_id, const std::string& plugin_handler_id, const std::string& configuration, const std::string& message, const std::string& from);
+
+
+        /**
+         * Returns the version of the shared object with the given path:
+         * its device, inode, size and modification time. It changes
+         * when the shared object is replaced.
+         *
+         * @param library_path    Path of the shared object.
+         * @return                Version, empty if the file can not be read.
+         */
+        static std::string Version(const std::string& library_path);
+
+
+        /**
+         * Returns a pointer to the collection of functions
+         * that can be called from the script/executable.
+         * @return  Pointer to the collection of functions
+         *          that can be called from the script/executable.
+         */
+        virtual std::shared_ptr<granada::Functions> functions(){
+          return functions_;
+        };
+
+
+        /**
+         * Returns a vector with the extensions of the scripts/executables
+         * Extensions examples: ["js"], ["sh"], ["exe"], ["js","sh"]
+         * @return   Vector with the extensions.
+         */
+        virtual std::vector<std::string> extensions(){
+          return NativeRunner::extensions_;
+        };
+
+
+      protected:
+
+        /**
+         * Shared object opened with dlopen and the
+         * functions it exports.
+         */
+        struct Library{
+
+          /**
+           * Closes the shared object, when it has been replaced
+           * and the last run using it has ended.
+           */
+          ~Library();
+
+          /**
+           * Handle returned by dlopen, nullptr if the shared
+           * object could not be opened or initialized.
+           */
+          void* handle = nullptr;
+
+          /**
+           * Why the shared object could not be opened or initialized.
+           */
+          std::string error;
+
+          /**
+           * Version of the file opened, see Version.
+           */
+          std::string version;
+
+          char* (*run)(const granada_plugin_context*, const char*, const char*) = nullptr;
+          char* (*on_event)(const granada_plugin_context*, const char*, const char*) = nullptr;
+          char* (*on_message)(const granada_plugin_context*, const char*, const char*) = nullptr;
+          void (*free)(char*) = nullptr;
+        };
+
+
+        /**
+         * Last version opened of each shared object, by path.
+         * Failures are not kept.
+         */
+        static std::map<std::string,std::shared_ptr<Library>> libraries_;
+
+
+        /**
+         * Paths passed to dlopen at least once. dlopen returns the shared
+         * object already loaded with the same path, even if the file has been
+         * replaced, so these paths are opened again through a private copy.
+         */
+        static std::set<std::string> opened_paths_;
+
+
+        /**
+         * Mutex protecting libraries_ and opened_paths_.
+         */
+        static std::mutex libraries_mtx_;
+
+
+        /**
+         * Array with the extensions of the scripts/executables,
+         * will be inserted in the extensions_ vector.
+         * Extensions examples: ["js"], ["sh"], ["exe"], ["js","sh"]
+         */
+        static std::string extensions_arr_[1];
+
+
+        /**
+         * Vector with the extensions of the scripts/executables,
+         * its content comes from the extensions_arr_ array.
+         * Extensions examples: ["js"], ["sh"], ["exe"], ["js","sh"]
+         */
+        static std::vector<std::string> extensions_;
+
+
+        /**
+         * Collection of the c++ functions that can be
+         * called from the plug-ins.
+         */
+        std::shared_ptr<granada::Functions> functions_;
+
+
+        /**
+         * Returns the shared object with the given path, opening and
+         * initializing it the first time and when it has been replaced.
+         *
+         * @param library_path  Path of the shared object.
+         * @return              Shared object, its handle is nullptr
+         *                      if it could not be opened.
+         */
+        static std::shared_ptr<Library> GetLibrary(const std::string& library_path);
+
+
+        /**
+         * Opens and initializes a shared object.
+         *
+         * @param library   Shared object, its handle and functions are set,
+         *                  or its error if it could not be opened.
+         * @param path      Path passed to dlopen.
+         * @param name      Path of the shared object, used in the errors.
+         */
+        static void Open(Library& library, const std::string& path, const std::string& name);
+
+
+        /**
+         * Copies a shared object to a new file of the temporary directory.
+         *
+         * @param library_path  Path of the shared object.
+         * @return              Path of the copy, empty if it could not be copied.
+         */
+        static std::string Copy(const std::string& library_path);
+
+
+        /**
+         * Returns the response of a plug-in as a string and frees it.
+         *
+         * @param library   Shared object of the plug-in.
+         * @param response  Response of the plug-in, may be NULL.
+         * @return          Response, "{}" if NULL.
+         */
+        static std::string Response(const Library& library, char* response);
+
+
+        /**
+         * Returns a stringified JSON with an error code and an error description.
+         *
+         * @param error               Error code.
+         * @param error_description   Error description.
+         * @return                    Stringified JSON.
+         */
+        static std::string Error(const std::string& error, const std::string& error_description);
+
+
+        /**
+         * The call function of granada_plugin_context. Calls the c++ function
+         * with the given name, the parameters are parsed to a web::json::value
+         * and the web::json::value returned is stringified.
+         *
+         * @param host            Pointer to the NativeRunner.
+         * @param function_name   Name of the function.
+         * @param parameters      Stringified JSON.
+         * @return                Stringified JSON returned by the function,
+         *                        to free with Release.
+         */
+        static char* Call(void* host, const char* function_name, const char* parameters);
+
+
+        /**
+         * The release function of granada_plugin_context,
+         * frees the strings returned by Call.
+         *
+         * @param str   String returned by Call.
+         */
+        static void Release(char* str);
+
+
+        /**
+         * Fills a granada_plugin_context. The strings have to
+         * live until the plug-in returns.
+         */
+        void Context(granada_plugin_context& context, const std::string& plugin_id, const std::string& plugin_handler_id, const std::string& configuration);
+
+    };
+  }
+}
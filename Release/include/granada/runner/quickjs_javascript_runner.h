@@ -0,0 +1,240 @@
+/**
+  * Copyright (c) <2016> Web App SDK granada <afernandez@cookinapps.io>
+  *
+  * This source code is licensed under the MIT license.
+  *
+  * Permission is hereby granted, free of charge, to any person obtaining a copy
+  * of this software and associated documentation files (the "Software"), to deal
+  * in the Software without restriction, including without limitation the rights
+  * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  * copies of the Software, and to permit persons to whom the Software is
+  * furnished to do so, subject to the following conditions:
+  *
+  * The above copyright notice and this permission notice shall be included in
+  * all copies or substantial portions of the Software.
+  *
+  * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  * SOFTWARE.
+  *
+  * Run javascript using QuickJS, a small embeddable JavaScript engine.
+  * https://bellard.org/quickjs/
+  */
+#pragma once
+#include <memory>
+#include <string>
+#include <vector>
+#include "cpprest/json.h"
+#include "granada/defaults.h"
+#include "runner.h"
+#include "quickjs.h"
+
+namespace granada{
+  namespace runner{
+
+    /**
+     * Run javascript using QuickJS, a small embeddable JavaScript engine.
+     * https://bellard.org/quickjs/
+     *
+     * Each thread keeps one QuickJS runtime, created the first time
+     * it runs a script, and each run uses a new context of that runtime.
+     * Scripts do not share their global objects, but they do not pay for
+     * the creation of a runtime as with SpiderMonkeyJavascriptRunner.
+     *
+     * The c++ functions of functions() are called in the thread running
+     * the script, they can run other scripts.
+     *
+     * Requires QuickJS 2024-01-13 or later.
+     */
+    class QuickJSJavascriptRunner : public Runner
+    {
+
+      public:
+
+        /**
+         * Constructor.
+         */
+        QuickJSJavascriptRunner(){};
+
+
+        /**
+         * Destructor.
+         */
+        virtual ~QuickJSJavascriptRunner(){};
+
+
+        /**
+         * @override
+         * Run given javascript script and returns the return/response
+         * of the script in form of string.
+         *
+         * @param _script   Javascript script.
+         * @return          Return/Response returned by the script run.
+         */
+        std::string Run(const std::string& _script);
+
+
+        /**
+         * Returns a pointer to the collection of functions
+         * that can be called from the script/executable.
+         * @return  Pointer to the collection of functions
+         *          that can be called from the script/executable.
+         */
+        virtual std::shared_ptr<granada::Functions> functions(){
+          return QuickJSJavascriptRunner::functions_;
+        };
+
+
+        /**
+         * Returns a vector with the extensions of the scripts/executables
+         * Extensions examples: ["js"], ["sh"], ["exe"], ["js","sh"]
+         * @return   Vector with the extensions.
+         */
+        virtual std::vector<std::string> extensions(){
+          return QuickJSJavascriptRunner::extensions_;
+        };
+
+
+        /**
+         * @override
+         * Returns a new instance: a context of the QuickJS runtime
+         * of the calling thread, kept between runs.
+         * @return   Instance.
+         */
+        virtual std::unique_ptr<Instance> Instance_unique_ptr();
+
+
+        /**
+         * Returns the QuickJS runtime of the calling thread,
+         * creating it if it does not exist yet.
+         * @return  QuickJS runtime, nullptr if it could not be created.
+         */
+        static JSRuntime* runtime();
+
+
+      protected:
+
+        friend class QuickJSJavascriptInstance;
+
+
+        /**
+         * Pointer to the collection of the c++ functions
+         * that can be called from the javascript.
+         */
+        static std::shared_ptr<granada::Functions> functions_;
+
+
+        /**
+         * Array with the extensions of the scripts/executables,
+         * will be inserted in the extensions_ vector.
+         * Extensions examples: ["js"], ["sh"], ["exe"], ["js","sh"]
+         */
+        static std::string extensions_arr_[1];
+
+
+        /**
+         * Vector with the extensions of the scripts/executables,
+         * its content comes from the extensions_arr_ array.
+         * Extensions examples: ["js"], ["sh"], ["exe"], ["js","sh"]
+         */
+        static std::vector<std::string> extensions_;
+
+
+        /**
+         * Runner initialization error stringified json.
+         * Used to respond in the Run functions when there is
+         * such error.
+         */
+        const std::string runner_initialization_error_ = "{\"" + default_strings::runner_error + "\":\"" + default_errors::runner_initialization_error + "\"}";
+
+
+        /**
+         * Wraps the c++ functions called from the javascript, so the argument
+         * is parsed to a web::json::value and the return to the javascript is
+         * the stringified JSON returned by the function.
+         *
+         * @param cx         QuickJS context running the script.
+         * @param this_val   Javascript this, not used.
+         * @param argc       Number of arguments.
+         * @param argv       Arguments, the first one is the stringified JSON
+         *                   passed to the function.
+         * @param magic      Not used.
+         * @param func_data  Name of the c++ function to call.
+         * @return           Stringified JSON returned by the function,
+         *                   or an exception.
+         */
+        static JSValue FunctionWrapper(JSContext* cx, JSValueConst this_val, int argc, JSValueConst* argv, int magic, JSValue* func_data);
+
+
+        /**
+         * Defines the c++ functions of functions_ in the global
+         * object of the given context.
+         *
+         * @param cx  QuickJS context.
+         */
+        static void DefineFunctions(JSContext* cx);
+
+
+        /**
+         * Evaluates a script in the given context and returns its result
+         * as a string, or a script_error stringified JSON if it throws.
+         * The context has to belong to the runtime of the calling thread.
+         *
+         * @param cx       QuickJS context.
+         * @param _script  Javascript script.
+         * @return         Return/Response returned by the script run.
+         */
+        static std::string Evaluate(JSContext* cx, const std::string& _script);
+
+    };
+
+
+    /**
+     * Instance of QuickJSJavascriptRunner: a context of the QuickJS runtime
+     * of the thread that creates it, its global object is kept between runs.
+     * It has to be used and destroyed in the thread that created it.
+     */
+    class QuickJSJavascriptInstance : public Instance
+    {
+
+      public:
+
+        /**
+         * Constructor.
+         * Creates the context and defines the c++ functions in it.
+         */
+        QuickJSJavascriptInstance();
+
+
+        /**
+         * Destructor.
+         * Frees the context.
+         */
+        virtual ~QuickJSJavascriptInstance();
+
+
+        /**
+         * @override
+         * Run given javascript script in the context of the instance
+         * and returns the return/response of the script in form of string.
+         *
+         * @param _script   Javascript script.
+         * @return          Return/Response returned by the script run.
+         */
+        std::string Run(const std::string& _script);
+
+
+      protected:
+
+        /**
+         * QuickJS context, nullptr if it could not be created.
+         */
+        JSContext* cx_;
+
+    };
+  }
+}
@@ -25,6 +25,7 @@
   */
 
 #pragma once
+#include <memory>
 #include <string>
 #include "granada/functions.h"
 
@@ -35,6 +36,32 @@ namespace granada{
    */
   namespace runner{
 
+    /**
+     * Environment keeping its global variables between runs, so a script
+     * can define objects once and later scripts can use them.
+     * An instance is not thread-safe: it has to be used and destroyed
+     * in the thread that created it.
+     */
+    class Instance
+    {
+      public:
+
+        /**
+         * Destructor
+         */
+        virtual ~Instance(){};
+
+
+        /**
+         * Run script in the environment of the instance.
+         *
+         * @param script  Script.
+         * @return        Result or response in form of string.
+         */
+        virtual std::string Run(const std::string& script){ return std::string(); };
+    };
+
+
     /**
      * Interface for running scripts or executables.
      */
@@ -82,6 +109,16 @@ namespace granada{
         virtual std::vector<std::string> extensions(){
           return std::vector<std::string>();
         };
+
+
+        /**
+         * Returns a new instance, an environment keeping its global
+         * variables between runs, to use in the calling thread.
+         * @return   Instance, nullptr if the runner does not support them.
+         */
+        virtual std::unique_ptr<Instance> Instance_unique_ptr(){
+          return std::unique_ptr<Instance>(nullptr);
+        };
     };
   }
 }
@@ -103,8 +103,19 @@ namespace granada{
         };
 
 
+        /**
+         * @override
+         * Returns a new instance with its own runtime and global
+         * object, kept between runs.
+         * @return   Instance.
+         */
+        virtual std::unique_ptr<Instance> Instance_unique_ptr();
+
+
       protected:
 
+        friend class SpiderMonkeyJavascriptInstance;
+
 
         /* The class of the global object. */
         static JSClass global_class_;
@@ -174,6 +185,59 @@ namespace granada{
 
 
 
+    };
+
+
+    /**
+     * Instance of SpiderMonkeyJavascriptRunner: a runtime, a context and a global
+     * object kept between runs. It has to be used and destroyed in the thread
+     * that created it.
+     *
+     * The c++ functions called from the scripts run in another thread, as
+     * with SpiderMonkeyJavascriptRunner.
+     */
+    class SpiderMonkeyJavascriptInstance : public Instance
+    {
+
+      public:
+
+        /**
+         * Constructor.
+         * Creates the runtime, the context and the global object,
+         * and defines the c++ functions in it.
+         */
+        SpiderMonkeyJavascriptInstance();
+
+
+        /**
+         * Destructor.
+         * Destroys the context and the runtime.
+         */
+        virtual ~SpiderMonkeyJavascriptInstance();
+
+
+        /**
+         * @override
+         * Run given javascript script with the global object of the instance
+         * and returns the return/response of the script in form of string.
+         *
+         * @param _script   Javascript script.
+         * @return          Return/Response returned by the script run.
+         */
+        std::string Run(const std::string& _script);
+
+
+      protected:
+
+        JSRuntime* rt_;
+
+        JSContext* cx_;
+
+        /**
+         * Global object, rooted while the instance lives.
+         */
+        std::unique_ptr<JS::PersistentRootedObject> global_;
+
     };
   }
 }
@@ -58,12 +58,6 @@ namespace granada{
       static std::string selfpath;
 
 
-      /**
-       * Application property file.
-       */
-      static std::unique_ptr<granada::util::file::PropertyFile> property_file_;
-
-
       /**
        * Returns the path of the application.
        * @return Path.
@@ -72,9 +66,10 @@ namespace granada{
 
 
       /**
-       * Returns the value of a property of the application config file.
+       * Returns the value of a property of the application config file,
+       * read from the current granada::util::configuration snapshot.
        * @param  name Name of the property to retrieve.
-       * @return      Value of the property.
+       * @return      Value of the property, empty if it is not found.
        */
       const std::string GetProperty(const std::string& name);
 
@@ -0,0 +1,191 @@
+/**
+  * Copyright (c) <2016> Web App SDK granada <afernandez@cookinapps.io>
+  *
+  * This source code is licensed under the MIT license.
+  *
+  * Permission is hereby granted, free of charge, to any person obtaining a copy
+  * of this software and associated documentation files (the "Software"), to deal
+  * in the Software without restriction, including without limitation the rights
+  * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  * copies of the Software, and to permit persons to whom the Software is
+  * furnished to do so, subject to the following conditions:
+  *
+  * The above copyright notice and this permission notice shall be included in
+  * all copies or substantial portions of the Software.
+  *
+  * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  * SOFTWARE.
+  *
+  * Utils for encoding binary records, used by the cache drivers
+  * that persist their data in files.
+  */
+
+#pragma once
+#include <cstdio>
+#include <cstdint>
+#include <string>
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace granada{
+  namespace util{
+
+    /**
+     * Utils for encoding binary records. Numbers are
+     * stored in little endian whatever the platform.
+     */
+    namespace binary{
+
+      /**
+       * Appends a 32 bits unsigned integer to a buffer.
+       * @param buffer Buffer.
+       * @param value  Number.
+       */
+      static inline void put_uint32(std::string& buffer, const uint32_t value){
+        buffer.push_back((char)(value & 0xff));
+        buffer.push_back((char)((value >> 8) & 0xff));
+        buffer.push_back((char)((value >> 16) & 0xff));
+        buffer.push_back((char)((value >> 24) & 0xff));
+      }
+
+
+      /**
+       * Reads a 32 bits unsigned integer.
+       * @param  data Pointer to the first of its 4 bytes.
+       * @return      Number.
+       */
+      static inline uint32_t get_uint32(const char* data){
+        const unsigned char* bytes = (const unsigned char*)data;
+        return (uint32_t)bytes[0] | ((uint32_t)bytes[1] << 8) | ((uint32_t)bytes[2] << 16) | ((uint32_t)bytes[3] << 24);
+      }
+
+
+      /**
+       * Appends a 64 bits unsigned integer to a buffer.
+       * @param buffer Buffer.
+       * @param value  Number.
+       */
+      static inline void put_uint64(std::string& buffer, const uint64_t value){
+        put_uint32(buffer, (uint32_t)(value & 0xffffffff));
+        put_uint32(buffer, (uint32_t)(value >> 32));
+      }
+
+
+      /**
+       * Reads a 64 bits unsigned integer.
+       * @param  data Pointer to the first of its 8 bytes.
+       * @return      Number.
+       */
+      static inline uint64_t get_uint64(const char* data){
+        return (uint64_t)get_uint32(data) | ((uint64_t)get_uint32(data + 4) << 32);
+      }
+
+
+      /**
+       * Appends a string preceded by its length to a buffer.
+       * @param buffer Buffer.
+       * @param value  String.
+       */
+      static inline void put_string(std::string& buffer, const std::string& value){
+        put_uint32(buffer, (uint32_t)value.size());
+        buffer.append(value);
+      }
+
+
+      /**
+       * Reads a string preceded by its length.
+       * @param  data     Buffer.
+       * @param  size     Size of the buffer.
+       * @param  position Position of the length of the string, it is moved
+       *                  after the string.
+       * @param  value    String read.
+       * @return          False if the buffer ends before the string does.
+       */
+      static inline bool get_string(const char* data, const std::size_t size, std::size_t& position, std::string& value){
+        if (position + 4 > size){
+          return false;
+        }
+        const uint32_t length = get_uint32(data + position);
+        if (position + 4 + length > size){
+          return false;
+        }
+        value.assign(data + position + 4, length);
+        position += 4 + length;
+        return true;
+      }
+
+
+      /**
+       * Returns the CRC-32 (IEEE 802.3) of the given bytes.
+       * @param  data Bytes.
+       * @param  size Number of bytes.
+       * @return      CRC-32.
+       */
+      static inline uint32_t crc32(const char* data, const std::size_t size){
+        struct Table{
+          uint32_t values[256];
+          Table(){
+            for (uint32_t i = 0; i < 256; i++){
+              uint32_t c = i;
+              for (int k = 0; k < 8; k++){
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+              }
+              values[i] = c;
+            }
+          }
+        };
+        static const Table table;
+        uint32_t crc = 0xFFFFFFFFu;
+        for (std::size_t i = 0; i < size; i++){
+          crc = table.values[(crc ^ (unsigned char)data[i]) & 0xff] ^ (crc >> 8);
+        }
+        return crc ^ 0xFFFFFFFFu;
+      }
+
+
+      /**
+       * Flushes a file to the disk.
+       * @param file File.
+       */
+      static inline void sync(std::FILE* file){
+        std::fflush(file);
+#ifdef _WIN32
+        _commit(_fileno(file));
+#else
+        fsync(fileno(file));
+#endif
+      }
+
+
+      /**
+       * Reads a whole file.
+       * @param  file_path Path of the file.
+       * @param  content   Content of the file.
+       * @return           False if the file could not be opened.
+       */
+      static inline bool read_file(const std::string& file_path, std::string& content){
+        content.clear();
+        std::FILE* file = std::fopen(file_path.c_str(), "rb");
+        if (file == nullptr){
+          return false;
+        }
+        char chunk[65536];
+        std::size_t read;
+        while ((read = std::fread(chunk, 1, sizeof(chunk), file)) > 0){
+          content.append(chunk, read);
+        }
+        std::fclose(file);
+        return true;
+      }
+
+    }
+  }
+}
@@ -0,0 +1,284 @@
+/**
+  * Copyright (c) <2016> Web App SDK granada <afernandez@cookinapps.io>
+  *
+  * This source code is licensed under the MIT license.
+  *
+  * Permission is hereby granted, free of charge, to any person obtaining a copy
+  * of this software and associated documentation files (the "Software"), to deal
+  * in the Software without restriction, including without limitation the rights
+  * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  * copies of the Software, and to permit persons to whom the Software is
+  * furnished to do so, subject to the following conditions:
+  *
+  * The above copyright notice and this permission notice shall be included in
+  * all copies or substantial portions of the Software.
+  *
+  * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  * SOFTWARE.
+  *
+  * Typed configuration: the properties of the server configuration
+  * file parsed once into typed values.
+  *
+  */
+
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "cpprest/json.h"
+
+namespace granada{
+  namespace util{
+
+    /**
+     * Typed configuration. The properties of the server configuration file
+     * listed in the _GRANADA_PROPERTIES section of granada/defaults.dat are
+     * parsed once, when the file is loaded, into values of their type, so
+     * reading them does not parse or allocate anything:
+     *
+     *    if (granada::util::configuration::Bool(granada::util::configuration::gzip_content)){ ... }
+     *
+     * The loaded file is published as an immutable shared snapshot. Reload()
+     * publishes a new snapshot if the file has changed, a replaced snapshot
+     * lives as long as someone holds it, so the accessors return values and
+     * Current() returns the snapshot itself.
+     *
+     * Reloading only changes the properties read each time they are used,
+     * they are listed in the _GRANADA_PROPERTIES section of
+     * granada/defaults.dat. The other properties, and most of the ones read
+     * with GetProperty(), are read once when a component is first used and
+     * need a restart.
+     *
+     * The other properties can be read with GetProperty() as strings.
+     */
+    namespace configuration{
+
+      /**
+       * Types of the properties.
+       */
+      enum Type {STRING, INT, BOOL, DURATION, JSON};
+
+
+      /**
+       * Typed properties, see the _GRANADA_PROPERTIES
+       * section of granada/defaults.dat.
+       */
+      enum Key{
+#define _GRANADA_PROPERTIES
+#define GRANADA_PROPERTY(name_, type_, default_) name_,
+#include "granada/defaults.dat"
+#undef _GRANADA_PROPERTIES
+#undef GRANADA_PROPERTY
+        KEY_COUNT
+      };
+
+
+      /**
+       * Value of a typed property, only the member of
+       * the type of the property is set.
+       */
+      struct Value{
+        std::string string;
+        int number = 0;
+        bool boolean = false;
+        std::chrono::milliseconds duration{0};
+        web::json::value json;
+      };
+
+
+      /**
+       * Properties of a configuration file.
+       */
+      class Snapshot{
+
+        public:
+
+          /**
+           * Constructor, parses the given configuration file.
+           * @param file_path Path of the configuration file.
+           */
+          Snapshot(const std::string& file_path);
+
+
+          /**
+           * Returns the value of a typed property.
+           * @param  key Property.
+           * @return     Value.
+           */
+          const Value& operator[](const Key key) const{
+            return values_[key];
+          };
+
+
+          /**
+           * Returns the value of a property as it is written in
+           * the configuration file.
+           * @param  name Name of the property.
+           * @return      Value, empty if the property is not found.
+           */
+          const std::string& GetProperty(const std::string& name) const;
+
+
+          /**
+           * Returns the properties as they are written in the configuration file.
+           * @return Properties.
+           */
+          const std::unordered_map<std::string,std::string>& properties() const{
+            return properties_;
+          };
+
+
+          /**
+           * Returns the path of the configuration file.
+           * @return Path of the configuration file.
+           */
+          const std::string& file_path() const{
+            return file_path_;
+          };
+
+
+        private:
+
+          /**
+           * Path of the configuration file.
+           */
+          std::string file_path_;
+
+
+          /**
+           * Properties as they are written in the configuration file.
+           */
+          std::unordered_map<std::string,std::string> properties_;
+
+
+          /**
+           * Typed properties.
+           */
+          std::vector<Value> values_;
+
+
+          /**
+           * Returned when a property is not found.
+           */
+          std::string empty_;
+      };
+
+
+      /**
+       * Parses a boolean: on, true, yes or 1 and off, false, no or 0.
+       * @param  text  Text to parse.
+       * @param  value Parsed value, set only if true is returned.
+       * @return       True if the text could be parsed.
+       */
+      bool ParseBool(const std::string& text, bool& value);
+
+
+      /**
+       * Parses a duration: a number followed by ms, s, m, h or d,
+       * seconds if there is no unit. Example: 250ms, 30s, 5m, 1h.
+       * @param  text  Text to parse.
+       * @param  value Parsed value, set only if true is returned.
+       * @return       True if the text could be parsed.
+       */
+      bool ParseDuration(const std::string& text, std::chrono::milliseconds& value);
+
+
+      /**
+       * Returns the current snapshot, loading the server.conf file of
+       * the application directory the first time it is called.
+       * @return Current snapshot, it remains valid while it is held
+       *         even if the configuration is reloaded.
+       */
+      std::shared_ptr<const Snapshot> Current();
+
+
+      /**
+       * Loads a configuration file and publishes it as the current snapshot,
+       * unless it is the file of the current snapshot and it has not changed.
+       * @param file_path Path of the configuration file.
+       */
+      void Load(const std::string& file_path);
+
+
+      /**
+       * Loads the configuration file again and publishes it
+       * as the current snapshot if it has changed.
+       */
+      void Reload();
+
+
+      /**
+       * Reloads the configuration file each time the application receives
+       * a SIGHUP signal, see Reload(). Does nothing on Windows.
+       */
+      void ReloadOnSignal();
+
+
+      /**
+       * Returns the number of snapshots that have been published,
+       * useful to know if the configuration has changed.
+       * @return Version of the configuration.
+       */
+      unsigned long version();
+
+
+      /**
+       * Returns the value of a string property.
+       * @param  key Property.
+       * @return     Value.
+       */
+      inline std::string String(const Key key){
+        return (*Current())[key].string;
+      };
+
+
+      /**
+       * Returns the value of an integer property.
+       * @param  key Property.
+       * @return     Value.
+       */
+      inline int Int(const Key key){
+        return (*Current())[key].number;
+      };
+
+
+      /**
+       * Returns the value of a boolean property.
+       * @param  key Property.
+       * @return     Value.
+       */
+      inline bool Bool(const Key key){
+        return (*Current())[key].boolean;
+      };
+
+
+      /**
+       * Returns the value of a duration property.
+       * @param  key Property.
+       * @return     Value.
+       */
+      inline std::chrono::milliseconds Duration(const Key key){
+        return (*Current())[key].duration;
+      };
+
+
+      /**
+       * Returns the value of a JSON property.
+       * @param  key Property.
+       * @return     Value.
+       */
+      inline web::json::value Json(const Key key){
+        return (*Current())[key].json;
+      };
+
+    }
+  }
+}
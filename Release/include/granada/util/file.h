@@ -221,6 +221,13 @@ namespace granada{
            * Check if file properties are parsed
            */
           const bool empty(){ return properties_.empty(); };
+
+
+          /**
+           * Returns all the parsed properties.
+           * @return unordered_map of property names and values.
+           */
+          const std::unordered_map<std::string,std::string>& properties() const{ return properties_; };
         private:
 
 
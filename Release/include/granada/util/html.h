@@ -0,0 +1,258 @@
+/**
+  * Copyright (c) <2016> Web App SDK granada <afernandez@cookinapps.io>
+  *
+  * This source code is licensed under the MIT license.
+  *
+  * Permission is hereby granted, free of charge, to any person obtaining a copy
+  * of this software and associated documentation files (the "Software"), to deal
+  * in the Software without restriction, including without limitation the rights
+  * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  * copies of the Software, and to permit persons to whom the Software is
+  * furnished to do so, subject to the following conditions:
+  *
+  * The above copyright notice and this permission notice shall be included in
+  * all copies or substantial portions of the Software.
+  *
+  * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  * SOFTWARE.
+  *
+  * Utils for rendering HTML.
+  */
+
+#pragma once
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+namespace granada{
+  namespace util{
+
+    /**
+     * Utils for rendering HTML.
+     */
+    namespace html{
+
+      /**
+       * Appends a text to an HTML buffer escaping the characters
+       * with special meaning in HTML elements and attribute values:
+       * & < > " '
+       * @param text   Text to escape.
+       * @param buffer String where the escaped text is appended.
+       */
+      static inline void escape(const std::string& text, std::string& buffer){
+        std::size_t start = 0;
+        for (std::size_t i = 0; i < text.size(); ++i){
+          const char* entity;
+          switch (text[i]){
+            case '&': entity = "&amp;"; break;
+            case '<': entity = "&lt;"; break;
+            case '>': entity = "&gt;"; break;
+            case '"': entity = "&quot;"; break;
+            case '\'': entity = "&#39;"; break;
+            default: continue;
+          }
+          buffer.append(text, start, i - start);
+          buffer.append(entity);
+          start = i + 1;
+        }
+        buffer.append(text, start, std::string::npos);
+      }
+
+
+      /**
+       * Template with {{tag}} placeholders, parsed once into a list of
+       * literal and placeholder segments so it can be rendered in a single
+       * pass, instead of searching and replacing each tag in a copy of the
+       * whole content every time.
+       *
+       * Example:
+       *      Template html_template("<p>hello {{username}}</p>");
+       *      std::unordered_map<std::string,std::string> values;
+       *      values["username"] = "John <Doe>";
+       *      html_template.Render(values);
+       *      => <p>hello John &lt;Doe&gt;</p>
+       *
+       * Placeholders without a value are rendered as they are written in
+       * the template, as granada::util::string::replace does.
+       * Once parsed, a template can be rendered by multiple threads.
+       */
+      class Template{
+
+        public:
+
+          /**
+           * Constructor
+           */
+          Template(){};
+
+
+          /**
+           * Constructor
+           * @param content Content of the template.
+           * @param open    Before tag mark.
+           * @param close   After tag mark.
+           */
+          Template(const std::string& content, const std::string& open = "{{", const std::string& close = "}}"){
+            Parse(content, open, close);
+          };
+
+
+          /**
+           * Destructor
+           */
+          virtual ~Template(){};
+
+
+          /**
+           * Parses the content of the template, replaces the
+           * previous content if any.
+           * @param content Content of the template.
+           * @param open    Before tag mark.
+           * @param close   After tag mark.
+           */
+          void Parse(const std::string& content, const std::string& open = "{{", const std::string& close = "}}"){
+            content_.assign(content);
+            segments_.clear();
+            placeholders_.clear();
+            literal_length_ = 0;
+
+            std::size_t pos = 0;
+            while (pos < content_.size()){
+              const std::size_t tag_start = content_.find(open, pos);
+              const std::size_t name_start = tag_start == std::string::npos ? std::string::npos : tag_start + open.size();
+              const std::size_t name_end = name_start == std::string::npos ? std::string::npos : content_.find(close, name_start);
+              if (name_end == std::string::npos){
+                AddLiteral(pos, content_.size() - pos);
+                break;
+              }
+              AddLiteral(pos, tag_start - pos);
+
+              const std::string name(content_, name_start, name_end - name_start);
+              std::size_t index = 0;
+              while (index < placeholders_.size() && placeholders_[index] != name){
+                ++index;
+              }
+              if (index == placeholders_.size()){
+                placeholders_.push_back(name);
+              }
+
+              Segment segment;
+              segment.placeholder = true;
+              segment.index = index;
+              segment.start = tag_start;
+              segment.length = name_end + close.size() - tag_start;
+              segments_.push_back(segment);
+
+              pos = name_end + close.size();
+            }
+          };
+
+
+          /**
+           * Renders the template replacing the placeholders by the given values.
+           * @param  values Tag name => value.
+           * @param  escape True if values have to be HTML escaped, true by default.
+           * @return        Rendered content.
+           */
+          std::string Render(const std::unordered_map<std::string,std::string>& values, const bool escape = true) const {
+            // resolve each placeholder once.
+            std::vector<const std::string*> resolved(placeholders_.size(), nullptr);
+            std::size_t length = literal_length_;
+            for (std::size_t i = 0; i < placeholders_.size(); ++i){
+              auto it = values.find(placeholders_[i]);
+              if (it != values.end()){
+                resolved[i] = &it->second;
+                length += it->second.size();
+              }
+            }
+
+            std::string buffer;
+            buffer.reserve(length + length / 8);
+            for (auto it = segments_.begin(); it != segments_.end(); ++it){
+              if (!it->placeholder){
+                buffer.append(content_, it->start, it->length);
+              }else if (resolved[it->index] == nullptr){
+                buffer.append(content_, it->start, it->length);
+              }else if (escape){
+                granada::util::html::escape(*resolved[it->index], buffer);
+              }else{
+                buffer.append(*resolved[it->index]);
+              }
+            }
+            return buffer;
+          };
+
+
+          /**
+           * Returns the names of the placeholders of the template,
+           * in order of first appearance and without repetitions.
+           * @return Names of the placeholders.
+           */
+          const std::vector<std::string>& placeholders() const {
+            return placeholders_;
+          };
+
+
+        private:
+
+          /**
+           * Literal text of the template or placeholder.
+           */
+          struct Segment{
+            bool placeholder;
+            std::size_t index;
+            std::size_t start;
+            std::size_t length;
+          };
+
+
+          /**
+           * Content of the template, literal segments point to it.
+           */
+          std::string content_;
+
+
+          /**
+           * Segments of the template in order.
+           */
+          std::vector<Segment> segments_;
+
+
+          /**
+           * Names of the placeholders, segments refer to them by index.
+           */
+          std::vector<std::string> placeholders_;
+
+
+          /**
+           * Total length of the literal segments.
+           */
+          std::size_t literal_length_ = 0;
+
+
+          /**
+           * Adds a literal segment, empty literals are skipped.
+           * @param start  Position of the literal in the content.
+           * @param length Length of the literal.
+           */
+          void AddLiteral(const std::size_t start, const std::size_t length){
+            if (length > 0){
+              Segment segment;
+              segment.placeholder = false;
+              segment.index = 0;
+              segment.start = start;
+              segment.length = length;
+              segments_.push_back(segment);
+              literal_length_ += length;
+            }
+          };
+
+      };
+    }
+  }
+}
@@ -25,7 +25,10 @@
   */
 
 #pragma once
+#include <algorithm>
 #include <string>
+#include <utility>
+#include <vector>
 #include "cpprest/details/basic_types.h"
 #include "cpprest/json.h"
 
@@ -122,6 +125,45 @@ namespace granada{
         return null_json_value;
       };
 
+
+      /**
+       * Serializes a JSON value with the fields of its objects sorted by key,
+       * so equal values give the same string whatever the order of their fields.
+       * Used to build keys from JSON parameters.
+       * @param   json  JSON value to serialize.
+       * @return        Serialized JSON value.
+       */
+      static std::string canonical(const web::json::value& json){
+        if (json.is_object()){
+          std::vector<std::pair<utility::string_t,const web::json::value*>> fields;
+          for(auto it = json.as_object().cbegin(); it != json.as_object().cend(); ++it){
+            fields.push_back(std::make_pair(it->first, &it->second));
+          }
+          std::sort(fields.begin(), fields.end(), [](const std::pair<utility::string_t,const web::json::value*>& a, const std::pair<utility::string_t,const web::json::value*>& b){
+            return a.first < b.first;
+          });
+
+          std::string str = "{";
+          for(auto it = fields.begin(); it != fields.end(); ++it){
+            if (it != fields.begin()){
+              str += ",";
+            }
+            str += utility::conversions::to_utf8string(web::json::value::string(it->first).serialize()) + ":" + canonical(*it->second);
+          }
+          return str + "}";
+        }else if (json.is_array()){
+          std::string str = "[";
+          for(std::size_t i = 0; i < json.size(); ++i){
+            if (i > 0){
+              str += ",";
+            }
+            str += canonical(json.at(i));
+          }
+          return str + "]";
+        }
+        return utility::conversions::to_utf8string(json.serialize());
+      };
+
     }
   }
 }
@@ -0,0 +1,852 @@
+/**
+  * Copyright (c) <2016> Web App SDK granada <afernandez@cookinapps.io>
+  *
+  * This source code is licensed under the MIT license.
+  *
+  * Permission is hereby granted, free of charge, to any person obtaining a copy
+  * of this software and associated documentation files (the "Software"), to deal
+  * in the Software without restriction, including without limitation the rights
+  * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  * copies of the Software, and to permit persons to whom the Software is
+  * furnished to do so, subject to the following conditions:
+  *
+  * The above copyright notice and this permission notice shall be included in
+  * all copies or substantial portions of the Software.
+  *
+  * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  * SOFTWARE.
+  *
+  * Read-only JSON document parsed into a compact array of nodes.
+  * Used for reading the JSON strings stored in the cache without
+  * building a web::json::value.
+  */
+
+#pragma once
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include "cpprest/details/basic_types.h"
+#include "cpprest/json.h"
+#include "granada/util/string.h"
+
+namespace granada{
+  namespace util{
+    namespace json{
+
+      /**
+       * Read-only JSON document. The JSON text is validated and parsed in one
+       * pass into a flat array of nodes that reference the text instead of
+       * copying it, strings are only decoded when they are read.
+       * Malformed JSON does not throw, the document is just not valid.
+       *
+       * Each node knows where its subtree ends, so skipping a value,
+       * for example when looking for a field, does not look at its content.
+       *
+       * Use to_value() to convert the document or a part of it to
+       * a web::json::value when it has to be passed to the rest of the code.
+       *
+       * Example:
+       *    granada::util::json::document doc("{\"id\":\"math.sum\",\"events\":[\"calculate\"]}");
+       *    doc.root().find("id").as_string() == "math.sum";
+       *    for (auto it = doc.root().begin(); it != doc.root().end(); ++it){
+       *      it.key().as_string();
+       *      it.value().raw();
+       *    }
+       */
+      class document{
+
+        public:
+
+          /**
+           * Types of the JSON values.
+           */
+          enum type_t : unsigned char {null_type, boolean_type, number_type, string_type, array_type, object_type};
+
+
+        private:
+
+          /**
+           * Parsed JSON value. Strings reference the characters between the
+           * quotes, the rest of values all their characters.
+           */
+          struct node{
+            type_t type;
+
+            // strings: has escape sequences, numbers: has no fraction nor exponent.
+            bool flag;
+
+            uint32_t begin;
+            uint32_t length;
+
+            // index of the first node after the subtree of this node.
+            uint32_t next;
+          };
+
+
+        public:
+
+          class iterator;
+
+
+          /**
+           * JSON value of a document, a light reference to one of its nodes.
+           * Elements must not be used after the document is destroyed or parsed again.
+           */
+          class element{
+
+            public:
+
+              /**
+               * Constructor, element that does not exist.
+               */
+              element() : document_(nullptr), index_(0){};
+
+
+              /**
+               * Constructor.
+               * @param doc   Document.
+               * @param index Index of the node.
+               */
+              element(const document* doc, const std::size_t index) : document_(doc), index_(index){};
+
+
+              /**
+               * Returns true if the element exists, false if it is the result
+               * of looking for a missing field or the root of a document that is not valid.
+               */
+              bool exists() const { return document_ != nullptr; };
+
+              type_t type() const { return exists() ? node().type : null_type; };
+              bool is_null() const { return type() == null_type; };
+              bool is_boolean() const { return exists() && node().type == boolean_type; };
+              bool is_number() const { return exists() && node().type == number_type; };
+              bool is_integer() const { return is_number() && node().flag; };
+              bool is_string() const { return exists() && node().type == string_type; };
+              bool is_array() const { return exists() && node().type == array_type; };
+              bool is_object() const { return exists() && node().type == object_type; };
+
+
+              /**
+               * Returns the number of fields of an object or elements of an array,
+               * 0 for the rest of values.
+               * @return Number of fields or elements.
+               */
+              std::size_t size() const {
+                std::size_t size = 0;
+                for (iterator it = begin(); it != end(); ++it){
+                  ++size;
+                }
+                return size;
+              };
+
+
+              /**
+               * Returns the value of a field of an object.
+               * @param  key Key of the field.
+               * @return     Value of the field, an element that does not exist
+               *             if this is not an object or it does not have the field.
+               */
+              element find(const granada::util::string::view& key) const {
+                if (is_object()){
+                  for (iterator it = begin(); it != end(); ++it){
+                    if (it.key().equals(key)){
+                      return it.value();
+                    }
+                  }
+                }
+                return element();
+              };
+
+
+              /**
+               * Returns an element of an array.
+               * @param  position Position of the element.
+               * @return          Element, an element that does not exist
+               *                  if this is not an array or it is too short.
+               */
+              element at(std::size_t position) const {
+                if (is_array()){
+                  for (iterator it = begin(); it != end(); ++it){
+                    if (position-- == 0){
+                      return *it;
+                    }
+                  }
+                }
+                return element();
+              };
+
+
+              /**
+               * Returns true if the element is a string equal to the given one.
+               * Strings without escape sequences are compared without being decoded.
+               * @param  str String to compare.
+               * @return     True if they are equal.
+               */
+              bool equals(const granada::util::string::view& str) const {
+                if (!is_string()){
+                  return false;
+                }
+                if (node().flag){
+                  return granada::util::string::view(as_string()) == str;
+                }
+                return content() == str;
+              };
+
+
+              /**
+               * Returns the decoded string, or an empty string
+               * if the element is not a string.
+               * @return Decoded string, UTF-8.
+               */
+              std::string as_string() const {
+                std::string str;
+                if (is_string()){
+                  const granada::util::string::view& escaped = content();
+                  if (node().flag){
+                    Unescape(escaped, str);
+                  }else{
+                    str.assign(escaped.data(), escaped.size());
+                  }
+                }
+                return str;
+              };
+
+
+              /**
+               * Returns true if the element is the boolean true.
+               */
+              bool as_bool() const {
+                return is_boolean() && content()[0] == 't';
+              };
+
+
+              /**
+               * Returns the number, or 0 if the element is not a number.
+               */
+              double as_double() const {
+                if (is_number()){
+                  return std::strtod(content().str().c_str(), nullptr);
+                }
+                return 0;
+              };
+
+
+              /**
+               * Returns the number as an integer, or 0 if the element is not a number.
+               */
+              int64_t as_integer() const {
+                if (is_number()){
+                  return std::strtoll(content().str().c_str(), nullptr, 10);
+                }
+                return 0;
+              };
+
+
+              /**
+               * Returns the JSON text of the element, strings with their quotes.
+               * @return View of the JSON text, it references the text of the document.
+               */
+              granada::util::string::view raw() const {
+                if (!exists()){
+                  return granada::util::string::view();
+                }
+                if (is_string()){
+                  const granada::util::string::view& str = content();
+                  return granada::util::string::view(str.data() - 1, str.size() + 2);
+                }
+                return content();
+              };
+
+
+              /**
+               * Converts the element to a web::json::value.
+               * @return Converted value, null if the element does not exist.
+               */
+              web::json::value to_value() const {
+                switch (type()){
+                  case boolean_type:
+                    return web::json::value::boolean(as_bool());
+                  case number_type:
+                    return Number(content(), node().flag);
+                  case string_type:
+                    return web::json::value::string(utility::conversions::to_string_t(as_string()));
+                  case array_type:{
+                    web::json::value array = web::json::value::array(size());
+                    std::size_t i = 0;
+                    for (iterator it = begin(); it != end(); ++it){
+                      array[i++] = it.value().to_value();
+                    }
+                    return array;
+                  }
+                  case object_type:{
+                    web::json::value object = web::json::value::object();
+                    for (iterator it = begin(); it != end(); ++it){
+                      object[utility::conversions::to_string_t(it.key().as_string())] = it.value().to_value();
+                    }
+                    return object;
+                  }
+                  default:
+                    return web::json::value::null();
+                }
+              };
+
+
+              /**
+               * Returns an iterator to the first field of an object or
+               * element of an array.
+               */
+              iterator begin() const {
+                if (is_object() || is_array()){
+                  return iterator(document_, index_ + 1, node().type == object_type);
+                }
+                return end();
+              };
+
+
+              /**
+               * Returns an iterator past the last field or element.
+               */
+              iterator end() const {
+                return iterator(document_, exists() ? node().next : 0, is_object());
+              };
+
+
+            private:
+
+              friend class document;
+
+              const document* document_;
+              std::size_t index_;
+
+              const document::node& node() const { return document_->nodes_[index_]; };
+
+              granada::util::string::view content() const {
+                return granada::util::string::view(document_->source_.data() + node().begin, node().length);
+              };
+
+          };
+
+
+          /**
+           * Iterates through the fields of an object or the elements of an array.
+           */
+          class iterator{
+
+            public:
+
+              /**
+               * Constructor.
+               * @param doc    Document.
+               * @param index  Index of the node of the key of the field or of the element.
+               * @param object True if iterating through the fields of an object.
+               */
+              iterator(const document* doc, const std::size_t index, const bool object) : document_(doc), index_(index), object_(object){};
+
+
+              /**
+               * Returns the key of the field, an element that does not
+               * exist if iterating through an array.
+               */
+              element key() const {
+                return object_ ? element(document_, index_) : element();
+              };
+
+
+              /**
+               * Returns the value of the field or the element.
+               */
+              element value() const {
+                return element(document_, object_ ? index_ + 1 : index_);
+              };
+
+
+              element operator*() const { return value(); };
+
+              iterator& operator++(){
+                index_ = document_->nodes_[object_ ? index_ + 1 : index_].next;
+                return *this;
+              };
+
+              bool operator==(const iterator& other) const { return index_ == other.index_; };
+              bool operator!=(const iterator& other) const { return index_ != other.index_; };
+
+
+            private:
+
+              const document* document_;
+              std::size_t index_;
+              bool object_;
+
+          };
+
+
+          /**
+           * Constructor, document that is not valid.
+           */
+          document(){};
+
+
+          /**
+           * Constructor, parses the given JSON text.
+           * @param json JSON text.
+           */
+          explicit document(const std::string& json) : source_(json){
+            Parse();
+          };
+
+
+          /**
+           * Constructor, parses the given JSON text.
+           * @param json JSON text, moved into the document.
+           */
+          explicit document(std::string&& json) : source_(std::move(json)){
+            Parse();
+          };
+
+
+          /**
+           * Copying a document would leave its elements pointing to the
+           * text of the original one.
+           */
+          document(const document&) = delete;
+          document& operator=(const document&) = delete;
+
+
+          /**
+           * Parses the given JSON text, replacing the current content.
+           * @param  json JSON text.
+           * @return      True if the JSON is valid.
+           */
+          bool Parse(const std::string& json){
+            source_.assign(json);
+            return Parse();
+          };
+
+
+          /**
+           * Returns true if the text was valid JSON.
+           */
+          bool valid() const { return !nodes_.empty(); };
+
+
+          /**
+           * Returns the root value, an element that does not exist if
+           * the document is not valid.
+           */
+          element root() const {
+            return valid() ? element(this, 0) : element();
+          };
+
+
+          /**
+           * Returns the JSON text.
+           */
+          const std::string& source() const { return source_; };
+
+
+          /**
+           * Appends a string to a JSON text as a quoted and escaped JSON string.
+           * @param json JSON text.
+           * @param str  String to append, UTF-8.
+           */
+          static void Quote(std::string& json, const granada::util::string::view& str){
+            static const char hex[] = "0123456789abcdef";
+            json.reserve(json.size() + str.size() + 2);
+            json.push_back('"');
+            for (const char* it = str.begin(); it != str.end(); ++it){
+              const unsigned char c = (unsigned char)*it;
+              switch (c){
+                case '"': json.append("\\\"", 2); break;
+                case '\\': json.append("\\\\", 2); break;
+                case '\b': json.append("\\b", 2); break;
+                case '\f': json.append("\\f", 2); break;
+                case '\n': json.append("\\n", 2); break;
+                case '\r': json.append("\\r", 2); break;
+                case '\t': json.append("\\t", 2); break;
+                default:
+                  if (c < 0x20){
+                    json.append("\\u00", 4);
+                    json.push_back(hex[c >> 4]);
+                    json.push_back(hex[c & 0xf]);
+                  }else{
+                    json.push_back((char)c);
+                  }
+              }
+            }
+            json.push_back('"');
+          };
+
+
+        private:
+
+          /**
+           * Maximum nesting of arrays and objects.
+           */
+          static const int max_depth_ = 512;
+
+
+          /**
+           * JSON text.
+           */
+          std::string source_;
+
+
+          /**
+           * Parsed values in the order they appear in the text.
+           * Empty if the text is not valid JSON.
+           */
+          std::vector<node> nodes_;
+
+
+          /**
+           * Parses the text.
+           * @return True if it is valid JSON.
+           */
+          bool Parse(){
+            nodes_.clear();
+            if (source_.size() >= UINT32_MAX){
+              return false;
+            }
+            nodes_.reserve(source_.size() / 8 + 1);
+            std::size_t pos = 0;
+            if (!ParseValue(pos, 0) || (SkipWhitespace(pos), pos != source_.size())){
+              nodes_.clear();
+              return false;
+            }
+            return true;
+          };
+
+
+          void SkipWhitespace(std::size_t& pos) const {
+            while (pos < source_.size() && (source_[pos] == ' ' || source_[pos] == '\n' || source_[pos] == '\r' || source_[pos] == '\t')){
+              ++pos;
+            }
+          };
+
+
+          void AddNode(const type_t type, const bool flag, const std::size_t begin, const std::size_t length){
+            node n;
+            n.type = type;
+            n.flag = flag;
+            n.begin = (uint32_t)begin;
+            n.length = (uint32_t)length;
+            n.next = (uint32_t)(nodes_.size() + 1);
+            nodes_.push_back(n);
+          };
+
+
+          bool ParseValue(std::size_t& pos, const int depth){
+            SkipWhitespace(pos);
+            if (pos >= source_.size()){
+              return false;
+            }
+            switch (source_[pos]){
+              case '{': return ParseContainer(pos, depth, object_type, '}');
+              case '[': return ParseContainer(pos, depth, array_type, ']');
+              case '"': return ParseString(pos);
+              case 't': return ParseLiteral(pos, "true", boolean_type);
+              case 'f': return ParseLiteral(pos, "false", boolean_type);
+              case 'n': return ParseLiteral(pos, "null", null_type);
+              default: return ParseNumber(pos);
+            }
+          };
+
+
+          bool ParseContainer(std::size_t& pos, const int depth, const type_t type, const char close){
+            if (depth >= max_depth_){
+              return false;
+            }
+            const std::size_t index = nodes_.size();
+            AddNode(type, false, pos, 0);
+            ++pos;
+            SkipWhitespace(pos);
+            if (pos < source_.size() && source_[pos] == close){
+              ++pos;
+            }else{
+              for (;;){
+                if (type == object_type){
+                  SkipWhitespace(pos);
+                  if (pos >= source_.size() || source_[pos] != '"' || !ParseString(pos)){
+                    return false;
+                  }
+                  SkipWhitespace(pos);
+                  if (pos >= source_.size() || source_[pos] != ':'){
+                    return false;
+                  }
+                  ++pos;
+                }
+                if (!ParseValue(pos, depth + 1)){
+                  return false;
+                }
+                SkipWhitespace(pos);
+                if (pos >= source_.size()){
+                  return false;
+                }
+                const char c = source_[pos++];
+                if (c == close){
+                  break;
+                }
+                if (c != ','){
+                  return false;
+                }
+              }
+            }
+            nodes_[index].length = (uint32_t)(pos - nodes_[index].begin);
+            nodes_[index].next = (uint32_t)nodes_.size();
+            return true;
+          };
+
+
+          bool ParseString(std::size_t& pos){
+            const char* const first = source_.data();
+            const char* const last = first + source_.size();
+            const char* it = first + ++pos;
+            bool escaped = false;
+            for (; (it = FindSpecial(it, last)) != last; ++it){
+              const unsigned char c = (unsigned char)*it;
+              if (c == '"'){
+                AddNode(string_type, escaped, pos, it - first - pos);
+                pos = it - first + 1;
+                return true;
+              }
+              if (c < 0x20){
+                return false;
+              }
+              if (c == '\\'){
+                escaped = true;
+                if (++it == last){
+                  return false;
+                }
+                switch (*it){
+                  case '"': case '\\': case '/': case 'b': case 'f': case 'n': case 'r': case 't':
+                    break;
+                  case 'u':
+                    if (last - it <= 4 || Hex(it[1]) < 0 || Hex(it[2]) < 0 || Hex(it[3]) < 0 || Hex(it[4]) < 0){
+                      return false;
+                    }
+                    it += 4;
+                    break;
+                  default:
+                    return false;
+                }
+              }
+            }
+            return false;
+          };
+
+
+          /**
+           * Returns a pointer to the first character of a range that ends
+           * or escapes a string or is a control character, comparing 16
+           * characters at a time when SSE2 is available.
+           * @param  first First character of the range.
+           * @param  last  End of the range.
+           * @return       Pointer to the character, last if there is none.
+           */
+          static const char* FindSpecial(const char* first, const char* last){
+#ifdef GRANADA_STRING_SSE2
+            const __m128i quote = _mm_set1_epi8('"');
+            const __m128i backslash = _mm_set1_epi8('\\');
+            const __m128i control = _mm_set1_epi8(0x1f);
+            while (last - first >= 16){
+              const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first));
+              const __m128i special = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, quote), _mm_cmpeq_epi8(chunk, backslash)),
+                                                   _mm_cmpeq_epi8(_mm_max_epu8(chunk, control), control));
+              const int mask = _mm_movemask_epi8(special);
+              if (mask != 0){
+#ifdef _MSC_VER
+                unsigned long index;
+                _BitScanForward(&index, (unsigned long)mask);
+                return first + index;
+#else
+                return first + __builtin_ctz((unsigned int)mask);
+#endif
+              }
+              first += 16;
+            }
+#endif
+            for (; first != last; ++first){
+              const unsigned char c = (unsigned char)*first;
+              if (c == '"' || c == '\\' || c < 0x20){
+                return first;
+              }
+            }
+            return last;
+          };
+
+
+          bool ParseLiteral(std::size_t& pos, const char* literal, const type_t type){
+            const std::size_t length = std::char_traits<char>::length(literal);
+            if (source_.compare(pos, length, literal) != 0){
+              return false;
+            }
+            AddNode(type, false, pos, length);
+            pos += length;
+            return true;
+          };
+
+
+          bool ParseNumber(std::size_t& pos){
+            const std::size_t begin = pos;
+            bool integer = true;
+            if (pos < source_.size() && source_[pos] == '-'){
+              ++pos;
+            }
+            if (pos < source_.size() && source_[pos] == '0'){
+              ++pos;
+            }else if (!ParseDigits(pos)){
+              return false;
+            }
+            if (pos < source_.size() && source_[pos] == '.'){
+              integer = false;
+              ++pos;
+              if (!ParseDigits(pos)){
+                return false;
+              }
+            }
+            if (pos < source_.size() && (source_[pos] == 'e' || source_[pos] == 'E')){
+              integer = false;
+              ++pos;
+              if (pos < source_.size() && (source_[pos] == '+' || source_[pos] == '-')){
+                ++pos;
+              }
+              if (!ParseDigits(pos)){
+                return false;
+              }
+            }
+            AddNode(number_type, integer, begin, pos - begin);
+            return true;
+          };
+
+
+          bool ParseDigits(std::size_t& pos) const {
+            const std::size_t begin = pos;
+            while (pos < source_.size() && source_[pos] >= '0' && source_[pos] <= '9'){
+              ++pos;
+            }
+            return pos > begin;
+          };
+
+
+          static int Hex(const char c){
+            if (c >= '0' && c <= '9') return c - '0';
+            if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+            if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+            return -1;
+          };
+
+
+          static unsigned int CodeUnit(const char* it){
+            return (Hex(it[0]) << 12) | (Hex(it[1]) << 8) | (Hex(it[2]) << 4) | Hex(it[3]);
+          };
+
+
+          /**
+           * Decodes the escape sequences of an already validated JSON string.
+           * @param escaped Characters between the quotes.
+           * @param str     Decoded string, UTF-8.
+           */
+          static void Unescape(const granada::util::string::view& escaped, std::string& str){
+            str.reserve(escaped.size());
+            for (const char* it = escaped.begin(); it != escaped.end(); ++it){
+              if (*it != '\\'){
+                str.push_back(*it);
+                continue;
+              }
+              switch (*++it){
+                case 'b': str.push_back('\b'); break;
+                case 'f': str.push_back('\f'); break;
+                case 'n': str.push_back('\n'); break;
+                case 'r': str.push_back('\r'); break;
+                case 't': str.push_back('\t'); break;
+                case 'u':{
+                  unsigned int code_point = CodeUnit(it + 1);
+                  it += 4;
+                  if (code_point >= 0xd800 && code_point < 0xdc00 && escaped.end() - it > 6 && it[1] == '\\' && it[2] == 'u'){
+                    const unsigned int low = CodeUnit(it + 3);
+                    if (low >= 0xdc00 && low < 0xe000){
+                      code_point = 0x10000 + ((code_point - 0xd800) << 10) + (low - 0xdc00);
+                      it += 6;
+                    }
+                  }
+                  if (code_point < 0x80){
+                    str.push_back((char)code_point);
+                  }else if (code_point < 0x800){
+                    str.push_back((char)(0xc0 | (code_point >> 6)));
+                    str.push_back((char)(0x80 | (code_point & 0x3f)));
+                  }else if (code_point < 0x10000){
+                    str.push_back((char)(0xe0 | (code_point >> 12)));
+                    str.push_back((char)(0x80 | ((code_point >> 6) & 0x3f)));
+                    str.push_back((char)(0x80 | (code_point & 0x3f)));
+                  }else{
+                    str.push_back((char)(0xf0 | (code_point >> 18)));
+                    str.push_back((char)(0x80 | ((code_point >> 12) & 0x3f)));
+                    str.push_back((char)(0x80 | ((code_point >> 6) & 0x3f)));
+                    str.push_back((char)(0x80 | (code_point & 0x3f)));
+                  }
+                  break;
+                }
+                default: str.push_back(*it);
+              }
+            }
+          };
+
+
+          /**
+           * Converts a JSON number to a web::json::value, integers that fit
+           * in 64 bits keep being integers as when cpprest parses them.
+           * @param  number  JSON text of the number.
+           * @param  integer True if the number has no fraction nor exponent.
+           * @return         Number.
+           */
+          static web::json::value Number(const granada::util::string::view& number, const bool integer){
+            const std::string& str = number.str();
+            if (integer){
+              errno = 0;
+              if (str[0] == '-'){
+                const long long value = std::strtoll(str.c_str(), nullptr, 10);
+                if (errno == 0){
+                  return web::json::value::number((int64_t)value);
+                }
+              }else{
+                const unsigned long long value = std::strtoull(str.c_str(), nullptr, 10);
+                if (errno == 0){
+                  if (value <= (unsigned long long)INT64_MAX){
+                    return web::json::value::number((int64_t)value);
+                  }
+                  return web::json::value::number((uint64_t)value);
+                }
+              }
+            }
+            return web::json::value::number(std::strtod(str.c_str(), nullptr));
+          };
+
+      };
+
+
+      /**
+       * Parses a string to a web::json::value through a document, if the
+       * string is not valid JSON returns an empty JSON object {}.
+       * Same as granada::util::string::to_json but without throwing
+       * and catching an exception for malformed JSON.
+       * @param  str String to parse.
+       * @return     Parsed JSON.
+       */
+      static inline web::json::value parse(const std::string& str){
+        const document doc(str);
+        if (doc.valid()){
+          return doc.root().to_value();
+        }
+        return web::json::value::object();
+      };
+
+    }
+  }
+}
@@ -0,0 +1,387 @@
+/**
+  * Copyright (c) <2016> Web App SDK granada <afernandez@cookinapps.io>
+  *
+  * This source code is licensed under the MIT license.
+  *
+  * Permission is hereby granted, free of charge, to any person obtaining a copy
+  * of this software and associated documentation files (the "Software"), to deal
+  * in the Software without restriction, including without limitation the rights
+  * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  * copies of the Software, and to permit persons to whom the Software is
+  * furnished to do so, subject to the following conditions:
+  *
+  * The above copyright notice and this permission notice shall be included in
+  * all copies or substantial portions of the Software.
+  *
+  * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  * SOFTWARE.
+  *
+  * Lightweight metrics: counters and latency histograms cheap enough
+  * to be updated in the hot paths, aggregated when they are read.
+  *
+  */
+
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace granada{
+  namespace util{
+
+    /**
+     * Lightweight metrics. Counters and histograms are split in cells,
+     * each thread updates its own cell with a relaxed atomic operation,
+     * so threads do not fight for the same cache line. The cells are
+     * added up only when the metrics are read.
+     *
+     * Metrics are registered once, usually in a function-local static,
+     * and never destroyed:
+     *
+     *    static granada::util::metrics::Histogram& latency = granada::util::metrics::GetHistogram(
+     *      "granada_cache_operation_seconds", "Latency of the cache operations.", "driver=\"redis\",operation=\"read\"");
+     *    granada::util::metrics::Timer timer(latency);
+     *
+     * Text() returns all the metrics in the Prometheus text format,
+     * see granada::http::controller::MetricsController.
+     */
+    namespace metrics{
+
+      /**
+       * Number of cells of each metric.
+       */
+      const std::size_t cells = 16;
+
+
+      /**
+       * Returns the cell the calling thread updates. Threads are
+       * given cells in turn the first time they update a metric.
+       * @return Index of the cell.
+       */
+      inline std::size_t cell(){
+        static std::atomic<std::size_t> next(0);
+        static thread_local const std::size_t index = next.fetch_add(1, std::memory_order_relaxed) % cells;
+        return index;
+      };
+
+
+      /**
+       * Monotonic counter.
+       * This code is multi-thread safe.
+       */
+      class Counter{
+
+        public:
+
+          /**
+           * Adds a number to the counter.
+           * @param n Number to add, 1 by default.
+           */
+          void Increment(const uint64_t n = 1){
+            cells_[cell()].value.fetch_add(n, std::memory_order_relaxed);
+          };
+
+
+          /**
+           * Returns the value of the counter.
+           * @return Sum of the cells.
+           */
+          uint64_t value() const{
+            uint64_t value = 0;
+            for (std::size_t i = 0; i < cells; ++i){
+              value += cells_[i].value.load(std::memory_order_relaxed);
+            }
+            return value;
+          };
+
+
+        private:
+
+          /**
+           * Cell padded to fill a cache line.
+           */
+          struct Cell{
+            std::atomic<uint64_t> value{0};
+            char padding[64 - sizeof(std::atomic<uint64_t>)];
+          };
+
+
+          /**
+           * Cells of the counter.
+           */
+          Cell cells_[cells];
+      };
+
+
+      /**
+       * Histogram of latencies in microseconds with log-linear buckets,
+       * like HdrHistogram: each power of two is divided in 8 buckets, so
+       * a value is known with an error of less than 12.5%, from
+       * 1 microsecond to about 12 days. Percentiles are computed
+       * from the buckets when the histogram is read.
+       * This code is multi-thread safe.
+       */
+      class Histogram{
+
+        public:
+
+          /**
+           * Number of buckets each power of two is divided in (2^sub_bucket_bits).
+           */
+          static const int sub_bucket_bits = 3;
+
+
+          /**
+           * Number of buckets.
+           */
+          static const std::size_t bucket_count = 304;
+
+
+          /**
+           * Aggregated values of the histogram.
+           */
+          struct Snapshot{
+
+            /**
+             * Number of values in each bucket.
+             */
+            std::vector<uint64_t> buckets;
+
+
+            /**
+             * Number of values.
+             */
+            uint64_t count = 0;
+
+
+            /**
+             * Sum of the values in microseconds.
+             */
+            uint64_t sum = 0;
+
+
+            /**
+             * Returns the value below which a given fraction of the values fall.
+             * @param  quantile Fraction between 0 and 1, example: 0.99.
+             * @return          Value in microseconds, the upper bound of the
+             *                  bucket containing it. 0 if there are no values.
+             */
+            uint64_t Quantile(const double quantile) const{
+              if (count == 0){
+                return 0;
+              }
+              uint64_t rank = (uint64_t)(quantile * (double)count);
+              if (rank >= count){
+                rank = count - 1;
+              }
+              uint64_t seen = 0;
+              for (std::size_t i = 0; i < buckets.size(); ++i){
+                seen += buckets[i];
+                if (seen > rank){
+                  return UpperBound(i);
+                }
+              }
+              return UpperBound(buckets.size() - 1);
+            };
+          };
+
+
+          /**
+           * Constructor
+           */
+          Histogram() : cells_(new Cell[cells]){};
+
+
+          /**
+           * Records a value.
+           * @param microseconds Value in microseconds.
+           */
+          void Record(const uint64_t microseconds){
+            Cell& cell = cells_[granada::util::metrics::cell()];
+            cell.buckets[Bucket(microseconds)].fetch_add(1, std::memory_order_relaxed);
+            cell.count.fetch_add(1, std::memory_order_relaxed);
+            cell.sum.fetch_add(microseconds, std::memory_order_relaxed);
+          };
+
+
+          /**
+           * Records a duration.
+           * @param duration Duration.
+           */
+          void Record(const std::chrono::steady_clock::duration duration){
+            const long long microseconds = std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+            Record((uint64_t)(microseconds > 0 ? microseconds : 0));
+          };
+
+
+          /**
+           * Returns the aggregated values of the histogram.
+           * @return Snapshot.
+           */
+          Snapshot snapshot() const{
+            Snapshot snapshot;
+            snapshot.buckets.assign(bucket_count, 0);
+            for (std::size_t c = 0; c < cells; ++c){
+              const Cell& cell = cells_[c];
+              for (std::size_t i = 0; i < bucket_count; ++i){
+                snapshot.buckets[i] += cell.buckets[i].load(std::memory_order_relaxed);
+              }
+              snapshot.count += cell.count.load(std::memory_order_relaxed);
+              snapshot.sum += cell.sum.load(std::memory_order_relaxed);
+            }
+            return snapshot;
+          };
+
+
+          /**
+           * Returns the bucket of a value. Values lower than 8 have
+           * a bucket each, the others are placed by their highest bit
+           * and the 3 bits that follow it.
+           * @param  value Value.
+           * @return       Index of the bucket.
+           */
+          static std::size_t Bucket(const uint64_t value){
+            const uint64_t sub_buckets = 1 << sub_bucket_bits;
+            if (value < sub_buckets){
+              return (std::size_t)value;
+            }
+            int exponent = 63;
+            while (!(value >> exponent)){
+              exponent--;
+            }
+            const std::size_t index = (exponent - sub_bucket_bits + 1) * sub_buckets + ((value >> (exponent - sub_bucket_bits)) & (sub_buckets - 1));
+            return index < bucket_count ? index : bucket_count - 1;
+          };
+
+
+          /**
+           * Returns the highest value of a bucket.
+           * @param  index Index of the bucket.
+           * @return       Highest value.
+           */
+          static uint64_t UpperBound(const std::size_t index){
+            const uint64_t sub_buckets = 1 << sub_bucket_bits;
+            if (index < sub_buckets){
+              return index;
+            }
+            const int exponent = (int)(index / sub_buckets) + sub_bucket_bits - 1;
+            const uint64_t sub_bucket = index % sub_buckets;
+            return ((sub_buckets + sub_bucket + 1) << (exponent - sub_bucket_bits)) - 1;
+          };
+
+
+        private:
+
+          /**
+           * Buckets, count and sum updated by the same threads.
+           */
+          struct Cell{
+            std::atomic<uint64_t> buckets[bucket_count];
+            std::atomic<uint64_t> count;
+            std::atomic<uint64_t> sum;
+            char padding[64];
+
+            Cell(){
+              for (std::size_t i = 0; i < bucket_count; ++i){
+                buckets[i].store(0, std::memory_order_relaxed);
+              }
+              count.store(0, std::memory_order_relaxed);
+              sum.store(0, std::memory_order_relaxed);
+            };
+          };
+
+
+          /**
+           * Cells of the histogram.
+           */
+          std::unique_ptr<Cell[]> cells_;
+      };
+
+
+      /**
+       * Records in a histogram the time elapsed from
+       * its construction to its destruction.
+       *
+       * Example:
+       *    {
+       *      granada::util::metrics::Timer timer(latency);
+       *      ... code to measure ...
+       *    }
+       */
+      class Timer{
+
+        public:
+
+          /**
+           * Constructor, starts measuring.
+           * @param histogram Histogram the elapsed time is recorded in.
+           */
+          Timer(Histogram& histogram) : histogram_(histogram), start_(std::chrono::steady_clock::now()){};
+
+
+          /**
+           * Destructor, records the elapsed time.
+           */
+          ~Timer(){
+            histogram_.Record(std::chrono::steady_clock::now() - start_);
+          };
+
+
+        private:
+
+          /**
+           * Histogram the elapsed time is recorded in.
+           */
+          Histogram& histogram_;
+
+
+          /**
+           * Time the measure started.
+           */
+          const std::chrono::steady_clock::time_point start_;
+      };
+
+
+      /**
+       * Returns the counter with the given name and labels, registering
+       * it the first time. The counter is never destroyed.
+       * @param  name   Name of the metric, example: granada_session_loads_total.
+       * @param  help   Description of the metric.
+       * @param  labels Labels distinguishing the counters with the same name,
+       *                example: result="found". Empty by default.
+       * @return        Counter.
+       */
+      Counter& GetCounter(const std::string& name, const std::string& help, const std::string& labels = "");
+
+
+      /**
+       * Returns the histogram with the given name and labels, registering
+       * it the first time. The histogram is never destroyed.
+       * @param  name   Name of the metric, example: granada_session_load_seconds.
+       * @param  help   Description of the metric.
+       * @param  labels Labels distinguishing the histograms with the same name,
+       *                example: driver="redis",operation="read". Empty by default.
+       * @return        Histogram.
+       */
+      Histogram& GetHistogram(const std::string& name, const std::string& help, const std::string& labels = "");
+
+
+      /**
+       * Returns all the metrics in the Prometheus text exposition format.
+       * Counters are written as counters and histograms as summaries
+       * with the 0.5, 0.9, 0.99 and 0.999 quantiles in seconds.
+       * @return Metrics.
+       */
+      std::string Text();
+
+    }
+  }
+}
@@ -28,12 +28,20 @@
 
 #include <algorithm>
 #include <cctype>
+#include <cstring>
 #include <locale>
 #include <string>
 #include <sstream>
 #include <vector>
 #include <deque>
 #include <unordered_map>
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define GRANADA_STRING_SSE2
+#include <emmintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
 #include "cpprest/details/basic_types.h"
 #include "cpprest/json.h"
 
@@ -45,12 +53,170 @@ namespace granada{
      */
     namespace string{
 
+      /**
+       * Non-owning reference to a sequence of characters, used to
+       * parse strings without copying each of their parts. The referenced
+       * characters must outlive the view.
+       *
+       * Example:
+       *      const std::string query = "id=0&quantity=2";
+       *      view first(query.data(), 4);
+       *      first.str() => "id=0"
+       */
+      class view{
+
+        public:
+
+          /**
+           * Constructor, empty view.
+           */
+          view() : data_(""), size_(0){};
+
+
+          /**
+           * Constructor.
+           * @param data  First character.
+           * @param size  Number of characters.
+           */
+          view(const char* data, const std::size_t size) : data_(data), size_(size){};
+
+
+          /**
+           * Constructor, view of a whole string.
+           * @param str String.
+           */
+          view(const std::string& str) : data_(str.data()), size_(str.size()){};
+
+
+          /**
+           * Constructor, view of a null terminated string.
+           * @param str String.
+           */
+          view(const char* str) : data_(str), size_(std::strlen(str)){};
+
+
+          const char* data() const { return data_; };
+          std::size_t size() const { return size_; };
+          bool empty() const { return size_ == 0; };
+          const char* begin() const { return data_; };
+          const char* end() const { return data_ + size_; };
+          char operator[](const std::size_t pos) const { return data_[pos]; };
+
+
+          /**
+           * Returns a copy of the referenced characters.
+           * @return String.
+           */
+          std::string str() const { return std::string(data_, size_); };
+
+
+          /**
+           * Returns a view of a part of this view.
+           * @param  pos    Position of the first character.
+           * @param  length Number of characters, the part goes until the
+           *                end of the view if there are less.
+           * @return        View of the part.
+           */
+          view substr(const std::size_t pos, const std::size_t length = std::string::npos) const {
+            const std::size_t start = pos < size_ ? pos : size_;
+            return view(data_ + start, std::min(length, size_ - start));
+          };
+
+
+          bool operator==(const view& other) const {
+            return size_ == other.size_ && std::memcmp(data_, other.data_, size_) == 0;
+          };
+
+
+          bool operator!=(const view& other) const {
+            return !(*this == other);
+          };
+
+
+        private:
+
+          const char* data_;
+          std::size_t size_;
+      };
+
+
+      /**
+       * Returns a pointer to the first occurrence of a character in a
+       * range of characters. Uses memchr, vectorized by the C library.
+       * @param  first First character of the range.
+       * @param  last  End of the range.
+       * @param  c     Character to find.
+       * @return       Pointer to the character, last if it is not found.
+       */
+      static inline const char* find(const char* first, const char* last, const char c){
+        const void* found = first == last ? nullptr : std::memchr(first, c, last - first);
+        return found ? static_cast<const char*>(found) : last;
+      }
+
+
+      /**
+       * Returns a pointer to the first occurrence of any of two characters
+       * in a range of characters, comparing 16 characters at a time when
+       * SSE2 is available. Used to tokenize key-value lists like query
+       * strings in a single pass.
+       * @param  first First character of the range.
+       * @param  last  End of the range.
+       * @param  a     Character to find.
+       * @param  b     Other character to find.
+       * @return       Pointer to the first of the characters, last if none is found.
+       */
+      static inline const char* find_first_of(const char* first, const char* last, const char a, const char b){
+#ifdef GRANADA_STRING_SSE2
+        const __m128i va = _mm_set1_epi8(a);
+        const __m128i vb = _mm_set1_epi8(b);
+        while (last - first >= 16){
+          const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first));
+          const int mask = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(chunk, va), _mm_cmpeq_epi8(chunk, vb)));
+          if (mask != 0){
+#ifdef _MSC_VER
+            unsigned long index;
+            _BitScanForward(&index, (unsigned long)mask);
+            return first + index;
+#else
+            return first + __builtin_ctz((unsigned int)mask);
+#endif
+          }
+          first += 16;
+        }
+#endif
+        for (; first != last; ++first){
+          if (*first == a || *first == b){
+            return first;
+          }
+        }
+        return last;
+      }
+
+
+      /**
+       * Returns a view without the white spaces at the start and the end.
+       * @param  s View to trim.
+       * @return   Trimmed view.
+       */
+      static inline view trimmed(const view& s){
+        const char* first = s.begin();
+        const char* last = s.end();
+        while (first != last && std::isspace((unsigned char)*first)){
+          ++first;
+        }
+        while (last != first && std::isspace((unsigned char)*(last - 1))){
+          --last;
+        }
+        return view(first, last - first);
+      }
+
+
       /**
        * Trim from start
        * @param s String to ltrim.
        */
       static inline void ltrim(std::string &s) {
-          s.erase(s.begin(), std::find_if(s.begin(), s.end(), std::not1(std::ptr_fun<int, int>(std::isspace))));
+          s.erase(s.begin(), std::find_if(s.begin(), s.end(), [](unsigned char c){ return !std::isspace(c); }));
       }
 
       /**
@@ -58,7 +224,7 @@ namespace granada{
        * @param s String to rtrim.
        */
       static inline void rtrim(std::string &s) {
-          s.erase(std::find_if(s.rbegin(), s.rend(), std::not1(std::ptr_fun<int, int>(std::isspace))).base(), s.end());
+          s.erase(std::find_if(s.rbegin(), s.rend(), [](unsigned char c){ return !std::isspace(c); }).base(), s.end());
       }
 
       /**
@@ -66,10 +232,98 @@ namespace granada{
        * @param s String to trim.
        */
       static inline void trim(std::string &s) {
-          ltrim(s);
           rtrim(s);
+          ltrim(s);
       }
 
+
+      /**
+       * Splits a string into views with a given delimiter, without
+       * copying the parts. As with std::getline, a delimiter at the end
+       * does not produce an empty last part.
+       *
+       * Example:
+       *      for (const view& part : splitter(query_string, '&')){
+       *        ...
+       *      }
+       *
+       * The split string must outlive the splitter and the views.
+       */
+      class splitter{
+
+        public:
+
+          /**
+           * Iterator over the parts of the split string.
+           */
+          class iterator{
+
+            public:
+
+              iterator(const char* first, const char* last, const char delim) : last_(last), delim_(delim){
+                Next(first);
+              };
+
+              const view& operator*() const { return part_; };
+              const view* operator->() const { return &part_; };
+
+              iterator& operator++(){
+                Next(next_);
+                return *this;
+              };
+
+              bool operator==(const iterator& other) const { return next_ == other.next_ && part_.data() == other.part_.data(); };
+              bool operator!=(const iterator& other) const { return !(*this == other); };
+
+            private:
+
+              const char* last_;
+              char delim_;
+
+              /**
+               * Current part.
+               */
+              view part_;
+
+              /**
+               * Start of the next part, nullptr when there are no more parts.
+               */
+              const char* next_;
+
+              /**
+               * Moves to the part starting at the given position.
+               * @param first Start of the part.
+               */
+              void Next(const char* first){
+                if (first == nullptr || first == last_){
+                  part_ = view(last_, 0);
+                  next_ = nullptr;
+                  return;
+                }
+                const char* delim = granada::util::string::find(first, last_, delim_);
+                part_ = view(first, delim - first);
+                next_ = delim == last_ ? last_ : delim + 1;
+              };
+          };
+
+
+          /**
+           * Constructor.
+           * @param s     String to split.
+           * @param delim Delimiter.
+           */
+          splitter(const view& s, const char delim) : s_(s), delim_(delim){};
+
+          iterator begin() const { return iterator(s_.begin(), s_.end(), delim_); };
+          iterator end() const { return iterator(nullptr, s_.end(), delim_); };
+
+        private:
+
+          view s_;
+          char delim_;
+      };
+
+
       /**
        * Split a string into a vector with a given delimiter.
        * @param   s     String to split.
@@ -78,14 +332,293 @@ namespace granada{
        * @return        Vector containing the splitted string.
        */
       static void split(const std::string &s, char delim, std::vector<std::string> &elems) {
-        std::stringstream ss(s);
-        std::string item;
-        while (std::getline(ss, item, delim)) {
-            elems.push_back(item);
+        for (const view& part : splitter(s, delim)){
+          elems.push_back(part.str());
         }
       }
 
 
+      /**
+       * Split a string into a vector of views with a given delimiter,
+       * without copying the parts.
+       * @param   s     String to split, must outlive the views.
+       * @param   delim Delimiter.
+       * @param   elems Vector containing the views of the parts.
+       */
+      static inline void split(const view& s, char delim, std::vector<view> &elems) {
+        for (const view& part : splitter(s, delim)){
+          elems.push_back(part);
+        }
+      }
+
+
+      /**
+       * Replaces several patterns in a string in a single pass, with an
+       * Aho-Corasick automaton built from the patterns. Each character of
+       * the content is read once whatever the number of patterns, and the
+       * result is built in one buffer.
+       *
+       * Replaced values are not searched again. When two patterns overlap
+       * the one that ends first is replaced, and if several end at the same
+       * position the longest. If a pattern is added twice the first value
+       * is used.
+       *
+       * Example:
+       *      replacer tags;
+       *      tags.Add("{{username}}", "John Doe");
+       *      tags.Add("{{date}}", "Tuesday, May 17, 2016");
+       *      std::string content = "hello {{username}} !!! {{date}}";
+       *      tags.Replace(content);
+       *      => hello John Doe !!! Tuesday, May 17, 2016
+       *
+       * Once all the patterns are added and Build() or Replace() has been
+       * called, a replacer can be used by multiple threads.
+       */
+      class replacer{
+
+        public:
+
+          /**
+           * Constructor
+           */
+          replacer() : nodes_(1){
+            std::fill(first_bytes_, first_bytes_ + 256, false);
+          };
+
+
+          /**
+           * Adds a pattern and the value it is replaced with,
+           * empty patterns are ignored.
+           * @param pattern Pattern.
+           * @param value   Value.
+           */
+          void Add(const std::string& pattern, const std::string& value){
+            if (pattern.empty()){
+              return;
+            }
+            int node = 0;
+            for (auto it = pattern.begin(); it != pattern.end(); ++it){
+              const unsigned char c = (unsigned char)*it;
+              int next = Child(node, c);
+              if (next == 0){
+                next = (int)nodes_.size();
+                nodes_.push_back(Node());
+                nodes_[next].c = c;
+                nodes_[next].sibling = nodes_[node].child;
+                nodes_[node].child = next;
+              }
+              node = next;
+            }
+            if (nodes_[node].value < 0){
+              nodes_[node].value = (int)values_.size();
+              nodes_[node].length = pattern.size();
+              values_.push_back(value);
+            }
+            first_bytes_[(unsigned char)pattern[0]] = true;
+            built_ = false;
+          };
+
+
+          /**
+           * Replaces all the patterns in the content.
+           * @param content Content.
+           */
+          void Replace(std::string& content){
+            if (!built_){
+              Build();
+            }
+            std::string buffer;
+            if (Apply(content, buffer)){
+              content.swap(buffer);
+            }
+          };
+
+
+          /**
+           * Computes the failure links of the automaton, called by
+           * Replace() if patterns were added since the last call.
+           */
+          void Build(){
+            // breadth-first, so the failure link of a node is
+            // computed before the ones of its children.
+            std::vector<int> queue;
+            queue.reserve(nodes_.size());
+            for (int child = nodes_[0].child; child != 0; child = nodes_[child].sibling){
+              nodes_[child].fail = 0;
+              queue.push_back(child);
+            }
+            for (std::size_t i = 0; i < queue.size(); ++i){
+              const int node = queue[i];
+              // a node without a value outputs the longest pattern
+              // ending at its failure link, if any.
+              if (nodes_[node].value < 0){
+                nodes_[node].output = nodes_[nodes_[node].fail].output;
+              }else{
+                nodes_[node].output = node;
+              }
+              for (int child = nodes_[node].child; child != 0; child = nodes_[child].sibling){
+                int fail = nodes_[node].fail;
+                while (fail != 0 && Child(fail, nodes_[child].c) == 0){
+                  fail = nodes_[fail].fail;
+                }
+                nodes_[child].fail = Child(fail, nodes_[child].c);
+                queue.push_back(child);
+              }
+            }
+            single_first_byte_ = -1;
+            int first_bytes = 0;
+            for (int c = 0; c < 256; ++c){
+              if (first_bytes_[c]){
+                single_first_byte_ = c;
+                ++first_bytes;
+              }
+            }
+            if (first_bytes != 1){
+              single_first_byte_ = -1;
+            }
+            built_ = true;
+          };
+
+
+        private:
+
+          /**
+           * Node of the automaton, the root is the node 0.
+           */
+          struct Node{
+            /**
+             * First child, 0 if none. Children are few so they are kept
+             * in a linked list and searched linearly.
+             */
+            int child = 0;
+
+            /**
+             * Next child of the parent, 0 if none.
+             */
+            int sibling = 0;
+
+            /**
+             * Character leading to this node from its parent.
+             */
+            unsigned char c = 0;
+
+            /**
+             * Longest proper suffix of this node that is also a node.
+             */
+            int fail = 0;
+
+            /**
+             * Index of the value of the pattern ending in this node, -1 if none.
+             */
+            int value = -1;
+
+            /**
+             * Length of the pattern ending in this node.
+             */
+            std::size_t length = 0;
+
+            /**
+             * Node with the longest pattern that ends here, 0 if none.
+             */
+            int output = 0;
+          };
+
+
+          std::vector<Node> nodes_;
+
+
+          std::vector<std::string> values_;
+
+
+          /**
+           * Characters patterns start with.
+           */
+          bool first_bytes_[256];
+
+
+          /**
+           * Character all the patterns start with, -1 if they start with
+           * different characters. Used to skip to the candidates with memchr.
+           */
+          int single_first_byte_ = -1;
+
+
+          /**
+           * True if the failure links are up to date.
+           */
+          bool built_ = true;
+
+
+          /**
+           * Returns the child of a node for a character.
+           * @param  node Node.
+           * @param  c    Character.
+           * @return      Child, 0 if none.
+           */
+          int Child(const int node, const unsigned char c) const {
+            for (int child = nodes_[node].child; child != 0; child = nodes_[child].sibling){
+              if (nodes_[child].c == c){
+                return child;
+              }
+            }
+            return 0;
+          };
+
+
+          /**
+           * Replaces the patterns.
+           * @param  content Content.
+           * @param  buffer  Filled with the result if a pattern is found.
+           * @return         True if a pattern was found.
+           */
+          bool Apply(const std::string& content, std::string& buffer) const {
+            const char* data = content.data();
+            const char* last = data + content.size();
+            const char* copied = data;
+            bool replaced = false;
+            int node = 0;
+            for (const char* it = data; it != last; ++it){
+              if (node == 0){
+                // skip to the next character a pattern can start with.
+                if (single_first_byte_ >= 0){
+                  it = granada::util::string::find(it, last, (char)single_first_byte_);
+                }else{
+                  while (it != last && !first_bytes_[(unsigned char)*it]){
+                    ++it;
+                  }
+                }
+                if (it == last){
+                  break;
+                }
+              }
+              const unsigned char c = (unsigned char)*it;
+              int next = Child(node, c);
+              while (next == 0 && node != 0){
+                node = nodes_[node].fail;
+                next = Child(node, c);
+              }
+              node = next;
+              const int output = nodes_[node].output;
+              if (output != 0){
+                if (!replaced){
+                  buffer.reserve(content.size() + content.size() / 4);
+                  replaced = true;
+                }
+                const char* start = it + 1 - nodes_[output].length;
+                buffer.append(copied, start - copied);
+                buffer.append(values_[nodes_[output].value]);
+                copied = it + 1;
+                node = 0;
+              }
+            }
+            if (replaced){
+              buffer.append(copied, last - copied);
+            }
+            return replaced;
+          };
+      };
+
+
       /**
        * Replace all occurences of a tag in a string by a value.
        * Example:
@@ -103,10 +636,66 @@ namespace granada{
        * @param  value      Value to replace the tag with.
        */
       static void replace(std::string& content,const std::string& tag, const std::string& value){
-        size_t pos = 0;
-        while ((pos = content.find(tag, pos)) != std::string::npos) {
-           content.replace(pos, tag.length(), value);
-           pos += value.length();
+        if (tag.empty()){
+          return;
+        }
+        std::size_t pos = content.find(tag);
+        if (pos == std::string::npos){
+          return;
+        }
+        // copy the content once to a new buffer instead of
+        // moving the rest of the content on each replacement.
+        std::string buffer;
+        buffer.reserve(content.size() + (value.size() > tag.size() ? 4 * (value.size() - tag.size()) : 0));
+        std::size_t start = 0;
+        do{
+          buffer.append(content, start, pos - start);
+          buffer.append(value);
+          start = pos + tag.size();
+        }while ((pos = content.find(tag, start)) != std::string::npos);
+        buffer.append(content, start, std::string::npos);
+        content.swap(buffer);
+      }
+
+
+      /**
+       * Replaces the tags of a string in a single pass: finds each open
+       * mark and the next close mark, and if the name between them has
+       * a value replaces the whole tag by it. Tags without a value are
+       * kept. Used by replace when tags have open and close marks, as it
+       * needs no automaton.
+       * @param content Content containing the tags to replace.
+       * @param open    Before tag mark, not empty.
+       * @param close   After tag mark, not empty.
+       * @param lookup  Function receiving the name of a tag and its length
+       *                and returning a pointer to its value, or nullptr.
+       */
+      template <typename Lookup>
+      static void replace_tags(std::string& content, const std::string& open, const std::string& close, Lookup lookup){
+        std::string buffer;
+        std::size_t copied = 0;
+        std::size_t pos = 0;
+        while ((pos = content.find(open, pos)) != std::string::npos){
+          const std::size_t name_start = pos + open.size();
+          const std::size_t name_end = content.find(close, name_start);
+          if (name_end == std::string::npos){
+            break;
+          }
+          const std::string* value = lookup(content.data() + name_start, name_end - name_start);
+          if (value == nullptr){
+            ++pos;
+            continue;
+          }
+          if (copied == 0 && buffer.empty()){
+            buffer.reserve(content.size() + content.size() / 4);
+          }
+          buffer.append(content, copied, pos - copied);
+          buffer.append(*value);
+          copied = pos = name_end + close.size();
+        }
+        if (copied > 0){
+          buffer.append(content, copied, std::string::npos);
+          content.swap(buffer);
         }
       }
 
@@ -130,17 +719,23 @@ namespace granada{
        * @param  close     After tag mark.
        */
       static void replace(std::string& content,const std::deque<std::pair<std::string,std::string>>& values, const std::string& open, const std::string& close){
-        std::string tag;
-        std::string value;
-        for (auto it = values.begin(); it != values.end(); ++it){
-          tag.assign(open + it->first + close);
-          value = it->second;
-          size_t pos = 0;
-          while ((pos = content.find(tag, pos)) != std::string::npos) {
-               content.replace(pos, tag.length(), value);
-               pos += value.length();
+        if (open.empty() || close.empty()){
+          // without both marks tags cannot be delimited, each tag is a pattern.
+          replacer tags;
+          for (auto it = values.begin(); it != values.end(); ++it){
+            tags.Add(open + it->first + close, it->second);
           }
+          tags.Replace(content);
+          return;
         }
+        replace_tags(content, open, close, [&values](const char* name, const std::size_t length) -> const std::string* {
+          for (auto it = values.begin(); it != values.end(); ++it){
+            if (it->first.size() == length && it->first.compare(0, length, name, length) == 0){
+              return &it->second;
+            }
+          }
+          return nullptr;
+        });
       }
 
 
@@ -163,17 +758,21 @@ namespace granada{
        * @param  close     After tag mark.
        */
       static void replace(std::string& content,const std::unordered_map<std::string,std::string>& values, const std::string& open, const std::string& close){
-        std::string tag;
-        std::string value;
-        for (auto it = values.begin(); it != values.end(); ++it){
-          tag.assign(open + it->first + close);
-          value = it->second;
-          size_t pos = 0;
-          while ((pos = content.find(tag, pos)) != std::string::npos) {
-               content.replace(pos, tag.length(), value);
-               pos += value.length();
+        if (open.empty() || close.empty()){
+          // without both marks tags cannot be delimited, each tag is a pattern.
+          replacer tags;
+          for (auto it = values.begin(); it != values.end(); ++it){
+            tags.Add(open + it->first + close, it->second);
           }
+          tags.Replace(content);
+          return;
         }
+        std::string key;
+        replace_tags(content, open, close, [&values, &key](const char* name, const std::size_t length) -> const std::string* {
+          key.assign(name, length);
+          auto it = values.find(key);
+          return it == values.end() ? nullptr : &it->second;
+        });
       }
 
 
@@ -0,0 +1,281 @@
+/**
+  * Copyright (c) <2016> Web App SDK granada <afernandez@cookinapps.io>
+  *
+  * This source code is licensed under the MIT license.
+  *
+  * Permission is hereby granted, free of charge, to any person obtaining a copy
+  * of this software and associated documentation files (the "Software"), to deal
+  * in the Software without restriction, including without limitation the rights
+  * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  * copies of the Software, and to permit persons to whom the Software is
+  * furnished to do so, subject to the following conditions:
+  *
+  * The above copyright notice and this permission notice shall be included in
+  * all copies or substantial portions of the Software.
+  *
+  * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  * SOFTWARE.
+  *
+  * Pools of worker threads with bounded queues of tasks.
+  *
+  */
+
+#pragma once
+#include <deque>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <string>
+
+namespace granada{
+  namespace util{
+    namespace thread{
+
+      /**
+       * Pool of worker threads running submitted tasks in order.
+       * The queue of pending tasks is bounded: when it is full new
+       * tasks are rejected instead of piling up, so a burst of work
+       * can not hold more threads or memory than configured.
+       * This code is multi-thread safe.
+       */
+      class BoundedThreadPool{
+        public:
+
+          /**
+           * Constructor
+           * @param threads   Number of worker threads, at least one.
+           * @param max_queue Maximum number of tasks waiting for a thread.
+           */
+          BoundedThreadPool(const std::size_t threads, const std::size_t max_queue){
+            max_queue_ = max_queue;
+            const std::size_t n = threads > 0 ? threads : 1;
+            for (std::size_t i = 0; i < n; ++i){
+              workers_.emplace_back([this]{ this->Work(); });
+            }
+          };
+
+
+          /**
+           * Destructor
+           * Runs the pending tasks and joins the worker threads.
+           */
+          virtual ~BoundedThreadPool(){
+            {
+              std::lock_guard<std::mutex> lg(mtx_);
+              stop_ = true;
+            }
+            cv_.notify_all();
+            Join();
+          };
+
+
+          /**
+           * Stops the pool without running the pending tasks: they are
+           * dropped, the running ones are finished and the worker threads
+           * joined. Tasks submitted afterwards are refused.
+           */
+          void Stop(){
+            {
+              std::lock_guard<std::mutex> lg(mtx_);
+              stop_ = true;
+              tasks_.clear();
+            }
+            cv_.notify_all();
+            Join();
+          };
+
+
+          /**
+           * Queues a task to be run by one of the worker threads.
+           * @param  task Task.
+           * @return      True if the task has been queued, false if the
+           *              queue is full or the pool is stopping.
+           */
+          bool Submit(std::function<void()> task){
+            {
+              std::lock_guard<std::mutex> lg(mtx_);
+              if (stop_ || tasks_.size() >= max_queue_){
+                return false;
+              }
+              tasks_.push_back(std::move(task));
+            }
+            cv_.notify_one();
+            return true;
+          };
+
+
+          /**
+           * Returns the number of tasks waiting for a thread.
+           * @return Number of pending tasks.
+           */
+          std::size_t pending(){
+            std::lock_guard<std::mutex> lg(mtx_);
+            return tasks_.size();
+          };
+
+
+        private:
+
+          /**
+           * Worker threads.
+           */
+          std::vector<std::thread> workers_;
+
+
+          /**
+           * Tasks waiting for a thread.
+           */
+          std::deque<std::function<void()>> tasks_;
+
+
+          /**
+           * Maximum number of tasks waiting for a thread.
+           */
+          std::size_t max_queue_;
+
+
+          /**
+           * True when the pool is being destroyed.
+           */
+          bool stop_ = false;
+
+
+          /**
+           * Mutex protecting the tasks queue.
+           */
+          std::mutex mtx_;
+
+
+          /**
+           * Wakes up the worker threads when there are tasks.
+           */
+          std::condition_variable cv_;
+
+
+          /**
+           * Joins the worker threads. If the pool is stopped by one of its
+           * own tasks the calling thread is detached, it ends when the task returns.
+           */
+          void Join(){
+            for (auto it = workers_.begin(); it != workers_.end(); ++it){
+              if (it->joinable()){
+                if (it->get_id() == std::this_thread::get_id()){
+                  it->detach();
+                }else{
+                  it->join();
+                }
+              }
+            }
+          };
+
+
+          /**
+           * Loop of the worker threads: runs tasks until the pool is
+           * stopped and there are no more pending tasks.
+           */
+          void Work(){
+            for (;;){
+              std::function<void()> task;
+              {
+                std::unique_lock<std::mutex> ul(mtx_);
+                cv_.wait(ul, [this]{ return stop_ || !tasks_.empty(); });
+                if (tasks_.empty()){
+                  return;
+                }
+                task = std::move(tasks_.front());
+                tasks_.pop_front();
+              }
+              try{
+                task();
+              }catch(...){}
+            }
+          };
+      };
+
+
+      /**
+       * Pool of worker threads where the tasks submitted with the same key
+       * run one after the other, in the order they were submitted, while
+       * tasks with different keys can run at the same time.
+       * Each key is always given to the same worker thread, which has its
+       * own bounded queue of tasks.
+       * This code is multi-thread safe.
+       */
+      class OrderedThreadPool{
+        public:
+
+          /**
+           * Constructor
+           * @param threads   Number of worker threads, at least one.
+           * @param max_queue Maximum number of tasks waiting for each thread.
+           */
+          OrderedThreadPool(const std::size_t threads, const std::size_t max_queue){
+            const std::size_t n = threads > 0 ? threads : 1;
+            for (std::size_t i = 0; i < n; ++i){
+              lanes_.emplace_back(new BoundedThreadPool(1, max_queue));
+            }
+          };
+
+
+          /**
+           * Destructor
+           * Runs the pending tasks and joins the worker threads.
+           */
+          virtual ~OrderedThreadPool(){};
+
+
+          /**
+           * Queues a task to be run after the tasks already
+           * submitted with the same key.
+           * @param  key  Key, example: the id of a Plug-in Handler.
+           * @param  task Task.
+           * @return      True if the task has been queued, false if the
+           *              queue of the thread of the key is full.
+           */
+          bool Submit(const std::string& key, std::function<void()> task){
+            return lanes_[std::hash<std::string>()(key) % lanes_.size()]->Submit(std::move(task));
+          };
+
+
+          /**
+           * Stops the pool without running the pending tasks,
+           * see BoundedThreadPool::Stop.
+           */
+          void Stop(){
+            for (auto it = lanes_.begin(); it != lanes_.end(); ++it){
+              (*it)->Stop();
+            }
+          };
+
+
+          /**
+           * Returns the number of tasks waiting for a thread.
+           * @return Number of pending tasks.
+           */
+          std::size_t pending(){
+            std::size_t pending = 0;
+            for (auto it = lanes_.begin(); it != lanes_.end(); ++it){
+              pending += (*it)->pending();
+            }
+            return pending;
+          };
+
+
+        private:
+
+          /**
+           * Single thread pools, one per worker thread.
+           */
+          std::vector<std::unique_ptr<BoundedThreadPool>> lanes_;
+      };
+    }
+  }
+}
@@ -0,0 +1,208 @@
+/**
+  * Copyright (c) <2016> Web App SDK granada <afernandez@cookinapps.io>
+  *
+  * This source code is licensed under the MIT license.
+  *
+  * Permission is hereby granted, free of charge, to any person obtaining a copy
+  * of this software and associated documentation files (the "Software"), to deal
+  * in the Software without restriction, including without limitation the rights
+  * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  * copies of the Software, and to permit persons to whom the Software is
+  * furnished to do so, subject to the following conditions:
+  *
+  * The above copyright notice and this permission notice shall be included in
+  * all copies or substantial portions of the Software.
+  *
+  * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  * SOFTWARE.
+  *
+  * Request tracing: spans recorded in a ring buffer and
+  * dumped in the Chrome trace event format.
+  *
+  */
+
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+namespace granada{
+  namespace util{
+
+    /**
+     * Request tracing. A Trace is opened where a request starts, and
+     * Spans around the stages of the request we want to measure:
+     *
+     *    void PluginController::handle_post(http_request request){
+     *      granada::util::tracing::Trace trace("plugin_controller.post");
+     *      ...
+     *    }
+     *
+     *    void PluginController::PluginHandlerLock(...){
+     *      granada::util::tracing::Span span("plugin_controller.lock");
+     *      ...
+     *    }
+     *
+     * Only one of every "tracing_sampling" traces is recorded, 0 to disable
+     * tracing, see granada::util::configuration. When a trace is not recorded
+     * a span only reads a thread local variable.
+     *
+     * Spans are only recorded in the thread that opened the trace. They are
+     * stored in a ring buffer of "tracing_buffer_size" spans without locks,
+     * when the buffer is full the oldest spans are overwritten.
+     *
+     * Dump() returns the recorded spans in the Chrome trace event format,
+     * they can be loaded in chrome://tracing or https://ui.perfetto.dev
+     */
+    namespace tracing{
+
+      /**
+       * Returns the id of the trace the calling thread is recording, 0 if none.
+       * @return Id of the trace.
+       */
+      inline uint64_t& current_trace(){
+        static thread_local uint64_t trace = 0;
+        return trace;
+      };
+
+
+      /**
+       * Returns the microseconds elapsed since an arbitrary point in time.
+       * @return Microseconds.
+       */
+      inline uint64_t now(){
+        return (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+      };
+
+
+      /**
+       * Stores a span in the ring buffer.
+       * @param name     Name of the span, must be a string literal.
+       * @param trace    Id of the trace.
+       * @param start    Start of the span in microseconds.
+       * @param duration Duration of the span in microseconds.
+       */
+      void Record(const char* name, const uint64_t trace, const uint64_t start, const uint64_t duration);
+
+
+      /**
+       * Returns the recorded spans in the Chrome trace event format:
+       * {"traceEvents":[{"name":"session.load","cat":"granada","ph":"X","ts":...,"dur":...,"pid":1,"tid":...,"args":{"trace":...}},...]}
+       * @return JSON.
+       */
+      std::string Dump();
+
+
+      /**
+       * Removes the recorded spans.
+       */
+      void Clear();
+
+
+      /**
+       * Measures a stage of the trace the calling thread is recording,
+       * from its construction to its destruction. Does nothing
+       * if the thread is not recording a trace.
+       */
+      class Span{
+
+        public:
+
+          /**
+           * Constructor, starts the span.
+           * @param name Name of the span, must be a string literal.
+           */
+          Span(const char* name) : name_(name), trace_(current_trace()){
+            if (trace_ != 0){
+              start_ = now();
+            }
+          };
+
+
+          /**
+           * Destructor, records the span.
+           */
+          ~Span(){
+            if (trace_ != 0){
+              Record(name_, trace_, start_, now() - start_);
+            }
+          };
+
+
+        private:
+
+          /**
+           * Name of the span.
+           */
+          const char* name_;
+
+
+          /**
+           * Id of the trace, 0 if it is not recorded.
+           */
+          const uint64_t trace_;
+
+
+          /**
+           * Start of the span in microseconds.
+           */
+          uint64_t start_ = 0;
+      };
+
+
+      /**
+       * Starts a trace in the calling thread if it is sampled, and
+       * measures it as a span. If the thread is already recording
+       * a trace it is only a span of that trace.
+       */
+      class Trace{
+
+        public:
+
+          /**
+           * Constructor, starts the trace.
+           * @param name Name of the span, must be a string literal.
+           */
+          Trace(const char* name);
+
+
+          /**
+           * Destructor, ends the trace.
+           */
+          ~Trace();
+
+
+        private:
+
+          /**
+           * Name of the span.
+           */
+          const char* name_;
+
+
+          /**
+           * Id of the trace, 0 if it is not recorded.
+           */
+          uint64_t trace_ = 0;
+
+
+          /**
+           * True if this object started the trace.
+           */
+          bool root_ = false;
+
+
+          /**
+           * Start of the span in microseconds.
+           */
+          uint64_t start_ = 0;
+      };
+
+    }
+  }
+}
@@ -115,7 +115,7 @@ void on_initialize(const string_t& address)
   uri_builder message_uri(address);
   message_uri.append_path(U("message"));
   addr = message_uri.to_uri().to_string();
-  std::unique_ptr<granada::http::controller::MessageController> message_controller(new granada::http::controller::MessageController(addr,session_factory,cache_handler));
+  std::unique_ptr<granada::http::controller::MessageController> message_controller(new granada::http::controller::MessageController(addr,session_factory,oauth2_factory,cache_handler));
   message_controller->open().wait();
   g_controllers.push_back(std::move(message_controller));
   ucout << "Message Controller: Initialized... Listening for requests at: " << addr << std::endl;
@@ -27,6 +27,7 @@
   */
 
 #include "application_controller.h"
+#include "granada/util/metrics.h"
 
 using namespace web::http::details;
 using namespace web::http::oauth2::details;
@@ -56,6 +57,8 @@ namespace granada{
 
 
       void ApplicationController::handle_get(web::http::http_request request){
+        static granada::util::metrics::Histogram& latency = granada::util::metrics::GetHistogram("granada_http_request_seconds", "Time spent handling the HTTP requests.", "controller=\"application\",method=\"GET\"");
+        granada::util::metrics::Timer timer(latency);
 
         web::http::http_response response;
 
@@ -161,6 +164,8 @@ namespace granada{
 
       void ApplicationController::handle_put(web::http::http_request request)
       {
+        static granada::util::metrics::Histogram& latency = granada::util::metrics::GetHistogram("granada_http_request_seconds", "Time spent handling the HTTP requests.", "controller=\"application\",method=\"PUT\"");
+        granada::util::metrics::Timer timer(latency);
         web::http::http_response response;
 
         // Retrieves session if it exists
@@ -207,6 +212,8 @@ namespace granada{
 
       void ApplicationController::handle_post(web::http::http_request request)
       {
+        static granada::util::metrics::Histogram& latency = granada::util::metrics::GetHistogram("granada_http_request_seconds", "Time spent handling the HTTP requests.", "controller=\"application\",method=\"POST\"");
+        granada::util::metrics::Timer timer(latency);
 
         web::http::http_response response;
 
@@ -282,6 +289,8 @@ namespace granada{
 
       void ApplicationController::handle_delete(web::http::http_request request)
       {
+        static granada::util::metrics::Histogram& latency = granada::util::metrics::GetHistogram("granada_http_request_seconds", "Time spent handling the HTTP requests.", "controller=\"application\",method=\"DELETE\"");
+        granada::util::metrics::Timer timer(latency);
         web::http::http_response response;
 
         // Retrieves session if it exists
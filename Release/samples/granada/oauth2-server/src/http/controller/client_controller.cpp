@@ -27,6 +27,7 @@
   */
 
 #include "client_controller.h"
+#include "granada/util/metrics.h"
 
 namespace granada{
   namespace http{
@@ -40,6 +41,8 @@ namespace granada{
 
       void ClientController::handle_post(web::http::http_request request)
       {
+        static granada::util::metrics::Histogram& latency = granada::util::metrics::GetHistogram("granada_http_request_seconds", "Time spent handling the HTTP requests.", "controller=\"client\",method=\"POST\"");
+        granada::util::metrics::Timer timer(latency);
 
 		std::string body = utility::conversions::to_utf8string(request.extract_string().get());
         std::string redirect_uris_str;
@@ -27,6 +27,7 @@
   */
 
 #include "message_controller.h"
+#include "granada/util/metrics.h"
 
 using namespace web::http::details;
 using namespace web::http::oauth2::details;
@@ -34,9 +35,10 @@ using namespace web::http::oauth2::details;
 namespace granada{
   namespace http{
     namespace controller{
-      MessageController::MessageController(utility::string_t url, std::shared_ptr<granada::http::session::SessionFactory>& session_factory, std::shared_ptr<granada::cache::CacheHandler>& cache)
+      MessageController::MessageController(utility::string_t url, std::shared_ptr<granada::http::session::SessionFactory>& session_factory, std::shared_ptr<granada::http::oauth2::OAuth2Factory>& oauth2_factory, std::shared_ptr<granada::cache::CacheHandler>& cache)
       {
 		  session_factory_ = session_factory;
+		  oauth2_factory_ = oauth2_factory;
 		  cache_ = cache;
         n_generator_ = std::unique_ptr<utility::nonce_generator>(new utility::nonce_generator(32));
         m_listener_ = std::unique_ptr<http_listener>(new http_listener(url));
@@ -48,6 +50,8 @@ namespace granada{
 
       void MessageController::handle_put(web::http::http_request request)
       {
+        static granada::util::metrics::Histogram& latency = granada::util::metrics::GetHistogram("granada_http_request_seconds", "Time spent handling the HTTP requests.", "controller=\"message\",method=\"PUT\"");
+        granada::util::metrics::Timer timer(latency);
         web::http::http_response response;
 
         // extract message from HTTP request.
@@ -68,21 +72,21 @@ namespace granada{
           json_str.assign("{\"error\":\"invalid_request\",\"error_description\":\"The request is missing a valid token or a valid message key.\"}");
         }else{
 
-          // retrieve session if it already exists.
-          std::unique_ptr<granada::http::session::Session> session = session_factory_->Session_unique_ptr(token);
+          // retrieve the access token: a session or a signed token.
+          std::unique_ptr<granada::http::oauth2::OAuth2AccessToken> access_token = AccessToken(token);
 
           // insert the message if the user has the permission,
-          if(session->roles()->Is("msg.insert")){
+          if(access_token->Is("msg.insert")){
             granada::Message message(cache_);
 
-            std::string username = session->roles()->GetProperty("msg.insert","username");
+            std::string username = access_token->GetProperty("msg.insert","username");
 
             // insert message.
             message.Create(username,message_str);
 
             // retrieve the actualized list of messages after insertion
             // if the user has the permissions.
-            if(session->roles()->Is("msg.select")){
+            if(access_token->Is("msg.select")){
               std::string message_list = message.List(username);
               json_str.assign("{\"description\":\"Success inserting message.\",\"data\":" + message_list + "}");
             }else{
@@ -108,6 +112,8 @@ namespace granada{
 
       void MessageController::handle_post(web::http::http_request request)
       {
+        static granada::util::metrics::Histogram& latency = granada::util::metrics::GetHistogram("granada_http_request_seconds", "Time spent handling the HTTP requests.", "controller=\"message\",method=\"POST\"");
+        granada::util::metrics::Timer timer(latency);
 
         web::http::http_response response;
 
@@ -133,18 +139,18 @@ namespace granada{
           if (token.empty()){
             json_str.assign("{\"error\":\"invalid_token\",\"error_description\":\"The request is missing a valid token.\"}");
           }else{
-            // retrieve session if it already exists.
-            std::unique_ptr<granada::http::session::Session> session = session_factory_->Session_unique_ptr(token);
+            // retrieve the access token: a session or a signed token.
+            std::unique_ptr<granada::http::oauth2::OAuth2AccessToken> access_token = AccessToken(token);
 
             if(name == "list"){
 
               // retrieve the user's list of messages if the user
               // has the permission.
-              if(session->roles()->Is("msg.select")){
+              if(access_token->Is("msg.select")){
 
                 granada::Message message(cache_);
 
-                std::string username = session->roles()->GetProperty("msg.select","username");
+                std::string username = access_token->GetProperty("msg.select","username");
 
                 std::string message_list = message.List(username);
 
@@ -167,13 +173,13 @@ namespace granada{
                 message_str.assign(parsed_data["message"]);
               }catch(const std::exception e){}
 
-              if(session->roles()->Is("msg.update")){
+              if(access_token->Is("msg.update")){
                 granada::Message message(cache_);
 
-                std::string username = session->roles()->GetProperty("msg.update","username");
+                std::string username = access_token->GetProperty("msg.update","username");
 
                 if (message.Edit(username,message_key,message_str)){
-                  if(session->roles()->Is("msg.select")){
+                  if(access_token->Is("msg.select")){
                     std::string message_list = message.List(username);
                     json_str.assign("{\"description\":\"Success editing message.\",\"data\":" + message_list + "}");
                   }else{
@@ -205,6 +211,8 @@ namespace granada{
 
       void MessageController::handle_delete(web::http::http_request request)
       {
+        static granada::util::metrics::Histogram& latency = granada::util::metrics::GetHistogram("granada_http_request_seconds", "Time spent handling the HTTP requests.", "controller=\"message\",method=\"DELETE\"");
+        granada::util::metrics::Timer timer(latency);
         web::http::http_response response;
 
         // extract message from HTTP request.
@@ -225,18 +233,18 @@ namespace granada{
           json_str.assign("{\"error\":\"invalid_request\",\"error_description\":\"The request is missing a valid token or a valid message key.\"}");
         }else{
 
-          // Retrieves session if it exists
-          std::unique_ptr<granada::http::session::Session> session = session_factory_->Session_unique_ptr(token);
+          // retrieve the access token: a session or a signed token.
+          std::unique_ptr<granada::http::oauth2::OAuth2AccessToken> access_token = AccessToken(token);
 
           // Delete message if the user has the permission.
-          if(session->roles()->Is("msg.delete")){
-            std::string username = session->roles()->GetProperty("msg.delete","username");
+          if(access_token->Is("msg.delete")){
+            std::string username = access_token->GetProperty("msg.delete","username");
             granada::Message message(cache_);
             message.Delete(username,message_key);
 
             // retrieve the actualized list of messages after deletion
             // if the user has the permissions.
-            if(session->roles()->Is("msg.select")){
+            if(access_token->Is("msg.select")){
               std::string message_list = message.List(username);
               json_str.assign("{\"description\":\"Success deleting message.\",\"data\":" + message_list + "}");
             }else{
@@ -259,6 +267,11 @@ namespace granada{
       }
 
 
+      std::unique_ptr<granada::http::oauth2::OAuth2AccessToken> MessageController::AccessToken(const std::string& token){
+        return oauth2_factory_->OAuth2Authorization_unique_ptr(granada::http::oauth2::OAuth2Parameters(),session_factory_.get())->AccessToken(token);
+      }
+
+
       void MessageController::MessageApplicationSessionFactory(std::unique_ptr<granada::http::session::Session>& session, web::http::http_request request, web::http::http_response response){
         std::unordered_map<std::string, std::string> cookies = granada::http::parser::ParseCookies(request);
         const std::string token_label = "message_token";
@@ -48,7 +48,7 @@ namespace granada{
           /**
            * Constructor
            */
-          MessageController(utility::string_t url, std::shared_ptr<granada::http::session::SessionFactory>& session_factory, std::shared_ptr<granada::cache::CacheHandler>& cache);
+          MessageController(utility::string_t url, std::shared_ptr<granada::http::session::SessionFactory>& session_factory, std::shared_ptr<granada::http::oauth2::OAuth2Factory>& oauth2_factory, std::shared_ptr<granada::cache::CacheHandler>& cache);
 
         private:
 
@@ -67,6 +67,13 @@ namespace granada{
           std::shared_ptr<granada::http::session::SessionFactory> session_factory_;
 
 
+          /**
+           * OAuth 2.0 Factory, used to verify the access tokens
+           * whether they are sessions or signed tokens.
+           */
+          std::shared_ptr<granada::http::oauth2::OAuth2Factory> oauth2_factory_;
+
+
           /**
            * Where the message are going to be stored.
            */
@@ -93,6 +100,15 @@ namespace granada{
           void handle_delete(web::http::http_request request);
 
 
+          /**
+           * Returns the access token sent by the client, a session
+           * token or a signed token.
+           * @param  token  Access token.
+           * @return        Access token with the roles granted to the client.
+           */
+          std::unique_ptr<granada::http::oauth2::OAuth2AccessToken> AccessToken(const std::string& token);
+
+
           void MessageApplicationSessionFactory(std::unique_ptr<granada::http::session::Session>& session, web::http::http_request request, web::http::http_response response);
       };
     }
@@ -27,6 +27,7 @@
   */
 
 #include "user_controller.h"
+#include "granada/util/metrics.h"
 
 namespace granada{
   namespace http{
@@ -40,6 +41,8 @@ namespace granada{
 
       void UserController::handle_post(web::http::http_request request)
       {
+        static granada::util::metrics::Histogram& latency = granada::util::metrics::GetHistogram("granada_http_request_seconds", "Time spent handling the HTTP requests.", "controller=\"user\",method=\"POST\"");
+        granada::util::metrics::Timer timer(latency);
         web::http::http_response response;
 
         std::string body = utility::conversions::to_utf8string(request.extract_string().get());
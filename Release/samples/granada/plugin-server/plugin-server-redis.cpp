@@ -30,6 +30,7 @@
 #include "granada/http/session/redis_session.h"
 #include "granada/plugin/redis_spidermonkey_plugin.h"
 #include "granada/http/controller/browser_controller.h"
+#include "granada/http/controller/metrics_controller.h"
 #include "granada/http/controller/plugin_controller.h"
 
 ////
@@ -57,6 +58,20 @@ void on_initialize(const string_t& address)
     ucout << "Browser Controller: Initialized... Listening for requests at: " << addr << std::endl;
   }
 
+  ////
+  // Metrics Controller
+  // Responds with the metrics and the traces of the server.
+  std::string metrics_module = granada::util::application::GetProperty("metrics_controller");
+  if(!metrics_module.empty() && metrics_module=="on"){
+    uri_builder uri(address);
+    uri.append_path(U("metrics"));
+    auto addr = uri.to_uri().to_string();
+    std::unique_ptr<granada::http::controller::Controller> metrics_controller(new granada::http::controller::MetricsController(addr));
+    metrics_controller->open().wait();
+    g_controllers.push_back(std::move(metrics_controller));
+    ucout << "Metrics Controller: Initialized... Listening for requests at: " << addr << std::endl;
+  }
+
   // factory used to create Plug-in Handlers, Plug-ins, Plug-in Factories.
   std::shared_ptr<granada::plugin::RedisSpidermonkeyPluginFactory> plugin_factory(new granada::plugin::RedisSpidermonkeyPluginFactory());
 
@@ -27,7 +27,7 @@
 #include <stdio.h>
 #include <string>
 #include "cpprest/details/basic_types.h"
-#include "granada/http/session/map_session.h"
+#include "granada/http/session/log_session.h"
 #include "granada/http/controller/browser_controller.h"
 #include "src/http/controller/test_controller.h"
 
@@ -39,7 +39,7 @@ std::vector<std::unique_ptr<granada::http::controller::Controller>> g_controller
 void on_initialize(const string_t& address)
 {
 
-  std::shared_ptr<granada::http::session::SessionFactory> session_factory = std::make_shared<granada::http::session::MapSessionFactory>();
+  std::shared_ptr<granada::http::session::SessionFactory> session_factory = std::make_shared<granada::http::session::LogSessionFactory>();
 
   ////
   // Browser Controller
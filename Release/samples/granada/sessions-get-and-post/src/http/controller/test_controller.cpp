@@ -26,6 +26,7 @@
   */
 
 #include "test_controller.h"
+#include "granada/util/metrics.h"
 
 namespace granada{
   namespace http{
@@ -40,6 +41,8 @@ namespace granada{
 
       void TestController::handle_get(web::http::http_request request)
       {
+        static granada::util::metrics::Histogram& latency = granada::util::metrics::GetHistogram("granada_http_request_seconds", "Time spent handling the HTTP requests.", "controller=\"test\",method=\"GET\"");
+        granada::util::metrics::Timer timer(latency);
 
         web::http::http_response response;
 
@@ -75,6 +78,8 @@ namespace granada{
 
       void TestController::handle_post(web::http::http_request request)
       {
+        static granada::util::metrics::Histogram& latency = granada::util::metrics::GetHistogram("granada_http_request_seconds", "Time spent handling the HTTP requests.", "controller=\"test\",method=\"POST\"");
+        granada::util::metrics::Timer timer(latency);
         web::http::http_response response;
 
         {
@@ -27,8 +27,10 @@
 #include <stdio.h>
 #include <string>
 #include "cpprest/details/basic_types.h"
+#include "granada/util/configuration.h"
 #include "granada/http/session/map_session.h"
 #include "granada/http/controller/browser_controller.h"
+#include "granada/http/controller/metrics_controller.h"
 #include "src/http/controller/cart_controller.h"
 #include "src/http/controller/auth_controller.h"
 
@@ -58,6 +60,20 @@ void on_initialize(const string_t& address)
     ucout << "Browser Controller: Initialized... Listening for requests at: " << addr << std::endl;
   }
 
+  ////
+  // Metrics Controller
+  // Responds with the metrics and the traces of the server.
+  std::string metrics_module = granada::util::application::GetProperty("metrics_controller");
+  if(!metrics_module.empty() && metrics_module=="on"){
+    uri_builder uri(address);
+    uri.append_path(U("metrics"));
+    auto addr = uri.to_uri().to_string();
+    std::unique_ptr<granada::http::controller::Controller> metrics_controller(new granada::http::controller::MetricsController(addr));
+    metrics_controller->open().wait();
+    g_controllers.push_back(std::move(metrics_controller));
+    ucout << "Metrics Controller: Initialized... Listening for requests at: " << addr << std::endl;
+  }
+
   uri_builder uri(address);
   uri.append_path(U("cart"));
   auto addr = uri.to_uri().to_string();
@@ -116,6 +132,11 @@ int main(int argc, char *argv[])
 
 	on_initialize(address);
 
+	// reload server.conf when the server receives a SIGHUP signal. Only the
+	// properties read on each use change, such as default_content_type, the
+	// sessions and the web resources settings are read once and need a restart.
+	granada::util::configuration::ReloadOnSignal();
+
 	std::cout << "------------------------------------------------\nPress ENTER to terminate server." << std::endl;
 
 	std::string line;
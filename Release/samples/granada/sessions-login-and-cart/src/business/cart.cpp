@@ -27,7 +27,7 @@
 
 namespace business{
 
-  std::unique_ptr<granada::cache::SharedMapCacheDriver> Cart::cache_ = std::unique_ptr<granada::cache::SharedMapCacheDriver>(new granada::cache::SharedMapCacheDriver());
+  std::unique_ptr<granada::cache::SharedMapCacheDriver> Cart::cache_ = std::unique_ptr<granada::cache::SharedMapCacheDriver>(new granada::cache::SharedMapCacheDriver("cart"));
 
 
   Cart::Cart(granada::http::session::Session* session){
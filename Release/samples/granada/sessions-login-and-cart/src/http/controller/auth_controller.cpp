@@ -24,6 +24,7 @@
   */
 
 #include "auth_controller.h"
+#include "granada/util/metrics.h"
 
 namespace granada{
   namespace http{
@@ -36,6 +37,8 @@ namespace granada{
 
       void AuthController::handle_post(web::http::http_request request)
       {
+        static granada::util::metrics::Histogram& latency = granada::util::metrics::GetHistogram("granada_http_request_seconds", "Time spent handling the HTTP requests.", "controller=\"auth\",method=\"POST\"");
+        granada::util::metrics::Timer timer(latency);
         web::http::http_response response;
         granada::http::session::MapSession simple_session(request,response);
         auto paths = uri::split_path(uri::decode(request.relative_uri().path()));
@@ -26,6 +26,7 @@
   */
 
 #include "cart_controller.h"
+#include "granada/util/metrics.h"
 
 namespace granada{
   namespace http{
@@ -40,6 +41,8 @@ namespace granada{
 
       void CartController::handle_get(web::http::http_request request)
       {
+        static granada::util::metrics::Histogram& latency = granada::util::metrics::GetHistogram("granada_http_request_seconds", "Time spent handling the HTTP requests.", "controller=\"cart\",method=\"GET\"");
+        granada::util::metrics::Timer timer(latency);
 
         web::http::http_response response;
 
@@ -76,6 +79,8 @@ namespace granada{
 
       void CartController::handle_put(web::http::http_request request)
       {
+        static granada::util::metrics::Histogram& latency = granada::util::metrics::GetHistogram("granada_http_request_seconds", "Time spent handling the HTTP requests.", "controller=\"cart\",method=\"PUT\"");
+        granada::util::metrics::Timer timer(latency);
         web::http::http_response response;
         granada::http::session::MapSession simple_session(request,response);
         business::Cart cart(&simple_session);
@@ -117,6 +122,8 @@ namespace granada{
 
       void CartController::handle_post(web::http::http_request request)
       {
+        static granada::util::metrics::Histogram& latency = granada::util::metrics::GetHistogram("granada_http_request_seconds", "Time spent handling the HTTP requests.", "controller=\"cart\",method=\"POST\"");
+        granada::util::metrics::Timer timer(latency);
         web::http::http_response response;
         granada::http::session::MapSession simple_session(request,response);
         business::Cart cart(&simple_session);
@@ -0,0 +1,417 @@
+/**
+  * Copyright (c) <2016> granada <afernandez@cookinapps.io>
+  *
+  * This source code is licensed under the MIT license.
+  *
+  * Permission is hereby granted, free of charge, to any person obtaining a copy
+  * of this software and associated documentation files (the "Software"), to deal
+  * in the Software without restriction, including without limitation the rights
+  * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  * copies of the Software, and to permit persons to whom the Software is
+  * furnished to do so, subject to the following conditions:
+  *
+  * The above copyright notice and this permission notice shall be included in
+  * all copies or substantial portions of the Software.
+  *
+  * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  * SOFTWARE.
+  *
+  *
+  * Manages the cache storing key-value pairs in an unordered map
+  * persisted in an append-only log file.
+  */
+
+#include "granada/cache/log_cache_driver.h"
+#include <iostream>
+#include "granada/util/binary.h"
+
+namespace granada{
+  namespace cache{
+
+    namespace{
+
+      /**
+       * First bytes of a log file.
+       */
+      const char log_magic[] = "GRANADA.LOG.1\n";
+
+
+      /**
+       * Number of bytes of log_magic.
+       */
+      const std::size_t log_magic_size = sizeof(log_magic) - 1;
+
+
+      /**
+       * Number of keys and values of each type of record.
+       */
+      std::size_t log_record_values(const unsigned char operation){
+        switch (operation){
+          case 1: return 2;
+          case 2: return 3;
+          case 3: return 1;
+          case 4: return 2;
+          case 5: return 2;
+        }
+        return 0;
+      }
+
+
+      /**
+       * Time spent appending records to the log, including the
+       * flushes to the disk and the compactions.
+       */
+      granada::util::metrics::Histogram& append_latency(){
+        static granada::util::metrics::Histogram& histogram = granada::util::metrics::GetHistogram("granada_cache_log_append_seconds", "Time spent appending records to the cache logs.");
+        return histogram;
+      }
+
+
+      /**
+       * Number of compactions.
+       */
+      granada::util::metrics::Counter& compactions(){
+        static granada::util::metrics::Counter& counter = granada::util::metrics::GetCounter("granada_cache_log_compactions_total", "Number of compactions of the cache logs.");
+        return counter;
+      }
+
+    }
+
+
+    granada::util::mutex::call_once LogCacheDriver::load_properties_call_once_;
+    int LogCacheDriver::fsync_frequency_;
+    int LogCacheDriver::compaction_min_records_;
+
+
+    LogCacheDriver::LogCacheDriver(const std::string& file_path){
+      file_path_.assign(file_path);
+      CountOperations("log");
+
+      // load properties only once, and wait all the
+      // threads until they are loaded.
+      load_properties_call_once_.call([this](){
+        this->LoadProperties();
+      });
+
+      std::lock_guard<std::mutex> lg(log_mtx_);
+      Replay();
+      if (file_ == nullptr){
+        file_ = std::fopen(file_path_.c_str(), "ab");
+        if (file_ == nullptr){
+          std::cout << "Can t open cache log: " << file_path_ << std::endl;
+        }
+      }
+      last_fsync_ = std::time(nullptr);
+    }
+
+
+    LogCacheDriver::~LogCacheDriver(){
+      std::lock_guard<std::mutex> lg(log_mtx_);
+      if (file_ != nullptr){
+        granada::util::binary::sync(file_);
+        std::fclose(file_);
+        file_ = nullptr;
+      }
+    }
+
+
+    void LogCacheDriver::LoadProperties(){
+      const std::string& fsync_frequency_str = granada::util::application::GetProperty(entity_keys::log_cache_driver_fsync_frequency);
+      if (fsync_frequency_str.empty()){
+        fsync_frequency_ = default_numbers::log_cache_driver_fsync_frequency;
+      }else{
+        try{
+          fsync_frequency_ = std::stoi(fsync_frequency_str);
+        }catch(const std::logic_error e){
+          fsync_frequency_ = default_numbers::log_cache_driver_fsync_frequency;
+        }
+      }
+
+      const std::string& compaction_min_records_str = granada::util::application::GetProperty(entity_keys::log_cache_driver_compaction_min_records);
+      if (compaction_min_records_str.empty()){
+        compaction_min_records_ = default_numbers::log_cache_driver_compaction_min_records;
+      }else{
+        try{
+          compaction_min_records_ = std::stoi(compaction_min_records_str);
+        }catch(const std::logic_error e){
+          compaction_min_records_ = default_numbers::log_cache_driver_compaction_min_records;
+        }
+      }
+    }
+
+
+    std::string LogCacheDriver::FilePath(const std::string& name){
+      std::string directory = granada::util::application::FormatDirectoryPath(granada::util::application::GetProperty(entity_keys::log_cache_driver_directory));
+      if (directory.empty()){
+        directory.assign(granada::util::application::get_selfpath());
+      }
+      return directory + "/" + name + ".log";
+    }
+
+
+    void LogCacheDriver::Write(const std::string& key,const std::string& value){
+      std::lock_guard<std::mutex> lg(log_mtx_);
+      SharedMapCacheDriver::Write(key,value);
+      std::string buffer;
+      Encode(buffer, Operation::WRITE, {&key, &value});
+      Append(buffer, 1);
+    }
+
+
+    void LogCacheDriver::Write(const std::string& hash,const std::string& key,const std::string& value){
+      std::lock_guard<std::mutex> lg(log_mtx_);
+      SharedMapCacheDriver::Write(hash,key,value);
+      std::string buffer;
+      Encode(buffer, Operation::WRITE_HASH, {&hash, &key, &value});
+      Append(buffer, 1);
+    }
+
+
+    void LogCacheDriver::Destroy(const std::string& key){
+      std::size_t found = key.find("*");
+      if (found!=std::string::npos){
+        std::vector<std::string> keys;
+        Match(key,keys);
+        Destroy(keys);
+      }else{
+        std::lock_guard<std::mutex> lg(log_mtx_);
+        SharedMapCacheDriver::Destroy(key);
+        std::string buffer;
+        Encode(buffer, Operation::DESTROY, {&key});
+        Append(buffer, 1);
+      }
+    }
+
+
+    void LogCacheDriver::Destroy(const std::vector<std::string>& keys){
+      if (keys.empty()){
+        return;
+      }
+      std::lock_guard<std::mutex> lg(log_mtx_);
+      SharedMapCacheDriver::Destroy(keys);
+      std::string buffer;
+      for (auto it = keys.begin(); it != keys.end(); ++it){
+        Encode(buffer, Operation::DESTROY, {&(*it)});
+      }
+      Append(buffer, keys.size());
+    }
+
+
+    void LogCacheDriver::Destroy(const std::string& hash,const std::string& key){
+      std::lock_guard<std::mutex> lg(log_mtx_);
+      SharedMapCacheDriver::Destroy(hash,key);
+      std::string buffer;
+      Encode(buffer, Operation::DESTROY_HASH, {&hash, &key});
+      Append(buffer, 1);
+    }
+
+
+    bool LogCacheDriver::Rename(const std::string& old_key, const std::string& new_key){
+      std::lock_guard<std::mutex> lg(log_mtx_);
+      if (SharedMapCacheDriver::Rename(old_key,new_key)){
+        std::string buffer;
+        Encode(buffer, Operation::RENAME, {&old_key, &new_key});
+        Append(buffer, 1);
+        return true;
+      }
+      return false;
+    }
+
+
+    void LogCacheDriver::Compact(){
+      std::lock_guard<std::mutex> lg(log_mtx_);
+      CompactLog();
+    }
+
+
+    void LogCacheDriver::Replay(){
+      std::string content;
+      granada::util::binary::read_file(file_path_, content);
+
+      if (content.empty()){
+        // new log.
+        file_ = std::fopen(file_path_.c_str(), "wb");
+        if (file_ != nullptr){
+          std::fwrite(log_magic, 1, log_magic_size, file_);
+          granada::util::binary::sync(file_);
+          std::fclose(file_);
+          file_ = nullptr;
+        }
+        return;
+      }
+
+      if (content.compare(0, log_magic_size, log_magic) != 0){
+        // not a log of this driver, keep it aside instead of overwriting it.
+        std::cout << "Cache log " << file_path_ << " is not valid, renamed to " << file_path_ << ".invalid" << std::endl;
+        std::rename(file_path_.c_str(), (file_path_ + ".invalid").c_str());
+        CompactLog();
+        return;
+      }
+
+      const char* data = content.data();
+      const std::size_t size = content.size();
+      std::size_t offset = log_magic_size;
+      std::vector<std::string> values;
+      while (offset + 8 <= size){
+        const uint32_t length = granada::util::binary::get_uint32(data + offset);
+        const uint32_t checksum = granada::util::binary::get_uint32(data + offset + 4);
+        if (length < 1 || offset + 8 + length > size || granada::util::binary::crc32(data + offset + 8, length) != checksum){
+          break;
+        }
+
+        // decode the record.
+        const char* record = data + offset + 8;
+        const unsigned char operation = (unsigned char)record[0];
+        const std::size_t value_count = log_record_values(operation);
+        values.clear();
+        std::size_t position = 1;
+        while (values.size() < value_count && position + 4 <= length){
+          const uint32_t value_length = granada::util::binary::get_uint32(record + position);
+          position += 4;
+          if (position + value_length > length){
+            break;
+          }
+          values.push_back(std::string(record + position, value_length));
+          position += value_length;
+        }
+        if (value_count == 0 || values.size() != value_count || position != length){
+          break;
+        }
+
+        // apply the record.
+        switch (operation){
+          case Operation::WRITE:
+            SharedMapCacheDriver::Write(values[0],values[1]);
+            break;
+          case Operation::WRITE_HASH:
+            SharedMapCacheDriver::Write(values[0],values[1],values[2]);
+            break;
+          case Operation::DESTROY:
+            SharedMapCacheDriver::Destroy(std::vector<std::string>(1,values[0]));
+            break;
+          case Operation::DESTROY_HASH:
+            SharedMapCacheDriver::Destroy(values[0],values[1]);
+            break;
+          case Operation::RENAME:
+            SharedMapCacheDriver::Rename(values[0],values[1]);
+            break;
+        }
+        records_++;
+        offset += 8 + length;
+      }
+
+      compacted_records_ = records_;
+      if (offset != size){
+        // the application stopped while writing the last record,
+        // rewrite the log without it.
+        std::cout << "Cache log " << file_path_ << " has an incomplete record at byte " << offset << ", it has been discarded." << std::endl;
+        CompactLog();
+      }
+    }
+
+
+    void LogCacheDriver::Encode(std::string& buffer, const Operation operation, const std::vector<const std::string*>& values){
+      std::size_t length = 1;
+      for (auto it = values.begin(); it != values.end(); ++it){
+        length += 4 + (*it)->size();
+      }
+      const std::size_t start = buffer.size();
+      buffer.reserve(start + 8 + length);
+      granada::util::binary::put_uint32(buffer, (uint32_t)length);
+      granada::util::binary::put_uint32(buffer, 0);
+      buffer.push_back((char)operation);
+      for (auto it = values.begin(); it != values.end(); ++it){
+        granada::util::binary::put_uint32(buffer, (uint32_t)(*it)->size());
+        buffer.append(**it);
+      }
+      const uint32_t checksum = granada::util::binary::crc32(buffer.data() + start + 8, length);
+      for (int i = 0; i < 4; i++){
+        buffer[start + 4 + i] = (char)((checksum >> (8 * i)) & 0xff);
+      }
+    }
+
+
+    void LogCacheDriver::Append(const std::string& buffer, const std::size_t records){
+      if (file_ == nullptr){
+        return;
+      }
+      granada::util::metrics::Timer timer(append_latency());
+      std::fwrite(buffer.data(), 1, buffer.size(), file_);
+      std::fflush(file_);
+      records_ += records;
+
+      if (fsync_frequency_ > -1){
+        const std::time_t now = std::time(nullptr);
+        if (now - last_fsync_ >= fsync_frequency_){
+          granada::util::binary::sync(file_);
+          last_fsync_ = now;
+        }
+      }
+
+      if (compaction_min_records_ > 0 && records_ >= (std::size_t)compaction_min_records_ && records_ >= 2 * compacted_records_){
+        CompactLog();
+      }
+    }
+
+
+    std::size_t LogCacheDriver::Dump(std::FILE* file){
+      std::size_t records = 0;
+      std::string buffer;
+      std::fwrite(log_magic, 1, log_magic_size, file);
+      std::vector<std::shared_ptr<const Data>> data;
+      Freeze(data);
+      for (auto shard = data.begin(); shard != data.end(); ++shard){
+        for (auto it = (*shard)->begin(); it != (*shard)->end(); ++it){
+          for (auto it2 = it->second.begin(); it2 != it->second.end(); ++it2){
+            Encode(buffer, Operation::WRITE_HASH, {&it->first, &it2->first, &it2->second});
+            records++;
+            if (buffer.size() > 65536){
+              std::fwrite(buffer.data(), 1, buffer.size(), file);
+              buffer.clear();
+            }
+          }
+        }
+      }
+      std::fwrite(buffer.data(), 1, buffer.size(), file);
+      return records;
+    }
+
+
+    void LogCacheDriver::CompactLog(){
+      compactions().Increment();
+      const std::string tmp_file_path(file_path_ + ".tmp");
+      std::FILE* tmp_file = std::fopen(tmp_file_path.c_str(), "wb");
+      if (tmp_file == nullptr){
+        return;
+      }
+      const std::size_t records = Dump(tmp_file);
+      const bool written = !std::ferror(tmp_file);
+      granada::util::binary::sync(tmp_file);
+      std::fclose(tmp_file);
+      if (!written){
+        std::remove(tmp_file_path.c_str());
+        return;
+      }
+
+      // replace the log with the compacted one.
+      if (file_ != nullptr){
+        std::fclose(file_);
+        file_ = nullptr;
+      }
+#ifdef _WIN32
+      std::remove(file_path_.c_str());
+#endif
+      std::rename(tmp_file_path.c_str(), file_path_.c_str());
+      file_ = std::fopen(file_path_.c_str(), "ab");
+      records_ = records;
+      compacted_records_ = records;
+      last_fsync_ = std::time(nullptr);
+    }
+
+  }
+}
@@ -24,28 +24,63 @@
   * Manages the cache with a redis database.
   */
 
+
 #include "granada/cache/redis_cache_driver.h"
+#include "granada/util/metrics.h"
 
 namespace granada{
   namespace cache{
 
+    namespace{
+
+      /**
+       * Latency of the read, write and destroy operations.
+       */
+      struct Latency{
+        granada::util::metrics::Histogram& read = granada::util::metrics::GetHistogram("granada_cache_operation_seconds", "Latency of the cache operations.", "driver=\"redis\",operation=\"read\"");
+        granada::util::metrics::Histogram& write = granada::util::metrics::GetHistogram("granada_cache_operation_seconds", "Latency of the cache operations.", "driver=\"redis\",operation=\"write\"");
+        granada::util::metrics::Histogram& destroy = granada::util::metrics::GetHistogram("granada_cache_operation_seconds", "Latency of the cache operations.", "driver=\"redis\",operation=\"destroy\"");
+      };
+
+      Latency& latency(){
+        static Latency latency;
+        return latency;
+      }
+
+    }
+
     std::string RedisSyncClientWrapper::redis_address_;
     unsigned short RedisSyncClientWrapper::redis_port_;
+    std::vector<std::pair<std::string,unsigned short>> RedisSyncClientWrapper::redis_nodes_;
+    int RedisSyncClientWrapper::redis_virtual_nodes_;
     granada::util::mutex::call_once RedisSyncClientWrapper::load_properties_call_once_;
 
     RedisSyncClientWrapper::RedisSyncClientWrapper(){
 
       // load properties only once, and wait all the
       // threads until they are loaded.
-      load_properties_call_once_.call([this](){
-        this->LoadProperties();
+      load_properties_call_once_.call([](){
+        RedisSyncClientWrapper::LoadProperties();
       });
 
-      // init redis async client
-      boost::asio::io_service ioService;
-      redis_.reset(new redisclient::RedisSyncClient(ioService));
-      ConnectRedisSyncClient(redis_.get(),redis_address_,redis_port_);
+      // init one redis sync client per redis server
+      // and place the servers in the hash ring.
+      for (auto it = redis_nodes_.begin(); it != redis_nodes_.end(); ++it){
+        std::unique_ptr<Node> node(new Node());
+        node->redis.reset(new redisclient::RedisSyncClient(node->io_service));
+        ConnectRedisSyncClient(node->redis.get(),it->first,it->second);
+        ring_.Add(it->first + ":" + std::to_string(it->second), redis_virtual_nodes_);
+        nodes_.push_back(std::move(node));
+      }
+
+    }
+
 
+    const std::vector<std::pair<std::string,unsigned short>>& RedisSyncClientWrapper::servers(){
+      load_properties_call_once_.call([](){
+        RedisSyncClientWrapper::LoadProperties();
+      });
+      return redis_nodes_;
     }
 
 
@@ -71,6 +106,38 @@ namespace granada{
           }catch(const std::exception& e){}
         }
       }
+
+      // redis servers the keys are sharded over, "address:port" separated by commas,
+      // if there are none only the server in "redis_cache_driver_address" is used.
+      redis_nodes_.clear();
+      std::vector<std::string> nodes;
+      granada::util::string::split(granada::util::application::GetProperty(entity_keys::redis_cache_driver_nodes),',',nodes);
+      for (auto it = nodes.begin(); it != nodes.end(); ++it){
+        std::string node = *it;
+        granada::util::string::trim(node);
+        if (!node.empty()){
+          const std::size_t colon = node.rfind(':');
+          if (colon == std::string::npos){
+            redis_nodes_.push_back(std::make_pair(node,redis_port_));
+          }else{
+            redis_nodes_.push_back(std::make_pair(node.substr(0,colon),(unsigned short) std::strtoul(node.substr(colon + 1).c_str(), NULL, 0)));
+          }
+        }
+      }
+      if (redis_nodes_.empty()){
+        redis_nodes_.push_back(std::make_pair(redis_address_,redis_port_));
+      }
+
+      std::string redis_virtual_nodes_str = granada::util::application::GetProperty(entity_keys::redis_cache_driver_virtual_nodes);
+      if (redis_virtual_nodes_str.empty()){
+        redis_virtual_nodes_ = default_numbers::redis_cache_driver_virtual_nodes;
+      }else{
+        try{
+          redis_virtual_nodes_ = std::stoi(redis_virtual_nodes_str);
+        }catch(const std::logic_error e){
+          redis_virtual_nodes_ = default_numbers::redis_cache_driver_virtual_nodes;
+        }
+      }
     }
 
 
@@ -90,12 +157,7 @@ namespace granada{
     }
 
     RedisIterator::RedisIterator(RedisIterator::Type type, const std::string& expression){
-
-      type_ = std::move(type);
-      expression_.assign(expression);
-
-      // get first set of keys.
-      GetNextVector();
+      set(type, expression);
     }
 
 
@@ -113,6 +175,15 @@ namespace granada{
       cursor_ = "";
       has_next_ = false;
 
+      // search only in the redis server where the keys are
+      // if the expression has a hash tag, in all of them if not.
+      if (cache_->node(expression_, node_)){
+        last_node_ = node_;
+      }else{
+        node_ = 0;
+        last_node_ = cache_->nodes() - 1;
+      }
+
       // get first set of keys.
       GetNextVector();
     }
@@ -141,56 +212,47 @@ namespace granada{
 
 
     void RedisIterator::GetNextVector(){
-      if (cursor_ == "0"){
-        has_next_ = false;
-      }else{
-        has_next_ = true;
-        if (cursor_.empty()){
-          cursor_ = "0";
+      has_next_ = false;
+      while (!has_next_){
+        if (cursor_ == "0"){
+          // no more keys in this redis server, continue with the next one.
+          if (node_ >= last_node_){
+            keys_.clear();
+            return;
+          }
+          node_++;
+          cursor_ = "";
         }
+        const std::string cursor(cursor_.empty() ? "0" : cursor_);
+        cursor_ = "0";
+        keys_.clear();
         if (type_ == 0){
-          const redisclient::RedisValue& result = cache_->Keys(expression_);
-          if(result.isOk()){
+          const redisclient::RedisValue& result = cache_->Keys(node_,expression_);
+          if(result.isOk() && result.isArray()){
             keys_ = result.toArray();
-            if (keys_.empty()){
-              has_next_ = false;
-            }
-          }else{
-            has_next_ = false;
           }
         }else if (type_ == 1){
           // SCAN search.
-          const redisclient::RedisValue& result = cache_->Scan(cursor_,expression_);
-          if(result.isOk()){
+          const redisclient::RedisValue& result = cache_->Scan(node_,cursor,expression_);
+          if(result.isOk() && result.isArray()){
             const std::vector<redisclient::RedisValue>& result_v = result.toArray();
             if (result_v.size() == 2){
               cursor_ = result_v.at(0).toString();
               keys_ = result_v.at(1).toArray();
-              if (keys_.empty()){
-                if (cursor_ == "0"){
-                  has_next_ = false;
-                }else{
-                  GetNextVector();
-                }
-              }
             }
-          }else{
-            has_next_ = false;
           }
         }
+        has_next_ = !keys_.empty();
       }
     }
 
 
-    std::mutex RedisCacheDriver::mtx_;
     std::unique_ptr<RedisSyncClientWrapper> RedisCacheDriver::redis_(new RedisSyncClientWrapper());
 
     const bool RedisCacheDriver::Exists(const std::string& key){
+      granada::util::metrics::Timer timer(latency().read);
 
-      const redisclient::RedisValue& result = [&]{
-        std::lock_guard<std::mutex> lg(mtx_);
-        return redis_->get()->command("EXISTS", {key});
-      }();
+      const redisclient::RedisValue& result = redis_->command(key, "EXISTS", {key});
 
       if(result.isOk())
       {
@@ -202,11 +264,9 @@ namespace granada{
     }
 
     const bool RedisCacheDriver::Exists(const std::string& hash,const std::string& key){
+      granada::util::metrics::Timer timer(latency().read);
 
-      const redisclient::RedisValue& result = [&]{
-        std::lock_guard<std::mutex> lg(mtx_);
-        return redis_->get()->command("EXISTS", {hash});
-      }();
+      const redisclient::RedisValue& result = redis_->command(hash, "EXISTS", {hash});
 
       if(result.isOk())
       {
@@ -218,11 +278,9 @@ namespace granada{
     }
 
     const std::string RedisCacheDriver::Read(const std::string& key){
+      granada::util::metrics::Timer timer(latency().read);
 
-      const redisclient::RedisValue& result = [&]{
-        std::lock_guard<std::mutex> lg(mtx_);
-        return redis_->get()->command("GET", {key});
-      }();
+      const redisclient::RedisValue& result = redis_->command(key, "GET", {key});
 
       if(result.isOk())
       {
@@ -233,11 +291,9 @@ namespace granada{
 
 
     const std::string RedisCacheDriver::Read(const std::string& hash,const std::string& key){
+      granada::util::metrics::Timer timer(latency().read);
 
-      const redisclient::RedisValue& result = [&]{
-        std::lock_guard<std::mutex> lg(mtx_);
-        return redis_->get()->command("HGET", {hash, key});
-      }();
+      const redisclient::RedisValue& result = redis_->command(hash, "HGET", {hash, key});
 
       if(result.isOk())
       {
@@ -247,15 +303,49 @@ namespace granada{
     }
 
 
+    void RedisCacheDriver::Fields(const std::string& hash, std::vector<std::string>& fields){
+      granada::util::metrics::Timer timer(latency().read);
+      fields.clear();
+
+      const redisclient::RedisValue& result = redis_->command(hash, "HKEYS", {hash});
+
+      if(result.isOk() && result.isArray())
+      {
+        const std::vector<redisclient::RedisValue>& values = result.toArray();
+        fields.reserve(values.size());
+        for (auto it = values.begin(); it != values.end(); ++it){
+          fields.push_back(it->toString());
+        }
+      }
+    }
+
+
+    void RedisCacheDriver::ReadAll(const std::string& hash, std::map<std::string,std::string>& values){
+      granada::util::metrics::Timer timer(latency().read);
+      values.clear();
+
+      const redisclient::RedisValue& result = redis_->command(hash, "HGETALL", {hash});
+
+      if(result.isOk() && result.isArray())
+      {
+        // reply is a flat array: field, value, field, value...
+        const std::vector<redisclient::RedisValue>& pairs = result.toArray();
+        for (std::size_t i = 0; i + 1 < pairs.size(); i += 2){
+          values[pairs[i].toString()] = pairs[i + 1].toString();
+        }
+      }
+    }
+
+
     void RedisCacheDriver::Write(const std::string& key,const std::string& value){
-      std::lock_guard<std::mutex> lg(mtx_);
-      redis_->get()->command("SET", {key, value});
+      granada::util::metrics::Timer timer(latency().write);
+      redis_->command(key, "SET", {key, value});
     }
 
 
     void RedisCacheDriver::Write(const std::string& hash,const std::string& key,const std::string& value){
-      std::lock_guard<std::mutex> lg(mtx_);
-      redis_->get()->command("HSET", {hash, key, value});
+      granada::util::metrics::Timer timer(latency().write);
+      redis_->command(hash, "HSET", {hash, key, value});
     }
 
 
@@ -264,47 +354,86 @@ namespace granada{
       if (found!=std::string::npos){
         std::vector<std::string> keys;
         Match(key,keys);
-        for (auto it = keys.begin(); it != keys.end(); ++it){
-          std::lock_guard<std::mutex> lg(mtx_);
-          redis_->get()->command("DEL", {*it});
-        }
+        Destroy(keys);
       }else{
-        std::lock_guard<std::mutex> lg(mtx_);
-        redis_->get()->command("DEL", {key});
+        granada::util::metrics::Timer timer(latency().destroy);
+        redis_->command(key, "DEL", {key});
+      }
+    }
+
+
+    void RedisCacheDriver::Destroy(const std::vector<std::string>& keys){
+      granada::util::metrics::Timer timer(latency().destroy);
+      const std::size_t batch_size = default_numbers::redis_cache_driver_batch_size;
+
+      // group the keys by redis server, sending a DEL command
+      // each time a group reaches the batch size.
+      std::vector<std::deque<redisclient::RedisBuffer>> batches(redis_->size());
+      for (auto it = keys.begin(); it != keys.end(); ++it){
+        const std::size_t node = redis_->node(*it);
+        std::deque<redisclient::RedisBuffer>& batch = batches[node];
+        batch.push_back(*it);
+        if (batch.size() >= batch_size){
+          redis_->command(node, "DEL", std::move(batch));
+          batch.clear();
+        }
+      }
+      for (std::size_t node = 0; node < batches.size(); ++node){
+        if (!batches[node].empty()){
+          redis_->command(node, "DEL", std::move(batches[node]));
+        }
       }
     }
 
 
     void RedisCacheDriver::Destroy(const std::string& hash,const std::string& key){
-      std::lock_guard<std::mutex> lg(mtx_);
-      redis_->get()->command("HDEL", {hash, key});
+      granada::util::metrics::Timer timer(latency().destroy);
+      redis_->command(hash, "HDEL", {hash, key});
     }
 
     
     bool RedisCacheDriver::Rename(const std::string& old_key, const std::string& new_key){
+      granada::util::metrics::Timer timer(latency().write);
+      const std::size_t old_node = redis_->node(old_key);
+      const std::size_t new_node = redis_->node(new_key);
 
-      const redisclient::RedisValue& result = [&]{
-        std::lock_guard<std::mutex> lg(mtx_);
-        return redis_->get()->command("RENAMENX", {old_key, new_key});
-      }();
+      if (old_node == new_node){
+        const redisclient::RedisValue& result = redis_->command(old_node, "RENAMENX", {old_key, new_key});
 
-      if(result.isOk())
-      {
-        return true;
+        if(result.isOk())
+        {
+          return true;
+        }
+        return false;
       }
-      return false;
+
+      // keys are in different redis servers, move the
+      // serialized value keeping its time to live.
+      if (Exists(new_key)){
+        return false;
+      }
+      const redisclient::RedisValue& dump = redis_->command(old_node, "DUMP", {old_key});
+      if (!dump.isOk() || dump.isNull()){
+        return false;
+      }
+      const redisclient::RedisValue& pttl = redis_->command(old_node, "PTTL", {old_key});
+      const std::string ttl((pttl.isInt() && pttl.toInt() > 0) ? std::to_string(pttl.toInt()) : "0");
+      const redisclient::RedisValue& restore = redis_->command(new_node, "RESTORE", {new_key, ttl, dump.toString()});
+      if (!restore.isOk()){
+        return false;
+      }
+      redis_->command(old_node, "DEL", {old_key});
+      return true;
     }
 
 
-    redisclient::RedisValue RedisCacheDriver::Scan(const std::string& cursor, const std::string& expression_){
-      std::lock_guard<std::mutex> lg(mtx_);
-      return redis_->get()->command("SCAN", {cursor, "MATCH", expression_});
+    redisclient::RedisValue RedisCacheDriver::Scan(const std::size_t node, const std::string& cursor, const std::string& expression_){
+      return redis_->command(node, "SCAN", {cursor, "MATCH", expression_});
     }
 
 
-    redisclient::RedisValue RedisCacheDriver::Keys(const std::string& expression_){
-      std::lock_guard<std::mutex> lg(mtx_);
-      return redis_->get()->command("KEYS", {expression_});
+    redisclient::RedisValue RedisCacheDriver::Keys(const std::size_t node, const std::string& expression_){
+      return redis_->command(node, "KEYS", {expression_});
     }
 
   }
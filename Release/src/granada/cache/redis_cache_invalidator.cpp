@@ -0,0 +1,311 @@
+/**
+  * Copyright (c) <2016> granada <afernandez@cookinapps.io>
+  *
+  * This source code is licensed under the MIT license.
+  *
+  * Permission is hereby granted, free of charge, to any person obtaining a copy
+  * of this software and associated documentation files (the "Software"), to deal
+  * in the Software without restriction, including without limitation the rights
+  * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  * copies of the Software, and to permit persons to whom the Software is
+  * furnished to do so, subject to the following conditions:
+  *
+  * The above copyright notice and this permission notice shall be included in
+  * all copies or substantial portions of the Software.
+  *
+  * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  * SOFTWARE.
+  *
+  *
+  * Tells the tiered cache handlers which redis keys have been modified.
+  */
+
+#include "granada/cache/redis_cache_invalidator.h"
+#include <algorithm>
+#include <chrono>
+#include <future>
+#include <iostream>
+
+namespace granada{
+  namespace cache{
+
+    granada::util::mutex::call_once RedisCacheInvalidator::load_properties_call_once_;
+    bool RedisCacheInvalidator::tracking_;
+
+
+    RedisCacheInvalidator::~RedisCacheInvalidator(){
+      for (auto it = nodes_.begin(); it != nodes_.end(); ++it){
+        Node* node = it->get();
+        node->work.reset();
+        node->io_service.stop();
+        if (node->thread.joinable()){
+          node->thread.join();
+        }
+        node->subscriber.reset();
+        node->tracker.reset();
+        node->socket.reset();
+      }
+    }
+
+
+    void RedisCacheInvalidator::LoadProperties(){
+      std::string invalidation = granada::util::application::GetProperty(entity_keys::redis_cache_invalidation);
+      if (invalidation.empty()){
+        invalidation.assign(default_strings::redis_cache_invalidation);
+      }
+      tracking_ = invalidation != "pubsub";
+    }
+
+
+    bool RedisCacheInvalidator::Subscribe(const std::vector<std::string>& prefixes, std::function<void(const std::string&)> invalidate, std::function<void()> disconnect){
+
+      // load properties only once, and wait all the
+      // threads until they are loaded.
+      load_properties_call_once_.call([](){
+        RedisCacheInvalidator::LoadProperties();
+      });
+
+      const std::vector<std::pair<std::string,unsigned short>>& servers = RedisSyncClientWrapper::servers();
+      if (servers.empty()){
+        return false;
+      }
+
+      if (!tracking_){
+        // all the processes publish and subscribe in the first server.
+        publisher_.reset(new redisclient::RedisSyncClient(publisher_io_service_));
+        std::string errmsg;
+        if (!publisher_->connect(boost::asio::ip::address::from_string(servers.front().first), servers.front().second, errmsg)){
+          std::cout << "Can t connect to redis: " << errmsg << std::endl;
+          return false;
+        }
+        nodes_.push_back(std::unique_ptr<Node>(new Node()));
+        return Subscribe(nodes_.back().get(), servers.front().first, servers.front().second, prefixes, invalidate, disconnect);
+      }
+
+      for (auto it = servers.begin(); it != servers.end(); ++it){
+        nodes_.push_back(std::unique_ptr<Node>(new Node()));
+        if (!Subscribe(nodes_.back().get(), it->first, it->second, prefixes, invalidate, disconnect)){
+          return false;
+        }
+      }
+      return true;
+    }
+
+
+    bool RedisCacheInvalidator::Subscribe(Node* node, const std::string& address, const unsigned short port, const std::vector<std::string>& prefixes, std::function<void(const std::string&)> invalidate, std::function<void()> disconnect){
+
+      // the handlers may be called after the timeout, so the
+      // result is shared and only the first value is taken.
+      std::shared_ptr<std::promise<bool>> subscribed = std::make_shared<std::promise<bool>>();
+      std::future<bool> future = subscribed->get_future();
+      std::function<void(bool)> done = [subscribed](bool value){
+        try{
+          subscribed->set_value(value);
+        }catch(const std::future_error& e){}
+      };
+
+      if (tracking_){
+        SubscribeTracking(node, address, port, prefixes, invalidate, disconnect, done);
+      }else{
+        SubscribePubsub(node, address, port, invalidate, disconnect, done);
+      }
+
+      node->work.reset(new boost::asio::io_service::work(node->io_service));
+      node->thread = std::thread([node](){
+        node->io_service.run();
+      });
+
+      if (future.wait_for(std::chrono::milliseconds(default_numbers::redis_cache_invalidation_timeout)) != std::future_status::ready){
+        std::cout << "Redis invalidation subscription timed out." << std::endl;
+        return false;
+      }
+      return future.get();
+    }
+
+
+    void RedisCacheInvalidator::SubscribePubsub(Node* node, const std::string& address, const unsigned short port, std::function<void(const std::string&)> invalidate, std::function<void()> disconnect, std::function<void(bool)> done){
+      const std::string channel = default_strings::redis_cache_invalidation_pubsub_channel;
+      redisclient::RedisAsyncClient* subscriber = new redisclient::RedisAsyncClient(node->io_service);
+      node->subscriber.reset(subscriber);
+
+      subscriber->installErrorHandler([disconnect, done](const std::string& error){
+        std::cout << "Redis invalidation subscription lost: " << error << std::endl;
+        done(false);
+        disconnect();
+      });
+
+      subscriber->connect(boost::asio::ip::address::from_string(address), port, [subscriber, channel, invalidate, done](bool connected, const std::string& errmsg){
+        if (!connected){
+          std::cout << "Can t connect to redis: " << errmsg << std::endl;
+          done(false);
+          return;
+        }
+        subscriber->subscribe(channel,
+          [invalidate](const std::vector<char>& message){
+            invalidate(std::string(message.begin(), message.end()));
+          },
+          [done](redisclient::RedisValue result){
+            done(!result.isError());
+          });
+      });
+    }
+
+
+    void RedisCacheInvalidator::SubscribeTracking(Node* node, const std::string& address, const unsigned short port, const std::vector<std::string>& prefixes, std::function<void(const std::string&)> invalidate, std::function<void()> disconnect, std::function<void(bool)> done){
+
+      // losing any of the two connections stops the invalidations.
+      std::function<void(const std::string&)> lost = [disconnect, done](const std::string& error){
+        std::cout << "Redis invalidation subscription lost: " << error << std::endl;
+        done(false);
+        disconnect();
+      };
+
+      // connection with client side caching enabled, redirecting the
+      // invalidations of the keys with the prefixes to the socket.
+      redisclient::RedisAsyncClient* tracker = new redisclient::RedisAsyncClient(node->io_service);
+      node->tracker.reset(tracker);
+      tracker->installErrorHandler(lost);
+
+      std::function<void(const int64_t)> track = [tracker, address, port, prefixes, done](const int64_t client_id){
+        tracker->connect(boost::asio::ip::address::from_string(address), port, [tracker, client_id, prefixes, done](bool connected, const std::string& errmsg){
+          if (!connected){
+            std::cout << "Can t connect to redis: " << errmsg << std::endl;
+            done(false);
+            return;
+          }
+          std::deque<redisclient::RedisBuffer> args = {"TRACKING", "ON", "REDIRECT", std::to_string(client_id), "BCAST"};
+          if (std::find(prefixes.begin(), prefixes.end(), std::string()) == prefixes.end()){
+            for (auto it = prefixes.begin(); it != prefixes.end(); ++it){
+              args.push_back("PREFIX");
+              args.push_back(*it);
+            }
+          }
+          tracker->command("CLIENT", args, [done](redisclient::RedisValue result){
+            if (result.isError()){
+              std::cout << "Redis client side caching not available: " << result.toString() << std::endl;
+              done(false);
+              return;
+            }
+            done(true);
+          });
+        });
+      };
+
+      // the socket receives the reply to CLIENT ID, the reply to SUBSCRIBE,
+      // then the invalidation messages. Only used by the io_service thread.
+      std::shared_ptr<int64_t> client_id = std::make_shared<int64_t>(-1);
+      std::shared_ptr<bool> tracking = std::make_shared<bool>(false);
+      std::function<void(const redisclient::RedisValue&)> receive = [client_id, tracking, track, invalidate, done](const redisclient::RedisValue& value){
+        if (*client_id < 0){
+          if (!value.isInt()){
+            done(false);
+            return;
+          }
+          *client_id = value.toInt();
+        }else if (!*tracking){
+          // subscribed before the tracking is enabled, so no invalidation is missed.
+          if (value.isError()){
+            std::cout << "Can t subscribe to redis invalidations: " << value.toString() << std::endl;
+            done(false);
+            return;
+          }
+          *tracking = true;
+          track(*client_id);
+        }else{
+          RedisCacheInvalidator::Invalidate(value, invalidate);
+        }
+      };
+
+      node->socket.reset(new boost::asio::ip::tcp::socket(node->io_service));
+      const boost::asio::ip::tcp::endpoint endpoint(boost::asio::ip::address::from_string(address), port);
+      node->socket->async_connect(endpoint, [node, receive, lost, done](const boost::system::error_code& ec){
+        if (ec){
+          std::cout << "Can t connect to redis: " << ec.message() << std::endl;
+          done(false);
+          return;
+        }
+        std::shared_ptr<std::string> request = std::make_shared<std::string>(
+          RedisCacheInvalidator::Command({"CLIENT", "ID"}) +
+          RedisCacheInvalidator::Command({"SUBSCRIBE", default_strings::redis_cache_invalidation_tracking_channel}));
+        boost::asio::async_write(*node->socket, boost::asio::buffer(*request), [request, lost](const boost::system::error_code& ec, std::size_t length){
+          if (ec){
+            lost(ec.message());
+          }
+        });
+        RedisCacheInvalidator::Read(node, receive, lost);
+      });
+    }
+
+
+    void RedisCacheInvalidator::Read(Node* node, std::function<void(const redisclient::RedisValue&)> receive, std::function<void(const std::string&)> lost){
+      node->socket->async_read_some(boost::asio::buffer(node->buffer), [node, receive, lost](const boost::system::error_code& ec, std::size_t length){
+        if (ec){
+          if (ec != boost::asio::error::operation_aborted){
+            lost(ec.message());
+          }
+          return;
+        }
+        std::size_t position = 0;
+        while (position < length){
+          const std::pair<std::size_t, redisclient::RedisParser::ParseResult>& result = node->parser.parse(node->buffer.data() + position, length - position);
+          position += result.first;
+          if (result.second == redisclient::RedisParser::Completed){
+            receive(node->parser.result());
+          }else if (result.second == redisclient::RedisParser::Error){
+            lost("malformed redis reply.");
+            return;
+          }
+        }
+        RedisCacheInvalidator::Read(node, receive, lost);
+      });
+    }
+
+
+    void RedisCacheInvalidator::Invalidate(const redisclient::RedisValue& message, const std::function<void(const std::string&)>& invalidate){
+      // ["message", "__redis__:invalidate", keys]
+      if (!message.isArray()){
+        return;
+      }
+      const std::vector<redisclient::RedisValue>& parts = message.toArray();
+      if (parts.size() != 3 || parts[0].toString() != "message"){
+        return;
+      }
+      const redisclient::RedisValue& keys = parts[2];
+      if (keys.isNull()){
+        // FLUSHALL, FLUSHDB or the server evicted its tracking
+        // table: any key may have been modified.
+        invalidate(std::string());
+      }else if (keys.isArray()){
+        const std::vector<redisclient::RedisValue>& array = keys.toArray();
+        for (auto it = array.begin(); it != array.end(); ++it){
+          invalidate(it->toString());
+        }
+      }else{
+        invalidate(keys.toString());
+      }
+    }
+
+
+    std::string RedisCacheInvalidator::Command(const std::vector<std::string>& args){
+      std::string command = "*" + std::to_string(args.size()) + "\r\n";
+      for (auto it = args.begin(); it != args.end(); ++it){
+        command += "$" + std::to_string(it->size()) + "\r\n" + *it + "\r\n";
+      }
+      return command;
+    }
+
+
+    void RedisCacheInvalidator::Publish(const std::string& key){
+      if (publisher_ != nullptr){
+        std::lock_guard<std::mutex> lg(publisher_mtx_);
+        publisher_->command("PUBLISH", {default_strings::redis_cache_invalidation_pubsub_channel, key});
+      }
+    }
+
+  }
+}
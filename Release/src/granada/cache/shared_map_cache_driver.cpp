@@ -21,14 +21,34 @@
   * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
   * SOFTWARE.
   *
-  * Manages the cache
+  * Manages the cache storing key-value pairs in an unordered map,
+  * optionally saved in snapshot files.
   */
 
 #include "granada/cache/shared_map_cache_driver.h"
+#include <cstdio>
+#include <iostream>
+#include "granada/util/binary.h"
 
 namespace granada{
   namespace cache{
 
+    namespace{
+
+      /**
+       * First bytes of a snapshot file.
+       */
+      const char snapshot_magic[] = "GRANADA.SNAPSHOT.1\n";
+
+
+      /**
+       * Number of bytes of snapshot_magic.
+       */
+      const std::size_t snapshot_magic_size = sizeof(snapshot_magic) - 1;
+
+    }
+
+
     SharedMapIterator::SharedMapIterator(const std::string& expression, SharedMapCacheDriver* cache){
       cache_ = cache;
       set(expression);
@@ -36,10 +56,20 @@ namespace granada{
 
 
     void SharedMapIterator::set(const std::string& expression){
-      expression_ = expression;
-      std::deque<std::pair<std::string,std::string>> values;
-      values.push_back(std::make_pair("*",".*"));
-      granada::util::string::replace(expression_,values,"","");
+      // "*" matches any sequence of characters, everything
+      // else is matched literally.
+      expression_.clear();
+      expression_.reserve(expression.size() * 2);
+      for (auto it = expression.begin(); it != expression.end(); ++it){
+        if (*it == '*'){
+          expression_ += ".*";
+        }else{
+          if (*it != '\0' && std::strchr("\\^$.|?+()[]{}", *it) != nullptr){
+            expression_ += '\\';
+          }
+          expression_ += *it;
+        }
+      }
       cache_->Keys(expression_,keys_);
       it_ = keys_.begin();
     }
@@ -60,14 +90,145 @@ namespace granada{
     }
 
 
+    granada::util::mutex::call_once SharedMapCacheDriver::load_properties_call_once_;
+    std::string SharedMapCacheDriver::snapshot_directory_;
+    int SharedMapCacheDriver::snapshot_frequency_;
+
+
     SharedMapCacheDriver::SharedMapCacheDriver(){
-      data_.reset(new std::unordered_map<std::string,std::map<std::string,std::string>>());
+      CountOperations("shared_map");
+      CreateShards();
+    }
+
+
+    SharedMapCacheDriver::SharedMapCacheDriver(const std::string& name){
+      name_.assign(name);
+      CountOperations("shared_map");
+      CreateShards();
+    }
+
+
+    void SharedMapCacheDriver::CountOperations(const std::string& driver){
+      const std::string& help = "Number of cache operations.";
+      const std::string& labels = "driver=\"" + driver + "\",operation=";
+      reads_ = &granada::util::metrics::GetCounter("granada_cache_operations_total", help, labels + "\"read\"");
+      writes_ = &granada::util::metrics::GetCounter("granada_cache_operations_total", help, labels + "\"write\"");
+      destroys_ = &granada::util::metrics::GetCounter("granada_cache_operations_total", help, labels + "\"destroy\"");
+    }
+
+
+    void SharedMapCacheDriver::Start(){
+      if (name_.empty()){
+        return;
+      }
+      std::call_once(start_once_, [this](){
+        // load properties only once, and wait all the
+        // threads until they are loaded.
+        load_properties_call_once_.call([](){
+          SharedMapCacheDriver::LoadProperties();
+        });
+
+        started_ = true;
+        if (snapshot_directory_.empty()){
+          return;
+        }
+        snapshot_path_.assign(snapshot_directory_ + "/" + name_ + ".snapshot");
+        LoadSnapshot(snapshot_path_);
+
+        if (snapshot_frequency_ > 0){
+          snapshot_thread_ = std::thread([this](){
+            std::unique_lock<std::mutex> lock(snapshot_thread_mtx_);
+            while (!snapshot_thread_stop_){
+              if (!snapshot_thread_cv_.wait_for(lock, std::chrono::seconds(snapshot_frequency_), [this]{ return snapshot_thread_stop_; })){
+                lock.unlock();
+                SaveSnapshot(snapshot_path_);
+                lock.lock();
+              }
+            }
+          });
+        }
+      });
+    }
+
+
+    SharedMapCacheDriver::~SharedMapCacheDriver(){
+      if (snapshot_thread_.joinable()){
+        {
+          std::lock_guard<std::mutex> lg(snapshot_thread_mtx_);
+          snapshot_thread_stop_ = true;
+        }
+        snapshot_thread_cv_.notify_all();
+        snapshot_thread_.join();
+      }
+      if (started_ && !snapshot_path_.empty()){
+        SaveSnapshot(snapshot_path_);
+      }
+    }
+
+
+    void SharedMapCacheDriver::LoadProperties(){
+      snapshot_directory_.assign(granada::util::application::GetProperty(entity_keys::shared_map_cache_driver_snapshot_directory));
+      while (snapshot_directory_.size() > 1 && (snapshot_directory_.back() == '/' || snapshot_directory_.back() == '\\')){
+        snapshot_directory_.pop_back();
+      }
+
+      const std::string& snapshot_frequency_str = granada::util::application::GetProperty(entity_keys::shared_map_cache_driver_snapshot_frequency);
+      if (snapshot_frequency_str.empty()){
+        snapshot_frequency_ = default_numbers::shared_map_cache_driver_snapshot_frequency;
+      }else{
+        try{
+          snapshot_frequency_ = std::stoi(snapshot_frequency_str);
+        }catch(const std::logic_error e){
+          snapshot_frequency_ = default_numbers::shared_map_cache_driver_snapshot_frequency;
+        }
+      }
+    }
+
+
+    void SharedMapCacheDriver::CreateShards(){
+      const int shards = default_numbers::shared_map_cache_driver_shards;
+      shards_.reserve(shards);
+      for (int i = 0; i < shards; i++){
+        std::unique_ptr<Shard> shard(new Shard());
+        shard->data = std::make_shared<Data>();
+        shards_.push_back(std::move(shard));
+      }
+    }
+
+
+    SharedMapCacheDriver::Shard& SharedMapCacheDriver::shard(const std::string& key){
+      Start();
+      return *shards_[granada::cache::HashRing::Hash(key) % shards_.size()];
+    }
+
+
+    SharedMapCacheDriver::Data& SharedMapCacheDriver::writable(Shard& shard){
+      if (shard.frozen){
+        shard.data = std::make_shared<Data>(*shard.data);
+        shard.frozen = false;
+      }
+      return *shard.data;
+    }
+
+
+    void SharedMapCacheDriver::Freeze(std::vector<std::shared_ptr<const Data>>& data){
+      Start();
+      data.clear();
+      data.reserve(shards_.size());
+      for (auto it = shards_.begin(); it != shards_.end(); ++it){
+        Shard& shard = **it;
+        std::lock_guard<std::mutex> lg(shard.mtx);
+        shard.frozen = true;
+        data.push_back(shard.data);
+      }
     }
 
 
     const bool SharedMapCacheDriver::Exists(const std::string& key){
-      std::lock_guard<std::mutex> lg(mtx_);
-      if (data_->find(key) != data_->end()){
+      reads_->Increment();
+      Shard& s = shard(key);
+      std::lock_guard<std::mutex> lg(s.mtx);
+      if (s.data->find(key) != s.data->end()){
         return true;
       }
       return false;
@@ -75,9 +236,11 @@ namespace granada{
 
 
     const bool SharedMapCacheDriver::Exists(const std::string& hash,const std::string& key){
-      std::lock_guard<std::mutex> lg(mtx_);
-      auto it = data_->find(hash);
-      if (it != data_->end()){
+      reads_->Increment();
+      Shard& s = shard(hash);
+      std::lock_guard<std::mutex> lg(s.mtx);
+      auto it = s.data->find(hash);
+      if (it != s.data->end()){
         const std::map<std::string,std::string>& properties = it->second;
         auto it2 = properties.find(key);
         if(it2 != properties.end()){
@@ -89,9 +252,11 @@ namespace granada{
 
 
     const std::string SharedMapCacheDriver::Read(const std::string& key){
-      std::lock_guard<std::mutex> lg(mtx_);
-      auto it = data_->find(key);
-      if (it != data_->end()){
+      reads_->Increment();
+      Shard& s = shard(key);
+      std::lock_guard<std::mutex> lg(s.mtx);
+      auto it = s.data->find(key);
+      if (it != s.data->end()){
         const std::map<std::string,std::string>& properties = it->second;
         auto it2 = properties.find("__");
         if(it2 != properties.end()){
@@ -103,10 +268,12 @@ namespace granada{
 
 
     const std::string SharedMapCacheDriver::Read(const std::string& hash,const std::string& key){
-      std::lock_guard<std::mutex> lg(mtx_);
-      auto it = data_->find(hash);
-      if (it != data_->end()){
-        std::map<std::string,std::string> properties = it->second;
+      reads_->Increment();
+      Shard& s = shard(hash);
+      std::lock_guard<std::mutex> lg(s.mtx);
+      auto it = s.data->find(hash);
+      if (it != s.data->end()){
+        const std::map<std::string,std::string>& properties = it->second;
         auto it2 = properties.find(key);
         if(it2 != properties.end()){
           return it2->second;
@@ -116,34 +283,49 @@ namespace granada{
     }
 
 
-    void SharedMapCacheDriver::Write(const std::string& key,const std::string& value){
-      std::lock_guard<std::mutex> lg(mtx_);
-      auto it = data_->find(key);
-      if (it == data_->end()){
-        std::map<std::string,std::string> properties;
-        properties["__"] = value;
-        (*data_)[key] = properties;
-      }else{
-        std::map<std::string,std::string> properties = it->second;
-        properties["__"] = value;
-        (*data_)[key] = properties;
+    void SharedMapCacheDriver::Fields(const std::string& hash, std::vector<std::string>& fields){
+      reads_->Increment();
+      fields.clear();
+      Shard& s = shard(hash);
+      std::lock_guard<std::mutex> lg(s.mtx);
+      auto it = s.data->find(hash);
+      if (it != s.data->end()){
+        const std::map<std::string,std::string>& properties = it->second;
+        fields.reserve(properties.size());
+        for (auto it2 = properties.begin(); it2 != properties.end(); ++it2){
+          fields.push_back(it2->first);
+        }
       }
     }
 
 
-    void SharedMapCacheDriver::Write(const std::string& hash,const std::string& key,const std::string& value){
-      std::lock_guard<std::mutex> lg(mtx_);
-      auto it = data_->find(hash);
-      if (it == data_->end()){
-        std::map<std::string,std::string> properties;
-        properties[key] = value;
-        (*data_)[hash] = properties;
+    void SharedMapCacheDriver::ReadAll(const std::string& hash, std::map<std::string,std::string>& values){
+      reads_->Increment();
+      Shard& s = shard(hash);
+      std::lock_guard<std::mutex> lg(s.mtx);
+      auto it = s.data->find(hash);
+      if (it != s.data->end()){
+        values = it->second;
       }else{
-        std::map<std::string,std::string> properties = it->second;
-        properties[key] = value;
-        (*data_)[hash] = properties;
+        values.clear();
       }
     }
+
+
+    void SharedMapCacheDriver::Write(const std::string& key,const std::string& value){
+      writes_->Increment();
+      Shard& s = shard(key);
+      std::lock_guard<std::mutex> lg(s.mtx);
+      writable(s)[key]["__"] = value;
+    }
+
+
+    void SharedMapCacheDriver::Write(const std::string& hash,const std::string& key,const std::string& value){
+      writes_->Increment();
+      Shard& s = shard(hash);
+      std::lock_guard<std::mutex> lg(s.mtx);
+      writable(s)[hash][key] = value;
+    }
     
 
     void SharedMapCacheDriver::Destroy(const std::string& key){
@@ -151,41 +333,63 @@ namespace granada{
       if (found!=std::string::npos){
         std::vector<std::string> keys;
         Match(key,keys);
-        for (auto it = keys.begin(); it != keys.end(); ++it){
-          std::lock_guard<std::mutex> lg(mtx_);
-          data_->erase(*it);
-        }
+        SharedMapCacheDriver::Destroy(keys);
       }else{
-        std::lock_guard<std::mutex> lg(mtx_);
-        data_->erase(key);
+        destroys_->Increment();
+        Shard& s = shard(key);
+        std::lock_guard<std::mutex> lg(s.mtx);
+        if (s.data->find(key) != s.data->end()){
+          writable(s).erase(key);
+        }
+      }
+    }
+
+
+    void SharedMapCacheDriver::Destroy(const std::vector<std::string>& keys){
+      destroys_->Increment(keys.size());
+      for (auto it = keys.begin(); it != keys.end(); ++it){
+        Shard& s = shard(*it);
+        std::lock_guard<std::mutex> lg(s.mtx);
+        if (s.data->find(*it) != s.data->end()){
+          writable(s).erase(*it);
+        }
       }
     }
 
 
     void SharedMapCacheDriver::Destroy(const std::string& hash,const std::string& key){
-      std::lock_guard<std::mutex> lg(mtx_);
-      auto it = data_->find(hash);
-      if (it != data_->end()){
-        std::map<std::string,std::string> properties = it->second;
-        properties.erase(key);
-        (*data_)[hash] = properties;
+      destroys_->Increment();
+      Shard& s = shard(hash);
+      std::lock_guard<std::mutex> lg(s.mtx);
+      auto it = s.data->find(hash);
+      if (it != s.data->end() && it->second.find(key) != it->second.end()){
+        writable(s)[hash].erase(key);
       }
     }
 
 
     bool SharedMapCacheDriver::Rename(const std::string& old_key, const std::string& new_key){
-      std::lock_guard<std::mutex> lg(mtx_);
-      auto it = data_->find(old_key);
-      if (it != data_->end()) {
-        // insert new key and value
-        std::map<std::string,std::string> properties;
-        (*data_)[new_key] = properties;
-
-        // swap
-        std::swap((*data_)[new_key], it->second);
+      writes_->Increment();
+      Shard& old_shard = shard(old_key);
+      Shard& new_shard = shard(new_key);
+
+      // lock both shards, or only one if the keys are in the same shard.
+      std::unique_lock<std::mutex> old_lock(old_shard.mtx, std::defer_lock);
+      std::unique_lock<std::mutex> new_lock(new_shard.mtx, std::defer_lock);
+      if (&old_shard == &new_shard){
+        old_lock.lock();
+      }else{
+        std::lock(old_lock, new_lock);
+      }
 
-        // erase old entry
-        data_->erase(it);
+      if (old_shard.data->find(old_key) != old_shard.data->end()) {
+        Data& old_data = writable(old_shard);
+        Data& new_data = writable(new_shard);
+        auto it = old_data.find(old_key);
+        std::map<std::string,std::string> properties;
+        std::swap(properties, it->second);
+        old_data.erase(it);
+        new_data[new_key] = std::move(properties);
         return true;
       }
       return false;
@@ -193,14 +397,184 @@ namespace granada{
 
 
     void SharedMapCacheDriver::Keys(const std::string& expression, std::vector<std::string>& keys){
+      Start();
       keys.clear();
-      std::lock_guard<std::mutex> lg(mtx_);
-      for(auto it = data_->begin(); it != data_->end(); ++it) {
-        const std::string& key = it->first;
-        if (std::regex_match(key, std::regex(expression))){
-          keys.push_back(it->first);
+      const std::regex regex(expression);
+      for (auto it = shards_.begin(); it != shards_.end(); ++it){
+        Shard& s = **it;
+        std::lock_guard<std::mutex> lg(s.mtx);
+        for(auto it2 = s.data->begin(); it2 != s.data->end(); ++it2) {
+          if (std::regex_match(it2->first, regex)){
+            keys.push_back(it2->first);
+          }
+        }
+      }
+    }
+
+
+    bool SharedMapCacheDriver::SaveSnapshot(const std::string& file_path){
+      std::lock_guard<std::mutex> lg(snapshot_mtx_);
+
+      // references to the current data of the shards,
+      // the driver keeps working with copies while they are saved.
+      std::vector<std::shared_ptr<const Data>> data;
+      Freeze(data);
+
+      const std::string tmp_file_path(file_path + ".tmp");
+      std::FILE* file = std::fopen(tmp_file_path.c_str(), "wb");
+      if (file == nullptr){
+        std::cout << "Can t save cache snapshot: " << file_path << std::endl;
+        return false;
+      }
+
+      std::string header(snapshot_magic, snapshot_magic_size);
+      granada::util::binary::put_uint32(header, (uint32_t)data.size());
+      std::fwrite(header.data(), 1, header.size(), file);
+
+      // one section per shard: length, checksum and content.
+      std::string section;
+      std::string section_header;
+      for (auto it = data.begin(); it != data.end(); ++it){
+        const Data& shard_data = **it;
+        section.clear();
+        granada::util::binary::put_uint32(section, (uint32_t)shard_data.size());
+        for (auto it2 = shard_data.begin(); it2 != shard_data.end(); ++it2){
+          granada::util::binary::put_string(section, it2->first);
+          granada::util::binary::put_uint32(section, (uint32_t)it2->second.size());
+          for (auto it3 = it2->second.begin(); it3 != it2->second.end(); ++it3){
+            granada::util::binary::put_string(section, it3->first);
+            granada::util::binary::put_string(section, it3->second);
+          }
+        }
+        section_header.clear();
+        granada::util::binary::put_uint64(section_header, section.size());
+        granada::util::binary::put_uint32(section_header, granada::util::binary::crc32(section.data(), section.size()));
+        std::fwrite(section_header.data(), 1, section_header.size(), file);
+        std::fwrite(section.data(), 1, section.size(), file);
+      }
+      data.clear();
+
+      const bool written = !std::ferror(file);
+      granada::util::binary::sync(file);
+      std::fclose(file);
+      if (!written){
+        std::remove(tmp_file_path.c_str());
+        std::cout << "Can t save cache snapshot: " << file_path << std::endl;
+        return false;
+      }
+#ifdef _WIN32
+      std::remove(file_path.c_str());
+#endif
+      return std::rename(tmp_file_path.c_str(), file_path.c_str()) == 0;
+    }
+
+
+    bool SharedMapCacheDriver::LoadSnapshot(const std::string& file_path){
+      std::string content;
+      if (!granada::util::binary::read_file(file_path, content)){
+        return false;
+      }
+      const char* bytes = content.data();
+      const std::size_t size = content.size();
+      if (size < snapshot_magic_size + 4 || content.compare(0, snapshot_magic_size, snapshot_magic) != 0){
+        std::cout << "Cache snapshot " << file_path << " is not valid." << std::endl;
+        return false;
+      }
+
+      // find the sections.
+      struct Section{
+        std::size_t offset;
+        std::size_t length;
+        uint32_t checksum;
+      };
+      std::size_t position = snapshot_magic_size;
+      const uint32_t section_count = granada::util::binary::get_uint32(bytes + position);
+      position += 4;
+      std::vector<Section> sections;
+      sections.reserve(section_count);
+      for (uint32_t i = 0; i < section_count; i++){
+        if (position + 12 > size){
+          std::cout << "Cache snapshot " << file_path << " is truncated." << std::endl;
+          return false;
+        }
+        Section section;
+        section.length = (std::size_t)granada::util::binary::get_uint64(bytes + position);
+        section.checksum = granada::util::binary::get_uint32(bytes + position + 8);
+        section.offset = position + 12;
+        if (section.length > size - section.offset){
+          std::cout << "Cache snapshot " << file_path << " is truncated." << std::endl;
+          return false;
+        }
+        position = section.offset + section.length;
+        sections.push_back(section);
+      }
+
+      // decode the sections in parallel.
+      std::vector<Data> decoded(sections.size());
+      std::vector<char> valid(sections.size(), 0);
+      const std::size_t threads = std::max<std::size_t>(1, std::min<std::size_t>(sections.size(), std::thread::hardware_concurrency()));
+      std::vector<std::thread> decoders;
+      for (std::size_t t = 0; t < threads; t++){
+        decoders.push_back(std::thread([&,t](){
+          for (std::size_t i = t; i < sections.size(); i += threads){
+            const Section& section = sections[i];
+            const char* data = bytes + section.offset;
+            if (granada::util::binary::crc32(data, section.length) != section.checksum || section.length < 4){
+              continue;
+            }
+            Data& shard_data = decoded[i];
+            std::size_t offset = 4;
+            const uint32_t entries = granada::util::binary::get_uint32(data);
+            bool ok = true;
+            std::string key, field, value;
+            for (uint32_t e = 0; e < entries && ok; e++){
+              ok = granada::util::binary::get_string(data, section.length, offset, key) && offset + 4 <= section.length;
+              if (ok){
+                const uint32_t fields = granada::util::binary::get_uint32(data + offset);
+                offset += 4;
+                std::map<std::string,std::string>& properties = shard_data[key];
+                for (uint32_t f = 0; f < fields && ok; f++){
+                  ok = granada::util::binary::get_string(data, section.length, offset, field) &&
+                       granada::util::binary::get_string(data, section.length, offset, value);
+                  if (ok){
+                    properties[field] = value;
+                  }
+                }
+              }
+            }
+            valid[i] = ok && offset == section.length;
+          }
+        }));
+      }
+      for (auto it = decoders.begin(); it != decoders.end(); ++it){
+        it->join();
+      }
+      for (auto it = valid.begin(); it != valid.end(); ++it){
+        if (!*it){
+          std::cout << "Cache snapshot " << file_path << " is corrupted." << std::endl;
+          return false;
+        }
+      }
+
+      // insert the data, if the snapshot was saved with the same number
+      // of shards each section is the data of the same shard.
+      for (std::size_t i = 0; i < decoded.size(); i++){
+        if (decoded.size() == shards_.size()){
+          Shard& s = *shards_[i];
+          std::lock_guard<std::mutex> lg(s.mtx);
+          if (s.data->empty()){
+            s.data = std::make_shared<Data>(std::move(decoded[i]));
+            s.frozen = false;
+            continue;
+          }
+        }
+        for (auto it = decoded[i].begin(); it != decoded[i].end(); ++it){
+          Shard& s = *shards_[granada::cache::HashRing::Hash(it->first) % shards_.size()];
+          std::lock_guard<std::mutex> lg(s.mtx);
+          writable(s)[it->first] = std::move(it->second);
         }
       }
+      return true;
     }
 
   }
@@ -0,0 +1,423 @@
+/**
+  * Copyright (c) <2016> granada <afernandez@cookinapps.io>
+  *
+  * This source code is licensed under the MIT license.
+  *
+  * Permission is hereby granted, free of charge, to any person obtaining a copy
+  * of this software and associated documentation files (the "Software"), to deal
+  * in the Software without restriction, including without limitation the rights
+  * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  * copies of the Software, and to permit persons to whom the Software is
+  * furnished to do so, subject to the following conditions:
+  *
+  * The above copyright notice and this permission notice shall be included in
+  * all copies or substantial portions of the Software.
+  *
+  * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  * SOFTWARE.
+  *
+  *
+  * Cache handler keeping the most read keys of another cache handler
+  * in process.
+  */
+
+#include "granada/cache/tiered_cache_handler.h"
+#include "granada/util/metrics.h"
+
+namespace granada{
+  namespace cache{
+
+    namespace{
+
+      /**
+       * Returns the part of an expression before the first "*".
+       */
+      std::string expression_prefix(const std::string& expression){
+        return expression.substr(0, expression.find('*'));
+      }
+
+
+      /**
+       * Number of lookups in the near cache by result: hit or miss.
+       */
+      granada::util::metrics::Counter& lookups(const bool hit){
+        static granada::util::metrics::Counter& hits = granada::util::metrics::GetCounter("granada_cache_tiered_lookups_total", "Number of lookups in the near caches.", "result=\"hit\"");
+        static granada::util::metrics::Counter& misses = granada::util::metrics::GetCounter("granada_cache_tiered_lookups_total", "Number of lookups in the near caches.", "result=\"miss\"");
+        return hit ? hits : misses;
+      }
+
+
+      /**
+       * Number of entries removed from the near cache to make room for others.
+       */
+      granada::util::metrics::Counter& evictions(){
+        static granada::util::metrics::Counter& counter = granada::util::metrics::GetCounter("granada_cache_tiered_evictions_total", "Number of entries evicted from the near caches.");
+        return counter;
+      }
+
+    }
+
+
+    granada::util::mutex::call_once TieredCacheHandler::load_properties_call_once_;
+    std::vector<std::string> TieredCacheHandler::default_prefixes_;
+    std::size_t TieredCacheHandler::default_max_size_;
+
+
+    TieredCacheHandler::TieredCacheHandler(CacheHandler* cache, CacheInvalidator* invalidator){
+      cache_.reset(cache);
+      invalidator_.reset(invalidator);
+    }
+
+
+    TieredCacheHandler::TieredCacheHandler(CacheHandler* cache, CacheInvalidator* invalidator, const std::vector<std::string>& namespaces, const std::size_t max_size){
+      cache_.reset(cache);
+      invalidator_.reset(invalidator);
+      for (auto it = namespaces.begin(); it != namespaces.end(); ++it){
+        prefixes_.push_back(expression_prefix(*it));
+      }
+      max_size_ = max_size;
+      configured_ = true;
+    }
+
+
+    void TieredCacheHandler::LoadProperties(){
+      std::string namespaces_str = granada::util::application::GetProperty(entity_keys::tiered_cache_handler_namespaces);
+      if (namespaces_str.empty()){
+        namespaces_str.assign(default_strings::tiered_cache_handler_namespaces);
+      }
+      std::vector<std::string> namespaces;
+      granada::util::string::split(namespaces_str,',',namespaces);
+      default_prefixes_.clear();
+      for (auto it = namespaces.begin(); it != namespaces.end(); ++it){
+        std::string expression = *it;
+        granada::util::string::trim(expression);
+        if (!expression.empty()){
+          default_prefixes_.push_back(expression_prefix(expression));
+        }
+      }
+
+      const std::string& max_size_str = granada::util::application::GetProperty(entity_keys::tiered_cache_handler_max_size);
+      if (max_size_str.empty()){
+        default_max_size_ = default_numbers::tiered_cache_handler_max_size;
+      }else{
+        try{
+          const int max_size = std::stoi(max_size_str);
+          default_max_size_ = max_size < 0 ? 0 : (std::size_t)max_size;
+        }catch(const std::logic_error e){
+          default_max_size_ = default_numbers::tiered_cache_handler_max_size;
+        }
+      }
+    }
+
+
+    void TieredCacheHandler::Start(){
+      std::call_once(start_once_, [this](){
+        if (!configured_){
+          // load properties only once, and wait all the
+          // threads until they are loaded.
+          load_properties_call_once_.call([](){
+            TieredCacheHandler::LoadProperties();
+          });
+          prefixes_ = default_prefixes_;
+          max_size_ = default_max_size_;
+        }
+
+        if (prefixes_.empty() || max_size_ < 1){
+          return;
+        }
+
+        if (invalidator_ == nullptr){
+          enabled_ = true;
+        }else{
+          enabled_ = invalidator_->Subscribe(prefixes_,
+            [this](const std::string& key){
+              Invalidate(key);
+            },
+            [this](){
+              enabled_ = false;
+              Invalidate(std::string());
+            });
+        }
+      });
+    }
+
+
+    bool TieredCacheHandler::Cached(const std::string& key){
+      Start();
+      if (enabled_){
+        for (auto it = prefixes_.begin(); it != prefixes_.end(); ++it){
+          if (key.compare(0, it->size(), *it) == 0){
+            return true;
+          }
+        }
+      }
+      return false;
+    }
+
+
+    TieredCacheHandler::Entry* TieredCacheHandler::Find(const std::string& key, const bool hash){
+      auto it = entries_.find(key);
+      if (it != entries_.end() && it->second.hash == hash){
+        lookups(true).Increment();
+        lru_.splice(lru_.begin(), lru_, it->second.lru);
+        return &it->second;
+      }
+      lookups(false).Increment();
+      return nullptr;
+    }
+
+
+    TieredCacheHandler::Entry& TieredCacheHandler::Insert(const std::string& key){
+      auto it = entries_.find(key);
+      if (it != entries_.end()){
+        lru_.splice(lru_.begin(), lru_, it->second.lru);
+        return it->second;
+      }
+      while (entries_.size() >= max_size_ && !lru_.empty()){
+        entries_.erase(lru_.back());
+        lru_.pop_back();
+        evictions().Increment();
+      }
+      lru_.push_front(key);
+      Entry& entry = entries_[key];
+      entry.lru = lru_.begin();
+      return entry;
+    }
+
+
+    void TieredCacheHandler::Load(const std::string& hash, std::map<std::string,std::string>& values){
+      uint64_t invalidations;
+      {
+        std::lock_guard<std::mutex> lg(mtx_);
+        invalidations = invalidations_;
+      }
+      cache_->ReadAll(hash, values);
+      std::lock_guard<std::mutex> lg(mtx_);
+      if (invalidations == invalidations_ && enabled_){
+        Entry& entry = Insert(hash);
+        entry.hash = true;
+        entry.value.clear();
+        entry.values = values;
+      }
+    }
+
+
+    void TieredCacheHandler::Invalidate(const std::string& key){
+      std::lock_guard<std::mutex> lg(mtx_);
+      invalidations_++;
+      if (key.empty()){
+        entries_.clear();
+        lru_.clear();
+        return;
+      }
+      const std::size_t found = key.find('*');
+      if (found == std::string::npos){
+        auto it = entries_.find(key);
+        if (it != entries_.end()){
+          lru_.erase(it->second.lru);
+          entries_.erase(it);
+        }
+      }else{
+        const std::string prefix(key, 0, found);
+        for (auto it = entries_.begin(); it != entries_.end();){
+          if (it->first.compare(0, prefix.size(), prefix) == 0){
+            lru_.erase(it->second.lru);
+            it = entries_.erase(it);
+          }else{
+            ++it;
+          }
+        }
+      }
+    }
+
+
+    void TieredCacheHandler::Modified(const std::string& key){
+      Invalidate(key);
+      if (invalidator_ != nullptr){
+        invalidator_->Publish(key);
+      }
+    }
+
+
+    const bool TieredCacheHandler::Exists(const std::string& key){
+      if (Cached(key)){
+        std::lock_guard<std::mutex> lg(mtx_);
+        auto it = entries_.find(key);
+        if (it != entries_.end()){
+          if (it->second.hash){
+            return !it->second.values.empty();
+          }
+          if (!it->second.value.empty()){
+            return true;
+          }
+        }
+      }
+      return cache_->Exists(key);
+    }
+
+
+    const bool TieredCacheHandler::Exists(const std::string& hash,const std::string& key){
+      if (Cached(hash)){
+        {
+          std::lock_guard<std::mutex> lg(mtx_);
+          Entry* entry = Find(hash, true);
+          if (entry != nullptr){
+            return entry->values.find(key) != entry->values.end();
+          }
+        }
+        std::map<std::string,std::string> values;
+        Load(hash, values);
+        return values.find(key) != values.end();
+      }
+      return cache_->Exists(hash,key);
+    }
+
+
+    const std::string TieredCacheHandler::Read(const std::string& key){
+      if (Cached(key)){
+        uint64_t invalidations;
+        {
+          std::lock_guard<std::mutex> lg(mtx_);
+          Entry* entry = Find(key, false);
+          if (entry != nullptr){
+            return entry->value;
+          }
+          invalidations = invalidations_;
+        }
+        const std::string value = cache_->Read(key);
+        std::lock_guard<std::mutex> lg(mtx_);
+        if (invalidations == invalidations_ && enabled_){
+          Entry& entry = Insert(key);
+          entry.hash = false;
+          entry.value = value;
+          entry.values.clear();
+        }
+        return value;
+      }
+      return cache_->Read(key);
+    }
+
+
+    const std::string TieredCacheHandler::Read(const std::string& hash,const std::string& key){
+      if (Cached(hash)){
+        {
+          std::lock_guard<std::mutex> lg(mtx_);
+          Entry* entry = Find(hash, true);
+          if (entry != nullptr){
+            auto it = entry->values.find(key);
+            return it != entry->values.end() ? it->second : std::string();
+          }
+        }
+        std::map<std::string,std::string> values;
+        Load(hash, values);
+        auto it = values.find(key);
+        return it != values.end() ? it->second : std::string();
+      }
+      return cache_->Read(hash,key);
+    }
+
+
+    void TieredCacheHandler::Fields(const std::string& hash, std::vector<std::string>& fields){
+      if (Cached(hash)){
+        std::map<std::string,std::string> values;
+        ReadAll(hash, values);
+        fields.clear();
+        fields.reserve(values.size());
+        for (auto it = values.begin(); it != values.end(); ++it){
+          fields.push_back(it->first);
+        }
+      }else{
+        cache_->Fields(hash,fields);
+      }
+    }
+
+
+    void TieredCacheHandler::ReadAll(const std::string& hash, std::map<std::string,std::string>& values){
+      if (Cached(hash)){
+        {
+          std::lock_guard<std::mutex> lg(mtx_);
+          Entry* entry = Find(hash, true);
+          if (entry != nullptr){
+            values = entry->values;
+            return;
+          }
+        }
+        Load(hash, values);
+      }else{
+        cache_->ReadAll(hash,values);
+      }
+    }
+
+
+    void TieredCacheHandler::Write(const std::string& key,const std::string& value){
+      cache_->Write(key,value);
+      if (Cached(key)){
+        Modified(key);
+      }
+    }
+
+
+    void TieredCacheHandler::Write(const std::string& hash,const std::string& key,const std::string& value){
+      cache_->Write(hash,key,value);
+      if (Cached(hash)){
+        Modified(hash);
+      }
+    }
+
+
+    void TieredCacheHandler::Destroy(const std::string& key){
+      cache_->Destroy(key);
+      if (key.find('*') != std::string::npos ? enabled() : Cached(key)){
+        Modified(key);
+      }
+    }
+
+
+    void TieredCacheHandler::Destroy(const std::vector<std::string>& keys){
+      cache_->Destroy(keys);
+      for (auto it = keys.begin(); it != keys.end(); ++it){
+        if (Cached(*it)){
+          Modified(*it);
+        }
+      }
+    }
+
+
+    void TieredCacheHandler::Destroy(const std::string& hash,const std::string& key){
+      cache_->Destroy(hash,key);
+      if (Cached(hash)){
+        Modified(hash);
+      }
+    }
+
+
+    bool TieredCacheHandler::Rename(const std::string& old_key, const std::string& new_key){
+      const bool renamed = cache_->Rename(old_key,new_key);
+      if (renamed){
+        if (Cached(old_key)){
+          Modified(old_key);
+        }
+        if (Cached(new_key)){
+          Modified(new_key);
+        }
+      }
+      return renamed;
+    }
+
+
+    const void TieredCacheHandler::Match(const std::string& expression, std::vector<std::string>& keys){
+      cache_->Match(expression,keys);
+    }
+
+
+    std::unique_ptr<granada::cache::CacheHandlerIterator> TieredCacheHandler::make_iterator(const std::string& expression){
+      return cache_->make_iterator(expression);
+    }
+
+  }
+}
@@ -26,6 +26,8 @@
   */
 
 #include "granada/cache/web_resource_cache.h"
+#include "granada/util/configuration.h"
+#include "granada/util/metrics.h"
 
 namespace granada{
 
@@ -36,11 +38,18 @@ namespace granada{
     }
 
     granada::cache::Resource WebResourceCache::GetFile(std::string& file_path){
+      static granada::util::metrics::Counter& memory = granada::util::metrics::GetCounter("granada_web_resource_requests_total", "Number of web resources requested by where they were found.", "source=\"memory\"");
+      static granada::util::metrics::Counter& disk = granada::util::metrics::GetCounter("granada_web_resource_requests_total", "Number of web resources requested by where they were found.", "source=\"disk\"");
+      static granada::util::metrics::Counter& not_found = granada::util::metrics::GetCounter("granada_web_resource_requests_total", "Number of web resources requested by where they were found.", "source=\"none\"");
+      static granada::util::metrics::Histogram& read_latency = granada::util::metrics::GetHistogram("granada_web_resource_read_seconds", "Time spent reading the web resources from the disk.");
+
       if ( !files_.empty() ){
         auto it = files_.find(file_path);
         if (it == files_.end()){
+          not_found.Increment();
           return granada::cache::Resource();
         }
+        memory.Increment();
         granada::cache::Resource resource = it->second;
         return resource;
       }
@@ -111,6 +120,9 @@ namespace granada{
           }catch(const web::json::json_exception e){}
         }
       }else{
+        disk.Increment();
+        granada::util::metrics::Timer timer(read_latency);
+
         // read the file and assign content to content string variable
         boost::filesystem::path path(file_path);
         std::ifstream ifs(path.string());
@@ -132,6 +144,7 @@ namespace granada{
         return resource;
       }
 
+      not_found.Increment();
       return granada::cache::Resource();
     }
 
@@ -159,26 +172,17 @@ namespace granada{
       // gzip content encoding
       // get property that will tell if gzip content or not (on:gzip;off:do not zip).
       // if gzip true then create a Gziped copy of the files.
-      std::string gzip_content_str = granada::util::application::GetProperty("gzip_content");
-      if(!gzip_content_str.empty() && gzip_content_str=="on"){
+      if(granada::util::configuration::Bool(granada::util::configuration::gzip_content)){
         gzip_content_ = true;
         GzipCopy();
       }
 
       // get percentage of the files we want to cache (0:none;100:all).
-      std::string cache_content = granada::util::application::GetProperty("cache_content");
-      if (!cache_content.empty() && cache_content == "on"){
+      if (granada::util::configuration::Bool(granada::util::configuration::cache_content)){
         // get the maximum cache memory property that is
-        // the maximum amount of MB that we will load in the cache.
-        std::string maximum_cache_memory_str = granada::util::application::GetProperty("maximum_cache_memory");
-        int maximum_cache_memory = 0;
-        if (!maximum_cache_memory_str.empty()){
-          try{
-            maximum_cache_memory = std::stoi(maximum_cache_memory_str);
-            // convert to bytes
-            maximum_cache_memory = maximum_cache_memory * 1024 * 1024;
-          }catch(const std::exception e){}
-        }
+        // the maximum amount of MB that we will load in the cache,
+        // converted to bytes.
+        int maximum_cache_memory = granada::util::configuration::Int(granada::util::configuration::maximum_cache_memory) * 1024 * 1024;
 
         // load all files in memory.
         RecursiveLoad("/",maximum_cache_memory);
@@ -190,11 +194,10 @@ namespace granada{
       ////
       // content types
       // get the pairs of content types and file extensions. Example image/png <=> png .
-      std::string content_types_str = granada::util::application::GetProperty("content_types");
-      if (!content_types_str.empty()){
+      const web::json::value obj = granada::util::configuration::Json(granada::util::configuration::content_types);
+      if (obj.is_object()){
         try{
-          // parse the json with the content types and files extensions into the unordered_map content_types_ .
-		  web::json::value obj = web::json::value::parse(utility::conversions::to_string_t(content_types_str));
+          // load the json with the content types and files extensions into the unordered_map content_types_ .
           std::string content_type;
           std::string extension;
           // loop through the keys of the json. The keys are the content types.
@@ -217,44 +220,32 @@ namespace granada{
       // default files
       // get the default files to get content from if the client request
       // only includes the directory path.
-      std::string default_files_str = granada::util::application::GetProperty("default_files");
-      if (!default_files_str.empty()){
-        try{
-          default_files_ = web::json::value::parse(utility::conversions::to_string_t(default_files_str));
-        }catch(const web::json::json_exception e){
-          default_files_ = web::json::value::array();
-        }
+      default_files_ = granada::util::configuration::Json(granada::util::configuration::default_files);
+      if (!default_files_.is_array()){
+        default_files_ = web::json::value::array();
       }
 
       ////
       // error files
       // get the path of the files to get content from when there is an error.
-      std::string error_paths_str = granada::util::application::GetProperty("error_paths");
-      if (!error_paths_str.empty()){
-        try{
-          error_paths_ = web::json::value::parse(utility::conversions::to_string_t(error_paths_str));
-        }catch(const web::json::json_exception e){
-          error_paths_ = web::json::value::object(false);
-        }
+      error_paths_ = granada::util::configuration::Json(granada::util::configuration::error_paths);
+      if (!error_paths_.is_object()){
+        error_paths_ = web::json::value::object(false);
       }
 
       ////
       // gzip extensions
       // get the extensions of the files to gzip from gzip_extensions property
       // in the server configuration file.
-      std::string gzip_extensions_str = granada::util::application::GetProperty("gzip_extensions");
-      if (!gzip_extensions_str.empty()){
-        try{
-		  gzip_extensions_ = web::json::value::parse(utility::conversions::to_string_t(gzip_extensions_str));
-        }catch(const web::json::json_exception e){
-          gzip_extensions_ = web::json::value::array();
-        }
+      gzip_extensions_ = granada::util::configuration::Json(granada::util::configuration::gzip_extensions);
+      if (!gzip_extensions_.is_array()){
+        gzip_extensions_ = web::json::value::array();
       }
 
       ////
       // root path
       // get relative path where the files of the web are stored.
-      std::string root_path_property = granada::util::application::GetProperty("root_path");
+      std::string root_path_property = granada::util::configuration::String(granada::util::configuration::root_path);
       if (root_path_property.empty()){
         root_path_property = "www";
       }
@@ -433,7 +424,7 @@ namespace granada{
       if (it != content_types_.end()){
         return it->second;
       }else{
-        return granada::util::application::GetProperty("default_content_type");
+        return granada::util::configuration::String(granada::util::configuration::default_content_type);
       }
     }
 
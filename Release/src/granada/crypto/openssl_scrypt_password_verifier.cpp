@@ -0,0 +1,259 @@
+/**
+  * Copyright (c) <2016> granada <afernandez@cookinapps.io>
+  *
+  * This source code is licensed under the MIT license.
+  *
+  * Permission is hereby granted, free of charge, to any person obtaining a copy
+  * of this software and associated documentation files (the "Software"), to deal
+  * in the Software without restriction, including without limitation the rights
+  * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  * copies of the Software, and to permit persons to whom the Software is
+  * furnished to do so, subject to the following conditions:
+  *
+  * The above copyright notice and this permission notice shall be included in
+  * all copies or substantial portions of the Software.
+  *
+  * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  * SOFTWARE.
+  *
+  * Hashes and verifies passwords with scrypt, or PBKDF2 when scrypt is not
+  * available, in a bounded pool of threads.
+  *
+  */
+
+#include "granada/crypto/openssl_scrypt_password_verifier.h"
+#include <future>
+#include <vector>
+#include <cstring>
+#include <unordered_map>
+#include <openssl/evp.h>
+#include <openssl/rand.h>
+#include <openssl/crypto.h>
+#include <openssl/sha.h>
+#include "granada/crypto/base64.h"
+
+#define SCRYPT_ALGORITHM "scrypt"
+#define PBKDF2_ALGORITHM "pbkdf2-sha256"
+#define SALT_LENGTH 16
+#define KEY_LENGTH 32
+
+namespace granada{
+  namespace crypto{
+
+    granada::util::mutex::call_once OpensslScryptPasswordVerifier::load_properties_call_once_;
+    int OpensslScryptPasswordVerifier::scrypt_ln_;
+    int OpensslScryptPasswordVerifier::scrypt_r_;
+    int OpensslScryptPasswordVerifier::scrypt_p_;
+    int OpensslScryptPasswordVerifier::pbkdf2_iterations_;
+    std::unique_ptr<granada::util::thread::BoundedThreadPool> OpensslScryptPasswordVerifier::pool_;
+    granada::cache::LocalRecordCache<bool> OpensslScryptPasswordVerifier::verifications_;
+
+
+    /**
+     * Reads a number property, if it is not found or it is not
+     * a number the default value is returned.
+     */
+    static long NumberProperty(const std::string& name, const long default_value){
+      const std::string& value_str = granada::util::application::GetProperty(name);
+      if (!value_str.empty()){
+        try{
+          return std::stol(value_str);
+        }catch(const std::logic_error e){}
+      }
+      return default_value;
+    }
+
+
+    std::string OpensslScryptPasswordVerifier::Hash(const std::string& password){
+      load_properties_call_once_.call([this](){
+        this->LoadProperties();
+      });
+
+      unsigned char salt_bytes[SALT_LENGTH];
+      if (RAND_bytes(salt_bytes, SALT_LENGTH) != 1){
+        return std::string();
+      }
+      const std::string salt((const char*)salt_bytes, SALT_LENGTH);
+
+      std::string algorithm;
+      std::string parameters;
+#if OPENSSL_VERSION_NUMBER >= 0x10100000L
+      algorithm.assign(SCRYPT_ALGORITHM);
+      parameters.assign("ln=" + std::to_string(scrypt_ln_) + ",r=" + std::to_string(scrypt_r_) + ",p=" + std::to_string(scrypt_p_));
+#else
+      algorithm.assign(PBKDF2_ALGORITHM);
+      parameters.assign("i=" + std::to_string(pbkdf2_iterations_));
+#endif
+
+      std::string key;
+      if (!RunInPool([&]{ return Derive(password, algorithm, parameters, salt, key); })){
+        return std::string();
+      }
+      return "$" + algorithm + "$" + parameters + "$" + base64::encode(salt, false) + "$" + base64::encode(key, false);
+    }
+
+
+    bool OpensslScryptPasswordVerifier::Verify(const std::string& password, const std::string& hash){
+      load_properties_call_once_.call([this](){
+        this->LoadProperties();
+      });
+
+      // $<algorithm>$<parameters>$<salt>$<key>
+      std::vector<std::string> parts;
+      std::size_t start = 1;
+      if (hash.empty() || hash[0] != '$'){
+        return false;
+      }
+      for (;;){
+        const std::size_t end = hash.find('$', start);
+        parts.push_back(hash.substr(start, end == std::string::npos ? std::string::npos : end - start));
+        if (end == std::string::npos){
+          break;
+        }
+        start = end + 1;
+      }
+      if (parts.size() != 4){
+        return false;
+      }
+
+      std::string salt;
+      std::string expected_key;
+      if (!base64::decode(parts[2], salt, false) || !base64::decode(parts[3], expected_key, false) || expected_key.empty()){
+        return false;
+      }
+
+      // digest of hash and password, identifies the verification
+      // without keeping the password in memory.
+      std::string verification_id(SHA256_DIGEST_LENGTH, '\0');
+      std::string verification(hash);
+      verification.push_back('\0');
+      verification.append(password);
+      SHA256((const unsigned char*)verification.data(), verification.size(), (unsigned char*)&verification_id[0]);
+      OPENSSL_cleanse(&verification[0], verification.size());
+
+      bool verified = false;
+      if (verifications_.Read(verification_id, verified)){
+        return verified;
+      }
+
+      std::string key;
+      if (!RunInPool([&]{ return Derive(password, parts[0], parts[1], salt, key); })){
+        return false;
+      }
+      verified = key.size() == expected_key.size() &&
+                 CRYPTO_memcmp(key.data(), expected_key.data(), key.size()) == 0;
+      if (verified){
+        verifications_.Write(verification_id, true);
+      }
+      return verified;
+    }
+
+
+    bool OpensslScryptPasswordVerifier::IsHash(const std::string& hash){
+      return hash.compare(0, std::strlen(SCRYPT_ALGORITHM) + 2, "$" SCRYPT_ALGORITHM "$") == 0 ||
+             hash.compare(0, std::strlen(PBKDF2_ALGORITHM) + 2, "$" PBKDF2_ALGORITHM "$") == 0;
+    }
+
+
+    void OpensslScryptPasswordVerifier::LoadProperties(){
+      scrypt_ln_ = (int)NumberProperty(entity_keys::password_verifier_scrypt_ln, default_numbers::password_verifier_scrypt_ln);
+      scrypt_r_ = (int)NumberProperty(entity_keys::password_verifier_scrypt_r, default_numbers::password_verifier_scrypt_r);
+      scrypt_p_ = (int)NumberProperty(entity_keys::password_verifier_scrypt_p, default_numbers::password_verifier_scrypt_p);
+      pbkdf2_iterations_ = (int)NumberProperty(entity_keys::password_verifier_pbkdf2_iterations, default_numbers::password_verifier_pbkdf2_iterations);
+
+      long threads = NumberProperty(entity_keys::password_verifier_threads, default_numbers::password_verifier_threads);
+      long queue = NumberProperty(entity_keys::password_verifier_queue, default_numbers::password_verifier_queue);
+      if (threads < 1){
+        threads = default_numbers::password_verifier_threads;
+      }
+      if (queue < 1){
+        queue = default_numbers::password_verifier_queue;
+      }
+      pool_.reset(new granada::util::thread::BoundedThreadPool((std::size_t)threads, (std::size_t)queue));
+
+      verifications_.set_ttl(NumberProperty(entity_keys::password_verifier_cache_ttl, default_numbers::password_verifier_cache_ttl));
+    }
+
+
+    bool OpensslScryptPasswordVerifier::Derive(const std::string& password,
+                                               const std::string& algorithm,
+                                               const std::string& parameters,
+                                               const std::string& salt,
+                                               std::string& key){
+      // parameters: name=value,name=value
+      std::unordered_map<std::string,long> values;
+      std::size_t start = 0;
+      while (start < parameters.size()){
+        std::size_t end = parameters.find(',', start);
+        if (end == std::string::npos){
+          end = parameters.size();
+        }
+        const std::size_t equal = parameters.find('=', start);
+        if (equal == std::string::npos || equal > end){
+          return false;
+        }
+        try{
+          values[parameters.substr(start, equal - start)] = std::stol(parameters.substr(equal + 1, end - equal - 1));
+        }catch(const std::logic_error e){
+          return false;
+        }
+        start = end + 1;
+      }
+
+      key.assign(KEY_LENGTH, '\0');
+      if (algorithm == SCRYPT_ALGORITHM){
+#if OPENSSL_VERSION_NUMBER >= 0x10100000L
+        const long ln = values["ln"];
+        const long r = values["r"];
+        const long p = values["p"];
+        if (ln < 1 || ln > 24 || r < 1 || r > 64 || p < 1 || p > 64){
+          return false;
+        }
+        const uint64_t n = (uint64_t)1 << ln;
+        // openssl limits the memory to 32 MiB by default, allow what the
+        // parameters need: 128 * r * (N + p + 2) bytes plus some margin.
+        const uint64_t maxmem = 128 * (uint64_t)r * (n + p + 2) + 1024 * 1024;
+        return EVP_PBE_scrypt(password.data(), password.size(),
+                              (const unsigned char*)salt.data(), salt.size(),
+                              n, (uint64_t)r, (uint64_t)p, maxmem,
+                              (unsigned char*)&key[0], key.size()) == 1;
+#else
+        return false;
+#endif
+      }else if (algorithm == PBKDF2_ALGORITHM){
+        const long iterations = values["i"];
+        if (iterations < 1){
+          return false;
+        }
+        return PKCS5_PBKDF2_HMAC(password.data(), (int)password.size(),
+                                 (const unsigned char*)salt.data(), (int)salt.size(),
+                                 (int)iterations, EVP_sha256(),
+                                 (int)key.size(), (unsigned char*)&key[0]) == 1;
+      }
+      return false;
+    }
+
+
+    bool OpensslScryptPasswordVerifier::RunInPool(std::function<bool()> fn){
+      std::shared_ptr<std::promise<bool>> promise = std::make_shared<std::promise<bool>>();
+      std::future<bool> future = promise->get_future();
+      const bool queued = pool_->Submit([fn, promise]{
+        bool result = false;
+        try{
+          result = fn();
+        }catch(...){}
+        promise->set_value(result);
+      });
+      if (!queued){
+        return false;
+      }
+      return future.get();
+    }
+
+  }
+}
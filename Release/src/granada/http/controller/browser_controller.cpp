@@ -24,6 +24,8 @@
   */
 
 #include "granada/http/controller/browser_controller.h"
+#include "granada/util/metrics.h"
+#include "granada/util/tracing.h"
 
 using namespace web::http;
 
@@ -49,6 +51,9 @@ namespace granada{
       // A GET of the server browser get the files stored.
       //
       void BrowserController::handle_get(http_request request){
+        static granada::util::metrics::Histogram& latency = granada::util::metrics::GetHistogram("granada_http_request_seconds", "Time spent handling the HTTP requests.", "controller=\"browser\",method=\"GET\"");
+        granada::util::metrics::Timer timer(latency);
+        granada::util::tracing::Trace trace("browser_controller.get");
 
 		std::string relative_uri_path = utility::conversions::to_utf8string(request.relative_uri().path());
 
@@ -26,6 +26,8 @@
   */
 
 #include "granada/http/controller/oauth2_controller.h"
+#include "granada/util/metrics.h"
+#include "granada/util/tracing.h"
 
 using namespace web::http::details;
 using namespace web::http::oauth2::details;
@@ -38,10 +40,10 @@ namespace granada{
       std::string OAuth2Controller::oauth2_authorize_uri_;
       std::string OAuth2Controller::oauth2_logout_uri_;
       std::string OAuth2Controller::oauth2_info_uri_;
-      std::string OAuth2Controller::oauth2_authorizing_login_template_;
-      std::string OAuth2Controller::oauth2_authorizing_message_template_;
+      granada::util::html::Template OAuth2Controller::oauth2_authorizing_login_template_;
+      granada::util::html::Template OAuth2Controller::oauth2_authorizing_message_template_;
       std::string OAuth2Controller::oauth2_logout_template_;
-      std::string OAuth2Controller::oauth2_authorizing_error_template_;
+      std::string OAuth2Controller::oauth2_forbidden_page_;
 
       OAuth2Controller::OAuth2Controller(
         utility::string_t url,
@@ -61,6 +63,9 @@ namespace granada{
       }
 
       void OAuth2Controller::handle_get(web::http::http_request request){
+        static granada::util::metrics::Histogram& latency = granada::util::metrics::GetHistogram("granada_http_request_seconds", "Time spent handling the HTTP requests.", "controller=\"oauth2\",method=\"GET\"");
+        granada::util::metrics::Timer timer(latency);
+        granada::util::tracing::Trace trace("oauth2_controller.get");
 
         web::http::http_response response;
 
@@ -105,15 +110,11 @@ namespace granada{
               if(has_all_roles){
                 // only show website with message
                 // with state
-                std::string authorizing_message_template = oauth2_authorizing_message_template_;
-                granada::util::string::replace(authorizing_message_template,values);
-                response.set_body(authorizing_message_template);
+                response.set_body(oauth2_authorizing_message_template_.Render(values));
               }else{
                 // show message and login.
                 // with state
-                std::string authorizing_login_template = oauth2_authorizing_login_template_;
-                granada::util::string::replace(authorizing_login_template,values);
-                response.set_body(authorizing_login_template);
+                response.set_body(oauth2_authorizing_login_template_.Render(values));
               }
 
               status_code = status_codes::OK;
@@ -150,12 +151,7 @@ namespace granada{
         }
 
         if (status_code == status_codes::Forbidden){
-          std::deque<std::pair<std::string, std::string>> values;
-          values.push_back(std::make_pair(oauth2_errors::error,"403"));
-          values.push_back(std::make_pair(oauth2_errors::error_description,"Forbidden"));
-          std::string authorizing_error_template = oauth2_authorizing_error_template_;
-          granada::util::string::replace(authorizing_error_template,values);
-          response.set_body(authorizing_error_template);
+          response.set_body(oauth2_forbidden_page_);
         }
 
         response.headers().add(header_names::content_type, U("text/html; charset=utf-8"));
@@ -166,6 +162,9 @@ namespace granada{
 
       void OAuth2Controller::handle_post(web::http::http_request request)
       {
+        static granada::util::metrics::Histogram& latency = granada::util::metrics::GetHistogram("granada_http_request_seconds", "Time spent handling the HTTP requests.", "controller=\"oauth2\",method=\"POST\"");
+        granada::util::metrics::Timer timer(latency);
+        granada::util::tracing::Trace trace("oauth2_controller.post");
 
         web::http::http_response response;
 		response.headers().add(utility::conversions::to_string_t(header_names_2::access_control_allow_origin), U("*"));
@@ -186,7 +185,7 @@ namespace granada{
           std::unique_ptr<granada::http::oauth2::OAuth2Authorization> oauth2_authorization = oauth2_factory_->OAuth2Authorization_unique_ptr(oauth2_parameters,session_factory_.get());
           oauth2_response = oauth2_authorization->Grant(request,response);
 
-          if (oauth2_parameters.grant_type == utility::conversions::to_utf8string(oauth2_strings::authorization_code)){
+          if (oauth2_parameters.grant_type == oauth2_strings_2::authorization_code){
             // reply with a json to the client.
             if (oauth2_response.redirect_uri.empty()){
               oauth2_response.redirect_uri = granada::http::parser::ParseURIFromReferer(request);
@@ -214,6 +213,9 @@ namespace granada{
 
 
       void OAuth2Controller::handle_delete(web::http::http_request request){
+        static granada::util::metrics::Histogram& latency = granada::util::metrics::GetHistogram("granada_http_request_seconds", "Time spent handling the HTTP requests.", "controller=\"oauth2\",method=\"DELETE\"");
+        granada::util::metrics::Timer timer(latency);
+        granada::util::tracing::Trace trace("oauth2_controller.delete");
 
         web::http::http_response response;
 
@@ -273,20 +275,31 @@ namespace granada{
         //
         // Load the HTML templates for displaying client authorization to the user
 
+        // Templates with OAuth 2.0 parameters are parsed once here, so each
+        // request only renders them in a single pass escaping the values.
+        std::string html_template;
+
         // load the HTML to show in case the user is not already logged in our auth server,
         // we ask the user to enter his/her credentials.
-        LoadHTMLTemplate(entity_keys::oauth2_authorizing_login_template, oauth2_templates::oauth2_authorizing_login, oauth2_authorizing_login_template_);
+        LoadHTMLTemplate(entity_keys::oauth2_authorizing_login_template, oauth2_templates::oauth2_authorizing_login, html_template);
+        oauth2_authorizing_login_template_.Parse(html_template);
 
         // load message template, shown in case the user is already logged in our auth server,
         // we don't ask the user it's credentials, instead we show one button for authorizing the
         // client and another for denying authorization.
-        LoadHTMLTemplate(entity_keys::oauth2_authorizing_message_template, oauth2_templates::oauth2_authorizing_message, oauth2_authorizing_message_template_);
+        LoadHTMLTemplate(entity_keys::oauth2_authorizing_message_template, oauth2_templates::oauth2_authorizing_message, html_template);
+        oauth2_authorizing_message_template_.Parse(html_template);
 
         // load logout page, this HTML will show if user manually logout from the auth server..
         LoadHTMLTemplate(entity_keys::oauth2_logout_template, oauth2_templates::oauth2_logout, oauth2_logout_template_);
 
-        // load error page, in case, the url is not well formed this HTML will show.
-        LoadHTMLTemplate(entity_keys::oauth2_authorizing_error_template, oauth2_templates::oauth2_authorizing_error, oauth2_authorizing_error_template_);
+        // load error page, in case, the url is not well formed this HTML will show,
+        // its values never change so it is rendered only once.
+        LoadHTMLTemplate(entity_keys::oauth2_authorizing_error_template, oauth2_templates::oauth2_authorizing_error, html_template);
+        std::unordered_map<std::string, std::string> error_values;
+        error_values.insert(std::make_pair(oauth2_errors::error,"403"));
+        error_values.insert(std::make_pair(oauth2_errors::error_description,"Forbidden"));
+        oauth2_forbidden_page_.assign(granada::util::html::Template(html_template).Render(error_values));
       }
 
 
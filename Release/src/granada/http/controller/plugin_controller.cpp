@@ -23,6 +23,8 @@
   *
   */
 #include "granada/http/controller/plugin_controller.h"
+#include "granada/util/metrics.h"
+#include "granada/util/tracing.h"
 
 namespace granada{
   namespace http{
@@ -136,6 +138,7 @@ namespace granada{
 
 
       void PluginController::PluginHandlerLock(granada::plugin::PluginHandler* plugin_handler){
+        granada::util::tracing::Span span("plugin_controller.lock");
         if (PluginController::PLUGIN_HANDLER_USE_FREQUENCY_LIMIT_>0){
           std::string plugin_handler_value_hash_str = plugin_handler->plugin_handler_value_hash();
           std::string t_str = plugin_handler->cache()->Read(plugin_handler_value_hash_str,entity_keys::plugin_handler_last_use);
@@ -260,6 +263,9 @@ namespace granada{
 
 
       void PluginController::handle_post(http_request request){
+        static granada::util::metrics::Histogram& latency = granada::util::metrics::GetHistogram("granada_http_request_seconds", "Time spent handling the HTTP requests.", "controller=\"plugin\",method=\"POST\"");
+        granada::util::metrics::Timer timer(latency);
+        granada::util::tracing::Trace trace("plugin_controller.post");
         
         // communicate with the plug-ins
         web::http::http_response response;
@@ -32,23 +32,26 @@ namespace granada{
     namespace oauth2{
       
       granada::util::mutex::call_once MapOAuth2Client::load_properties_call_once_;
-      std::unique_ptr<granada::cache::CacheHandler> MapOAuth2Client::cache_(new granada::cache::SharedMapCacheDriver());
-      std::unique_ptr<granada::crypto::Cryptograph> MapOAuth2Client::cryptograph_(new granada::crypto::OpensslAESCryptograph());
+      std::unique_ptr<granada::cache::CacheHandler> MapOAuth2Client::cache_(new granada::cache::SharedMapCacheDriver("oauth2.client"));
+      std::unique_ptr<granada::crypto::Cryptograph> MapOAuth2Client::cryptograph_(new granada::crypto::OpensslEVPCryptograph());
       std::unique_ptr<granada::crypto::NonceGenerator> MapOAuth2Client::n_generator_(new granada::crypto::CPPRESTNonceGenerator());
 
       granada::util::mutex::call_once MapOAuth2User::load_properties_call_once_;
-      std::unique_ptr<granada::cache::CacheHandler> MapOAuth2User::cache_(new granada::cache::SharedMapCacheDriver());
-      std::unique_ptr<granada::crypto::Cryptograph> MapOAuth2User::cryptograph_(new granada::crypto::OpensslAESCryptograph());
+      std::unique_ptr<granada::cache::CacheHandler> MapOAuth2User::cache_(new granada::cache::SharedMapCacheDriver("oauth2.user"));
+      std::unique_ptr<granada::crypto::Cryptograph> MapOAuth2User::cryptograph_(new granada::crypto::OpensslEVPCryptograph());
       std::unique_ptr<granada::crypto::NonceGenerator> MapOAuth2User::n_generator_(new granada::crypto::CPPRESTNonceGenerator());
+      std::unique_ptr<granada::crypto::PasswordVerifier> MapOAuth2User::password_verifier_(new granada::crypto::OpensslScryptPasswordVerifier());
 
       granada::util::mutex::call_once MapOAuth2Code::load_properties_call_once_;
-      std::unique_ptr<granada::cache::CacheHandler> MapOAuth2Code::cache_(new granada::cache::SharedMapCacheDriver());
-      std::unique_ptr<granada::crypto::Cryptograph> MapOAuth2Code::cryptograph_(new granada::crypto::OpensslAESCryptograph());
+      std::unique_ptr<granada::cache::CacheHandler> MapOAuth2Code::cache_(new granada::cache::SharedMapCacheDriver("oauth2.code"));
+      std::unique_ptr<granada::crypto::Cryptograph> MapOAuth2Code::cryptograph_(new granada::crypto::OpensslEVPCryptograph());
       std::unique_ptr<granada::crypto::NonceGenerator> MapOAuth2Code::n_generator_(new granada::crypto::CPPRESTNonceGenerator());
 
       granada::util::mutex::call_once MapOAuth2Authorization::load_properties_call_once_;
       std::unique_ptr<granada::http::oauth2::OAuth2Factory> MapOAuth2Authorization::oauth2_factory_(new granada::http::oauth2::MapOAuth2Factory());
-      std::unique_ptr<granada::cache::CacheHandler> MapOAuth2Authorization::cache_(new granada::cache::SharedMapCacheDriver());
+      std::unique_ptr<granada::cache::CacheHandler> MapOAuth2Authorization::cache_(new granada::cache::SharedMapCacheDriver("oauth2.authorization"));
+      std::unique_ptr<granada::crypto::NonceGenerator> MapOAuth2Authorization::n_generator_(new granada::crypto::CPPRESTNonceGenerator());
+      std::unique_ptr<granada::crypto::TokenSigner> MapOAuth2Authorization::token_signer_(new granada::crypto::OpensslHMACTokenSigner());
     }
   }
 }
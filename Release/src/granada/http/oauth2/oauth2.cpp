@@ -24,6 +24,7 @@
   */
 
 #include "granada/http/oauth2/oauth2.h"
+#include "granada/util/json_document.h"
 
 #define _OAUTH2_ERRORS
 #define HTTP_CONSTANT(a_, b_) const oauth2_error oauth2_errors::a_(std::string(b_));
@@ -60,6 +61,100 @@ namespace granada{
   namespace http{
     namespace oauth2{
 
+      //////////////////////////////////////////////////
+      // OAuth2 Parameters
+      ////
+
+      namespace{
+
+        /**
+         * Name of a known OAuth 2.0 field and the parameter it fills.
+         */
+        struct OAuth2ParameterSlot{
+          const std::string* name;
+          std::string OAuth2Parameters::* value;
+        };
+
+
+        /**
+         * Returns the value of an hexadecimal digit, -1 if the
+         * character is not an hexadecimal digit.
+         */
+        inline int HexValue(const char c){
+          if (c >= '0' && c <= '9') return c - '0';
+          if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+          if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+          return -1;
+        }
+
+
+        /**
+         * Percent-decodes a value into the given string, reusing its memory.
+         * Malformed escapes are copied as they are.
+         */
+        void PercentDecode(const char* begin, const char* end, std::string& value){
+          const char* percent = std::find(begin, end, '%');
+          if (percent == end){
+            value.assign(begin, end);
+            return;
+          }
+          value.assign(begin, percent);
+          for (const char* c = percent; c < end; ++c){
+            int high, low;
+            if (*c == '%' && end - c > 2 && (high = HexValue(c[1])) >= 0 && (low = HexValue(c[2])) >= 0){
+              value.push_back((char)((high << 4) | low));
+              c += 2;
+            }else{
+              value.push_back(*c);
+            }
+          }
+        }
+      }
+
+
+      void OAuth2Parameters::Parse(const std::string& query_string){
+        static const OAuth2ParameterSlot slots[] = {
+          { &oauth2_strings_2::grant_type, &OAuth2Parameters::grant_type },
+          { &oauth2_strings_2::code, &OAuth2Parameters::code },
+          { &oauth2_strings_2::refresh_token, &OAuth2Parameters::refresh_token },
+          { &oauth2_strings_2::client_id, &OAuth2Parameters::client_id },
+          { &oauth2_strings_2::client_secret, &OAuth2Parameters::client_secret },
+          { &oauth2_strings_2::redirect_uri, &OAuth2Parameters::redirect_uri },
+          { &oauth2_strings_2::response_type, &OAuth2Parameters::response_type },
+          { &oauth2_strings_2::scope, &OAuth2Parameters::scope },
+          { &oauth2_strings_2::state, &OAuth2Parameters::state },
+          { &oauth2_strings_2::username, &OAuth2Parameters::username },
+          { &oauth2_strings_2::password, &OAuth2Parameters::password },
+          { &oauth2_strings_2::authorize, &OAuth2Parameters::authorize },
+          { &oauth2_strings_2::access_token, &OAuth2Parameters::access_token },
+          { &oauth2_strings_2::expires_in, &OAuth2Parameters::expires_in },
+          { &oauth2_strings_2::token_type, &OAuth2Parameters::token_type },
+          { &oauth2_errors::error, &OAuth2Parameters::error },
+          { &oauth2_errors::error_description, &OAuth2Parameters::error_description },
+        };
+        static const std::size_t slots_size = sizeof(slots) / sizeof(slots[0]);
+
+        const char* c = query_string.data();
+        const char* const end = c + query_string.size();
+        while (c < end){
+          const char* pair_end = std::find(c, end, '&');
+          const char* equal = std::find(c, pair_end, '=');
+          if (equal != pair_end && equal + 1 != pair_end){
+            const std::size_t name_length = equal - c;
+            for (std::size_t i = 0; i < slots_size; ++i){
+              const std::string& name = *slots[i].name;
+              if (name.size() == name_length && name.compare(0, name_length, c, name_length) == 0){
+                PercentDecode(equal + 1, pair_end, this->*slots[i].value);
+                break;
+              }
+            }
+          }
+          c = pair_end + 1;
+        }
+      }
+
+
+
       //////////////////////////////////////////////////
       // OAuth2 Client
       ////
@@ -67,12 +162,29 @@ namespace granada{
       std::mutex OAuth2Client::oauth2_client_creation_mtx_;
       std::string OAuth2Client::cache_namespace_;
       int OAuth2Client::client_id_length_;
+      granada::cache::LocalRecordCache<OAuth2Client::Record> OAuth2Client::records_;
 
       void OAuth2Client::Load(){
 
-        if (!id_.empty() && Exists()){
+        if (id_.empty()){
+          return;
+        }
 
-          const std::string& hash(this->hash());
+        const std::string& hash(this->hash());
+
+        // try the process-local records first.
+        Record record;
+        if (records_.Read(hash, record)){
+          key_.assign(record.key);
+          type_.assign(record.type);
+          application_name_.assign(record.application_name);
+          redirect_uris_ = record.redirect_uris;
+          roles_ = record.roles;
+          creation_time_ = record.creation_time;
+          return;
+        }
+
+        if (Exists()){
           
           // load client properties.
           key_.assign(cache()->Read(hash, entity_keys::oauth2_client_key));
@@ -88,6 +200,14 @@ namespace granada{
           const std::string& creation_time_str(cache()->Read(hash, entity_keys::oauth2_client_creation_time));
           creation_time_ = granada::util::time::parse(creation_time_str);
 
+          record.key = key_;
+          record.type = type_;
+          record.application_name = application_name_;
+          record.redirect_uris = redirect_uris_;
+          record.roles = roles_;
+          record.creation_time = creation_time_;
+          records_.Write(hash, record);
+
         }else{
           id_.assign("");
         }
@@ -138,6 +258,7 @@ namespace granada{
           cache()->Write(hash, entity_keys::oauth2_client_roles, granada::util::vector::stringify(roles,","));
           cache()->Write(hash, entity_keys::oauth2_client_creation_time, granada::util::time::stringify(std::time(nullptr)));
 
+          records_.Destroy(hash);
         }
       }
 
@@ -145,7 +266,9 @@ namespace granada{
       bool OAuth2Client::Delete(const std::string& secret){
 
         if (cryptograph()->Decrypt(key_,secret) == id_){
-          cache()->Destroy(hash());
+          const std::string& hash(this->hash());
+          cache()->Destroy(hash);
+          records_.Destroy(hash);
           return true;
         }
         return false;
@@ -187,6 +310,18 @@ namespace granada{
         if (cache_namespace_.empty()){
           cache_namespace_.assign(cache_namespaces::oauth2_client_value);
         }
+
+        // get the seconds loaded clients are kept in the process-local record cache.
+        long cache_ttl = default_numbers::oauth2_client_cache_ttl;
+        const std::string& cache_ttl_str = granada::util::application::GetProperty(entity_keys::oauth2_client_cache_ttl);
+        if (!cache_ttl_str.empty()){
+          try{
+            cache_ttl = std::stol(cache_ttl_str);
+          }catch(const std::logic_error e){
+            cache_ttl = default_numbers::oauth2_client_cache_ttl;
+          }
+        }
+        records_.set_ttl(cache_ttl);
       }
 
 
@@ -197,12 +332,27 @@ namespace granada{
 
       std::mutex OAuth2User::oauth2_user_creation_mtx_;
       std::string OAuth2User::cache_namespace_;
+      granada::cache::LocalRecordCache<OAuth2User::Record> OAuth2User::records_;
 
       bool OAuth2User::Create(const std::string& username, std::string& password, const web::json::value& roles){
         username_.assign(username);
         
         const std::string& hash(this->hash());
 
+        // hash the password before taking the username, hashing
+        // is slow on purpose and may be rejected when too many
+        // passwords are being hashed at the same time.
+        std::string key;
+        granada::crypto::PasswordVerifier* verifier = password_verifier();
+        if (verifier == nullptr){
+          key.assign(cryptograph()->Encrypt(username,password));
+        }else{
+          key.assign(verifier->Hash(password));
+          if (key.empty()){
+            return false;
+          }
+        }
+
         // save with unique username,
         // check if it does not already exist one user with the same username.
         oauth2_user_creation_mtx_.lock();
@@ -216,7 +366,6 @@ namespace granada{
           oauth2_user_creation_mtx_.unlock();
 
           // save user properties.
-          const std::string& key = cryptograph()->Encrypt(username,password);
           key_.assign(key);
           cache()->Write(hash, entity_keys::oauth2_user_key, key);
           std::string roles_str;
@@ -229,27 +378,40 @@ namespace granada{
           }
           cache()->Write(hash, entity_keys::oauth2_user_roles, roles_str);
           cache()->Write(hash, entity_keys::oauth2_user_creation_time, granada::util::time::stringify(std::time(nullptr)));
+          records_.Destroy(hash);
           return true;
         }
       }
 
       void OAuth2User::Load(){
-        if (!username_.empty() && Exists()){
-          const std::string& hash(this->hash());
+        if (username_.empty()){
+          return;
+        }
+
+        const std::string& hash(this->hash());
+
+        // try the process-local records first.
+        Record record;
+        if (records_.Read(hash, record)){
+          key_.assign(record.key);
+          roles_ = record.roles;
+          creation_time_ = record.creation_time;
+          return;
+        }
+
+        if (Exists()){
 
           // load user's properties.
           key_.assign(cache()->Read(hash, entity_keys::oauth2_user_key));
-          std::string roles_str(cache()->Read(hash, entity_keys::oauth2_user_roles));
-
-          try{
-			  roles_ = web::json::value::parse(utility::conversions::to_string_t(roles_str));
-          }catch(const web::json::json_exception e){
-            roles_str = "{}";
-			roles_ = web::json::value::parse(utility::conversions::to_string_t(roles_str));
-          }
+          roles_ = granada::util::json::parse(cache()->Read(hash, entity_keys::oauth2_user_roles));
 
           const std::string& creation_time_str(cache()->Read(hash, entity_keys::oauth2_user_creation_time));
           creation_time_ = granada::util::time::parse(creation_time_str);
+
+          record.key = key_;
+          record.roles = roles_;
+          record.creation_time = creation_time_;
+          records_.Write(hash, record);
         }else{
           username_.assign("");
         }
@@ -264,19 +426,38 @@ namespace granada{
 
 
       bool OAuth2User::CorrectCredentials(std::string password){
+        granada::crypto::PasswordVerifier* verifier = password_verifier();
+        if (verifier != nullptr && verifier->IsHash(key_)){
+          return verifier->Verify(password,key_);
+        }
+
+        // key of a user created without password verifier.
         std::string decrypted_key = cryptograph()->Decrypt(key_,password);
         if (decrypted_key.length()>username_.length()){
           decrypted_key.erase(decrypted_key.begin()+username_.length(),decrypted_key.end());
         }
         if (decrypted_key == username_){
+          if (verifier != nullptr){
+            // upgrade the key to a password hash now that
+            // we know the password.
+            const std::string& key = verifier->Hash(password);
+            if (!key.empty()){
+              const std::string& hash(this->hash());
+              key_.assign(key);
+              cache()->Write(hash, entity_keys::oauth2_user_key, key);
+              records_.Destroy(hash);
+            }
+          }
           return true;
         }
         return false;
       }
 
       bool OAuth2User::Delete(const std::string& password){
-        if (cryptograph()->Decrypt(key_,password) == username_){
-          cache()->Destroy(hash());
+        if (CorrectCredentials(password)){
+          const std::string& hash(this->hash());
+          cache()->Destroy(hash);
+          records_.Destroy(hash);
           return true;
         }
         return false;
@@ -290,6 +471,18 @@ namespace granada{
         if (cache_namespace_.empty()){
           cache_namespace_.assign(cache_namespaces::oauth2_user_value);
         }
+
+        // get the seconds loaded users are kept in the process-local record cache.
+        long cache_ttl = default_numbers::oauth2_user_cache_ttl;
+        const std::string& cache_ttl_str = granada::util::application::GetProperty(entity_keys::oauth2_user_cache_ttl);
+        if (!cache_ttl_str.empty()){
+          try{
+            cache_ttl = std::stol(cache_ttl_str);
+          }catch(const std::logic_error e){
+            cache_ttl = default_numbers::oauth2_user_cache_ttl;
+          }
+        }
+        records_.set_ttl(cache_ttl);
       }
 
 
@@ -357,6 +550,17 @@ namespace granada{
         cache()->Destroy(hash());
       }
 
+
+      void OAuth2Code::Delete(const std::vector<std::string>& codes){
+        std::vector<std::string> keys;
+        keys.reserve(codes.size());
+        for (auto it = codes.begin(); it != codes.end(); ++it){
+          SetCode(*it);
+          keys.push_back(hash());
+        }
+        cache()->Destroy(keys);
+      }
+
       void OAuth2Code::LoadProperties(){
         // try to get the properties from the server configuration file first.
 
@@ -386,7 +590,11 @@ namespace granada{
       ////
 
       std::string OAuth2Authorization::cache_namespace_;
+      std::string OAuth2Authorization::index_namespace_;
       bool OAuth2Authorization::oauth2_use_refresh_token_;
+      bool OAuth2Authorization::oauth2_signed_access_token_ = false;
+      long OAuth2Authorization::oauth2_access_token_timeout_;
+      bool OAuth2Authorization::oauth2_access_token_check_revocation_ = false;
 
       void OAuth2Authorization::LoadProperties(){
         // retrieve if we have to generate refresh_token when generating access_token.
@@ -406,16 +614,68 @@ namespace granada{
         if (cache_namespace_.empty()){
           cache_namespace_.assign(cache_namespaces::oauth2_authorization);
         }
+
+        // get the name of the OAuth 2.0 authorization index namespace.
+        index_namespace_.assign(granada::util::application::GetProperty(entity_keys::oauth2_authorization_index_namespace));
+        if (index_namespace_.empty()){
+          index_namespace_.assign(cache_namespaces::oauth2_authorization_index);
+        }
+
+        // get the type of access token: server session or signed self-contained token.
+        std::string oauth2_access_token_type = granada::util::application::GetProperty(entity_keys::oauth2_access_token_type);
+        if (oauth2_access_token_type.empty()){
+          oauth2_access_token_type = default_strings::oauth2_access_token_type;
+        }
+
+        // keys used to sign and verify access tokens: kid1:secret1,kid2:secret2
+        // the first key signs new tokens, the others are only used to verify
+        // tokens signed before a key rotation.
+        oauth2_signed_access_token_ = false;
+        granada::crypto::TokenSigner* signer = token_signer();
+        if (signer != nullptr){
+          std::vector<std::string> keys;
+          granada::util::string::split(granada::util::application::GetProperty(entity_keys::oauth2_access_token_keys), ',', keys);
+          for (auto it = keys.begin(); it != keys.end(); ++it){
+            const std::size_t separator = it->find(':');
+            if (separator != std::string::npos && separator > 0 && separator + 1 < it->size()){
+              const std::string& kid = it->substr(0,separator);
+              signer->AddKey(kid, it->substr(separator + 1));
+              if (it == keys.begin()){
+                signer->SetSigningKey(kid);
+              }
+            }
+          }
+          oauth2_signed_access_token_ = (oauth2_access_token_type == entity_keys::oauth2_access_token_type_signed) && signer->CanSign();
+        }
+
+        // seconds a signed access token is valid.
+        const std::string& oauth2_access_token_timeout_str = granada::util::application::GetProperty(entity_keys::oauth2_access_token_timeout);
+        if (oauth2_access_token_timeout_str.empty()){
+          oauth2_access_token_timeout_ = default_numbers::oauth2_access_token_timeout;
+        }else{
+          try{
+            oauth2_access_token_timeout_ = std::stol(oauth2_access_token_timeout_str);
+          }catch(const std::logic_error e){
+            oauth2_access_token_timeout_ = default_numbers::oauth2_access_token_timeout;
+          }
+        }
+
+        // check if signed access tokens have been revoked when verifying them.
+        std::string oauth2_access_token_check_revocation_str = granada::util::application::GetProperty(entity_keys::oauth2_access_token_check_revocation);
+        if (oauth2_access_token_check_revocation_str.empty()){
+          oauth2_access_token_check_revocation_str = default_strings::oauth2_access_token_check_revocation;
+        }
+        oauth2_access_token_check_revocation_ = (oauth2_access_token_check_revocation_str == entity_keys::_true);
       };
 
 
       granada::http::oauth2::OAuth2Parameters OAuth2Authorization::Grant(web::http::http_request &request, web::http::http_response& response){
         granada::http::oauth2::OAuth2Parameters oauth2_response;
         try{
-          // if grant_type=refresh_token use grant type code as we will use the same resources and
-          // the response will be the same as a code grant type.
-			if (oauth2_parameters_.grant_type == utility::conversions::to_utf8string(oauth2_strings::refresh_token)){
-            oauth2_parameters_.grant_type = entity_keys::oauth2_code_code;
+          // if grant_type=refresh_token use grant type authorization_code as we will use the same resources and
+          // the response will be the same as an authorization code grant type.
+			if (oauth2_parameters_.grant_type == oauth2_strings_2::refresh_token){
+            oauth2_parameters_.grant_type = oauth2_strings_2::authorization_code;
             oauth2_parameters_.code = oauth2_parameters_.refresh_token;
           }
 
@@ -469,7 +729,7 @@ namespace granada{
 
               // check if client is allowed to have the demanded scope/roles.
               if (CheckRoleAllowance(roles, oauth2_client.get(), oauth2_user.get())){
-				  if (oauth2_parameters_.response_type == utility::conversions::to_utf8string(oauth2_strings::code)){
+				  if (oauth2_parameters_.response_type == oauth2_strings_2::code){
                   // respond with the requested code.
                   CreateCode(oauth2_user_session, oauth2_code, oauth2_user.get(),oauth2_response,request,response);
                   oauth2_parameters_.code = oauth2_code->GetCode();
@@ -482,6 +742,7 @@ namespace granada{
                 if (oauth2_response.error.empty()){
                   // store user, client, code and access token relation.
                   cache()->Write(hash(),"0");
+                  Index();
                 }
               }else{
                 oauth2_response.error = oauth2_errors::invalid_scope;
@@ -523,9 +784,9 @@ namespace granada{
           }
           if (redirect_uri_exists){
             // we can redirect to a URI related to the client.
-			  if (oauth2_parameters_.response_type != utility::conversions::to_utf8string(oauth2_strings::code)
-				  && oauth2_parameters_.response_type != utility::conversions::to_utf8string(oauth2_strings::token)
-				  && oauth2_parameters_.grant_type != utility::conversions::to_utf8string(oauth2_strings::authorization_code)){
+			  if (oauth2_parameters_.response_type != oauth2_strings_2::code
+				  && oauth2_parameters_.response_type != oauth2_strings_2::token
+				  && oauth2_parameters_.grant_type != oauth2_strings_2::authorization_code){
 
               oauth2_response.error = oauth2_errors::unsupported_response_type;
               oauth2_response.error_description = oauth2_errors_description::unsupported_response_type;
@@ -549,7 +810,7 @@ namespace granada{
                                                  web::http::http_request& request,
                                                  web::http::http_response& response){
 
-		  if (oauth2_parameters_.grant_type == utility::conversions::to_utf8string(oauth2_strings::authorization_code)){
+		  if (oauth2_parameters_.grant_type == oauth2_strings_2::authorization_code){
           // check if provided code is valid.
           if (oauth2_parameters_.code.empty()){
             oauth2_response.error = oauth2_errors::access_denied;
@@ -647,20 +908,30 @@ namespace granada{
                                                   granada::http::oauth2::OAuth2Parameters& oauth2_response,
                                                   web::http::http_request& request,
                                                   web::http::http_response& response){
+        oauth2_parameters_.username = oauth2_user->GetUsername();
+
         // Client session. Resource access session.
-        std::unique_ptr<granada::http::session::Session> oauth2_client_session = session_factory()->Session_unique_ptr();
-        oauth2_client_session->Open();
+        // Not used with signed access tokens, they carry the roles themselves.
+        std::unique_ptr<granada::http::session::Session> oauth2_client_session;
+        if (oauth2_signed_access_token_){
+          CreateSignedAccessToken(roles,oauth2_user->GetRoles(),oauth2_response);
+          if (!oauth2_response.error.empty()){
+            return;
+          }
+        }else{
+          oauth2_client_session = session_factory()->Session_unique_ptr();
+          oauth2_client_session->Open();
 
-        // set session roles
-        AssignRolesToClientSession(roles,oauth2_user->GetRoles(),oauth2_client_session.get());
-        oauth2_response.access_token = oauth2_client_session->GetToken();
-		oauth2_response.token_type = utility::conversions::to_utf8string(oauth2_strings::bearer);
+          // set session roles
+          AssignRolesToClientSession(roles,oauth2_user->GetRoles(),oauth2_client_session.get());
+          oauth2_response.access_token = oauth2_client_session->GetToken();
+        }
+		oauth2_response.token_type = oauth2_strings_2::bearer;
         oauth2_response.scope = oauth2_parameters_.scope;
 
-        oauth2_parameters_.username = oauth2_user->GetUsername();
         oauth2_parameters_.access_token = oauth2_response.access_token;
 
-		if (oauth2_parameters_.grant_type == utility::conversions::to_utf8string(oauth2_strings::authorization_code)){
+		if (oauth2_parameters_.grant_type == oauth2_strings_2::authorization_code){
           // Access Token Request
           if (oauth2_use_refresh_token_){
             // create refresh token
@@ -673,15 +944,162 @@ namespace granada{
         }
       }
 
+      void OAuth2Authorization::CreateSignedAccessToken(std::vector<std::string>& roles,
+                                                        const web::json::value& user_roles,
+                                                        granada::http::oauth2::OAuth2Parameters& oauth2_response){
+        // the roles claim holds the same roles and properties
+        // AssignRolesToClientSession gives to a client session.
+        web::json::value roles_claim = web::json::value::object();
+        if (!user_roles.is_null()){
+          for (auto it = roles.begin(); it != roles.end(); ++it){
+            const utility::string_t& role = utility::conversions::to_string_t(*it);
+            if (user_roles.has_field(role)){
+              web::json::value properties = web::json::value::object();
+              const web::json::value& role_properties = user_roles.at(role);
+              if (role_properties.is_object()){
+                for (auto it2 = role_properties.as_object().cbegin(); it2 != role_properties.as_object().cend(); ++it2){
+                  if (it2->second.is_string()){
+                    properties[it2->first] = it2->second;
+                  }
+                }
+              }
+              roles_claim[role] = properties;
+            }
+          }
+        }
+
+        const std::time_t now = std::time(nullptr);
+        int token_id_length = nonce_lengths::oauth2_access_token_id;
+
+        web::json::value claims = web::json::value::object();
+        claims[utility::conversions::to_string_t(entity_keys::oauth2_claim_subject)] = web::json::value::string(utility::conversions::to_string_t(oauth2_parameters_.username));
+        claims[utility::conversions::to_string_t(entity_keys::oauth2_claim_client_id)] = web::json::value::string(utility::conversions::to_string_t(oauth2_parameters_.client_id));
+        claims[utility::conversions::to_string_t(entity_keys::oauth2_claim_scope)] = web::json::value::string(utility::conversions::to_string_t(oauth2_parameters_.scope));
+        claims[utility::conversions::to_string_t(entity_keys::oauth2_claim_roles)] = roles_claim;
+        claims[utility::conversions::to_string_t(entity_keys::oauth2_claim_issued_at)] = web::json::value::number((int64_t)now);
+        claims[utility::conversions::to_string_t(entity_keys::oauth2_claim_expiration)] = web::json::value::number((int64_t)(now + oauth2_access_token_timeout_));
+        claims[utility::conversions::to_string_t(entity_keys::oauth2_claim_token_id)] = web::json::value::string(utility::conversions::to_string_t(nonce_generator()->generate(token_id_length)));
+
+        const std::string& access_token = token_signer()->Sign(utility::conversions::to_utf8string(claims.serialize()));
+        if (access_token.empty()){
+          oauth2_response.error = oauth2_errors::server_error;
+          oauth2_response.error_description = oauth2_errors_description::server_error;
+        }else{
+          oauth2_response.access_token = access_token;
+          oauth2_response.expires_in.assign(std::to_string(oauth2_access_token_timeout_));
+        }
+      }
+
+      bool OAuth2Authorization::VerifyAccessToken(const std::string& access_token, web::json::value& claims){
+        granada::crypto::TokenSigner* signer = token_signer();
+        std::string payload;
+        if (signer == nullptr || !signer->Verify(access_token, payload)){
+          return false;
+        }
+        try{
+          claims = web::json::value::parse(utility::conversions::to_string_t(payload));
+          const utility::string_t& expiration_key = utility::conversions::to_string_t(entity_keys::oauth2_claim_expiration);
+          if (!claims.is_object() || !claims.has_field(expiration_key) || !claims.at(expiration_key).is_number()){
+            return false;
+          }
+          const int64_t expiration = claims.at(expiration_key).as_number().to_int64();
+          if (expiration <= (int64_t)std::time(nullptr)){
+            return false;
+          }
+          if (oauth2_access_token_check_revocation_){
+            const utility::string_t& token_id_key = utility::conversions::to_string_t(entity_keys::oauth2_claim_token_id);
+            if (claims.has_field(token_id_key) && claims.at(token_id_key).is_string() &&
+                cache()->Exists(revoked_hash(expiration), utility::conversions::to_utf8string(claims.at(token_id_key).as_string()))){
+              return false;
+            }
+          }
+        }catch(const std::exception e){
+          return false;
+        }
+        return true;
+      }
+
+      std::unique_ptr<granada::http::oauth2::OAuth2AccessToken> OAuth2Authorization::AccessToken(const std::string& access_token){
+        if (IsSignedAccessToken(access_token)){
+          web::json::value claims;
+          if (!VerifyAccessToken(access_token, claims)){
+            claims = web::json::value::null();
+          }
+          return granada::util::memory::make_unique<granada::http::oauth2::OAuth2AccessToken>(claims);
+        }
+        granada::http::session::SessionFactory* factory = session_factory();
+        if (factory == nullptr || access_token.empty()){
+          return granada::util::memory::make_unique<granada::http::oauth2::OAuth2AccessToken>(web::json::value::null());
+        }
+        return granada::util::memory::make_unique<granada::http::oauth2::OAuth2AccessToken>(factory->Session_unique_ptr(access_token));
+      }
+
+      void OAuth2Authorization::RevokeSignedAccessToken(const std::string& access_token){
+        RevokeSignedAccessTokens(std::vector<std::string>(1, access_token));
+      }
+
+      void OAuth2Authorization::RevokeSignedAccessTokens(const std::vector<std::string>& access_tokens){
+        granada::crypto::TokenSigner* signer = token_signer();
+        if (signer == nullptr){
+          return;
+        }
+        const int64_t now = (int64_t)std::time(nullptr);
+        for (auto it = access_tokens.begin(); it != access_tokens.end(); ++it){
+          std::string payload;
+          if (signer->Verify(*it, payload)){
+            try{
+              const web::json::value& claims = web::json::value::parse(utility::conversions::to_string_t(payload));
+              const std::string& token_id = utility::conversions::to_utf8string(claims.at(utility::conversions::to_string_t(entity_keys::oauth2_claim_token_id)).as_string());
+              const int64_t expiration = claims.at(utility::conversions::to_string_t(entity_keys::oauth2_claim_expiration)).as_number().to_int64();
+              if (expiration > now){
+                cache()->Write(revoked_hash(expiration), token_id, std::to_string(expiration));
+              }
+            }catch(const std::exception e){}
+          }
+        }
+
+        PruneRevokedAccessTokens(now);
+      }
+
+      void OAuth2Authorization::PruneRevokedAccessTokens(const int64_t now){
+        const int64_t period = now / default_numbers::oauth2_access_token_revoked_period;
+        const std::string& pruned = cache()->Read(cache_namespaces::oauth2_access_token_revoked_pruned);
+        // nothing pruned yet: there are no lists before the current period.
+        int64_t first = period;
+        if (!pruned.empty()){
+          try{
+            first = std::stoll(pruned);
+          }catch(const std::logic_error e){}
+        }
+
+        // remove the lists of the periods that have already expired. Tokens revoked
+        // since the last pruning expire at most one access token timeout after it,
+        // so there are no lists to remove after that.
+        const int64_t last = std::min(period, first + oauth2_access_token_timeout_ / default_numbers::oauth2_access_token_revoked_period + 2);
+        if (first < last){
+          std::vector<std::string> keys;
+          keys.reserve((std::size_t)(last - first));
+          for (int64_t i = first; i < last; ++i){
+            keys.push_back(cache_namespaces::oauth2_access_token_revoked + ":" + std::to_string(i));
+          }
+          cache()->Destroy(keys);
+        }
+        if (pruned.empty() || first != period){
+          cache()->Write(cache_namespaces::oauth2_access_token_revoked_pruned, std::to_string(period));
+        }
+      }
+
       void OAuth2Authorization::CreateRefreshToken(granada::http::session::Session* oauth2_client_session,
                                                    std::unique_ptr<granada::http::oauth2::OAuth2Code>& oauth2_code,
                                                    granada::http::oauth2::OAuth2Parameters& oauth2_response){
 
-        const long& session_timeout = oauth2_client_session->GetSessionTimeout();
-        try{
-          oauth2_response.expires_in.assign(std::to_string(session_timeout));
-        }catch(const std::exception e){
-          oauth2_response.expires_in.assign("-1");
+        if (oauth2_client_session != nullptr){
+          const long& session_timeout = oauth2_client_session->GetSessionTimeout();
+          try{
+            oauth2_response.expires_in.assign(std::to_string(session_timeout));
+          }catch(const std::exception e){
+            oauth2_response.expires_in.assign("-1");
+          }
         }
 
         // generate a refresh token,
@@ -767,29 +1185,73 @@ namespace granada{
         }
       }
 
+      void OAuth2Authorization::Index(){
+        if (!oauth2_parameters_.client_id.empty()){
+          // user => clients.
+          cache()->Write(clients_index_hash(),oauth2_parameters_.client_id,"0");
+
+          // user + client => codes.
+          if (!oauth2_parameters_.code.empty()){
+            cache()->Write(codes_index_hash(),oauth2_parameters_.code,"0");
+          }
+
+          // user + client => access tokens, each one linked to the code
+          // used to obtain it (empty in case of an implicit grant).
+          if (!oauth2_parameters_.access_token.empty()){
+            cache()->Write(tokens_index_hash(),oauth2_parameters_.access_token,oauth2_parameters_.code);
+          }
+        }
+      }
+
+
+      void OAuth2Authorization::MigrateIndex(){
+        // the empty field of the user's clients index marks
+        // that the user's authorizations have been indexed.
+        const std::string& clients_hash = clients_index_hash();
+        if (oauth2_parameters_.username.empty() || cache()->Exists(clients_hash,"")){
+          return;
+        }
+
+        // authorizations granted before the indexes existed can only be
+        // found scanning the keys: namespace + username + client_id + code + access_token
+        const std::string client_id = oauth2_parameters_.client_id;
+        const std::string code = oauth2_parameters_.code;
+        const std::string access_token = oauth2_parameters_.access_token;
+        const std::string& prefix = cache_namespace_ + oauth2_parameters_.username + ":";
+        std::unique_ptr<granada::cache::CacheHandlerIterator> cache_iterator = cache()->make_iterator(prefix + "*:*:*");
+        while(cache_iterator->has_next()){
+          const std::string& key = cache_iterator->next();
+          const std::size_t client_end = key.find(':', prefix.size());
+          const std::size_t code_end = client_end == std::string::npos ? std::string::npos : key.find(':', client_end + 1);
+          if (key.compare(0, prefix.size(), prefix) == 0 && code_end != std::string::npos){
+            oauth2_parameters_.client_id = key.substr(prefix.size(), client_end - prefix.size());
+            oauth2_parameters_.code = key.substr(client_end + 1, code_end - client_end - 1);
+            oauth2_parameters_.access_token = key.substr(code_end + 1);
+            Index();
+          }
+        }
+        oauth2_parameters_.client_id = client_id;
+        oauth2_parameters_.code = code;
+        oauth2_parameters_.access_token = access_token;
+
+        cache()->Write(clients_hash,"","0");
+      }
+
+
       web::json::value OAuth2Authorization::Information(){
+        MigrateIndex();
+
         std::string json_str = "";
         if (oauth2_parameters_.client_id.empty()){
           // give information about all the clients authorized by the user.
           std::vector<std::string> clients_ids;
-          const std::string& expression = cache_namespace_ + oauth2_parameters_.username + ":*:*:*";
-          std::unique_ptr<granada::cache::CacheHandlerIterator> cache_iterator = cache()->make_iterator(expression);
-          std::string key;
-          std::string client_id;
-          while(cache_iterator->has_next()){
-            key = cache_iterator->next();
-            std::vector<std::string> splitted_key;
-            granada::util::string::split(key,':',splitted_key);
-            if (splitted_key.size() > 2){
-              client_id = splitted_key[2];
-              if (!client_id.empty()){
-                if (std::find(clients_ids.begin(), clients_ids.end(), client_id) == clients_ids.end()){
-                  // client not already reported, retrieve its application name and report it.
-                  const std::unique_ptr<granada::http::oauth2::OAuth2Client>& oauth2_client = factory()->OAuth2Client_unique_ptr(client_id);
-                  json_str += ",{\"client_id\":\"" + client_id + "\",\"application_name\":\"" + oauth2_client->GetApplicationName() + "\"}";
-                  clients_ids.push_back(client_id);
-                }
-              }
+          cache()->Fields(clients_index_hash(),clients_ids);
+          for (auto it = clients_ids.begin(); it != clients_ids.end(); ++it){
+            const std::string& client_id = *it;
+            if (!client_id.empty()){
+              // retrieve the client application name and report it.
+              const std::unique_ptr<granada::http::oauth2::OAuth2Client>& oauth2_client = factory()->OAuth2Client_unique_ptr(client_id);
+              json_str += ",{\"client_id\":\"" + client_id + "\",\"application_name\":\"" + oauth2_client->GetApplicationName() + "\"}";
             }
           }
         }else{
@@ -797,26 +1259,11 @@ namespace granada{
           std::unique_ptr<granada::http::oauth2::OAuth2Client> oauth2_client = factory()->OAuth2Client_unique_ptr();
           oauth2_client->SetId(oauth2_parameters_.client_id);
           if (oauth2_client->Exists()){
-            // get all the codes and the access_tokens linked to that client and user.
+            // get all the codes linked to that client and user.
             std::vector<std::string> codes;
-            const std::string& expression = cache_namespace_ + oauth2_parameters_.username + ":" + oauth2_parameters_.client_id + ":*:*";
-            std::unique_ptr<granada::cache::CacheHandlerIterator> cache_iterator = cache()->make_iterator(expression);
-            std::string key;
-            std::string code;
-            while(cache_iterator->has_next()){
-              key = cache_iterator->next();
-              std::vector<std::string> splitted_key;
-              granada::util::string::split(key,':',splitted_key);
-              if (splitted_key.size() > 3){
-                code = splitted_key[3];
-                if (!code.empty()){
-                  if (std::find(codes.begin(), codes.end(), code) == codes.end()){
-                    // code not already reported, report it.
-                    json_str += ",\"" + code + "\"";
-                    codes.push_back(code);
-                  }
-                }
-              }
+            cache()->Fields(codes_index_hash(),codes);
+            for (auto it = codes.begin(); it != codes.end(); ++it){
+              json_str += ",\"" + *it + "\"";
             }
           }else{
             granada::http::oauth2::OAuth2Parameters oauth2_response;
@@ -845,57 +1292,70 @@ namespace granada{
       web::json::value OAuth2Authorization::Delete(){
         web::json::value json;
 
+        MigrateIndex();
+
         std::unique_ptr<granada::http::oauth2::OAuth2Client> oauth2_client = factory()->OAuth2Client_unique_ptr();
         oauth2_client->SetId(oauth2_parameters_.client_id);
         if (oauth2_client->Exists()){
-          // remove all codes and access_token from a client.
+          // remove all codes and access_token from a client,
+          // retrieved from the indexes instead of scanning the cache keys.
+          const std::string& codes_hash = codes_index_hash();
+          const std::string& tokens_hash = tokens_index_hash();
+
+          // keys of the authorizations and indexes to remove at once.
           std::vector<std::string> keys;
+
+          // remove codes and gather the authorizations in which they were given.
           std::vector<std::string> codes;
-          std::vector<std::string> access_tokens;
-          const std::string& expression = cache_namespace_ + oauth2_parameters_.username + ":" + oauth2_parameters_.client_id + ":*:*";
-          std::unique_ptr<granada::cache::CacheHandlerIterator> cache_iterator = cache()->make_iterator(expression);
-          std::string key;
-          std::string code;
-          std::string access_token;
-          std::unique_ptr<granada::http::oauth2::OAuth2Code> oauth2_code = factory()->OAuth2Code_unique_ptr();
-          while(cache_iterator->has_next()){
-            key = cache_iterator->next();
-            // a key is formed with namespace + username + client_id + code + access_token
-            // so we split it to have access to the code and the access_token.
-            std::vector<std::string> splitted_key;
-            granada::util::string::split(key,':',splitted_key);
-
-            if (splitted_key.size() > 4){
-
-              // remove code and report it as removed
-              code = splitted_key[3];
-              if (!code.empty()){
-                if (std::find(codes.begin(), codes.end(), code) == codes.end()){
-                  oauth2_code->SetCode(code);
-                  oauth2_code->Delete();
-                  codes.push_back(code);
-                }
-              }
+          cache()->Fields(codes_hash,codes);
+          if (!codes.empty()){
+            factory()->OAuth2Code_unique_ptr()->Delete(codes);
+          }
 
-              // remove access_token and report it as removed
-              access_token = splitted_key[4];
-              if (!access_token.empty()){
-                if (std::find(access_tokens.begin(), access_tokens.end(), access_token) == access_tokens.end()){
-                  std::unique_ptr<granada::http::session::Session> session = session_factory()->Session_unique_ptr(access_token);
-                  session->Close();
-                  access_tokens.push_back(access_token);
-                }
-              }
+          // gather the access tokens with the codes they were given with.
+          std::map<std::string,std::string> access_tokens;
+          cache()->ReadAll(tokens_hash,access_tokens);
+
+          keys.reserve(codes.size() + access_tokens.size() + 2);
+          for (auto it = codes.begin(); it != codes.end(); ++it){
+            keys.push_back(authorization_hash(*it,""));
+          }
+
+          std::vector<std::string> signed_access_tokens;
+          std::vector<std::string> session_tokens;
+          for (auto it = access_tokens.begin(); it != access_tokens.end(); ++it){
+            if (IsSignedAccessToken(it->first)){
+              signed_access_tokens.push_back(it->first);
+            }else{
+              session_tokens.push_back(it->first);
             }
+            keys.push_back(authorization_hash(it->second,it->first));
+          }
 
-            // store key to remove.
-            keys.push_back(key);
+          // revoke signed access tokens.
+          if (!signed_access_tokens.empty()){
+            RevokeSignedAccessTokens(signed_access_tokens);
           }
 
-          // remove OAuth 2.0 authorizations
-          for (auto it = keys.begin(); it != keys.end(); ++it){
-            cache()->Destroy(*it);
+          // close access_tokens sessions, they are invalid as soon as
+          // CloseSessions returns, close callbacks are run asynchronously.
+          if (!session_tokens.empty()){
+            const std::unique_ptr<granada::http::session::Session>& session = session_factory()->Session_unique_ptr();
+            granada::http::session::SessionHandler* session_handler = session->session_handler();
+            if (session_handler != nullptr){
+              session_handler->CloseSessions(session_tokens);
+            }else{
+              for (auto it = session_tokens.begin(); it != session_tokens.end(); ++it){
+                session_factory()->Session_unique_ptr(*it)->Close();
+              }
+            }
           }
+
+          // remove authorizations and indexes.
+          keys.push_back(codes_hash);
+          keys.push_back(tokens_hash);
+          cache()->Destroy(keys);
+          cache()->Destroy(clients_index_hash(),oauth2_parameters_.client_id);
         }else{
           granada::http::oauth2::OAuth2Parameters oauth2_response;
           oauth2_response.error = oauth2_errors::unauthorized_client;
@@ -909,7 +1369,6 @@ namespace granada{
         return json;
       }
 
-
     }
   }
 }
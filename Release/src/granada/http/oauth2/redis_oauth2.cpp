@@ -32,23 +32,26 @@ namespace granada{
     namespace oauth2{
 
       granada::util::mutex::call_once RedisOAuth2Client::load_properties_call_once_;
-      std::unique_ptr<granada::cache::CacheHandler> RedisOAuth2Client::cache_(new granada::cache::RedisCacheDriver());
-      std::unique_ptr<granada::crypto::Cryptograph> RedisOAuth2Client::cryptograph_(new granada::crypto::OpensslAESCryptograph());
+      std::unique_ptr<granada::cache::CacheHandler> RedisOAuth2Client::cache_(new granada::cache::TieredCacheHandler(new granada::cache::RedisCacheDriver(), new granada::cache::RedisCacheInvalidator()));
+      std::unique_ptr<granada::crypto::Cryptograph> RedisOAuth2Client::cryptograph_(new granada::crypto::OpensslEVPCryptograph());
       std::unique_ptr<granada::crypto::NonceGenerator> RedisOAuth2Client::n_generator_(new granada::crypto::CPPRESTNonceGenerator());
 
       granada::util::mutex::call_once RedisOAuth2User::load_properties_call_once_;
       std::unique_ptr<granada::cache::CacheHandler> RedisOAuth2User::cache_(new granada::cache::RedisCacheDriver());
-      std::unique_ptr<granada::crypto::Cryptograph> RedisOAuth2User::cryptograph_(new granada::crypto::OpensslAESCryptograph());
+      std::unique_ptr<granada::crypto::Cryptograph> RedisOAuth2User::cryptograph_(new granada::crypto::OpensslEVPCryptograph());
       std::unique_ptr<granada::crypto::NonceGenerator> RedisOAuth2User::n_generator_(new granada::crypto::CPPRESTNonceGenerator());
+      std::unique_ptr<granada::crypto::PasswordVerifier> RedisOAuth2User::password_verifier_(new granada::crypto::OpensslScryptPasswordVerifier());
 
       granada::util::mutex::call_once RedisOAuth2Code::load_properties_call_once_;
       std::unique_ptr<granada::cache::CacheHandler> RedisOAuth2Code::cache_(new granada::cache::RedisCacheDriver());
-      std::unique_ptr<granada::crypto::Cryptograph> RedisOAuth2Code::cryptograph_(new granada::crypto::OpensslAESCryptograph());
+      std::unique_ptr<granada::crypto::Cryptograph> RedisOAuth2Code::cryptograph_(new granada::crypto::OpensslEVPCryptograph());
       std::unique_ptr<granada::crypto::NonceGenerator> RedisOAuth2Code::n_generator_(new granada::crypto::CPPRESTNonceGenerator());
       
       granada::util::mutex::call_once RedisOAuth2Authorization::load_properties_call_once_;
       std::unique_ptr<granada::http::oauth2::OAuth2Factory> RedisOAuth2Authorization::oauth2_factory_(new granada::http::oauth2::RedisOAuth2Factory());
       std::unique_ptr<granada::cache::CacheHandler> RedisOAuth2Authorization::cache_(new granada::cache::RedisCacheDriver());
+      std::unique_ptr<granada::crypto::NonceGenerator> RedisOAuth2Authorization::n_generator_(new granada::crypto::CPPRESTNonceGenerator());
+      std::unique_ptr<granada::crypto::TokenSigner> RedisOAuth2Authorization::token_signer_(new granada::crypto::OpensslHMACTokenSigner());
     }
   }
 }
@@ -30,24 +30,20 @@ namespace granada{
 
       std::unordered_map<std::string, std::string> ParseCookies(const web::http::http_request &request){
         std::unordered_map<std::string, std::string> cookies;
-        web::http::http_headers headers = request.headers();
+        const web::http::http_headers& headers = request.headers();
 
-        if( headers.has(utility::conversions::to_string_t(entity_keys::http_parser_cookie)) ){
-			    const std::string cookies_str = utility::conversions::to_utf8string(headers[utility::conversions::to_string_t(entity_keys::http_parser_cookie)]);
+        auto header = headers.find(utility::conversions::to_string_t(entity_keys::http_parser_cookie));
+        if (header != headers.end()){
+          const std::string cookies_str = utility::conversions::to_utf8string(header->second);
 
           // separate different cookies.
-          std::stringstream ss(cookies_str);
-          std::string cookie_name_and_content;
-          while (std::getline(ss, cookie_name_and_content, ';')) {
-            granada::util::string::trim(cookie_name_and_content);
+          for (const granada::util::string::view& cookie : granada::util::string::splitter(cookies_str, ';')){
+            const granada::util::string::view& cookie_name_and_content = granada::util::string::trimmed(cookie);
             // get cookie name and content.
-            const std::string delimiter("=");
-            const size_t delimiter_length(delimiter.length());
-            auto it = std::search(cookie_name_and_content.begin(), cookie_name_and_content.end(), delimiter.c_str(), delimiter.c_str() + delimiter_length);
-
-            if (it!=cookie_name_and_content.end()){
+            const char* delimiter = granada::util::string::find(cookie_name_and_content.begin(), cookie_name_and_content.end(), '=');
+            if (delimiter != cookie_name_and_content.end()){
               // insert cookie name and content in cookies map.
-              cookies.insert(std::make_pair(std::string(cookie_name_and_content.begin(),it), std::string(it+delimiter_length,cookie_name_and_content.end())));
+              cookies.insert(std::make_pair(std::string(cookie_name_and_content.begin(), delimiter), std::string(delimiter + 1, cookie_name_and_content.end())));
             }
           }
         }
@@ -57,17 +53,22 @@ namespace granada{
 
       std::unordered_map<std::string, std::string> ParseQueryString(const std::string& query_string){
         std::unordered_map<std::string, std::string> parsed_query;
-        if (!query_string.empty()){
-          std::vector<std::string> keys_and_values;
-          granada::util::string::split(query_string,'&',keys_and_values);
-          int len = keys_and_values.size();
-          while (len--) {
-            std::vector<std::string> key_and_value;
-            granada::util::string::split(keys_and_values[len],'=',key_and_value);
-            if (key_and_value.size() > 1){
-              parsed_query.insert(std::make_pair(key_and_value[0],utility::conversions::to_utf8string(web::uri::decode(utility::conversions::to_string_t(key_and_value[1])))));
-            }
+        const char* pos = query_string.data();
+        const char* last = pos + query_string.size();
+        while (pos < last){
+          // key=value pairs separated by "&", a value only goes until the next "=",
+          // pairs without a value are ignored and the last repeated key wins.
+          const char* key_end = granada::util::string::find_first_of(pos, last, '=', '&');
+          if (key_end == last || *key_end == '&'){
+            pos = key_end + 1;
+            continue;
+          }
+          const char* value_end = granada::util::string::find_first_of(key_end + 1, last, '=', '&');
+          const char* pair_end = (value_end == last || *value_end == '&') ? value_end : granada::util::string::find(value_end, last, '&');
+          if (pair_end > key_end + 1){
+            parsed_query[std::string(pos, key_end)] = utility::conversions::to_utf8string(web::uri::decode(utility::conversions::to_string_t(std::string(key_end + 1, value_end))));
           }
+          pos = pair_end + 1;
         }
         return parsed_query;
       }
@@ -23,6 +23,8 @@
   *
   */
 #include "granada/http/session/session.h"
+#include "granada/util/metrics.h"
+#include "granada/util/tracing.h"
 
 namespace granada{
   namespace http{
@@ -157,6 +159,11 @@ namespace granada{
       }
 
 
+      const std::string Session::session_data_hash(){
+        return cache_namespaces::session_data + session_handler()->cache()->Tag(token_);
+      }
+
+
       web::json::value Session::to_json(){
         web::json::value json = web::json::value::object();
     		json[utility::conversions::to_string_t(entity_keys::session_token)] = web::json::value::string(utility::conversions::to_string_t(token_));
@@ -262,6 +269,11 @@ namespace granada{
 
       const bool Session::LoadSession(const std::string& token){
         if (!token.empty()){
+          static granada::util::metrics::Histogram& latency = granada::util::metrics::GetHistogram("granada_session_load_seconds", "Time spent loading and updating the sessions.");
+          static granada::util::metrics::Counter& found = granada::util::metrics::GetCounter("granada_session_loads_total", "Number of sessions loaded by result.", "result=\"found\"");
+          static granada::util::metrics::Counter& not_found = granada::util::metrics::GetCounter("granada_session_loads_total", "Number of sessions loaded by result.", "result=\"not_found\"");
+          granada::util::metrics::Timer timer(latency);
+          granada::util::tracing::Span span("session.load");
 
           // use session handler to load session from wherever the sessions are stored.
           // If session is found the value of this session will be replaced by the
@@ -271,8 +283,10 @@ namespace granada{
             // session found, update the session. For example the session update time,
             // so session is kept alive.
             Update();
+            found.Increment();
             return true;
           }
+          not_found.Increment();
         }
         return false;
       }
@@ -325,6 +339,11 @@ namespace granada{
       }
 
 
+      const std::string SessionRoles::session_roles_hash(const std::string& role_name){
+        return cache_namespaces::session_roles + session_->session_handler()->cache()->Tag(session_->GetToken()) + ":" + role_name;
+      }
+
+
 
 
       int SessionHandler::token_length_ = 32;
@@ -373,6 +392,44 @@ namespace granada{
       }
 
 
+      void SessionHandler::CloseSessions(const std::vector<std::string>& tokens){
+        if (tokens.empty()){
+          return;
+        }
+
+        // invalidate all the sessions at once.
+        std::vector<std::string> keys;
+        keys.reserve(tokens.size());
+        for (auto it = tokens.begin(); it != tokens.end(); ++it){
+          if (!it->empty()){
+            keys.push_back(session_value_hash(*it));
+          }
+        }
+        cache()->Destroy(keys);
+
+        // call close callbacks and remove roles without making the caller wait.
+        // The destroyed values only held the token and the update time, the
+        // callbacks receive the token and the close time instead.
+        granada::http::session::SessionFactory* session_factory = factory();
+        if (session_factory != nullptr){
+          const std::time_t close_time = std::time(nullptr);
+          pplx::create_task([session_factory,tokens,close_time]{
+            for (auto it = tokens.begin(); it != tokens.end(); ++it){
+              if (!it->empty()){
+                // nobody waits for this task, an exception would terminate
+                // the process, and must not prevent closing the other sessions.
+                try{
+                  const std::unique_ptr<granada::http::session::Session>& session = session_factory->Session_unique_ptr();
+                  session->set(*it,close_time);
+                  session->Close();
+                }catch(...){}
+              }
+            }
+          });
+        }
+      }
+
+
       void SessionHandler::CleanSessions(){
         const std::unique_ptr<granada::cache::CacheHandlerIterator>& cache_iterator = cache()->make_iterator(session_value_hash("*"));
         while(cache_iterator->has_next()){
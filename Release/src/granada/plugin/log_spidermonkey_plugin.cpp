@@ -0,0 +1,40 @@
+/**
+  * Copyright (c) <2016> granada <afernandez@cookinapps.io>
+  *
+  * This source code is licensed under the MIT license.
+  *
+  * Permission is hereby granted, free of charge, to any person obtaining a copy
+  * of this software and associated documentation files (the "Software"), to deal
+  * in the Software without restriction, including without limitation the rights
+  * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  * copies of the Software, and to permit persons to whom the Software is
+  * furnished to do so, subject to the following conditions:
+  *
+  * The above copyright notice and this permission notice shall be included in
+  * all copies or substantial portions of the Software.
+  *
+  * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  * SOFTWARE.
+  *
+  */
+
+#include "granada/plugin/log_spidermonkey_plugin.h"
+
+namespace granada{
+
+  namespace plugin{
+
+    std::unique_ptr<granada::cache::CacheHandler> LogSpidermonkeyPluginHandler::cache_;
+    granada::util::mutex::call_once LogSpidermonkeyPluginHandler::cache_call_once_;
+    std::unique_ptr<granada::plugin::PluginFactory> LogSpidermonkeyPluginHandler::plugin_factory_(new granada::plugin::LogSpidermonkeyPluginFactory());
+    std::unique_ptr<granada::runner::Runner> LogSpidermonkeyPluginHandler::runner_;
+    granada::util::mutex::call_once LogSpidermonkeyPluginHandler::runner_call_once_;
+    std::unique_ptr<granada::runner::NativeRunner> LogSpidermonkeyPluginHandler::native_runner_(new granada::runner::NativeRunner());
+
+  }
+}
@@ -29,9 +29,11 @@ namespace granada{
 
   namespace plugin{
 
-    std::unique_ptr<granada::cache::CacheHandler> MapSpidermonkeyPluginHandler::cache_(new granada::cache::SharedMapCacheDriver());
+    std::unique_ptr<granada::cache::CacheHandler> MapSpidermonkeyPluginHandler::cache_(new granada::cache::SharedMapCacheDriver("plugin"));
     std::unique_ptr<granada::plugin::PluginFactory> MapSpidermonkeyPluginHandler::plugin_factory_(new granada::plugin::MapSpidermonkeyPluginFactory());
-    std::unique_ptr<granada::runner::Runner> MapSpidermonkeyPluginHandler::runner_(new granada::runner::SpiderMonkeyJavascriptRunner());
+    std::unique_ptr<granada::runner::Runner> MapSpidermonkeyPluginHandler::runner_;
+    granada::util::mutex::call_once MapSpidermonkeyPluginHandler::runner_call_once_;
+    std::unique_ptr<granada::runner::NativeRunner> MapSpidermonkeyPluginHandler::native_runner_(new granada::runner::NativeRunner());
 
   }
 }
@@ -26,6 +26,14 @@
   */
 
 #include "granada/plugin/plugin.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include "granada/util/configuration.h"
+#include "granada/util/metrics.h"
+#include "granada/util/tracing.h"
+#include "granada/util/json_document.h"
 
 namespace granada{
   namespace plugin{
@@ -40,6 +48,8 @@ namespace granada{
     std::mutex PluginHandler::uid_mtx_;
     granada::util::mutex::call_once PluginHandler::load_properties_call_once_;
     granada::util::mutex::call_once PluginHandler::functions_to_runner_call_once_;
+    granada::util::thread::OrderedThreadPool* PluginHandler::event_pool_ = nullptr;
+    granada::util::mutex::call_once PluginHandler::event_pool_call_once_;
 //
 ////
 
@@ -70,9 +80,22 @@ namespace granada{
       // cache plug-in handler id, now plug-in handler exists.
       cache()->Write(plugin_handler_value_hash(),entity_keys::plugin_handler_id,id_);
 
+      // new generation of the plug-in handler, the asynchronous events
+      // queued by the previous one are not fired.
+      {
+        std::stringstream generation;
+        generation << std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count() << "-" << GetUID();
+        cache()->Write(plugin_handler_value_hash(),entity_keys::plugin_handler_generation,generation.str());
+      }
+
       // store the repositories
       cache()->Write(plugin_handler_value_hash(),entity_keys::plugin_handler_repositories,granada::util::vector::stringify(paths_,","));
 
+      // fire the events that were waiting when the server stopped.
+      if (granada::util::configuration::Bool(granada::util::configuration::plugin_event_queue_persist)){
+        FireQueuedEvents();
+      }
+
       // fire "ph-init-after" event
       Fire(default_strings::plugin_init_ph_event + "-" + default_strings::plugin_after, response, [&response](const web::json::value& data){
         const web::json::value& new_parameters = granada::util::json::first(granada::util::json::as_object(data,entity_keys::plugin_parameter_data));
@@ -98,6 +121,9 @@ namespace granada{
       // remove event loaders from the cache.
       cache()->Destroy(plugin_event_value_hash("*"));
 
+      // remove the events waiting to be fired from the cache.
+      cache()->Destroy(plugin_event_queue_hash("*"));
+
       // remove plugin values stored in the cache.
       cache()->Destroy(plugin_value_hash("*"));
 
@@ -169,15 +195,27 @@ namespace granada{
 
       if (!malformed_parameters){
         
-        // retrieve the cached event loaders and parse them to a JSON object.
+        // retrieve the cached event loaders.
         const std::string& event_hash = plugin_event_value_hash(event_name);
-        web::json::value cached_event_loaders = granada::util::string::to_json(cache()->Read(event_hash,entity_keys::plugin_event_loader));
-
-        // add the plug-in event loader to the loaders.
-		cached_event_loaders[utility::conversions::to_string_t(plugin_id)] = plugin_loader;
+        const granada::util::json::document cached_event_loaders(cache()->Read(event_hash,entity_keys::plugin_event_loader));
+
+        // copy the text of the other loaders as it is and
+        // add the plug-in event loader, without building
+        // a JSON object with all of them.
+        std::string event_loaders("{");
+        const granada::util::json::document::element& loaders = cached_event_loaders.root();
+        for (auto it = loaders.begin(); loaders.is_object() && it != loaders.end(); ++it){
+          if (!it.key().equals(plugin_id)){
+            const granada::util::string::view& key = it.key().raw();
+            const granada::util::string::view& loader = it.value().raw();
+            event_loaders.append(key.data(),key.size()).append(1,':').append(loader.data(),loader.size()).append(1,',');
+          }
+        }
+        granada::util::json::document::Quote(event_loaders,plugin_id);
+        event_loaders.append(1,':').append(utility::conversions::to_utf8string(plugin_loader.serialize())).append(1,'}');
 
         // store the loaders again in the cache.
-		cache()->Write(event_hash, entity_keys::plugin_event_loader, utility::conversions::to_utf8string(cached_event_loaders.serialize()));
+        cache()->Write(event_hash, entity_keys::plugin_event_loader, event_loaders);
       }
     }
 
@@ -422,8 +460,8 @@ namespace granada{
           // it has became an inactive plugin, its extensions
           // will do the job.
           // fire plug-in add after event.
-          Fire(plugin_add_after_event,event_parameters);
-          Fire(plugin_id + "-" + plugin_add_after_event,event_parameters);
+          FireAsync(plugin_add_after_event,event_parameters);
+          FireAsync(plugin_id + "-" + plugin_add_after_event,event_parameters);
         }else{
 
           // plug-in has not been extended, it is active and it can be run.
@@ -472,8 +510,8 @@ namespace granada{
           }
 
           // fire plug-in add after event.
-          Fire(plugin_add_after_event,event_parameters);
-          Fire(plugin_id + "-" + plugin_add_after_event,event_parameters);
+          FireAsync(plugin_add_after_event,event_parameters);
+          FireAsync(plugin_id + "-" + plugin_add_after_event,event_parameters);
 
           if (run_plugin){
             // if no events specified, run plug-in when added.
@@ -637,6 +675,7 @@ namespace granada{
         // contains all the plug-ins listening to
         // one event in one script.
         cache()->Destroy(event_value_hash,entity_keys::plugin_event_script);
+        cache()->Destroy(event_value_hash,entity_keys::plugin_event_separate_ids);
       }
     }
 
@@ -673,6 +712,7 @@ namespace granada{
 
           // clean cached scripts
           cache()->Destroy(event_value_hash,entity_keys::plugin_event_script);
+          cache()->Destroy(event_value_hash,entity_keys::plugin_event_separate_ids);
         }
       }
     }
@@ -755,6 +795,7 @@ namespace granada{
 
 
     std::unique_ptr<granada::plugin::Plugin> PluginHandler::GetPluginById(const std::string& plugin_id){
+      granada::util::tracing::Span span("plugin.get_by_id");
 
       const bool& malformed_parameters = plugin_id.empty() || id_.empty();
 
@@ -770,9 +811,10 @@ namespace granada{
 
         if (!malformed_plugin){
 
-          // parse the plug-in header and configuration into JSON objects.
-          const web::json::value& header = granada::util::string::to_json(header_str);
-          const web::json::value& configuration = granada::util::string::to_json(configuration_str);
+          // parse the plug-in header and configuration into JSON objects,
+          // malformed ones are taken as empty objects.
+          const web::json::value& header = granada::util::json::parse(header_str);
+          const web::json::value& configuration = granada::util::json::parse(configuration_str);
 
           // instanciate a plug-in and return its pointer
           return plugin_factory()->Plugin_unique_ptr(this,header,configuration,script);
@@ -939,8 +981,8 @@ namespace granada{
         cache()->Destroy(plugin_value_hash(plugin_id));
 
         const std::string& plugin_remove_after_event = default_strings::plugin_remove_event + "-" + default_strings::plugin_after;
-        Fire(plugin_remove_after_event,parameters);
-        Fire(plugin_id + "-" + plugin_remove_after_event,parameters);
+        FireAsync(plugin_remove_after_event,parameters);
+        FireAsync(plugin_id + "-" + plugin_remove_after_event,parameters);
       }
 
     }
@@ -1055,6 +1097,94 @@ namespace granada{
     }
 
 
+    void PluginHandler::FireAsync(const std::string& event_name, const web::json::value& parameters){
+      static granada::util::metrics::Counter& queued = granada::util::metrics::GetCounter("granada_plugin_async_events_total", "Events fired asynchronously, by whether they were queued or fired in the caller.", "result=\"queued\"");
+      static granada::util::metrics::Counter& fired_in_caller = granada::util::metrics::GetCounter("granada_plugin_async_events_total", "Events fired asynchronously, by whether they were queued or fired in the caller.", "result=\"caller\"");
+
+      PluginHandler::event_pool_call_once_.call([](){
+        const int workers = granada::util::configuration::Int(granada::util::configuration::plugin_event_workers);
+        const int queue_size = granada::util::configuration::Int(granada::util::configuration::plugin_event_queue_size);
+        if (workers > 0){
+          PluginHandler::event_pool_ = new granada::util::thread::OrderedThreadPool((std::size_t)workers, (std::size_t)(queue_size > 0 ? queue_size : 1));
+          std::atexit(PluginHandler::StopAsyncEvents);
+        }
+      });
+
+      granada::plugin::PluginFactory* factory = plugin_factory();
+      if (PluginHandler::event_pool_ != nullptr && factory != nullptr && !event_name.empty()){
+
+        // keep the event in the cache until it has been fired.
+        std::string event_hash;
+        if (granada::util::configuration::Bool(granada::util::configuration::plugin_event_queue_persist)){
+          std::stringstream event_key;
+          event_key << std::setfill('0') << std::setw(16) << std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count() << "-" << std::setw(20) << GetUID();
+          event_hash = plugin_event_queue_hash(event_key.str());
+          cache()->Write(event_hash,entity_keys::plugin_parameter_event_name,event_name);
+          cache()->Write(event_hash,entity_keys::plugin_parameters,utility::conversions::to_utf8string(parameters.serialize()));
+        }
+
+        // the Plug-in Handler may not exist anymore when the event is
+        // fired, the event is fired by a new one with the same id,
+        // if it is still the same generation.
+        const std::string plugin_handler_id = id_;
+        const std::string generation = cache()->Read(plugin_handler_value_hash(),entity_keys::plugin_handler_generation);
+        if (PluginHandler::event_pool_->Submit(id_, [factory, plugin_handler_id, generation, event_name, parameters, event_hash](){
+          PluginHandler::FireQueuedEvent(factory, plugin_handler_id, generation, event_name, parameters, event_hash);
+        })){
+          queued.Increment();
+          return;
+        }
+
+        // too many events waiting, fire it now.
+        if (!event_hash.empty()){
+          cache()->Destroy(event_hash);
+        }
+      }
+
+      fired_in_caller.Increment();
+      web::json::value fire_parameters = parameters;
+      Fire(event_name,fire_parameters);
+    }
+
+
+    void PluginHandler::StopAsyncEvents(){
+      if (PluginHandler::event_pool_ != nullptr){
+        PluginHandler::event_pool_->Stop();
+      }
+    }
+
+
+    void PluginHandler::FireQueuedEvent(granada::plugin::PluginFactory* plugin_factory, const std::string& plugin_handler_id, const std::string& generation, const std::string& event_name, web::json::value parameters, const std::string& event_hash){
+      const std::unique_ptr<granada::plugin::PluginHandler>& plugin_handler = plugin_factory->PluginHandler_unique_ptr(plugin_handler_id);
+
+      // the Plug-in Handler has been stopped or reset since the event was queued.
+      if (plugin_handler->cache()->Read(plugin_handler->plugin_handler_value_hash(),entity_keys::plugin_handler_generation) == generation){
+        plugin_handler->Fire(event_name,parameters);
+      }
+      if (!event_hash.empty()){
+        plugin_handler->cache()->Destroy(event_hash);
+      }
+    }
+
+
+    void PluginHandler::FireQueuedEvents(){
+      std::vector<std::string> event_hashes;
+      cache()->Match(plugin_event_queue_hash("*"),event_hashes);
+
+      // the keys of the events sort in the order the events were queued.
+      std::sort(event_hashes.begin(),event_hashes.end());
+
+      for (auto it = event_hashes.begin(); it != event_hashes.end(); ++it){
+        const std::string& event_name = cache()->Read(*it,entity_keys::plugin_parameter_event_name);
+        const web::json::value& parameters = granada::util::string::to_json(cache()->Read(*it,entity_keys::plugin_parameters));
+        cache()->Destroy(*it);
+        if (!event_name.empty()){
+          FireAsync(event_name,parameters);
+        }
+      }
+    }
+
+
     web::json::value PluginHandler::Fire(const web::json::value& parameters){
 
       web::json::value response = web::json::value::object();
@@ -1614,6 +1744,41 @@ namespace granada{
     }
 
 
+    bool PluginHandler::IsTrustedNativePath(const std::string& library_path){
+      if (native_runner() == nullptr || !granada::util::configuration::Bool(granada::util::configuration::plugin_native)){
+        return false;
+      }
+
+      boost::system::error_code ec;
+      const std::string& library = boost::filesystem::canonical(library_path, ec).string();
+      if (ec){
+        return false;
+      }
+
+      std::vector<std::string> repositories;
+      const web::json::value native_repositories = granada::util::configuration::Json(granada::util::configuration::plugin_native_repositories);
+      if (native_repositories.is_array()){
+        for (auto it = native_repositories.as_array().cbegin(); it != native_repositories.as_array().cend(); ++it){
+          if (it->is_string()){
+            repositories.push_back(utility::conversions::to_utf8string(it->as_string()));
+          }
+        }
+      }
+      if (repositories.empty()){
+        const std::string& plugin_publicfiles_directory = granada::util::application::GetProperty(entity_keys::plugin_publicfiles_directory);
+        repositories.push_back(plugin_publicfiles_directory.empty() ? default_strings::plugin_publicfiles_directory : plugin_publicfiles_directory);
+      }
+
+      for (auto it = repositories.begin(); it != repositories.end(); ++it){
+        const std::string& repository = boost::filesystem::canonical(granada::util::application::FormatDirectoryPath(*it), ec).string();
+        if (!ec && library.compare(0, repository.size() + 1, repository + "/") == 0){
+          return true;
+        }
+      }
+      return false;
+    }
+
+
     int PluginHandler::PreloadRepositories(){
 
       // cumulated loaded repositories
@@ -1730,8 +1895,14 @@ namespace granada{
 
 
         if (boost::filesystem::exists(package_server_directory_path) && boost::filesystem::is_directory(package_server_directory_path)){
-          // get the extensions of the script/executable files
-          const std::vector<std::string>& extensions = runner()->extensions();
+          // get the extensions of the script/executable files,
+          // followed by the extensions of the native plug-ins.
+          std::vector<std::string> extensions = runner()->extensions();
+          const std::size_t native_extensions_begin = extensions.size();
+          if (native_runner() != nullptr && granada::util::configuration::Bool(granada::util::configuration::plugin_native)){
+            const std::vector<std::string>& native_extensions = native_runner()->extensions();
+            extensions.insert(extensions.end(), native_extensions.begin(), native_extensions.end());
+          }
 
           boost::filesystem::directory_iterator end_it;
 
@@ -1772,6 +1943,12 @@ namespace granada{
                     }
                   }
                   
+                  // native plug-ins are only loaded from trusted repositories.
+                  const bool native = std::size_t(it - extensions.begin()) >= native_extensions_begin;
+                  if (native && !IsTrustedNativePath(plugin_script_path)){
+                    continue;
+                  }
+
                   // script/executable file and header have to exist both
                   // check if script/executable file exists
                   if (boost::filesystem::exists(plugin_script_path)){
@@ -1806,6 +1983,14 @@ namespace granada{
                           return total_size;
                         }
                       }
+                      // the script of the native plug-ins is the path of their
+                      // shared object, the file extension tells which ones are.
+                      if (native){
+                        header[entity_keys::plugin_header_native] = web::json::value::boolean(true);
+                      }else if (header.has_field(entity_keys::plugin_header_native)){
+                        header[entity_keys::plugin_header_native] = web::json::value::boolean(false);
+                      }
+
                       const std::string& script = TransformPluginScriptPath(plugin_script_path);
                       AddPluginLoader(header, configuration, script);
                       break;
@@ -1835,15 +2020,22 @@ namespace granada{
     void PluginHandler::FireLoadEvent(const std::string& event_name){
 
       // retrieve the plug-in loaders that have to be processed for
-      // the given event.
-      const web::json::value& event_loaders = granada::util::string::to_json(cache()->Read(plugin_event_value_hash(event_name),entity_keys::plugin_event_loader));
+      // the given event. Most of the times there are none, as they are
+      // removed once processed.
+      const std::string& event_loaders_str = cache()->Read(plugin_event_value_hash(event_name),entity_keys::plugin_event_loader);
+      if (event_loaders_str.empty()){
+        return;
+      }
+      const granada::util::json::document event_loaders(event_loaders_str);
+      const granada::util::json::document::element& loaders = event_loaders.root();
 
       // loop through the plug-in loaders and add the plug-ins if they are
-      // not already added.
-      for(auto it = event_loaders.as_object().cbegin(); it != event_loaders.as_object().cend(); ++it){
-		  const std::string& plugin_id = utility::conversions::to_utf8string(it->first);
+      // not already added. Only the loaders used are converted
+      // to web::json::value.
+      for(auto it = loaders.begin(); loaders.is_object() && it != loaders.end(); ++it){
+        const std::string& plugin_id = it.key().as_string();
         const std::unique_ptr<granada::plugin::Plugin>& plugin = plugin_factory()->Plugin_unique_ptr(this,plugin_id);
-        if (!plugin->Exists() && Load(plugin.get(),it->second)){
+        if (!plugin->Exists() && Load(plugin.get(),it.value().to_value())){
 
           // add plug-in, but tell to not run plug-in
           // even if it does not have "run" events.
@@ -1898,6 +2090,15 @@ namespace granada{
         return plugin_handler->RemoveEventListeners(parameters);
       });
 
+      // native plug-ins can call the same functions.
+      if (plugin_handler->native_runner() != nullptr){
+        std::shared_ptr<granada::FunctionsIterator> it = plugin_handler->runner()->functions()->make_iterator();
+        while(it->has_next()){
+          const granada::Function& function = it->next();
+          plugin_handler->native_runner()->functions()->Add(function.name, function.function);
+        }
+      }
+
     }
 
 
@@ -29,9 +29,11 @@ namespace granada{
 
   namespace plugin{
 
-    std::unique_ptr<granada::cache::CacheHandler> RedisSpidermonkeyPluginHandler::cache_(new granada::cache::RedisCacheDriver());
+    std::unique_ptr<granada::cache::CacheHandler> RedisSpidermonkeyPluginHandler::cache_(new granada::cache::TieredCacheHandler(new granada::cache::RedisCacheDriver(), new granada::cache::RedisCacheInvalidator()));
     std::unique_ptr<granada::plugin::PluginFactory> RedisSpidermonkeyPluginHandler::plugin_factory_(new granada::plugin::RedisSpidermonkeyPluginFactory());
-    std::unique_ptr<granada::runner::Runner> RedisSpidermonkeyPluginHandler::runner_(new granada::runner::SpiderMonkeyJavascriptRunner());
+    std::unique_ptr<granada::runner::Runner> RedisSpidermonkeyPluginHandler::runner_;
+    granada::util::mutex::call_once RedisSpidermonkeyPluginHandler::runner_call_once_;
+    std::unique_ptr<granada::runner::NativeRunner> RedisSpidermonkeyPluginHandler::native_runner_(new granada::runner::NativeRunner());
 
   }
 }
@@ -0,0 +1,203 @@
+/**
+  * Copyright (c) <2016> Web App SDK granada <afernandez@cookinapps.io>
+  *
+  * This source code is licensed under the MIT license.
+  *
+  * Permission is hereby granted, free of charge, to any person obtaining a copy
+  * of this software and associated documentation files (the "Software"), to deal
+  * in the Software without restriction, including without limitation the rights
+  * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  * copies of the Software, and to permit persons to whom the Software is
+  * furnished to do so, subject to the following conditions:
+  *
+  * The above copyright notice and this permission notice shall be included in
+  * all copies or substantial portions of the Software.
+  *
+  * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  * SOFTWARE.
+  *
+  * Resident plug-in: a plug-in kept alive in a script instance, running
+  * its calls one after the other and keeping its state in memory.
+  */
+
+#include "granada/plugin/resident_plugin.h"
+
+namespace granada{
+  namespace plugin{
+
+    const std::string ResidentPlugin::checkpoint_script_ = "(function(){var s;try{s=JSON.stringify(__PLUGIN.state);}catch(e){}return \"state:\"+(typeof s==\"string\"?s:\"\");})();";
+
+
+    ResidentPlugin::ResidentPlugin(granada::runner::Runner* runner, const std::string& script, const std::string& state, std::function<void(const std::string&)> checkpoint, const int mailbox_size, const int timeout, const int checkpoint_interval) :
+      script_(script),
+      mailbox_size_(mailbox_size > 0 ? mailbox_size : 1),
+      timeout_(timeout),
+      worker_(new Worker()){
+
+      worker_->checkpoint = std::move(checkpoint);
+      worker_->checkpoint_interval = std::chrono::milliseconds(checkpoint_interval > 0 ? checkpoint_interval : 0);
+      worker_->last_checkpoint = std::chrono::steady_clock::now();
+      worker_->state = state;
+
+      std::string init_script = script;
+      if (!state.empty()){
+        init_script += " __PLUGIN.state = " + state + ";";
+      }
+
+      // the thread id is set before the thread can take calls.
+      std::lock_guard<std::mutex> lg(worker_->mtx);
+      thread_ = std::thread(&ResidentPlugin::Work, worker_, runner, init_script);
+      worker_->thread_id = thread_.get_id();
+    }
+
+
+    ResidentPlugin::~ResidentPlugin(){
+      Stop();
+    }
+
+
+    std::string ResidentPlugin::Run(const std::string& script){
+
+      // a call from the plug-in itself cannot wait for the
+      // call it is part of, run it now.
+      if (std::this_thread::get_id() == worker_->thread_id){
+        return Execute(*worker_, script);
+      }
+
+      std::future<std::string> response;
+      {
+        std::lock_guard<std::mutex> lg(worker_->mtx);
+        if (worker_->stopped){
+          return Error(default_errors::plugin_resident_stopped, default_error_descriptions::plugin_resident_stopped);
+        }
+        if (worker_->mailbox.size() >= mailbox_size_){
+          return Error(default_errors::plugin_resident_mailbox_full, default_error_descriptions::plugin_resident_mailbox_full);
+        }
+        std::unique_ptr<Call> call(new Call());
+        call->script = script;
+        response = call->response.get_future();
+        worker_->mailbox.push_back(std::move(call));
+      }
+      worker_->cv.notify_one();
+
+      if (timeout_ > 0 && response.wait_for(std::chrono::milliseconds(timeout_)) != std::future_status::ready){
+        // the call stays in the mailbox and will run,
+        // but nobody waits for its response anymore.
+        return Error(default_errors::plugin_resident_timeout, default_error_descriptions::plugin_resident_timeout);
+      }
+      return response.get();
+    }
+
+
+    void ResidentPlugin::Stop(){
+      {
+        std::lock_guard<std::mutex> lg(worker_->mtx);
+        worker_->stopped = true;
+      }
+      worker_->cv.notify_one();
+
+      if (thread_.joinable()){
+        if (std::this_thread::get_id() == thread_.get_id()){
+          // stopped by the plug-in itself, the thread ends
+          // when the call it is running returns.
+          thread_.detach();
+        }else{
+          thread_.join();
+        }
+      }
+    }
+
+
+    void ResidentPlugin::Work(std::shared_ptr<Worker> worker, granada::runner::Runner* runner, const std::string script){
+
+      if (runner != nullptr){
+        worker->instance = runner->Instance_unique_ptr();
+      }
+      if (worker->instance){
+        worker->instance->Run(script);
+      }
+
+      std::unique_lock<std::mutex> lk(worker->mtx);
+      while (true){
+        if (worker->mailbox.empty() && !worker->stopped){
+          if (worker->dirty){
+            // wake up to checkpoint even if no call comes.
+            worker->cv.wait_until(lk, worker->last_checkpoint + worker->checkpoint_interval);
+          }else{
+            worker->cv.wait(lk);
+          }
+        }
+
+        if (worker->mailbox.empty()){
+          if (worker->stopped){
+            break;
+          }
+          lk.unlock();
+          if (std::chrono::steady_clock::now() >= worker->last_checkpoint + worker->checkpoint_interval){
+            Checkpoint(*worker);
+          }
+          lk.lock();
+        }else{
+          std::unique_ptr<Call> call = std::move(worker->mailbox.front());
+          worker->mailbox.pop_front();
+          lk.unlock();
+
+          call->response.set_value(Execute(*worker, call->script));
+          if (std::chrono::steady_clock::now() >= worker->last_checkpoint + worker->checkpoint_interval){
+            Checkpoint(*worker);
+          }
+          lk.lock();
+        }
+      }
+      lk.unlock();
+
+      Checkpoint(*worker);
+
+      // the instance has to be destroyed in the thread that created it.
+      worker->instance.reset();
+    }
+
+
+    std::string ResidentPlugin::Execute(Worker& worker, const std::string& script){
+      if (!worker.instance){
+        return Error(default_errors::runner_initialization_error, std::string());
+      }
+      worker.dirty = true;
+      return worker.instance->Run(script);
+    }
+
+
+    void ResidentPlugin::Checkpoint(Worker& worker){
+      if (worker.dirty && worker.instance){
+        worker.dirty = false;
+        worker.last_checkpoint = std::chrono::steady_clock::now();
+
+        const std::string& response = worker.instance->Run(checkpoint_script_);
+        const std::string prefix = "state:";
+        if (response.compare(0, prefix.size(), prefix) == 0){
+          const std::string& state = response.substr(prefix.size());
+          if (!state.empty() && state != worker.state){
+            worker.state = state;
+            if (worker.checkpoint){
+              worker.checkpoint(state);
+            }
+          }
+        }
+      }
+    }
+
+
+    std::string ResidentPlugin::Error(const std::string& error, const std::string& error_description){
+      web::json::value response = web::json::value::object();
+      response[default_strings::plugin_error] = web::json::value::string(error);
+      response[default_strings::plugin_error_description] = web::json::value::string(error_description);
+      return response.serialize();
+    }
+
+  }
+}
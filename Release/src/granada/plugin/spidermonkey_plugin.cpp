@@ -24,14 +24,22 @@
   */
 
 #include "granada/plugin/spidermonkey_plugin.h"
+#include "granada/util/configuration.h"
+#include "granada/util/metrics.h"
 
 namespace granada{
 
   namespace plugin{
 
+    std::map<std::string,std::shared_ptr<granada::plugin::ResidentPlugin>> SpidermonkeyPluginHandler::resident_plugins_;
+    std::mutex SpidermonkeyPluginHandler::resident_plugins_mtx_;
+    granada::cache::LocalRecordCache<web::json::value> SpidermonkeyPluginHandler::plugin_results_;
+
 
     void SpidermonkeyPluginHandler::Extend(const web::json::array& extended_plugins_ids, granada::plugin::Plugin* plugin){
-      if (plugin!=nullptr && extended_plugins_ids.size()>0){
+      // native plug-ins have no script to merge,
+      // they neither extend nor are extended.
+      if (plugin!=nullptr && !plugin->IsNative() && extended_plugins_ids.size()>0){
         std::string extended_plugins_scripts = "";
         std::string extended_configurations = "";
 
@@ -59,7 +67,7 @@ namespace granada{
               // the plug-in that has to be extended has not been added yet.
               // its extension will be applied when it will be added.
               AddExtension(extended_plugin_id,plugin->GetId());
-            }else{
+            }else if (!extended_plugin->IsNative()){
               if (i>0){
                 extended_plugins_scripts += ",";
                 extended_configurations += ",";
@@ -107,6 +115,9 @@ namespace granada{
           const std::string& response = runner()->Run(script);
           plugin->SetScript(response);
 
+          // results of the plug-in before extending are no more valid.
+          plugin_results_.DestroyPrefix(plugin_result_prefix(plugin->GetId()));
+
           if (!plugin_extends.is_null()){
             
             // store the new plug-in extends in plug-in header.
@@ -137,24 +148,7 @@ namespace granada{
         success(response);
       }else{
 
-        // build the script to execute.
-        {
-            script =  GetJavaScriptPluginCore(plugin) + " var __PLUGIN = " + script  + "; __wrappedRun(" + granada::util::string::stringified_json(parameters.serialize());
-        }
-        
-        if (event_name.empty()){
-          script += ",null);";
-        }else{
-          script += ",\"" + event_name + "\");";
-        }
-
-        // wait until runner is usable, it is recommended to 
-        // limit the use of the runner so it does not harm
-        // other users performance.
-        RunnerLock();
-
-        // run the script and parse response to json.
-        web::json::value response_data = granada::util::string::to_json(runner()->Run(script));
+        web::json::value response_data = RunPlugin(plugin,parameters,event_name);
 
         if (response_data.has_field(default_strings::plugin_error)){
 
@@ -165,8 +159,8 @@ namespace granada{
           response_data[entity_keys::plugin_id] = web::json::value::string(plugin->GetId());
           failure(response_data);
           const std::string& plugin_run_failure_after_event = default_strings::plugin_run_failure_event + "-" + default_strings::plugin_after;
-          PluginHandler::Fire(plugin_run_failure_after_event,response_data);
-          PluginHandler::Fire(plugin->GetId() + "-" + plugin_run_failure_after_event,response_data);
+          FireAsync(plugin_run_failure_after_event,response_data);
+          FireAsync(plugin->GetId() + "-" + plugin_run_failure_after_event,response_data);
           
           // Managing plug-in execution failure
           // if it is a script_error remove the plug-in so it won't be able to be executed again.
@@ -187,22 +181,104 @@ namespace granada{
     }
 
 
+    web::json::value SpidermonkeyPluginHandler::RunPlugin(granada::plugin::Plugin* plugin, web::json::value& parameters, const std::string& event_name){
+      static granada::util::metrics::Counter& hits = granada::util::metrics::GetCounter("granada_plugin_results_total", "Runs of cacheable plug-ins, by whether a kept result was reused.", "result=\"hit\"");
+      static granada::util::metrics::Counter& misses = granada::util::metrics::GetCounter("granada_plugin_results_total", "Runs of cacheable plug-ins, by whether a kept result was reused.", "result=\"miss\"");
+
+      web::json::value response_data;
+
+      // reuse the result of a previous run with
+      // the same parameters if it has not expired.
+      const long cache_ttl = plugin->CacheTTL();
+      std::string result_key;
+      if (cache_ttl > 0){
+        result_key = PluginResultKey(plugin,parameters,event_name);
+        if (plugin_results_.Read(result_key,response_data)){
+          hits.Increment();
+          return response_data;
+        }
+        misses.Increment();
+      }
+
+      if (plugin->IsNative()){
+
+        // the script is the path of the shared object,
+        // call it directly without using the javascript runner.
+        response_data = RunNative(plugin,parameters,event_name);
+      }else if (plugin->IsResident()){
+
+        // run in the instance kept for the plug-in.
+        response_data = RunResident(plugin,parameters,event_name);
+      }else{
+
+        // build the script to execute.
+        std::string script = GetJavaScriptPluginCore(plugin) + " var __PLUGIN = " + plugin->GetScript() + "; __wrappedRun(" + granada::util::string::stringified_json(parameters.serialize());
+
+        if (event_name.empty()){
+          script += ",null);";
+        }else{
+          script += ",\"" + event_name + "\");";
+        }
+
+        // wait until runner is usable, it is recommended to 
+        // limit the use of the runner so it does not harm
+        // other users performance.
+        RunnerLock();
+
+        // run the script and parse response to json.
+        response_data = granada::util::string::to_json(runner()->Run(script));
+      }
+
+      // errors are not kept, the plug-in runs again next time.
+      if (cache_ttl > 0 && !response_data.has_field(default_strings::plugin_error)){
+        plugin_results_.Write(result_key,response_data,cache_ttl);
+      }
+
+      return response_data;
+    }
+
+
     web::json::value SpidermonkeyPluginHandler::Run(const std::vector<std::string>& plugin_ids, const std::string& event_name, web::json::value& parameters){
 
-      std::string script = MultiplePluginScript(plugin_ids);
+      std::vector<std::unique_ptr<granada::plugin::Plugin>> separate_plugins;
+      std::string script = MultiplePluginScript(plugin_ids,separate_plugins);
 
-      if (script.empty()){
+      if (script.empty() && separate_plugins.empty()){
         web::json::value response = web::json::value::object();
         response[default_strings::plugin_error] = web::json::value::string(default_errors::plugin_empty_script);
         return response;
       }else{
 
-        const std::unique_ptr<granada::plugin::Plugin>& plugin = plugin_factory()->Plugin_unique_ptr(this,"none");
-        script = "var __PLUGIN; " + GetJavaScriptPluginCore(plugin.get()) + script;
+        const std::string& event_value_hash = plugin_event_value_hash(event_name);
+        web::json::value response;
+
+        if (script.empty()){
+          response = web::json::value::object();
+        }else{
+          const std::unique_ptr<granada::plugin::Plugin>& plugin = plugin_factory()->Plugin_unique_ptr(this,"none");
+          script = "var __PLUGIN; " + GetJavaScriptPluginCore(plugin.get()) + script;
 
-        // cache script so it can be reused
-        cache()->Write(plugin_event_value_hash(event_name),entity_keys::plugin_event_script,script);  
-        return Run(script,event_name,parameters);
+          // cache script so it can be reused
+          cache()->Write(event_value_hash,entity_keys::plugin_event_script,script);  
+          response = Run(script,event_name,parameters);
+        }
+
+        if (!separate_plugins.empty()){
+
+          // cache the ids of the native and resident plug-ins
+          // so they also run when the cached script is reused.
+          std::string separate_plugin_ids;
+          for (auto it = separate_plugins.begin(); it != separate_plugins.end(); ++it){
+            if (!separate_plugin_ids.empty()){
+              separate_plugin_ids += ",";
+            }
+            separate_plugin_ids += (*it)->GetId();
+            RunSeparately(it->get(),parameters,event_name,response);
+          }
+          cache()->Write(event_value_hash,entity_keys::plugin_event_separate_ids,separate_plugin_ids);
+        }
+
+        return response;
       }
 
     }
@@ -229,8 +305,9 @@ namespace granada{
         // check if a script containing the plug-ins
         // is already cached, if so use it.
         std::string script = cache()->Read(event_value_hash,entity_keys::plugin_event_script);
+        const std::string& separate_plugin_ids_str = cache()->Read(event_value_hash,entity_keys::plugin_event_separate_ids);
 
-        if (script.empty()){
+        if (script.empty() && separate_plugin_ids_str.empty()){
 
           // script is not cached, we have to form it, for doing so, we put all the
           // scripts of the plug-ins listening to the fired event in a single script
@@ -251,7 +328,22 @@ namespace granada{
           }
 
         }else{
-          response_data = Run(script,event_name,parameters);
+
+          if (script.empty()){
+            response_data = web::json::value::object();
+          }else{
+            response_data = Run(script,event_name,parameters);
+          }
+
+          // run the native and resident plug-ins listening to the event.
+          std::vector<std::string> separate_plugin_ids;
+          granada::util::string::split(separate_plugin_ids_str,',',separate_plugin_ids);
+          for (auto it = separate_plugin_ids.begin(); it != separate_plugin_ids.end(); ++it){
+            const std::unique_ptr<granada::plugin::Plugin>& plugin = GetPluginById(*it);
+            if (plugin.get() != nullptr){
+              RunSeparately(plugin.get(),parameters,event_name,response_data);
+            }
+          }
         }
 
         response[entity_keys::plugin_parameter_data] = response_data;
@@ -264,7 +356,8 @@ namespace granada{
 
     web::json::value SpidermonkeyPluginHandler::SendMessage(const std::string& from, const std::vector<std::string>& to_ids, const web::json::value& message){
 
-      std::string script = MultiplePluginScript(to_ids);
+      std::vector<std::unique_ptr<granada::plugin::Plugin>> separate_plugins;
+      std::string script = MultiplePluginScript(to_ids,separate_plugins);
 
       web::json::value response_data;
       
@@ -283,10 +376,83 @@ namespace granada{
 
       }
 
+      if (!separate_plugins.empty()){
+        if (!response_data.is_object()){
+          response_data = web::json::value::object();
+        }
+
+        // as with the javascript plug-ins, only the responses
+        // without error are returned.
+        const std::string& message_str = message.serialize();
+        for (auto it = separate_plugins.begin(); it != separate_plugins.end(); ++it){
+          web::json::value message_response;
+          if ((*it)->IsNative()){
+            if (!IsTrustedNativePath((*it)->GetScript())){
+              continue;
+            }
+            message_response = granada::util::string::to_json(native_runner()->OnMessage((*it)->GetScript(),(*it)->GetId(),id_,(*it)->GetConfiguration().serialize(),message_str,from));
+          }else{
+            const std::string& on_message_script = "__onMessage(" + granada::util::string::stringified_json(message_str) + ",\"" + from + "\");";
+            if ((*it)->IsResident()){
+              message_response = granada::util::string::to_json(GetResidentPlugin(it->get())->Run(on_message_script));
+            }else{
+
+              // cacheable plug-in, only its runs are cached.
+              RunnerLock();
+              message_response = granada::util::string::to_json(runner()->Run(GetJavaScriptPluginCore(it->get()) + " var __PLUGIN = " + (*it)->GetScript() + "; " + on_message_script));
+            }
+          }
+          if (!message_response.has_field(default_strings::plugin_error)){
+            web::json::value plugin_response = web::json::value::object();
+            plugin_response[entity_keys::plugin_parameter_data] = std::move(message_response);
+            response_data[(*it)->GetId()] = std::move(plugin_response);
+          }
+        }
+      }
+
       return response_data;
     }
 
 
+    void SpidermonkeyPluginHandler::Remove(const std::string& plugin_id){
+      StopResidentPlugin(plugin_id);
+      plugin_results_.DestroyPrefix(plugin_result_prefix(plugin_id));
+      PluginHandler::Remove(plugin_id);
+    }
+
+
+    void SpidermonkeyPluginHandler::Stop(){
+
+      // stop the resident plug-ins of this Plug-in Handler,
+      // their last state is checkpointed before the plug-in
+      // stores are removed.
+      const std::string& prefix = plugin_value_hash("");
+      std::vector<std::shared_ptr<granada::plugin::ResidentPlugin>> resident_plugins;
+      {
+        std::lock_guard<std::mutex> lg(resident_plugins_mtx_);
+        auto it = resident_plugins_.lower_bound(prefix);
+        while (it != resident_plugins_.end() && it->first.compare(0, prefix.size(), prefix) == 0){
+          resident_plugins.push_back(std::move(it->second));
+          it = resident_plugins_.erase(it);
+        }
+      }
+      for (auto it = resident_plugins.begin(); it != resident_plugins.end(); ++it){
+        (*it)->Stop();
+      }
+
+      // forget the results of the plug-ins of this Plug-in Handler.
+      plugin_results_.DestroyPrefix(prefix);
+
+      PluginHandler::Stop();
+    }
+
+
+    void SpidermonkeyPluginHandler::LoadProperties(){
+      PluginHandler::LoadProperties();
+      plugin_results_.set_max_size(granada::util::configuration::Int(granada::util::configuration::plugin_cache_size));
+    }
+
+
     web::json::value SpidermonkeyPluginHandler::ExtendsAddition(const web::json::value& extended_plugin_extends, const web::json::value& plugin_extends, const std::string& plugin_id){
       if (plugin_extends.is_null() || !plugin_extends.is_array()){
         if (!extended_plugin_extends.is_null() && extended_plugin_extends.is_array()){
@@ -396,12 +562,18 @@ namespace granada{
         // fire a plug-in configuration load after event.
         parameters[entity_keys::plugin_configuration] = configuration;
         const std::string& configuration_load_after_event = default_strings::plugin_configuration_load_event + "-" + default_strings::plugin_after;
-        PluginHandler::Fire(configuration_load_after_event,parameters);
-        PluginHandler::Fire(plugin->GetId() + "-" + configuration_load_after_event,parameters);
+        FireAsync(configuration_load_after_event,parameters);
+        FireAsync(plugin->GetId() + "-" + configuration_load_after_event,parameters);
         
         // retrieve and set the plug-in script.
         const std::string& script_path = cache()->Read(plugin_loader_hash,entity_keys::plugin_script);
-        plugin->SetScript(granada::util::file::ContentAsString(script_path));
+        if (plugin->IsNative()){
+
+          // the script of a native plug-in is the path of its shared object.
+          plugin->SetScript(script_path);
+        }else{
+          plugin->SetScript(granada::util::file::ContentAsString(script_path));
+        }
 
         // plug-in successfully loaded.
         return true;
@@ -414,6 +586,12 @@ namespace granada{
 
 
     std::string SpidermonkeyPluginHandler::MultiplePluginScript(const std::vector<std::string>& plugin_ids){
+      std::vector<std::unique_ptr<granada::plugin::Plugin>> separate_plugins;
+      return MultiplePluginScript(plugin_ids,separate_plugins);
+    }
+
+
+    std::string SpidermonkeyPluginHandler::MultiplePluginScript(const std::vector<std::string>& plugin_ids, std::vector<std::unique_ptr<granada::plugin::Plugin>>& separate_plugins){
       // synchronously run plug-ins
       int i = 0;
       
@@ -421,9 +599,13 @@ namespace granada{
       std::string configurations = "";
       for (auto it = plugin_ids.begin(); it != plugin_ids.end(); ++it){
 
-        const std::unique_ptr<granada::plugin::Plugin>& plugin = GetPluginById(*it);
+        std::unique_ptr<granada::plugin::Plugin> plugin = GetPluginById(*it);
 
-        if (plugin.get() != nullptr){
+        if (plugin.get() != nullptr && (plugin->IsNative() || plugin->IsResident() || plugin->CacheTTL() > 0)){
+
+          // native, resident and cacheable plug-ins are not part of the script.
+          separate_plugins.push_back(std::move(plugin));
+        }else if (plugin.get() != nullptr){
 
           if (i>0){
             script += ",";
@@ -481,6 +663,161 @@ namespace granada{
 
 
 
+    web::json::value SpidermonkeyPluginHandler::RunNative(granada::plugin::Plugin* plugin, web::json::value& parameters, const std::string& event_name){
+
+      if (native_runner() == nullptr){
+        web::json::value response = web::json::value::object();
+        response[default_strings::plugin_error] = web::json::value::string(default_errors::runner_initialization_error);
+        return response;
+      }
+
+      // the header of a plug-in added by a client may say it is native,
+      // only the shared objects of the trusted repositories are run.
+      if (!IsTrustedNativePath(plugin->GetScript())){
+        web::json::value response = web::json::value::object();
+        response[default_strings::plugin_error] = web::json::value::string(default_errors::plugin_native_not_allowed);
+        response[default_strings::plugin_error_description] = web::json::value::string(default_error_descriptions::plugin_native_not_allowed);
+        return response;
+      }
+
+      const std::string& plugin_id = plugin->GetId();
+      web::json::value plugin_parameters = parameters;
+
+      // fire the same events the javascript plug-ins fire when they run,
+      // the before and after listeners can replace the parameters and the response.
+      PluginHandler::Fire(plugin_id + "-" + default_strings::plugin_before,plugin_parameters,[&plugin_parameters](const web::json::value& data){
+        const web::json::value& new_parameters = granada::util::json::first(granada::util::json::as_object(data,entity_keys::plugin_parameter_data));
+        if (!new_parameters.is_null()){
+          plugin_parameters = granada::util::json::as_object(new_parameters,entity_keys::plugin_parameter_data);
+        }
+      },[](const web::json::value& data){});
+
+      PluginHandler::Fire(plugin_id + "-" + default_strings::plugin_in_process,plugin_parameters);
+
+      web::json::value response_data = granada::util::string::to_json(native_runner()->Run(plugin->GetScript(),plugin_id,id_,plugin->GetConfiguration().serialize(),plugin_parameters.serialize(),event_name));
+
+      PluginHandler::Fire(plugin_id + "-" + default_strings::plugin_after,plugin_parameters,[&response_data](const web::json::value& data){
+        const web::json::value& new_response_data = granada::util::json::first(granada::util::json::as_object(data,entity_keys::plugin_parameter_data));
+        if (!new_response_data.is_null()){
+          response_data = granada::util::json::as_object(new_response_data,entity_keys::plugin_parameter_data);
+        }
+      },[](const web::json::value& data){});
+
+      return response_data;
+    }
+
+
+    web::json::value SpidermonkeyPluginHandler::RunResident(granada::plugin::Plugin* plugin, web::json::value& parameters, const std::string& event_name){
+      std::string script = "__wrappedRun(" + granada::util::string::stringified_json(parameters.serialize());
+      if (event_name.empty()){
+        script += ",null);";
+      }else{
+        script += ",\"" + event_name + "\");";
+      }
+      return granada::util::string::to_json(GetResidentPlugin(plugin)->Run(script));
+    }
+
+
+    void SpidermonkeyPluginHandler::RunSeparately(granada::plugin::Plugin* plugin, web::json::value& parameters, const std::string& event_name, web::json::value& response){
+      web::json::value response_data = RunPlugin(plugin,parameters,event_name);
+      if (!response.is_object()){
+        response = web::json::value::object();
+      }
+      if (response_data.has_field(default_strings::plugin_error)){
+        response[plugin->GetId()] = std::move(response_data);
+      }else{
+        web::json::value plugin_response = web::json::value::object();
+        plugin_response[entity_keys::plugin_parameter_data] = std::move(response_data);
+        response[plugin->GetId()] = std::move(plugin_response);
+      }
+    }
+
+
+    std::shared_ptr<granada::plugin::ResidentPlugin> SpidermonkeyPluginHandler::GetResidentPlugin(granada::plugin::Plugin* plugin){
+      const std::string& plugin_id = plugin->GetId();
+      const std::string& resident_plugin_key = plugin_value_hash(plugin_id);
+
+      // the configuration is part of the plug-in core, so a new
+      // configuration also gives a different script.
+      const std::string& script = GetJavaScriptPluginCore(plugin) + " var __PLUGIN = " + plugin->GetScript() + ";";
+
+      std::shared_ptr<granada::plugin::ResidentPlugin> outdated_resident_plugin;
+      {
+        std::lock_guard<std::mutex> lg(resident_plugins_mtx_);
+        auto it = resident_plugins_.find(resident_plugin_key);
+        if (it != resident_plugins_.end()){
+          if (it->second->script() == script){
+            return it->second;
+          }
+          outdated_resident_plugin = std::move(it->second);
+          resident_plugins_.erase(it);
+        }
+      }
+
+      // stopped outside the lock, its last calls may need
+      // other resident plug-ins. Its state is checkpointed
+      // so the new resident plug-in starts with it.
+      if (outdated_resident_plugin){
+        outdated_resident_plugin->Stop();
+      }
+
+      const std::string& store_hash = plugin_store_hash(id_,plugin_id);
+      granada::cache::CacheHandler* cache_handler = cache();
+      std::shared_ptr<granada::plugin::ResidentPlugin> resident_plugin(new granada::plugin::ResidentPlugin(
+        runner(),
+        script,
+        cache_handler->Read(store_hash,entity_keys::plugin_resident_state),
+        [cache_handler,store_hash](const std::string& state){
+          cache_handler->Write(store_hash,entity_keys::plugin_resident_state,state);
+        },
+        granada::util::configuration::Int(granada::util::configuration::plugin_resident_mailbox_size),
+        granada::util::configuration::Int(granada::util::configuration::plugin_resident_timeout),
+        granada::util::configuration::Int(granada::util::configuration::plugin_resident_checkpoint_interval)));
+
+      std::lock_guard<std::mutex> lg(resident_plugins_mtx_);
+      std::shared_ptr<granada::plugin::ResidentPlugin>& running_resident_plugin = resident_plugins_[resident_plugin_key];
+      if (running_resident_plugin && running_resident_plugin->script() == script){
+
+        // started by another thread meanwhile, the one
+        // created here has not run and is just discarded.
+        return running_resident_plugin;
+      }
+      running_resident_plugin = resident_plugin;
+      return resident_plugin;
+    }
+
+
+    void SpidermonkeyPluginHandler::StopResidentPlugin(const std::string& plugin_id){
+      std::shared_ptr<granada::plugin::ResidentPlugin> resident_plugin;
+      {
+        std::lock_guard<std::mutex> lg(resident_plugins_mtx_);
+        auto it = resident_plugins_.find(plugin_value_hash(plugin_id));
+        if (it != resident_plugins_.end()){
+          resident_plugin = std::move(it->second);
+          resident_plugins_.erase(it);
+        }
+      }
+      if (resident_plugin){
+        resident_plugin->Stop();
+      }
+    }
+
+
+    std::string SpidermonkeyPluginHandler::PluginResultKey(granada::plugin::Plugin* plugin, const web::json::value& parameters, const std::string& event_name){
+
+      // a new script or configuration gives a new version,
+      // so the results of the previous one are not used.
+      // the script of a native plug-in is the path of its shared
+      // object, the version of the file tells when it is replaced.
+      std::string script = plugin->GetScript();
+      if (plugin->IsNative()){
+        script += "|" + granada::runner::NativeRunner::Version(script);
+      }
+      const std::size_t version = std::hash<std::string>()(script + plugin->GetConfiguration().serialize());
+      return plugin_result_prefix(plugin->GetId()) + std::to_string(version) + "|" + event_name + "|" + granada::util::json::canonical(parameters);
+    }
+
+
     std::string SpidermonkeyPluginHandler::GetJavaScriptPluginCore(granada::plugin::Plugin* plugin){
       std::string script_extension = javascript_plugin_core_;
       std::deque<std::pair<std::string,std::string>> values;
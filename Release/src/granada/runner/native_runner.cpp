@@ -0,0 +1,266 @@
+/**
+  * Copyright (c) <2016> Web App SDK granada <afernandez@cookinapps.io>
+  *
+  * This source code is licensed under the MIT license.
+  *
+  * Permission is hereby granted, free of charge, to any person obtaining a copy
+  * of this software and associated documentation files (the "Software"), to deal
+  * in the Software without restriction, including without limitation the rights
+  * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  * copies of the Software, and to permit persons to whom the Software is
+  * furnished to do so, subject to the following conditions:
+  *
+  * The above copyright notice and this permission notice shall be included in
+  * all copies or substantial portions of the Software.
+  *
+  * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  * SOFTWARE.
+  *
+  * Run native plug-ins: shared objects implementing the C interface
+  * of granada/plugin/native_plugin.h.
+  */
+
+#include "granada/runner/native_runner.h"
+#include <cstdlib>
+#include <cstring>
+#include <dlfcn.h>
+#include <fstream>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "granada/util/metrics.h"
+#include "granada/util/tracing.h"
+
+namespace granada{
+  namespace runner{
+
+    std::map<std::string,std::shared_ptr<NativeRunner::Library>> NativeRunner::libraries_;
+    std::set<std::string> NativeRunner::opened_paths_;
+    std::mutex NativeRunner::libraries_mtx_;
+
+    // native plug-ins are shared objects with the so extension.
+    std::string NativeRunner::extensions_arr_[1] = {"so"};
+    std::vector<std::string> NativeRunner::extensions_(extensions_arr_, extensions_arr_ + sizeof(extensions_arr_)/sizeof(*extensions_arr_));
+
+
+    std::string NativeRunner::Run(const std::string& _script){
+      return Run(_script, std::string(), std::string(), "{}", "{}", std::string());
+    }
+
+
+    std::string NativeRunner::Run(const std::string& library_path, const std::string& plugin_id, const std::string& plugin_handler_id, const std::string& configuration, const std::string& parameters, const std::string& event_name){
+      static granada::util::metrics::Histogram& latency = granada::util::metrics::GetHistogram("granada_runner_run_seconds", "Time spent running scripts, including the creation of the runtime.", "runner=\"native\"");
+      granada::util::metrics::Timer timer(latency);
+      granada::util::tracing::Span span("runner.native.run");
+
+      const std::shared_ptr<Library>& library = GetLibrary(library_path);
+      if (library->handle == nullptr){
+        return Error(default_errors::runner_initialization_error, library->error);
+      }
+
+      granada_plugin_context context;
+      Context(context, plugin_id, plugin_handler_id, configuration);
+
+      if (!event_name.empty() && library->on_event != nullptr){
+        return Response(*library, library->on_event(&context, event_name.c_str(), parameters.c_str()));
+      }
+      return Response(*library, library->run(&context, parameters.c_str(), event_name.empty() ? nullptr : event_name.c_str()));
+    }
+
+
+    std::string NativeRunner::OnMessage(const std::string& library_path, const std::string& plugin_id, const std::string& plugin_handler_id, const std::string& configuration, const std::string& message, const std::string& from){
+      granada::util::tracing::Span span("runner.native.on_message");
+
+      const std::shared_ptr<Library>& library = GetLibrary(library_path);
+      if (library->handle == nullptr){
+        return Error(default_errors::runner_initialization_error, library->error);
+      }
+      if (library->on_message == nullptr){
+        return Error(default_errors::runner_undefined_function, default_strings::runner_native_on_message);
+      }
+
+      granada_plugin_context context;
+      Context(context, plugin_id, plugin_handler_id, configuration);
+      return Response(*library, library->on_message(&context, message.c_str(), from.c_str()));
+    }
+
+
+    NativeRunner::Library::~Library(){
+      if (handle != nullptr){
+        dlclose(handle);
+      }
+    }
+
+
+    std::string NativeRunner::Version(const std::string& library_path){
+      struct stat st;
+      if (stat(library_path.c_str(), &st) != 0){
+        return std::string();
+      }
+      return std::to_string(st.st_dev) + ":" + std::to_string(st.st_ino) + ":" + std::to_string(st.st_size) + ":" + std::to_string(st.st_mtim.tv_sec) + "." + std::to_string(st.st_mtim.tv_nsec);
+    }
+
+
+    std::shared_ptr<NativeRunner::Library> NativeRunner::GetLibrary(const std::string& library_path){
+      const std::string& version = Version(library_path);
+
+      std::lock_guard<std::mutex> lg(NativeRunner::libraries_mtx_);
+
+      auto it = NativeRunner::libraries_.find(library_path);
+      if (it != NativeRunner::libraries_.end() && !version.empty() && it->second->version == version){
+        return it->second;
+      }
+
+      std::shared_ptr<Library> library(new Library());
+      library->version = version;
+      if (version.empty()){
+        library->error = library_path + ": the shared object can not be read.";
+        return library;
+      }
+
+      if (NativeRunner::opened_paths_.insert(library_path).second){
+        Open(*library, library_path, library_path);
+      }else{
+        // the path has already been opened, dlopen would return the
+        // version loaded, open a private copy of the new version instead.
+        const std::string& copy_path = Copy(library_path);
+        if (copy_path.empty()){
+          library->error = library_path + ": the shared object can not be copied.";
+        }else{
+          Open(*library, copy_path, library_path);
+          // the shared object stays mapped after its file is removed.
+          unlink(copy_path.c_str());
+        }
+      }
+
+      // failures are not kept, the shared object is tried again in the next run.
+      // the replaced version is closed when the last run using it ends.
+      if (library->handle != nullptr){
+        NativeRunner::libraries_[library_path] = library;
+      }
+      return library;
+    }
+
+
+    std::string NativeRunner::Copy(const std::string& library_path){
+      const char* tmpdir = std::getenv("TMPDIR");
+      std::string copy_path = std::string(tmpdir != nullptr && *tmpdir != '\0' ? tmpdir : "/tmp") + "/granada-native-XXXXXX";
+      const int fd = mkstemp(&copy_path[0]);
+      if (fd == -1){
+        return std::string();
+      }
+      close(fd);
+
+      std::ifstream in(library_path, std::ios::binary);
+      std::ofstream out(copy_path, std::ios::binary | std::ios::trunc);
+      out << in.rdbuf();
+      out.close();
+      if (!in || !out){
+        unlink(copy_path.c_str());
+        return std::string();
+      }
+      return copy_path;
+    }
+
+
+    void NativeRunner::Open(Library& library, const std::string& path, const std::string& name){
+      void* handle = dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+      if (handle == nullptr){
+        const char* error = dlerror();
+        library.error = error ? error : name;
+      }else{
+        library.run = reinterpret_cast<char* (*)(const granada_plugin_context*, const char*, const char*)>(dlsym(handle, default_strings::runner_native_run.c_str()));
+        library.on_event = reinterpret_cast<char* (*)(const granada_plugin_context*, const char*, const char*)>(dlsym(handle, default_strings::runner_native_on_event.c_str()));
+        library.on_message = reinterpret_cast<char* (*)(const granada_plugin_context*, const char*, const char*)>(dlsym(handle, default_strings::runner_native_on_message.c_str()));
+        library.free = reinterpret_cast<void (*)(char*)>(dlsym(handle, default_strings::runner_native_free.c_str()));
+        int (*init)(unsigned int) = reinterpret_cast<int (*)(unsigned int)>(dlsym(handle, default_strings::runner_native_init.c_str()));
+
+        if (library.run == nullptr){
+          library.error = name + ": " + default_strings::runner_native_run + " is not exported.";
+        }else if (init != nullptr && init(GRANADA_NATIVE_PLUGIN_ABI_VERSION) != 0){
+          library.error = name + ": " + default_strings::runner_native_init + " failed.";
+        }
+
+        if (library.error.empty()){
+          library.handle = handle;
+        }else{
+          dlclose(handle);
+        }
+      }
+    }
+
+
+    std::string NativeRunner::Response(const Library& library, char* response){
+      if (response == nullptr){
+        return "{}";
+      }
+      std::string response_str(response);
+      if (library.free != nullptr){
+        library.free(response);
+      }else{
+        std::free(response);
+      }
+      return response_str;
+    }
+
+
+    std::string NativeRunner::Error(const std::string& error, const std::string& error_description){
+      web::json::value response = web::json::value::object();
+      response[default_strings::runner_error] = web::json::value::string(error);
+      response[default_strings::runner_error_description] = web::json::value::string(error_description);
+      return response.serialize();
+    }
+
+
+    char* NativeRunner::Call(void* host, const char* function_name, const char* parameters){
+      std::string response_str;
+      NativeRunner* runner = static_cast<NativeRunner*>(host);
+
+      if (runner == nullptr || function_name == nullptr){
+        response_str = Error(default_errors::runner_undefined_function, std::string());
+      }else{
+        web::json::value params;
+        try{
+          params = web::json::value::parse(parameters ? parameters : "");
+        }catch(const web::json::json_exception& e){
+          params = web::json::value::object();
+          params[default_strings::runner_error] = web::json::value::string(default_errors::runner_malformed_parameters);
+          params[default_strings::runner_error_description] = web::json::value::string(default_error_descriptions::runner_malformed_parameters);
+        }
+
+        // exceptions must not go through the plug-in frames.
+        try{
+          response_str = runner->functions_->Get(function_name)(params).serialize();
+        }catch(...){
+          response_str = "{}";
+        }
+      }
+
+      char* response = static_cast<char*>(std::malloc(response_str.size() + 1));
+      if (response != nullptr){
+        std::memcpy(response, response_str.c_str(), response_str.size() + 1);
+      }
+      return response;
+    }
+
+
+    void NativeRunner::Release(char* str){
+      std::free(str);
+    }
+
+
+    void NativeRunner::Context(granada_plugin_context& context, const std::string& plugin_id, const std::string& plugin_handler_id, const std::string& configuration){
+      context.plugin_id = plugin_id.c_str();
+      context.plugin_handler_id = plugin_handler_id.c_str();
+      context.configuration = configuration.c_str();
+      context.host = this;
+      context.call = &NativeRunner::Call;
+      context.release = &NativeRunner::Release;
+    }
+
+  }
+}
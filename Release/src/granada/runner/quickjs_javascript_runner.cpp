@@ -0,0 +1,247 @@
+/**
+  * Copyright (c) <2016> Web App SDK granada <afernandez@cookinapps.io>
+  *
+  * This source code is licensed under the MIT license.
+  *
+  * Permission is hereby granted, free of charge, to any person obtaining a copy
+  * of this software and associated documentation files (the "Software"), to deal
+  * in the Software without restriction, including without limitation the rights
+  * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  * copies of the Software, and to permit persons to whom the Software is
+  * furnished to do so, subject to the following conditions:
+  *
+  * The above copyright notice and this permission notice shall be included in
+  * all copies or substantial portions of the Software.
+  *
+  * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  * SOFTWARE.
+  *
+  * Run javascript using QuickJS, a small embeddable JavaScript engine.
+  * https://bellard.org/quickjs/
+  */
+
+#include "granada/runner/quickjs_javascript_runner.h"
+#include "granada/util/metrics.h"
+#include "granada/util/tracing.h"
+
+namespace granada{
+  namespace runner{
+
+    std::shared_ptr<granada::Functions> QuickJSJavascriptRunner::functions_ = std::shared_ptr<granada::Functions>(new granada::FunctionsMap());
+
+    // the files containing scripts used in this runner may have the js extensions.
+    std::string QuickJSJavascriptRunner::extensions_arr_[1] = {"js"};
+    std::vector<std::string> QuickJSJavascriptRunner::extensions_(extensions_arr_, extensions_arr_ + sizeof(extensions_arr_)/sizeof(*extensions_arr_));
+
+
+    namespace{
+
+      /**
+       * QuickJS runtime of a thread, freed when the thread exits.
+       */
+      struct ThreadRuntime{
+
+        JSRuntime* rt;
+
+        // number of scripts the thread is running, more than one
+        // when a c++ function called from a script runs another script.
+        int depth = 0;
+
+        ThreadRuntime() : rt(JS_NewRuntime()){
+          if (rt){
+            JS_SetMemoryLimit(rt, default_numbers::runner_quickjs_memory_limit);
+            JS_SetMaxStackSize(rt, default_numbers::runner_quickjs_max_stack_size);
+          }
+        };
+
+        ~ThreadRuntime(){
+          if (rt){
+            JS_FreeRuntime(rt);
+          }
+        };
+
+      };
+
+
+      ThreadRuntime& thread_runtime(){
+        thread_local ThreadRuntime runtime;
+        return runtime;
+      }
+
+    }
+
+
+    JSRuntime* QuickJSJavascriptRunner::runtime(){
+      return thread_runtime().rt;
+    }
+
+
+    std::string QuickJSJavascriptRunner::Run(const std::string& _script){
+      static granada::util::metrics::Histogram& latency = granada::util::metrics::GetHistogram("granada_runner_run_seconds", "Time spent running scripts, including the creation of the runtime.", "runner=\"quickjs\"");
+      granada::util::metrics::Timer timer(latency);
+      granada::util::tracing::Span span("runner.quickjs.run");
+
+      ThreadRuntime& runtime = thread_runtime();
+      if (!runtime.rt){
+        return runner_initialization_error_;
+      }
+
+      // the stack limit is relative to where the outermost script starts.
+      if (runtime.depth == 0){
+        JS_UpdateStackTop(runtime.rt);
+      }
+
+      JSContext* cx = JS_NewContext(runtime.rt);
+      if (!cx){
+        return runner_initialization_error_;
+      }
+      ++runtime.depth;
+
+      DefineFunctions(cx);
+      const std::string& response = Evaluate(cx, _script);
+
+      --runtime.depth;
+      JS_FreeContext(cx);
+
+      return response;
+    }
+
+
+    std::unique_ptr<Instance> QuickJSJavascriptRunner::Instance_unique_ptr(){
+      return std::unique_ptr<Instance>(new QuickJSJavascriptInstance());
+    }
+
+
+    void QuickJSJavascriptRunner::DefineFunctions(JSContext* cx){
+      JSValue global = JS_GetGlobalObject(cx);
+
+      std::shared_ptr<granada::FunctionsIterator> it = QuickJSJavascriptRunner::functions_->make_iterator();
+
+      while(it->has_next()){
+        granada::Function function = it->next();
+        JSValue name = JS_NewStringLen(cx, function.name.data(), function.name.size());
+        JS_SetPropertyStr(cx, global, function.name.c_str(), JS_NewCFunctionData(cx, FunctionWrapper, 1, 0, 1, &name));
+        JS_FreeValue(cx, name);
+      }
+
+      JS_FreeValue(cx, global);
+    }
+
+
+    std::string QuickJSJavascriptRunner::Evaluate(JSContext* cx, const std::string& _script){
+      std::string response;
+
+      // std::string is null terminated as QuickJS requires.
+      JSValue rval = JS_Eval(cx, _script.c_str(), _script.size(), "<script>", JS_EVAL_TYPE_GLOBAL);
+      const char* bytes = nullptr;
+      std::size_t length = 0;
+      if (!JS_IsException(rval)){
+        bytes = JS_ToCStringLen(cx, &length, rval);
+      }
+      if (bytes){
+        response.assign(bytes, length);
+        JS_FreeCString(cx, bytes);
+      }else{
+        JS_FreeValue(cx, JS_GetException(cx));
+        response = "{\"" + default_strings::runner_error + "\":\"" + default_errors::runner_script_error + "\"}";
+      }
+      JS_FreeValue(cx, rval);
+
+      return response;
+    }
+
+
+    QuickJSJavascriptInstance::QuickJSJavascriptInstance() : cx_(nullptr){
+      JSRuntime* rt = thread_runtime().rt;
+      if (rt){
+        cx_ = JS_NewContext(rt);
+        if (cx_){
+          QuickJSJavascriptRunner::DefineFunctions(cx_);
+        }
+      }
+    }
+
+
+    QuickJSJavascriptInstance::~QuickJSJavascriptInstance(){
+      if (cx_){
+        JS_FreeContext(cx_);
+      }
+    }
+
+
+    std::string QuickJSJavascriptInstance::Run(const std::string& _script){
+      static granada::util::metrics::Histogram& latency = granada::util::metrics::GetHistogram("granada_runner_run_seconds", "Time spent running scripts, including the creation of the runtime.", "runner=\"quickjs_instance\"");
+      granada::util::metrics::Timer timer(latency);
+      granada::util::tracing::Span span("runner.quickjs.instance.run");
+
+      if (!cx_){
+        return "{\"" + default_strings::runner_error + "\":\"" + default_errors::runner_initialization_error + "\"}";
+      }
+
+      ThreadRuntime& runtime = thread_runtime();
+      if (runtime.depth == 0){
+        JS_UpdateStackTop(runtime.rt);
+      }
+
+      ++runtime.depth;
+      const std::string& response = QuickJSJavascriptRunner::Evaluate(cx_, _script);
+      --runtime.depth;
+
+      return response;
+    }
+
+
+    JSValue QuickJSJavascriptRunner::FunctionWrapper(JSContext* cx, JSValueConst this_val, int argc, JSValueConst* argv, int magic, JSValue* func_data){
+
+      // get the name of the function we want to call.
+      std::string function_name;
+      const char* name = JS_ToCString(cx, func_data[0]);
+      if (name){
+        function_name = name;
+        JS_FreeCString(cx, name);
+      }
+
+      if (function_name.empty()){
+        return JS_NewString(cx, default_errors::runner_undefined_function.c_str());
+      }
+
+      // get parameters and call function
+      // between the functions of the functions collection.
+      std::string encoded_str;
+      if (argc > 0){
+        std::size_t length = 0;
+        const char* bytes = JS_ToCStringLen(cx, &length, argv[0]);
+        if (!bytes){
+          return JS_GetException(cx);
+        }
+        encoded_str.assign(bytes, length);
+        JS_FreeCString(cx, bytes);
+      }
+
+      web::json::value params;
+      try{
+        params = web::json::value::parse(encoded_str);
+      }catch(const web::json::json_exception& e){
+        params = web::json::value::object();
+        params[default_strings::runner_error] = web::json::value::string(default_errors::runner_malformed_parameters);
+        params[default_strings::runner_error_description] = web::json::value::string(default_error_descriptions::runner_malformed_parameters);
+      }
+
+      std::string response_str;
+      granada::function_json_json fn = QuickJSJavascriptRunner::functions_->Get(function_name);
+      // exceptions must not go through the QuickJS frames.
+      try{
+        response_str = fn(params).serialize();
+      }catch(...){
+        response_str = "{}";
+      }
+
+      return JS_NewStringLen(cx, response_str.data(), response_str.size());
+    }
+  }
+}
@@ -27,6 +27,8 @@
   */
 
 #include "granada/runner/spidermonkey_javascript_runner.h"
+#include "granada/util/metrics.h"
+#include "granada/util/tracing.h"
 
 namespace granada{
   namespace runner{
@@ -53,6 +55,10 @@ namespace granada{
 
 
     std::string SpiderMonkeyJavascriptRunner::Run(const std::string& _script){
+      static granada::util::metrics::Histogram& latency = granada::util::metrics::GetHistogram("granada_runner_run_seconds", "Time spent running scripts, including the creation of the runtime.", "runner=\"spidermonkey\"");
+      granada::util::metrics::Timer timer(latency);
+      granada::util::tracing::Span span("runner.spidermonkey.run");
+
       JSRuntime* rt = JS_NewRuntime(default_numbers::runner_spidermonkey_runtime_maxbytes);
       if (!rt){
         return runner_initialization_error_;
@@ -114,6 +120,81 @@ namespace granada{
     }
 
 
+    std::unique_ptr<Instance> SpiderMonkeyJavascriptRunner::Instance_unique_ptr(){
+      return std::unique_ptr<Instance>(new SpiderMonkeyJavascriptInstance());
+    }
+
+
+    SpiderMonkeyJavascriptInstance::SpiderMonkeyJavascriptInstance() : rt_(nullptr), cx_(nullptr){
+      rt_ = JS_NewRuntime(default_numbers::runner_spidermonkey_runtime_maxbytes);
+      if (rt_){
+        cx_ = JS_NewContext(rt_, default_numbers::runner_spidermonkey_context_stackchunksize);
+      }
+      if (cx_){
+        JSAutoRequest ar(cx_);
+        JS::RootedObject global(cx_, JS_NewGlobalObject(cx_, &SpiderMonkeyJavascriptRunner::global_class_, nullptr, JS::FireOnNewGlobalHook));
+        if (global){
+          JSAutoCompartment ac(cx_, global);
+          JS_InitStandardClasses(cx_, global);
+
+          std::shared_ptr<granada::FunctionsIterator> it = SpiderMonkeyJavascriptRunner::functions_->make_iterator();
+          while(it->has_next()){
+            granada::Function function = it->next();
+            JS_DefineFunction(cx_, global, function.name.c_str(), SpiderMonkeyJavascriptRunner::FunctionWrapper, 1, 0);
+          }
+
+          global_.reset(new JS::PersistentRootedObject(cx_, global));
+        }
+      }
+    }
+
+
+    SpiderMonkeyJavascriptInstance::~SpiderMonkeyJavascriptInstance(){
+      // the global object has to be unrooted before the context is destroyed.
+      global_.reset();
+      if (cx_){
+        JS_DestroyContext(cx_);
+      }
+      if (rt_){
+        JS_DestroyRuntime(rt_);
+      }
+    }
+
+
+    std::string SpiderMonkeyJavascriptInstance::Run(const std::string& _script){
+      static granada::util::metrics::Histogram& latency = granada::util::metrics::GetHistogram("granada_runner_run_seconds", "Time spent running scripts, including the creation of the runtime.", "runner=\"spidermonkey_instance\"");
+      granada::util::metrics::Timer timer(latency);
+      granada::util::tracing::Span span("runner.spidermonkey.instance.run");
+
+      if (!global_){
+        return "{\"" + default_strings::runner_error + "\":\"" + default_errors::runner_initialization_error + "\"}";
+      }
+
+      std::string response;
+
+      JSAutoRequest ar(cx_);
+      JSAutoCompartment ac(cx_, *global_);
+
+      JS::RootedValue rval(cx_);
+      JS::CompileOptions options(cx_);
+      bool ok = JS::Evaluate(cx_, *global_, options, _script.c_str(), _script.size(), &rval);
+      if (ok){
+        // scripts keeping variables may end with a statement
+        // that has no value, such as a var declaration.
+        if (rval.isString()){
+          char * bytes = JS_EncodeString(cx_, rval.toString());
+          response = bytes;
+          JS_free(cx_, bytes);
+        }
+      }else{
+        JS_ClearPendingException(cx_);
+        response = "{\"" + default_strings::runner_error + "\":\"" + default_errors::runner_script_error + "\"}";
+      }
+
+      return response;
+    }
+
+
     bool SpiderMonkeyJavascriptRunner::FunctionWrapper(JSContext *cx, unsigned argc, JS::Value *vp){
 
       std::string error;
@@ -1,5 +1,6 @@
 
 #include "granada/util/application.h"
+#include "granada/util/configuration.h"
 
 namespace granada{
   namespace util{
@@ -43,11 +44,7 @@ namespace granada{
 
 
       const std::string GetProperty(const std::string& name){
-        if (property_file_ == NULL){
-          std::string configuration_file_path = get_selfpath() + "/server.conf";
-          property_file_ = std::unique_ptr<granada::util::file::PropertyFile>(new granada::util::file::PropertyFile(configuration_file_path));
-        }
-        return property_file_->GetProperty(name);
+        return granada::util::configuration::Current()->GetProperty(name);
       }
     }
   }
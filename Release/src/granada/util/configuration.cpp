@@ -0,0 +1,271 @@
+/**
+  * Copyright (c) <2016> Web App SDK granada <afernandez@cookinapps.io>
+  *
+  * This source code is licensed under the MIT license.
+  *
+  * Permission is hereby granted, free of charge, to any person obtaining a copy
+  * of this software and associated documentation files (the "Software"), to deal
+  * in the Software without restriction, including without limitation the rights
+  * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  * copies of the Software, and to permit persons to whom the Software is
+  * furnished to do so, subject to the following conditions:
+  *
+  * The above copyright notice and this permission notice shall be included in
+  * all copies or substantial portions of the Software.
+  *
+  * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  * SOFTWARE.
+  *
+  * Typed configuration: the properties of the server configuration
+  * file parsed once into typed values.
+  *
+  */
+
+#include "granada/util/configuration.h"
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <thread>
+#ifndef _WIN32
+#include <cerrno>
+#include <csignal>
+#include <unistd.h>
+#endif
+#include "granada/util/application.h"
+#include "granada/util/file.h"
+#include "granada/util/string.h"
+
+namespace granada{
+  namespace util{
+    namespace configuration{
+
+      namespace{
+
+        /**
+         * Name, type and default value of the typed properties.
+         */
+        struct Definition{
+          const char* name;
+          Type type;
+          const char* default_value;
+        };
+
+        const Definition definitions[] = {
+#define _GRANADA_PROPERTIES
+#define GRANADA_PROPERTY(name_, type_, default_) {#name_, type_, default_},
+#include "granada/defaults.dat"
+#undef _GRANADA_PROPERTIES
+#undef GRANADA_PROPERTY
+        };
+
+
+        /**
+         * Current snapshot, read and replaced with std::atomic_load and
+         * std::atomic_store. It is not deleted on exit, so the threads
+         * still running can read it.
+         */
+        std::shared_ptr<const Snapshot>& current(){
+          static std::shared_ptr<const Snapshot>* current = new std::shared_ptr<const Snapshot>();
+          return *current;
+        }
+        std::atomic<unsigned long> version_{0};
+        std::once_flag load_once_;
+        std::mutex load_mtx_;
+
+
+        /**
+         * Parses the text of a property into a value of the given type.
+         */
+        bool ParseValue(const Type type, const std::string& text, Value& value){
+          switch (type){
+            case STRING:
+              value.string.assign(text);
+              return true;
+            case INT:
+              try{
+                std::size_t position;
+                value.number = std::stoi(text, &position);
+                return position == text.size();
+              }catch(const std::logic_error e){
+                return false;
+              }
+            case BOOL:
+              return ParseBool(text, value.boolean);
+            case DURATION:
+              return ParseDuration(text, value.duration);
+            case JSON:
+              try{
+                value.json = web::json::value::parse(utility::conversions::to_string_t(text));
+                return true;
+              }catch(const web::json::json_exception e){
+                return false;
+              }
+          }
+          return false;
+        }
+
+#ifndef _WIN32
+        /**
+         * Pipe the signal handler writes to, the reload is done in
+         * a thread reading it as it can't be done in the handler.
+         */
+        int reload_pipe_[2] = {-1, -1};
+        std::once_flag reload_on_signal_once_;
+
+        extern "C" void ReloadSignalHandler(int){
+          const int saved_errno = errno;
+          const char c = 0;
+          if (::write(reload_pipe_[1], &c, 1) < 0){}
+          errno = saved_errno;
+        }
+#endif
+
+      }
+
+
+      Snapshot::Snapshot(const std::string& file_path){
+        file_path_.assign(file_path);
+        granada::util::file::PropertyFile property_file(file_path);
+        properties_ = property_file.properties();
+
+        values_.resize(KEY_COUNT);
+        for (int i = 0; i < KEY_COUNT; i++){
+          const Definition& definition = definitions[i];
+          auto it = properties_.find(definition.name);
+          if (it == properties_.end() || !ParseValue(definition.type, it->second, values_[i])){
+            values_[i] = Value();
+            ParseValue(definition.type, definition.default_value, values_[i]);
+          }
+        }
+      }
+
+
+      const std::string& Snapshot::GetProperty(const std::string& name) const{
+        auto it = properties_.find(name);
+        if (it != properties_.end()){
+          return it->second;
+        }
+        return empty_;
+      }
+
+
+      bool ParseBool(const std::string& text, bool& value){
+        std::string lower(text);
+        granada::util::string::trim(lower);
+        for (auto it = lower.begin(); it != lower.end(); ++it){
+          *it = std::tolower((unsigned char)*it);
+        }
+        if (lower == "on" || lower == "true" || lower == "yes" || lower == "1"){
+          value = true;
+          return true;
+        }
+        if (lower == "off" || lower == "false" || lower == "no" || lower == "0"){
+          value = false;
+          return true;
+        }
+        return false;
+      }
+
+
+      bool ParseDuration(const std::string& text, std::chrono::milliseconds& value){
+        const char* begin = text.c_str();
+        char* end;
+        errno = 0;
+        const double number = std::strtod(begin, &end);
+        if (end == begin || errno != 0){
+          return false;
+        }
+        std::string unit(end);
+        granada::util::string::trim(unit);
+        double milliseconds;
+        if (unit.empty() || unit == "s"){
+          milliseconds = number * 1000;
+        }else if (unit == "ms"){
+          milliseconds = number;
+        }else if (unit == "m"){
+          milliseconds = number * 60000;
+        }else if (unit == "h"){
+          milliseconds = number * 3600000;
+        }else if (unit == "d"){
+          milliseconds = number * 86400000;
+        }else{
+          return false;
+        }
+        value = std::chrono::milliseconds((long long)milliseconds);
+        return true;
+      }
+
+
+      std::shared_ptr<const Snapshot> Current(){
+        std::shared_ptr<const Snapshot> snapshot = std::atomic_load(&current());
+        if (snapshot == nullptr){
+          std::call_once(load_once_, [](){
+            if (std::atomic_load(&current()) == nullptr){
+              Load(granada::util::application::get_selfpath() + "/server.conf");
+            }
+          });
+          snapshot = std::atomic_load(&current());
+        }
+        return snapshot;
+      }
+
+
+      void Load(const std::string& file_path){
+        std::shared_ptr<const Snapshot> snapshot = std::make_shared<const Snapshot>(file_path);
+        std::lock_guard<std::mutex> lg(load_mtx_);
+        const std::shared_ptr<const Snapshot> loaded = std::atomic_load(&current());
+        if (loaded != nullptr && loaded->file_path() == file_path && loaded->properties() == snapshot->properties()){
+          return;
+        }
+        std::atomic_store(&current(), snapshot);
+        version_++;
+      }
+
+
+      void Reload(){
+        Load(Current()->file_path());
+      }
+
+
+      unsigned long version(){
+        return version_.load();
+      }
+
+
+      void ReloadOnSignal(){
+#ifndef _WIN32
+        std::call_once(reload_on_signal_once_, [](){
+          if (::pipe(reload_pipe_) != 0){
+            return;
+          }
+          std::thread([](){
+            char c;
+            for (;;){
+              const ssize_t n = ::read(reload_pipe_[0], &c, 1);
+              if (n > 0){
+                Reload();
+              }else if (n < 0 && errno == EINTR){
+                continue;
+              }else{
+                break;
+              }
+            }
+          }).detach();
+
+          struct sigaction action;
+          action.sa_handler = ReloadSignalHandler;
+          sigemptyset(&action.sa_mask);
+          action.sa_flags = SA_RESTART;
+          sigaction(SIGHUP, &action, nullptr);
+        });
+#endif
+      }
+
+    }
+  }
+}
@@ -0,0 +1,157 @@
+/**
+  * Copyright (c) <2016> Web App SDK granada <afernandez@cookinapps.io>
+  *
+  * This source code is licensed under the MIT license.
+  *
+  * Permission is hereby granted, free of charge, to any person obtaining a copy
+  * of this software and associated documentation files (the "Software"), to deal
+  * in the Software without restriction, including without limitation the rights
+  * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  * copies of the Software, and to permit persons to whom the Software is
+  * furnished to do so, subject to the following conditions:
+  *
+  * The above copyright notice and this permission notice shall be included in
+  * all copies or substantial portions of the Software.
+  *
+  * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  * SOFTWARE.
+  *
+  * Lightweight metrics: counters and latency histograms cheap enough
+  * to be updated in the hot paths, aggregated when they are read.
+  *
+  */
+
+#include "granada/util/metrics.h"
+#include <cstdio>
+#include <map>
+#include <mutex>
+#include <utility>
+
+namespace granada{
+  namespace util{
+    namespace metrics{
+
+      namespace{
+
+        /**
+         * Registered metrics with the same name.
+         */
+        struct Family{
+          std::string help;
+          std::map<std::string,std::unique_ptr<Counter>> counters;
+          std::map<std::string,std::unique_ptr<Histogram>> histograms;
+        };
+
+
+        /**
+         * Registered metrics by name. Allocated the first time
+         * it is used and never destroyed, so metrics can be
+         * registered and updated during static initialization
+         * and destruction.
+         */
+        struct Registry{
+          std::mutex mtx;
+          std::map<std::string,Family> families;
+        };
+
+        Registry& registry(){
+          static Registry* registry = new Registry();
+          return *registry;
+        }
+
+
+        /**
+         * Writes a line of the text format.
+         */
+        void WriteSample(std::string& text, const std::string& name, const std::string& labels, const std::string& value){
+          text += name;
+          if (!labels.empty()){
+            text += "{" + labels + "}";
+          }
+          text += " " + value + "\n";
+        }
+
+
+        /**
+         * Converts microseconds into seconds.
+         */
+        std::string Seconds(const uint64_t microseconds){
+          char buffer[32];
+          std::snprintf(buffer, sizeof(buffer), "%.6f", microseconds / 1000000.0);
+          return buffer;
+        }
+
+      }
+
+
+      Counter& GetCounter(const std::string& name, const std::string& help, const std::string& labels){
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lg(r.mtx);
+        Family& family = r.families[name];
+        if (family.help.empty()){
+          family.help = help;
+        }
+        std::unique_ptr<Counter>& counter = family.counters[labels];
+        if (counter == nullptr){
+          counter.reset(new Counter());
+        }
+        return *counter;
+      }
+
+
+      Histogram& GetHistogram(const std::string& name, const std::string& help, const std::string& labels){
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lg(r.mtx);
+        Family& family = r.families[name];
+        if (family.help.empty()){
+          family.help = help;
+        }
+        std::unique_ptr<Histogram>& histogram = family.histograms[labels];
+        if (histogram == nullptr){
+          histogram.reset(new Histogram());
+        }
+        return *histogram;
+      }
+
+
+      std::string Text(){
+        static const double quantiles[] = {0.5, 0.9, 0.99, 0.999};
+        static const char* quantile_labels[] = {"0.5", "0.9", "0.99", "0.999"};
+
+        std::string text;
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lg(r.mtx);
+        for (auto it = r.families.begin(); it != r.families.end(); ++it){
+          const std::string& name = it->first;
+          const Family& family = it->second;
+          text += "# HELP " + name + " " + family.help + "\n";
+          if (!family.counters.empty()){
+            text += "# TYPE " + name + " counter\n";
+            for (auto counter = family.counters.begin(); counter != family.counters.end(); ++counter){
+              WriteSample(text, name, counter->first, std::to_string(counter->second->value()));
+            }
+          }else{
+            text += "# TYPE " + name + " summary\n";
+            for (auto histogram = family.histograms.begin(); histogram != family.histograms.end(); ++histogram){
+              const std::string& labels = histogram->first;
+              const Histogram::Snapshot& snapshot = histogram->second->snapshot();
+              for (std::size_t i = 0; i < sizeof(quantiles) / sizeof(quantiles[0]); ++i){
+                const std::string quantile_label = std::string("quantile=\"") + quantile_labels[i] + "\"";
+                WriteSample(text, name, labels.empty() ? quantile_label : labels + "," + quantile_label, Seconds(snapshot.Quantile(quantiles[i])));
+              }
+              WriteSample(text, name + "_sum", labels, Seconds(snapshot.sum));
+              WriteSample(text, name + "_count", labels, std::to_string(snapshot.count));
+            }
+          }
+        }
+        return text;
+      }
+
+    }
+  }
+}
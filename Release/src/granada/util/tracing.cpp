@@ -0,0 +1,231 @@
+/**
+  * Copyright (c) <2016> Web App SDK granada <afernandez@cookinapps.io>
+  *
+  * This source code is licensed under the MIT license.
+  *
+  * Permission is hereby granted, free of charge, to any person obtaining a copy
+  * of this software and associated documentation files (the "Software"), to deal
+  * in the Software without restriction, including without limitation the rights
+  * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  * copies of the Software, and to permit persons to whom the Software is
+  * furnished to do so, subject to the following conditions:
+  *
+  * The above copyright notice and this permission notice shall be included in
+  * all copies or substantial portions of the Software.
+  *
+  * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  * SOFTWARE.
+  *
+  * Request tracing: spans recorded in a ring buffer and
+  * dumped in the Chrome trace event format.
+  *
+  */
+
+#include "granada/util/tracing.h"
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "granada/util/configuration.h"
+
+namespace granada{
+  namespace util{
+    namespace tracing{
+
+      namespace{
+
+        /**
+         * Span stored in the ring buffer. The sequence is odd while
+         * the span is being written, so a reader can detect and skip
+         * the spans that are modified while it reads them.
+         */
+        struct Slot{
+          std::atomic<uint64_t> sequence{0};
+          std::atomic<const char*> name{nullptr};
+          std::atomic<uint64_t> trace{0};
+          std::atomic<uint64_t> start{0};
+          std::atomic<uint64_t> duration{0};
+          std::atomic<uint64_t> thread{0};
+        };
+
+
+        /**
+         * Ring buffer of spans. Allocated the first time a trace is
+         * recorded and never destroyed.
+         */
+        struct Buffer{
+          std::unique_ptr<Slot[]> slots;
+          std::size_t size = 0;
+          std::atomic<uint64_t> next{0};
+        };
+
+        std::atomic<Buffer*> buffer_{nullptr};
+        std::once_flag buffer_once_;
+
+        Buffer* buffer(){
+          std::call_once(buffer_once_, [](){
+            int size = granada::util::configuration::Int(granada::util::configuration::tracing_buffer_size);
+            Buffer* buffer = new Buffer();
+            buffer->size = size > 0 ? size : 1;
+            buffer->slots.reset(new Slot[buffer->size]);
+            buffer_.store(buffer, std::memory_order_release);
+          });
+          return buffer_.load(std::memory_order_acquire);
+        }
+
+
+        /**
+         * Number of traces started, used for sampling and as trace ids.
+         */
+        std::atomic<uint64_t> traces_{0};
+
+
+        /**
+         * Returns a small number identifying the calling thread.
+         */
+        uint64_t thread_id(){
+          static std::atomic<uint64_t> next(0);
+          static thread_local const uint64_t id = ++next;
+          return id;
+        }
+
+
+        /**
+         * Span copied from the ring buffer.
+         */
+        struct Event{
+          const char* name;
+          uint64_t trace;
+          uint64_t start;
+          uint64_t duration;
+          uint64_t thread;
+        };
+
+
+        /**
+         * Appends a string to a JSON text escaping it.
+         */
+        void AppendString(std::string& json, const char* value){
+          json += '"';
+          for (const char* c = value; *c != '\0'; ++c){
+            if (*c == '"' || *c == '\\'){
+              json += '\\';
+              json += *c;
+            }else if ((unsigned char)*c >= 0x20){
+              json += *c;
+            }
+          }
+          json += '"';
+        }
+
+      }
+
+
+      void Record(const char* name, const uint64_t trace, const uint64_t start, const uint64_t duration){
+        Buffer* b = buffer();
+        const uint64_t index = b->next.fetch_add(1, std::memory_order_relaxed);
+        Slot& slot = b->slots[index % b->size];
+        slot.sequence.store(2 * index + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        slot.name.store(name, std::memory_order_relaxed);
+        slot.trace.store(trace, std::memory_order_relaxed);
+        slot.start.store(start, std::memory_order_relaxed);
+        slot.duration.store(duration, std::memory_order_relaxed);
+        slot.thread.store(thread_id(), std::memory_order_relaxed);
+        slot.sequence.store(2 * index + 2, std::memory_order_release);
+      }
+
+
+      std::string Dump(){
+        std::vector<Event> events;
+        Buffer* b = buffer_.load(std::memory_order_acquire);
+        if (b != nullptr){
+          events.reserve(b->size);
+          for (std::size_t i = 0; i < b->size; ++i){
+            const Slot& slot = b->slots[i];
+            const uint64_t sequence = slot.sequence.load(std::memory_order_acquire);
+            if (sequence == 0 || sequence % 2 == 1){
+              continue;
+            }
+            Event event;
+            event.name = slot.name.load(std::memory_order_relaxed);
+            event.trace = slot.trace.load(std::memory_order_relaxed);
+            event.start = slot.start.load(std::memory_order_relaxed);
+            event.duration = slot.duration.load(std::memory_order_relaxed);
+            event.thread = slot.thread.load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.sequence.load(std::memory_order_relaxed) == sequence){
+              events.push_back(event);
+            }
+          }
+        }
+        std::sort(events.begin(), events.end(), [](const Event& a, const Event& b){
+          return a.start < b.start;
+        });
+
+        std::string json = "{\"traceEvents\":[";
+        for (auto it = events.begin(); it != events.end(); ++it){
+          if (it != events.begin()){
+            json += ",";
+          }
+          json += "{\"name\":";
+          AppendString(json, it->name);
+          json += ",\"cat\":\"granada\",\"ph\":\"X\",\"ts\":" + std::to_string(it->start);
+          json += ",\"dur\":" + std::to_string(it->duration);
+          json += ",\"pid\":1,\"tid\":" + std::to_string(it->thread);
+          json += ",\"args\":{\"trace\":" + std::to_string(it->trace) + "}}";
+        }
+        json += "]}";
+        return json;
+      }
+
+
+      void Clear(){
+        Buffer* b = buffer_.load(std::memory_order_acquire);
+        if (b != nullptr){
+          for (std::size_t i = 0; i < b->size; ++i){
+            b->slots[i].sequence.store(0, std::memory_order_relaxed);
+          }
+        }
+      }
+
+
+      Trace::Trace(const char* name) : name_(name){
+        uint64_t& current = current_trace();
+        if (current != 0){
+          trace_ = current;
+        }else{
+          const int sampling = granada::util::configuration::Int(granada::util::configuration::tracing_sampling);
+          if (sampling > 0){
+            const uint64_t trace = traces_.fetch_add(1, std::memory_order_relaxed) + 1;
+            if (trace % sampling == 0){
+              trace_ = trace;
+              current = trace;
+              root_ = true;
+            }
+          }
+        }
+        if (trace_ != 0){
+          start_ = now();
+        }
+      }
+
+
+      Trace::~Trace(){
+        if (trace_ != 0){
+          Record(name_, trace_, start_, now() - start_);
+          if (root_){
+            current_trace() = 0;
+          }
+        }
+      }
+
+    }
+  }
+}
@@ -0,0 +1,119 @@
+/**
+ * Copyright (c) <2016> Web App SDK granada <afernandez@cookinapps.io>
+ *
+ * This source code is licensed under the MIT license.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * =+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+
+ *
+ *
+ * Tests for granada::cache::HashRing
+ *
+ * =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-
+ **/
+#include "stdafx.h"
+#include <string>
+#include <vector>
+#include "granada/cache/hash_ring.h"
+
+namespace granada { namespace test { namespace cache {
+    
+SUITE(hash_ring)
+{
+
+	TEST(tag)
+	{
+		VERIFY_ARE_EQUAL(granada::cache::HashRing::Tag("session:value:{6464}"),"6464");
+		VERIFY_ARE_EQUAL(granada::cache::HashRing::Tag("session:roles:{6464}:user"),"6464");
+		VERIFY_ARE_EQUAL(granada::cache::HashRing::Tag("{a}{b}"),"a");
+		VERIFY_ARE_EQUAL(granada::cache::HashRing::Tag("session:value:6464"),"session:value:6464");
+		VERIFY_ARE_EQUAL(granada::cache::HashRing::Tag("session:{}:6464"),"session:{}:6464");
+		VERIFY_ARE_EQUAL(granada::cache::HashRing::Tag("session:{6464"),"session:{6464");
+	}
+
+
+	TEST(node)
+	{
+		granada::cache::HashRing ring;
+		VERIFY_IS_TRUE(ring.Node("hello")==0);
+
+		VERIFY_IS_TRUE(ring.Add("127.0.0.1:7001",160)==0);
+		VERIFY_IS_TRUE(ring.Add("127.0.0.1:7002",160)==1);
+		VERIFY_IS_TRUE(ring.Add("127.0.0.1:7003",160)==2);
+		VERIFY_IS_TRUE(ring.size()==3);
+
+		// keys with the same hash tag are in the same node.
+		for (int i = 0; i < 100; i++){
+			const std::string token = std::to_string(i);
+			VERIFY_IS_TRUE(ring.Node("session:value:{" + token + "}")==ring.Node("session:roles:{" + token + "}:user"));
+			VERIFY_IS_TRUE(ring.Node("session:value:{" + token + "}")==ring.Node("session:data:{" + token + "}"));
+		}
+
+		// keys are spread over all the nodes.
+		std::vector<int> counts(3,0);
+		for (int i = 0; i < 3000; i++){
+			counts[ring.Node("key:" + std::to_string(i))]++;
+		}
+		for (int i = 0; i < 3; i++){
+			VERIFY_IS_TRUE(counts[i] > 600);
+		}
+	}
+
+
+	TEST(add_node)
+	{
+		granada::cache::HashRing ring;
+		ring.Add("127.0.0.1:7001",160);
+		ring.Add("127.0.0.1:7002",160);
+
+		std::vector<std::size_t> nodes;
+		for (int i = 0; i < 1000; i++){
+			nodes.push_back(ring.Node("key:" + std::to_string(i)));
+		}
+
+		// adding a node only moves keys to the new node.
+		ring.Add("127.0.0.1:7003",160);
+		int moved = 0;
+		for (int i = 0; i < 1000; i++){
+			const std::size_t node = ring.Node("key:" + std::to_string(i));
+			if (node != nodes[i]){
+				VERIFY_IS_TRUE(node==2);
+				moved++;
+			}
+		}
+		VERIFY_IS_TRUE(moved > 0 && moved < 600);
+	}
+
+
+	TEST(expression_node)
+	{
+		granada::cache::HashRing ring;
+		ring.Add("127.0.0.1:7001",160);
+		ring.Add("127.0.0.1:7002",160);
+
+		std::size_t node = 99;
+		VERIFY_IS_TRUE(ring.Node("session:roles:{6464}:*",node));
+		VERIFY_IS_TRUE(node==ring.Node("session:roles:{6464}:user"));
+		VERIFY_IS_FALSE(ring.Node("session:value:{*}",node));
+		VERIFY_IS_FALSE(ring.Node("session:value:*",node));
+	}
+
+}
+
+} } } //namespaces
@@ -0,0 +1,136 @@
+/**
+ * Copyright (c) <2016> Web App SDK granada <afernandez@cookinapps.io>
+ *
+ * This source code is licensed under the MIT license.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * =+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+
+ *
+ * Tests for granada::cache::LocalRecordCache
+ *
+ * =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-
+ **/
+#include "stdafx.h"
+#include <string>
+#include "granada/cache/local_record_cache.h"
+
+namespace granada { namespace test { namespace cache {
+    
+SUITE(local_record_cache)
+{
+
+	TEST(write_read)
+	{
+		granada::cache::LocalRecordCache<std::string> records;
+		std::string record;
+
+		// no ttl, nothing is cached.
+		records.Write("hello","world");
+		VERIFY_IS_FALSE(records.Read("hello",record));
+
+		records.set_ttl(60);
+		records.Write("hello","world");
+		VERIFY_IS_TRUE(records.Read("hello",record));
+		VERIFY_ARE_EQUAL(record,"world");
+		VERIFY_IS_FALSE(records.Read("none",record));
+
+		records.Write("hello","!!!");
+		VERIFY_IS_TRUE(records.Read("hello",record));
+		VERIFY_ARE_EQUAL(record,"!!!");
+	}
+
+
+	TEST(destroy)
+	{
+		granada::cache::LocalRecordCache<std::string> records;
+		records.set_ttl(60);
+		records.Write("hello","world");
+		records.Write("session","6464");
+
+		std::string record;
+		records.Destroy("hello");
+		VERIFY_IS_FALSE(records.Read("hello",record));
+		VERIFY_IS_TRUE(records.Read("session",record));
+
+		records.Clear();
+		VERIFY_IS_FALSE(records.Read("session",record));
+
+		records.Write("hello","world");
+		records.set_ttl(0);
+		VERIFY_IS_FALSE(records.Read("hello",record));
+	}
+
+
+	TEST(max_size)
+	{
+		granada::cache::LocalRecordCache<std::string> records;
+		records.set_ttl(60);
+		records.set_max_size(2);
+		records.Write("a","1");
+		records.Write("b","2");
+
+		std::string record;
+
+		// rewriting an existing record does not purge.
+		records.Write("b","3");
+		VERIFY_IS_TRUE(records.Read("a",record));
+
+		// no expired records, all of them are removed.
+		records.Write("c","4");
+		VERIFY_IS_FALSE(records.Read("a",record));
+		VERIFY_IS_FALSE(records.Read("b",record));
+		VERIFY_IS_TRUE(records.Read("c",record));
+	}
+
+
+	TEST(write_with_ttl)
+	{
+		granada::cache::LocalRecordCache<std::string> records;
+		std::string record;
+
+		// the ttl of the record is used instead of set_ttl.
+		records.Write("hello","world",60);
+		VERIFY_IS_TRUE(records.Read("hello",record));
+		VERIFY_ARE_EQUAL(record,"world");
+
+		records.set_ttl(60);
+		records.Write("hello","!!!",0);
+		VERIFY_IS_TRUE(records.Read("hello",record));
+		VERIFY_ARE_EQUAL(record,"world");
+	}
+
+
+	TEST(destroy_prefix)
+	{
+		granada::cache::LocalRecordCache<std::string> records;
+		records.set_ttl(60);
+		records.Write("math.sum|1","3");
+		records.Write("math.sum|2","4");
+		records.Write("math.square|2","4");
+
+		std::string record;
+		records.DestroyPrefix("math.sum|");
+		VERIFY_IS_FALSE(records.Read("math.sum|1",record));
+		VERIFY_IS_FALSE(records.Read("math.sum|2",record));
+		VERIFY_IS_TRUE(records.Read("math.square|2",record));
+	}
+
+}
+
+} } } //namespaces
@@ -0,0 +1,136 @@
+/**
+ * Copyright (c) <2016> Web App SDK granada <afernandez@cookinapps.io>
+ *
+ * This source code is licensed under the MIT license.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * =+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+
+ *
+ *
+ * Tests for granada::cache::LogCacheDriver
+ *
+ * =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-
+ **/
+#include "stdafx.h"
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "granada/cache/log_cache_driver.h"
+
+namespace granada { namespace test { namespace cache {
+
+static const std::string log_file_path("log_cache_driver_test.log");
+
+SUITE(log_cache_driver)
+{
+
+	TEST(replay)
+	{
+		std::remove(log_file_path.c_str());
+		{
+			granada::cache::LogCacheDriver cache_driver(log_file_path);
+			cache_driver.Write("hello","world");
+			cache_driver.Write("session:{6464}","token","6464");
+			cache_driver.Write("session:{6464}","update.time","123456789");
+			cache_driver.Write("session:{777}","token","777");
+			cache_driver.Write("binary",std::string("a\0b\r\n",5));
+			cache_driver.Destroy("session:{6464}","update.time");
+			cache_driver.Destroy("session:{777}");
+			cache_driver.Rename("hello","bye");
+		}
+
+		granada::cache::LogCacheDriver cache_driver(log_file_path);
+		VERIFY_IS_FALSE(cache_driver.Exists("hello"));
+		VERIFY_ARE_EQUAL(cache_driver.Read("bye"),"world");
+		VERIFY_ARE_EQUAL(cache_driver.Read("session:{6464}","token"),"6464");
+		VERIFY_IS_FALSE(cache_driver.Exists("session:{6464}","update.time"));
+		VERIFY_IS_FALSE(cache_driver.Exists("session:{777}"));
+		VERIFY_ARE_EQUAL(cache_driver.Read("binary"),std::string("a\0b\r\n",5));
+	}
+
+
+	TEST(destroy_keys)
+	{
+		std::remove(log_file_path.c_str());
+		{
+			granada::cache::LogCacheDriver cache_driver(log_file_path);
+			cache_driver.Write("session:{6464}","token","6464");
+			cache_driver.Write("session:{777}","token","777");
+			cache_driver.Write("plugin:store:1","0","0");
+			cache_driver.Destroy("session:*");
+		}
+
+		granada::cache::LogCacheDriver cache_driver(log_file_path);
+		VERIFY_IS_FALSE(cache_driver.Exists("session:{6464}"));
+		VERIFY_IS_FALSE(cache_driver.Exists("session:{777}"));
+		VERIFY_IS_TRUE(cache_driver.Exists("plugin:store:1"));
+	}
+
+
+	TEST(crash_recovery)
+	{
+		std::remove(log_file_path.c_str());
+		{
+			granada::cache::LogCacheDriver cache_driver(log_file_path);
+			cache_driver.Write("hello","world");
+			cache_driver.Write("session:{6464}","token","6464");
+		}
+
+		// simulate a record that was being written when the application stopped.
+		std::FILE* file = std::fopen(log_file_path.c_str(), "ab");
+		std::fwrite("\x20\x00\x00\x00\x01\x02", 1, 6, file);
+		std::fclose(file);
+
+		{
+			granada::cache::LogCacheDriver cache_driver(log_file_path);
+			VERIFY_ARE_EQUAL(cache_driver.Read("hello"),"world");
+			VERIFY_ARE_EQUAL(cache_driver.Read("session:{6464}","token"),"6464");
+			cache_driver.Write("after","crash");
+		}
+
+		// the incomplete record has been discarded and new records are kept.
+		granada::cache::LogCacheDriver cache_driver(log_file_path);
+		VERIFY_ARE_EQUAL(cache_driver.Read("hello"),"world");
+		VERIFY_ARE_EQUAL(cache_driver.Read("after"),"crash");
+	}
+
+
+	TEST(compact)
+	{
+		std::remove(log_file_path.c_str());
+		{
+			granada::cache::LogCacheDriver cache_driver(log_file_path);
+			for (int i = 0; i < 100; i++){
+				cache_driver.Write("counter",std::to_string(i));
+			}
+			cache_driver.Write("session:{6464}","token","6464");
+			cache_driver.Compact();
+			cache_driver.Write("hello","world");
+		}
+
+		granada::cache::LogCacheDriver cache_driver(log_file_path);
+		VERIFY_ARE_EQUAL(cache_driver.Read("counter"),"99");
+		VERIFY_ARE_EQUAL(cache_driver.Read("session:{6464}","token"),"6464");
+		VERIFY_ARE_EQUAL(cache_driver.Read("hello"),"world");
+		std::remove(log_file_path.c_str());
+	}
+
+}
+
+} } } //namespaces
@@ -0,0 +1,44 @@
+#!/bin/sh
+#
+# Starts or stops several local redis servers to try the redis cache
+# driver sharding keys over them. Data is not persisted.
+#
+# Usage:
+#   ./redis_shards.sh start [number of servers] [first port]
+#   ./redis_shards.sh stop  [number of servers] [first port]
+#
+# Then add to the server.conf of the application:
+#   redis_cache_driver_nodes=127.0.0.1:7001,127.0.0.1:7002,127.0.0.1:7003
+#
+
+ACTION=${1:-start}
+SERVERS=${2:-3}
+FIRST_PORT=${3:-7001}
+DIR=${TMPDIR:-/tmp}/granada-redis-shards
+
+NODES=""
+i=0
+while [ $i -lt $SERVERS ]; do
+  PORT=$((FIRST_PORT + i))
+  case $ACTION in
+    start)
+      mkdir -p $DIR/$PORT
+      redis-server --port $PORT --bind 127.0.0.1 --dir $DIR/$PORT \
+                   --save "" --appendonly no --daemonize yes \
+                   --pidfile $DIR/$PORT/redis.pid --logfile $DIR/$PORT/redis.log
+      ;;
+    stop)
+      redis-cli -p $PORT shutdown nosave > /dev/null 2>&1
+      ;;
+    *)
+      echo "Usage: $0 start|stop [number of servers] [first port]"
+      exit 1
+      ;;
+  esac
+  NODES="$NODES${NODES:+,}127.0.0.1:$PORT"
+  i=$((i + 1))
+done
+
+if [ "$ACTION" = "start" ]; then
+  echo "redis_cache_driver_nodes=$NODES"
+fi
@@ -27,6 +27,8 @@
  * =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-
  **/
 #include "stdafx.h"
+#include <cstdio>
+#include <map>
 #include <vector>
 #include "granada/util/time.h"
 #include "granada/cache/shared_map_cache_driver.h"
@@ -101,6 +103,28 @@ SUITE(shared_map_cache_driver)
 	}
 
 
+	TEST(fields)
+	{
+		granada::cache::SharedMapCacheDriver cache_driver;
+		cache_driver.Write("session:6464","token","6464");
+		cache_driver.Write("session:6464","update.time","123456789");
+
+		std::vector<std::string> fields;
+
+		cache_driver.Fields("none",fields);
+		VERIFY_IS_TRUE(fields.size()==0);
+
+		cache_driver.Fields("session:6464",fields);
+		VERIFY_IS_TRUE(fields.size()==2);
+		VERIFY_ARE_EQUAL(fields[0],"token");
+		VERIFY_ARE_EQUAL(fields[1],"update.time");
+
+		cache_driver.Destroy("session:6464","token");
+		cache_driver.Fields("session:6464",fields);
+		VERIFY_IS_TRUE(fields.size()==1);
+	}
+
+
 	TEST(destroy)
 	{
 		granada::cache::SharedMapCacheDriver cache_driver;
@@ -129,6 +153,76 @@ SUITE(shared_map_cache_driver)
 	}
 
 
+	TEST(read_all)
+	{
+		granada::cache::SharedMapCacheDriver cache_driver;
+		cache_driver.Write("session:6464","token","6464");
+		cache_driver.Write("session:6464","update.time","123456789");
+
+		std::map<std::string,std::string> values;
+
+		cache_driver.ReadAll("none",values);
+		VERIFY_IS_TRUE(values.size()==0);
+
+		cache_driver.ReadAll("session:6464",values);
+		VERIFY_IS_TRUE(values.size()==2);
+		VERIFY_ARE_EQUAL(values["token"],"6464");
+		VERIFY_ARE_EQUAL(values["update.time"],"123456789");
+	}
+
+
+	TEST(destroy_keys)
+	{
+		granada::cache::SharedMapCacheDriver cache_driver;
+		cache_driver.Write("hello","world");
+		cache_driver.Write("session:6464","token","6464");
+		cache_driver.Write("session:777","token","777");
+
+		std::vector<std::string> keys;
+		keys.push_back("hello");
+		keys.push_back("session:6464");
+		keys.push_back("none");
+		cache_driver.Destroy(keys);
+
+		VERIFY_IS_FALSE(cache_driver.Exists("hello"));
+		VERIFY_IS_FALSE(cache_driver.Exists("session:6464"));
+		VERIFY_IS_TRUE(cache_driver.Exists("session:777"));
+
+		// keys are not expressions.
+		keys.clear();
+		keys.push_back("session:*");
+		cache_driver.Destroy(keys);
+		VERIFY_IS_TRUE(cache_driver.Exists("session:777"));
+	}
+
+
+	TEST(match_hash_tag)
+	{
+		granada::cache::SharedMapCacheDriver cache_driver;
+		cache_driver.Write("session:value:{6464}","token","6464");
+		cache_driver.Write("session:roles:{6464}:user","0","0");
+		cache_driver.Write("session:roles:{6464}:admin","0","0");
+		cache_driver.Write("session:roles:{777}:user","0","0");
+		cache_driver.Write("oauth2xclient:value:1","0");
+
+		std::vector<std::string> keys;
+
+		cache_driver.Match("session:value:{*}",keys);
+		VERIFY_IS_TRUE(keys.size()==1);
+
+		cache_driver.Match("session:roles:{6464}:*",keys);
+		VERIFY_IS_TRUE(keys.size()==2);
+
+		// characters other than "*" are matched literally.
+		cache_driver.Match("oauth2.client:value:*",keys);
+		VERIFY_IS_TRUE(keys.size()==0);
+
+		cache_driver.Destroy("session:roles:{6464}:*");
+		VERIFY_IS_FALSE(cache_driver.Exists("session:roles:{6464}:user"));
+		VERIFY_IS_TRUE(cache_driver.Exists("session:roles:{777}:user"));
+	}
+
+
 	TEST(iterator)
 	{
 		granada::cache::SharedMapCacheDriver cache_driver;
@@ -205,6 +299,65 @@ SUITE(shared_map_cache_driver)
 		VERIFY_IS_TRUE(i==2);
 	}
 
+
+	TEST(snapshot)
+	{
+		const std::string snapshot_path("shared_map_cache_driver_test.snapshot");
+		std::remove(snapshot_path.c_str());
+
+		granada::cache::SharedMapCacheDriver cache_driver;
+		cache_driver.Write("hello","world");
+		cache_driver.Write("session:6464","token","6464");
+		cache_driver.Write("session:6464","update.time","123456789");
+		for (int i = 0; i < 1000; i++){
+			cache_driver.Write("key:" + std::to_string(i),"value","" + std::to_string(i));
+		}
+		VERIFY_IS_TRUE(cache_driver.SaveSnapshot(snapshot_path));
+
+		// modifications after the snapshot are not saved in it.
+		cache_driver.Write("hello","everyone");
+		cache_driver.Destroy("key:0");
+		VERIFY_ARE_EQUAL(std::string("everyone"),cache_driver.Read("hello"));
+
+		granada::cache::SharedMapCacheDriver cache_driver2;
+		cache_driver2.Write("other","value");
+		VERIFY_IS_TRUE(cache_driver2.LoadSnapshot(snapshot_path));
+		VERIFY_ARE_EQUAL(std::string("world"),cache_driver2.Read("hello"));
+		VERIFY_ARE_EQUAL(std::string("123456789"),cache_driver2.Read("session:6464","update.time"));
+		VERIFY_ARE_EQUAL(std::string("0"),cache_driver2.Read("key:0","value"));
+		VERIFY_ARE_EQUAL(std::string("999"),cache_driver2.Read("key:999","value"));
+		VERIFY_ARE_EQUAL(std::string("value"),cache_driver2.Read("other"));
+
+		std::remove(snapshot_path.c_str());
+	}
+
+
+	TEST(snapshot_corrupted)
+	{
+		const std::string snapshot_path("shared_map_cache_driver_test.snapshot");
+		{
+			granada::cache::SharedMapCacheDriver cache_driver;
+			cache_driver.Write("hello","world");
+			VERIFY_IS_TRUE(cache_driver.SaveSnapshot(snapshot_path));
+		}
+
+		// change the last byte of the file.
+		std::FILE* file = std::fopen(snapshot_path.c_str(), "r+b");
+		std::fseek(file, -1, SEEK_END);
+		const int c = std::fgetc(file);
+		std::fseek(file, -1, SEEK_END);
+		std::fputc(c ^ 0xff, file);
+		std::fclose(file);
+
+		// nothing is loaded from a corrupted snapshot.
+		granada::cache::SharedMapCacheDriver cache_driver;
+		VERIFY_IS_FALSE(cache_driver.LoadSnapshot(snapshot_path));
+		VERIFY_IS_FALSE(cache_driver.Exists("hello"));
+		VERIFY_IS_FALSE(cache_driver.LoadSnapshot("none.snapshot"));
+
+		std::remove(snapshot_path.c_str());
+	}
+
 }
     
 }}} //namespaces
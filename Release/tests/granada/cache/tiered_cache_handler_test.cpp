@@ -0,0 +1,174 @@
+/**
+ * Copyright (c) <2016> Web App SDK granada <afernandez@cookinapps.io>
+ *
+ * This source code is licensed under the MIT license.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * =+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+
+ *
+ *
+ * Tests for granada::cache::TieredCacheHandler
+ *
+ * =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-
+ **/
+#include "stdafx.h"
+#include <map>
+#include <vector>
+#include "granada/cache/shared_map_cache_driver.h"
+#include "granada/cache/tiered_cache_handler.h"
+
+namespace granada { namespace test { namespace cache {
+
+/**
+ * Invalidator used for simulating modifications made by other processes.
+ */
+class TestInvalidator : public granada::cache::CacheInvalidator
+{
+	public:
+		TestInvalidator(bool subscribed) : subscribed_(subscribed){};
+
+		virtual bool Subscribe(const std::vector<std::string>& prefixes, std::function<void(const std::string&)> invalidate, std::function<void()> disconnect) override {
+			invalidate_ = invalidate;
+			disconnect_ = disconnect;
+			return subscribed_;
+		};
+
+		virtual void Publish(const std::string& key) override {
+			published_.push_back(key);
+		};
+
+		bool subscribed_;
+		std::function<void(const std::string&)> invalidate_;
+		std::function<void()> disconnect_;
+		std::vector<std::string> published_;
+};
+
+SUITE(tiered_cache_handler)
+{
+
+	TEST(read_through)
+	{
+		granada::cache::SharedMapCacheDriver* remote = new granada::cache::SharedMapCacheDriver();
+		TestInvalidator* invalidator = new TestInvalidator(true);
+		granada::cache::TieredCacheHandler cache_handler(remote, invalidator, {"plugin:value:*"}, 100);
+		remote->Write("plugin:value:1","script","a");
+		remote->Write("session:value:1","token","1");
+
+		VERIFY_ARE_EQUAL(std::string("a"),cache_handler.Read("plugin:value:1","script"));
+		VERIFY_ARE_EQUAL(std::string("1"),cache_handler.Read("session:value:1","token"));
+		VERIFY_IS_TRUE(cache_handler.size()==1);
+
+		// modified by another process.
+		remote->Write("plugin:value:1","script","b");
+		remote->Write("session:value:1","token","2");
+		VERIFY_ARE_EQUAL(std::string("a"),cache_handler.Read("plugin:value:1","script"));
+		VERIFY_ARE_EQUAL(std::string("2"),cache_handler.Read("session:value:1","token"));
+
+		invalidator->invalidate_("plugin:value:1");
+		VERIFY_ARE_EQUAL(std::string("b"),cache_handler.Read("plugin:value:1","script"));
+		VERIFY_IS_TRUE(cache_handler.Exists("plugin:value:1","script"));
+		VERIFY_IS_FALSE(cache_handler.Exists("plugin:value:1","header"));
+		VERIFY_IS_FALSE(cache_handler.Exists("plugin:value:2","script"));
+
+		std::vector<std::string> fields;
+		cache_handler.Fields("plugin:value:1",fields);
+		VERIFY_IS_TRUE(fields.size()==1);
+	}
+
+
+	TEST(write_invalidates)
+	{
+		granada::cache::SharedMapCacheDriver* remote = new granada::cache::SharedMapCacheDriver();
+		TestInvalidator* invalidator = new TestInvalidator(true);
+		granada::cache::TieredCacheHandler cache_handler(remote, invalidator, {"plugin:value:*","plugin.event:value:*"}, 100);
+
+		cache_handler.Write("plugin:value:1","script","a");
+		VERIFY_ARE_EQUAL(std::string("a"),cache_handler.Read("plugin:value:1","script"));
+		cache_handler.Write("plugin:value:1","script","b");
+		VERIFY_ARE_EQUAL(std::string("b"),cache_handler.Read("plugin:value:1","script"));
+
+		cache_handler.Write("plugin.event:value:x","y");
+		VERIFY_ARE_EQUAL(std::string("y"),cache_handler.Read("plugin.event:value:x"));
+		VERIFY_IS_TRUE(cache_handler.Exists("plugin.event:value:x"));
+
+		cache_handler.Rename("plugin.event:value:x","plugin.event:value:z");
+		VERIFY_ARE_EQUAL(std::string(),cache_handler.Read("plugin.event:value:x"));
+		VERIFY_ARE_EQUAL(std::string("y"),cache_handler.Read("plugin.event:value:z"));
+
+		cache_handler.Destroy("plugin:value:*");
+		VERIFY_IS_FALSE(cache_handler.Exists("plugin:value:1","script"));
+
+		// modifications are published for the other processes.
+		VERIFY_IS_TRUE(invalidator->published_.size()==6);
+		VERIFY_ARE_EQUAL(std::string("plugin:value:*"),invalidator->published_.back());
+
+		// keys of other namespaces are not published.
+		cache_handler.Write("session:value:1","token","1");
+		VERIFY_IS_TRUE(invalidator->published_.size()==6);
+	}
+
+
+	TEST(max_size)
+	{
+		granada::cache::TieredCacheHandler cache_handler(new granada::cache::SharedMapCacheDriver(), nullptr, {"*"}, 3);
+		for (int i = 0; i < 10; i++){
+			cache_handler.Write("key:" + std::to_string(i),"value",std::to_string(i));
+			cache_handler.Read("key:" + std::to_string(i),"value");
+			cache_handler.Read("key:0","value");
+		}
+		VERIFY_IS_TRUE(cache_handler.size()==3);
+		VERIFY_ARE_EQUAL(std::string("9"),cache_handler.Read("key:9","value"));
+		VERIFY_ARE_EQUAL(std::string("0"),cache_handler.Read("key:0","value"));
+		VERIFY_ARE_EQUAL(std::string("5"),cache_handler.Read("key:5","value"));
+	}
+
+
+	TEST(not_subscribed)
+	{
+		granada::cache::SharedMapCacheDriver* remote = new granada::cache::SharedMapCacheDriver();
+		TestInvalidator* invalidator = new TestInvalidator(false);
+		granada::cache::TieredCacheHandler cache_handler(remote, invalidator, {"plugin:value:*"}, 100);
+		cache_handler.Write("plugin:value:1","script","a");
+		VERIFY_ARE_EQUAL(std::string("a"),cache_handler.Read("plugin:value:1","script"));
+		VERIFY_IS_FALSE(cache_handler.enabled());
+		VERIFY_IS_TRUE(cache_handler.size()==0);
+	}
+
+
+	TEST(disconnect)
+	{
+		granada::cache::SharedMapCacheDriver* remote = new granada::cache::SharedMapCacheDriver();
+		TestInvalidator* invalidator = new TestInvalidator(true);
+		granada::cache::TieredCacheHandler cache_handler(remote, invalidator, {"plugin:value:*"}, 100);
+		cache_handler.Write("plugin:value:1","script","a");
+		VERIFY_ARE_EQUAL(std::string("a"),cache_handler.Read("plugin:value:1","script"));
+		VERIFY_IS_TRUE(cache_handler.size()==1);
+
+		// no key is kept once invalidations are not received.
+		invalidator->disconnect_();
+		VERIFY_IS_FALSE(cache_handler.enabled());
+		VERIFY_IS_TRUE(cache_handler.size()==0);
+		remote->Write("plugin:value:1","script","b");
+		VERIFY_ARE_EQUAL(std::string("b"),cache_handler.Read("plugin:value:1","script"));
+		VERIFY_IS_TRUE(cache_handler.size()==0);
+	}
+
+}
+
+}}} //namespaces
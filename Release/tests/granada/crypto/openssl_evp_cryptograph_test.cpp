@@ -0,0 +1,109 @@
+/**
+ * Copyright (c) <2016> Web App SDK granada <afernandez@cookinapps.io>
+ *
+ * This source code is licensed under the MIT license.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * =+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+
+ *
+ * Tests for granada::crypto::OpensslEVPCryptograph
+ *
+ * =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-
+ **/
+#include "stdafx.h"
+#include <string>
+#include "granada/crypto/openssl_evp_cryptograph.h"
+
+namespace granada { namespace test { namespace crypto {
+    
+SUITE(openssl_evp_cryptograph)
+{
+
+	TEST(encrypt_decrypt)
+	{
+		granada::crypto::OpensslEVPCryptograph cryptograph;
+		const std::string& encrypted = cryptograph.Encrypt("johndoe","secret");
+		VERIFY_ARE_NOT_EQUAL(encrypted,"johndoe");
+		VERIFY_ARE_EQUAL(cryptograph.Decrypt(encrypted,"secret"),"johndoe");
+
+		// same text and password, different IV.
+		VERIFY_ARE_NOT_EQUAL(cryptograph.Encrypt("johndoe","secret"),encrypted);
+
+		// arbitrary length texts.
+		const std::string long_text(10000,'x');
+		VERIFY_ARE_EQUAL(cryptograph.Decrypt(cryptograph.Encrypt(long_text,"secret"),"secret"),long_text);
+		VERIFY_ARE_EQUAL(cryptograph.Decrypt(cryptograph.Encrypt("","secret"),"secret"),"");
+	}
+
+
+	TEST(wrong_password)
+	{
+		granada::crypto::OpensslEVPCryptograph cryptograph;
+		const std::string& encrypted = cryptograph.Encrypt("johndoe","secret");
+		VERIFY_ARE_EQUAL(cryptograph.Decrypt(encrypted,"other secret"),"");
+
+		// altered text.
+		std::string altered = encrypted;
+		altered[altered.size() - 1] ^= 1;
+		VERIFY_ARE_EQUAL(cryptograph.Decrypt(altered,"secret"),"");
+		VERIFY_ARE_EQUAL(cryptograph.Decrypt("","secret"),"");
+	}
+
+
+	TEST(ciphers)
+	{
+		granada::crypto::OpensslEVPCryptograph aes_cryptograph(EVP_aes_256_gcm());
+		granada::crypto::OpensslEVPCryptograph chacha_cryptograph(EVP_chacha20_poly1305());
+
+		// same password, each cipher has its own contexts.
+		const std::string& aes_encrypted = aes_cryptograph.Encrypt("johndoe","secret");
+		const std::string& chacha_encrypted = chacha_cryptograph.Encrypt("johndoe","secret");
+		VERIFY_ARE_EQUAL(aes_cryptograph.Decrypt(aes_encrypted,"secret"),"johndoe");
+		VERIFY_ARE_EQUAL(chacha_cryptograph.Decrypt(chacha_encrypted,"secret"),"johndoe");
+		VERIFY_ARE_EQUAL(chacha_cryptograph.Decrypt(aes_encrypted,"secret"),"");
+		VERIFY_ARE_EQUAL(aes_cryptograph.Decrypt(chacha_encrypted,"secret"),"");
+	}
+
+
+	TEST(legacy)
+	{
+		granada::crypto::OpensslAESCryptograph legacy_cryptograph;
+		granada::crypto::OpensslEVPCryptograph cryptograph;
+		const std::string& encrypted = legacy_cryptograph.Encrypt("johndoe","secret");
+		VERIFY_ARE_EQUAL(cryptograph.Decrypt(encrypted,"secret"),"johndoe");
+	}
+
+
+	TEST(passwords)
+	{
+		granada::crypto::OpensslEVPCryptograph cryptograph;
+
+		// empty password.
+		VERIFY_ARE_EQUAL(cryptograph.Decrypt(cryptograph.Encrypt("johndoe",""),""),"johndoe");
+
+		// passwords containing '\0' are not truncated.
+		const std::string password("secret\0one",10);
+		const std::string& encrypted = cryptograph.Encrypt("johndoe",password);
+		VERIFY_ARE_EQUAL(cryptograph.Decrypt(encrypted,password),"johndoe");
+		VERIFY_ARE_EQUAL(cryptograph.Decrypt(encrypted,"secret"),"");
+	}
+
+}
+
+} } } //namespaces
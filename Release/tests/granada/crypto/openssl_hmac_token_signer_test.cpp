@@ -0,0 +1,108 @@
+/**
+ * Copyright (c) <2016> Web App SDK granada <afernandez@cookinapps.io>
+ *
+ * This source code is licensed under the MIT license.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * =+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+
+ *
+ * Tests for granada::crypto::OpensslHMACTokenSigner
+ *
+ * =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-
+ **/
+#include "stdafx.h"
+#include <string>
+#include "granada/crypto/openssl_hmac_token_signer.h"
+
+namespace granada { namespace test { namespace crypto {
+    
+SUITE(openssl_hmac_token_signer)
+{
+
+	TEST(sign_verify)
+	{
+		granada::crypto::OpensslHMACTokenSigner signer;
+		VERIFY_IS_FALSE(signer.CanSign());
+		VERIFY_ARE_EQUAL(signer.Sign("{\"sub\":\"johndoe\"}"),"");
+
+		signer.AddKey("k1","secret");
+		VERIFY_IS_FALSE(signer.SetSigningKey("none"));
+		VERIFY_IS_TRUE(signer.SetSigningKey("k1"));
+		VERIFY_IS_TRUE(signer.CanSign());
+
+		const std::string token = signer.Sign("{\"sub\":\"johndoe\"}");
+		VERIFY_ARE_NOT_EQUAL(token,"");
+
+		std::string payload;
+		VERIFY_IS_TRUE(signer.Verify(token,payload));
+		VERIFY_ARE_EQUAL(payload,"{\"sub\":\"johndoe\"}");
+	}
+
+
+	TEST(tampered)
+	{
+		granada::crypto::OpensslHMACTokenSigner signer;
+		signer.AddKey("k1","secret");
+		signer.SetSigningKey("k1");
+		std::string token = signer.Sign("{\"sub\":\"johndoe\"}");
+
+		std::string payload;
+		VERIFY_IS_FALSE(signer.Verify("",payload));
+		VERIFY_IS_FALSE(signer.Verify("a.b",payload));
+		VERIFY_IS_FALSE(signer.Verify(token + ".a",payload));
+
+		// change one character of the payload.
+		const std::size_t first_dot = token.find('.');
+		token[first_dot + 1] = (token[first_dot + 1] == 'A') ? 'B' : 'A';
+		VERIFY_IS_FALSE(signer.Verify(token,payload));
+
+		// same token signed with another secret.
+		granada::crypto::OpensslHMACTokenSigner other_signer;
+		other_signer.AddKey("k1","other secret");
+		other_signer.SetSigningKey("k1");
+		VERIFY_IS_FALSE(signer.Verify(other_signer.Sign("{\"sub\":\"johndoe\"}"),payload));
+	}
+
+
+	TEST(key_rotation)
+	{
+		granada::crypto::OpensslHMACTokenSigner signer;
+		signer.AddKey("k1","secret1");
+		signer.SetSigningKey("k1");
+		const std::string old_token = signer.Sign("{\"sub\":\"johndoe\"}");
+
+		// rotate: new tokens signed with k2, old tokens still valid.
+		signer.AddKey("k2","secret2");
+		signer.SetSigningKey("k2");
+		const std::string new_token = signer.Sign("{\"sub\":\"johndoe\"}");
+
+		std::string payload;
+		VERIFY_IS_TRUE(signer.Verify(old_token,payload));
+		VERIFY_IS_TRUE(signer.Verify(new_token,payload));
+
+		// old key removed, old tokens not valid anymore.
+		signer.RemoveKey("k1");
+		VERIFY_IS_FALSE(signer.Verify(old_token,payload));
+		VERIFY_IS_TRUE(signer.Verify(new_token,payload));
+		VERIFY_IS_TRUE(signer.CanSign());
+	}
+
+}
+
+} } } //namespaces
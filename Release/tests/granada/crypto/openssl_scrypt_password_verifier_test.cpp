@@ -0,0 +1,80 @@
+/**
+ * Copyright (c) <2016> Web App SDK granada <afernandez@cookinapps.io>
+ *
+ * This source code is licensed under the MIT license.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * =+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+
+ *
+ * Tests for granada::crypto::OpensslScryptPasswordVerifier
+ *
+ * =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-
+ **/
+#include "stdafx.h"
+#include <string>
+#include "granada/crypto/openssl_scrypt_password_verifier.h"
+
+namespace granada { namespace test { namespace crypto {
+    
+SUITE(openssl_scrypt_password_verifier)
+{
+
+	TEST(hash_verify)
+	{
+		granada::crypto::OpensslScryptPasswordVerifier verifier;
+		const std::string hash = verifier.Hash("secret");
+		VERIFY_ARE_NOT_EQUAL(hash,"");
+		VERIFY_IS_TRUE(verifier.IsHash(hash));
+		VERIFY_IS_TRUE(verifier.Verify("secret",hash));
+		VERIFY_IS_FALSE(verifier.Verify("Secret",hash));
+		VERIFY_IS_FALSE(verifier.Verify("",hash));
+
+		// salted, same password gives a different hash.
+		const std::string hash2 = verifier.Hash("secret");
+		VERIFY_ARE_NOT_EQUAL(hash,hash2);
+		VERIFY_IS_TRUE(verifier.Verify("secret",hash2));
+	}
+
+
+	TEST(cached_verification)
+	{
+		granada::crypto::OpensslScryptPasswordVerifier verifier;
+		const std::string hash = verifier.Hash("secret");
+		VERIFY_IS_TRUE(verifier.Verify("secret",hash));
+		VERIFY_IS_TRUE(verifier.Verify("secret",hash));
+		VERIFY_IS_FALSE(verifier.Verify("wrong",hash));
+		VERIFY_IS_FALSE(verifier.Verify("wrong",hash));
+	}
+
+
+	TEST(malformed)
+	{
+		granada::crypto::OpensslScryptPasswordVerifier verifier;
+		VERIFY_IS_FALSE(verifier.IsHash(""));
+		VERIFY_IS_FALSE(verifier.IsHash("am9obmRvZQ=="));
+		VERIFY_IS_FALSE(verifier.Verify("secret",""));
+		VERIFY_IS_FALSE(verifier.Verify("secret","$scrypt$"));
+		VERIFY_IS_FALSE(verifier.Verify("secret","$scrypt$ln=14,r=8,p=1$c2FsdA$"));
+		VERIFY_IS_FALSE(verifier.Verify("secret","$scrypt$ln=99,r=8,p=1$c2FsdA$a2V5"));
+		VERIFY_IS_FALSE(verifier.Verify("secret","$md5$x$c2FsdA$a2V5"));
+	}
+
+}
+
+} } } //namespaces
@@ -0,0 +1,423 @@
+/**
+ * Copyright (c) <2016> Web App SDK granada <afernandez@cookinapps.io>
+ *
+ * This source code is licensed under the MIT license.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * =+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+
+ * =+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+
+ *
+ * Tests for granada::http::oauth2::OAuth2Authorization
+ *
+ * =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-
+ **/
+#include "stdafx.h"
+#include <string>
+#include <vector>
+#include <ctime>
+#include "granada/http/session/map_session.h"
+#include "granada/http/oauth2/map_oauth2.h"
+
+namespace granada { namespace test { namespace http {
+
+/**
+ * Authorization server issuing signed access tokens
+ * and checking if they have been revoked.
+ */
+class SignedOAuth2Authorization : public granada::http::oauth2::MapOAuth2Authorization
+{
+public:
+	SignedOAuth2Authorization(const granada::http::oauth2::OAuth2Parameters& oauth2_parameters,
+	                          granada::http::session::SessionFactory* session_factory)
+		: granada::http::oauth2::MapOAuth2Authorization(oauth2_parameters,session_factory)
+	{
+		token_signer()->AddKey("k1","secret");
+		token_signer()->SetSigningKey("k1");
+		oauth2_signed_access_token_ = true;
+		oauth2_access_token_check_revocation_ = true;
+	}
+
+	std::string Issue(std::vector<std::string> roles, const web::json::value& user_roles)
+	{
+		granada::http::oauth2::OAuth2Parameters oauth2_response;
+		CreateSignedAccessToken(roles,user_roles,oauth2_response);
+		return oauth2_response.access_token;
+	}
+
+	void Revoke(const std::string& access_token)
+	{
+		RevokeSignedAccessToken(access_token);
+	}
+
+	std::string RevokedHash(const int64_t expiration)
+	{
+		return revoked_hash(expiration);
+	}
+};
+
+
+/**
+ * Authorization server delivering a refresh token
+ * with each access token issued for a code.
+ */
+class RefreshOAuth2Authorization : public granada::http::oauth2::MapOAuth2Authorization
+{
+public:
+	RefreshOAuth2Authorization(const granada::http::oauth2::OAuth2Parameters& oauth2_parameters,
+	                           granada::http::session::SessionFactory* session_factory)
+		: granada::http::oauth2::MapOAuth2Authorization(oauth2_parameters,session_factory)
+	{
+		use_refresh_token_ = oauth2_use_refresh_token_;
+		oauth2_use_refresh_token_ = true;
+	}
+
+	virtual ~RefreshOAuth2Authorization()
+	{
+		oauth2_use_refresh_token_ = use_refresh_token_;
+	}
+
+private:
+	bool use_refresh_token_;
+};
+
+
+static granada::http::oauth2::OAuth2Parameters parameters()
+{
+	granada::http::oauth2::OAuth2Parameters oauth2_parameters;
+	oauth2_parameters.username = "johndoe";
+	oauth2_parameters.client_id = "gida8fZEFh9abpkg";
+	oauth2_parameters.scope = "msg.select";
+	return oauth2_parameters;
+}
+
+
+static web::json::value user_roles()
+{
+	return web::json::value::parse(U("{\"msg.select\":{\"username\":\"johndoe\"},\"msg.insert\":{\"username\":\"johndoe\"}}"));
+}
+
+
+/**
+ * Registers a client allowed to ask for the msg.select role
+ * and returns its id.
+ */
+static std::string register_client()
+{
+	granada::http::oauth2::MapOAuth2Client oauth2_client;
+	std::string secret = "Kf8TyF3wZr2m";
+	oauth2_client.Create(oauth2_client_types::_public,
+	                     std::vector<std::string>(1,"http://localhost/callback"),
+	                     "messages",
+	                     std::vector<std::string>(1,"msg.select"),
+	                     secret);
+	return oauth2_client.GetId();
+}
+
+
+/**
+ * Registers a user with the given username and password.
+ */
+static void register_user(const std::string& username, std::string password)
+{
+	granada::http::oauth2::MapOAuth2User oauth2_user;
+	oauth2_user.Create(username,password,web::json::value::parse(U("{\"msg.select\":{\"username\":\"johndoe\"}}")));
+}
+
+
+/**
+ * Returns the clients listed in Information() with no client_id,
+ * or the codes listed with a client_id.
+ */
+static std::vector<std::string> information(granada::http::oauth2::OAuth2Authorization& authorization)
+{
+	std::vector<std::string> values;
+	const web::json::value& json = authorization.Information();
+	if (json.has_field(U("data"))){
+		const web::json::array& data = json.at(U("data")).as_array();
+		for (auto it = data.cbegin(); it != data.cend(); ++it){
+			if (it->is_object()){
+				values.push_back(utility::conversions::to_utf8string(it->at(U("client_id")).as_string()));
+			}else{
+				values.push_back(utility::conversions::to_utf8string(it->as_string()));
+			}
+		}
+	}
+	return values;
+}
+
+
+SUITE(oauth2_authorization)
+{
+
+	TEST(signed_access_token_accepted)
+	{
+		SignedOAuth2Authorization authorization(parameters(),nullptr);
+		const std::string token = authorization.Issue(std::vector<std::string>(1,"msg.select"),user_roles());
+		VERIFY_ARE_NOT_EQUAL(token,"");
+		VERIFY_IS_TRUE(granada::http::oauth2::OAuth2Authorization::IsSignedAccessToken(token));
+
+		web::json::value claims;
+		VERIFY_IS_TRUE(authorization.VerifyAccessToken(token,claims));
+
+		const std::unique_ptr<granada::http::oauth2::OAuth2AccessToken>& access_token = authorization.AccessToken(token);
+		VERIFY_IS_TRUE(access_token->IsValid());
+		VERIFY_IS_TRUE(access_token->session() == nullptr);
+		VERIFY_IS_TRUE(access_token->Is("msg.select"));
+		VERIFY_ARE_EQUAL(access_token->GetProperty("msg.select","username"),"johndoe");
+		VERIFY_ARE_EQUAL(access_token->GetProperty("msg.select","password"),"");
+
+		// only the requested roles are granted.
+		VERIFY_IS_FALSE(access_token->Is("msg.insert"));
+		VERIFY_ARE_EQUAL(access_token->GetProperty("msg.insert","username"),"");
+	}
+
+
+	TEST(signed_access_token_tampered)
+	{
+		SignedOAuth2Authorization authorization(parameters(),nullptr);
+		std::string token = authorization.Issue(std::vector<std::string>(1,"msg.select"),user_roles());
+		const std::size_t signature = token.rfind('.') + 1;
+		token[signature] = token[signature] == 'A' ? 'B' : 'A';
+
+		const std::unique_ptr<granada::http::oauth2::OAuth2AccessToken>& access_token = authorization.AccessToken(token);
+		VERIFY_IS_FALSE(access_token->IsValid());
+		VERIFY_IS_FALSE(access_token->Is("msg.select"));
+		VERIFY_ARE_EQUAL(access_token->GetProperty("msg.select","username"),"");
+	}
+
+
+	TEST(signed_access_token_revoked)
+	{
+		SignedOAuth2Authorization authorization(parameters(),nullptr);
+		const std::string token = authorization.Issue(std::vector<std::string>(1,"msg.select"),user_roles());
+		VERIFY_IS_TRUE(authorization.AccessToken(token)->Is("msg.select"));
+
+		authorization.Revoke(token);
+		VERIFY_IS_FALSE(authorization.AccessToken(token)->IsValid());
+		VERIFY_IS_FALSE(authorization.AccessToken(token)->Is("msg.select"));
+	}
+
+
+	TEST(revoked_access_tokens_pruned)
+	{
+		SignedOAuth2Authorization authorization(parameters(),nullptr);
+		const std::string token = authorization.Issue(std::vector<std::string>(1,"msg.select"),user_roles());
+		const web::json::value& claims = authorization.AccessToken(token)->claims();
+		const std::string token_id = utility::conversions::to_utf8string(claims.at(U("jti")).as_string());
+		const int64_t expiration = claims.at(U("exp")).as_number().to_int64();
+		const int64_t now = (int64_t)std::time(nullptr);
+
+		// a list of revoked tokens that has already expired.
+		const std::string expired_hash = authorization.RevokedHash(now - default_numbers::oauth2_access_token_revoked_period);
+		authorization.cache()->Write(expired_hash,"expired",std::to_string(now - default_numbers::oauth2_access_token_revoked_period));
+		authorization.cache()->Write(cache_namespaces::oauth2_access_token_revoked_pruned,std::to_string((now - default_numbers::oauth2_access_token_revoked_period) / default_numbers::oauth2_access_token_revoked_period));
+
+		authorization.Revoke(token);
+		VERIFY_IS_TRUE(authorization.cache()->Exists(authorization.RevokedHash(expiration),token_id));
+		VERIFY_IS_FALSE(authorization.cache()->Exists(expired_hash,"expired"));
+		VERIFY_IS_FALSE(authorization.AccessToken(token)->IsValid());
+	}
+
+
+	TEST(session_access_token_accepted)
+	{
+		granada::http::session::MapSessionFactory session_factory;
+		std::unique_ptr<granada::http::session::Session> session = session_factory.Session_unique_ptr();
+		session->Open();
+		session->roles()->Add("msg.select");
+		session->roles()->SetProperty("msg.select","username","johndoe");
+
+		SignedOAuth2Authorization authorization(parameters(),&session_factory);
+		const std::unique_ptr<granada::http::oauth2::OAuth2AccessToken>& access_token = authorization.AccessToken(session->GetToken());
+		VERIFY_IS_TRUE(access_token->IsValid());
+		VERIFY_IS_TRUE(access_token->session() != nullptr);
+		VERIFY_IS_TRUE(access_token->Is("msg.select"));
+		VERIFY_IS_FALSE(access_token->Is("msg.insert"));
+		VERIFY_ARE_EQUAL(access_token->GetProperty("msg.select","username"),"johndoe");
+
+		session->Close();
+		VERIFY_IS_FALSE(authorization.AccessToken(session->GetToken())->Is("msg.select"));
+	}
+
+
+	TEST(unknown_access_token)
+	{
+		granada::http::session::MapSessionFactory session_factory;
+		SignedOAuth2Authorization authorization(parameters(),&session_factory);
+		VERIFY_IS_FALSE(authorization.AccessToken("")->IsValid());
+		VERIFY_IS_FALSE(authorization.AccessToken("k5g25AGZcIfjduQ9vkLTzUXGbnBjbQ4R")->Is("msg.select"));
+
+		SignedOAuth2Authorization without_sessions(parameters(),nullptr);
+		VERIFY_IS_FALSE(without_sessions.AccessToken("k5g25AGZcIfjduQ9vkLTzUXGbnBjbQ4R")->IsValid());
+	}
+
+
+	TEST(grant_information_delete)
+	{
+		granada::http::session::MapSessionFactory session_factory;
+		const std::string client_id = register_client();
+		register_user("grant.user","Zq4mPw9sLx2c");
+		web::http::http_request request;
+		web::http::http_response response;
+
+		// the user authorizes the client, which receives a code.
+		granada::http::oauth2::OAuth2Parameters code_request;
+		code_request.client_id = client_id;
+		code_request.response_type = oauth2_strings_2::code;
+		code_request.username = "grant.user";
+		code_request.password = "Zq4mPw9sLx2c";
+		code_request.scope = "msg.select";
+		granada::http::oauth2::MapOAuth2Authorization code_authorization(code_request,&session_factory);
+		const granada::http::oauth2::OAuth2Parameters& code_response = code_authorization.Grant(request,response);
+		VERIFY_ARE_EQUAL(code_response.error,"");
+		VERIFY_ARE_NOT_EQUAL(code_response.code,"");
+
+		// the client exchanges the code for an access token.
+		granada::http::oauth2::OAuth2Parameters token_request;
+		token_request.client_id = client_id;
+		token_request.grant_type = oauth2_strings_2::authorization_code;
+		token_request.code = code_response.code;
+		granada::http::oauth2::MapOAuth2Authorization token_authorization(token_request,&session_factory);
+		const granada::http::oauth2::OAuth2Parameters& token_response = token_authorization.Grant(request,response);
+		VERIFY_ARE_EQUAL(token_response.error,"");
+		VERIFY_ARE_NOT_EQUAL(token_response.access_token,"");
+		VERIFY_IS_TRUE(token_authorization.AccessToken(token_response.access_token)->Is("msg.select"));
+
+		// the authorization is listed.
+		granada::http::oauth2::OAuth2Parameters user_parameters;
+		user_parameters.username = "grant.user";
+		granada::http::oauth2::MapOAuth2Authorization user_authorization(user_parameters,&session_factory);
+		VERIFY_IS_TRUE(information(user_authorization) == std::vector<std::string>(1,client_id));
+
+		user_parameters.client_id = client_id;
+		granada::http::oauth2::MapOAuth2Authorization client_authorization(user_parameters,&session_factory);
+		VERIFY_IS_TRUE(information(client_authorization) == std::vector<std::string>(1,code_response.code));
+
+		// deleting it closes the access token and removes the code.
+		client_authorization.Delete();
+		VERIFY_IS_FALSE(token_authorization.AccessToken(token_response.access_token)->IsValid());
+		VERIFY_IS_TRUE(information(user_authorization).empty());
+		VERIFY_ARE_EQUAL(granada::http::oauth2::MapOAuth2Code(code_response.code).GetCode(),"");
+	}
+
+
+	TEST(refresh_token_grant)
+	{
+		granada::http::session::MapSessionFactory session_factory;
+		const std::string client_id = register_client();
+		register_user("refresh.user","Hw5cJt8nVe3x");
+		web::http::http_request request;
+		web::http::http_response response;
+
+		granada::http::oauth2::OAuth2Parameters code_request;
+		code_request.client_id = client_id;
+		code_request.response_type = oauth2_strings_2::code;
+		code_request.username = "refresh.user";
+		code_request.password = "Hw5cJt8nVe3x";
+		code_request.scope = "msg.select";
+		granada::http::oauth2::MapOAuth2Authorization code_authorization(code_request,&session_factory);
+		const granada::http::oauth2::OAuth2Parameters& code_response = code_authorization.Grant(request,response);
+		VERIFY_ARE_EQUAL(code_response.error,"");
+
+		// the code is exchanged for an access token and a refresh token.
+		granada::http::oauth2::OAuth2Parameters token_request;
+		token_request.client_id = client_id;
+		token_request.grant_type = oauth2_strings_2::authorization_code;
+		token_request.code = code_response.code;
+		RefreshOAuth2Authorization token_authorization(token_request,&session_factory);
+		const granada::http::oauth2::OAuth2Parameters& token_response = token_authorization.Grant(request,response);
+		VERIFY_ARE_EQUAL(token_response.error,"");
+		VERIFY_ARE_NOT_EQUAL(token_response.refresh_token,"");
+
+		// the refresh token is exchanged for a new access token.
+		granada::http::oauth2::OAuth2Parameters refresh_request;
+		refresh_request.client_id = client_id;
+		refresh_request.grant_type = oauth2_strings_2::refresh_token;
+		refresh_request.refresh_token = token_response.refresh_token;
+		RefreshOAuth2Authorization refresh_authorization(refresh_request,&session_factory);
+		const granada::http::oauth2::OAuth2Parameters& refresh_response = refresh_authorization.Grant(request,response);
+		VERIFY_ARE_EQUAL(refresh_response.error,"");
+		VERIFY_ARE_NOT_EQUAL(refresh_response.access_token,"");
+		VERIFY_ARE_NOT_EQUAL(refresh_response.access_token,token_response.access_token);
+		VERIFY_IS_TRUE(refresh_authorization.AccessToken(refresh_response.access_token)->Is("msg.select"));
+	}
+
+
+	TEST(implicit_grant_information_delete)
+	{
+		granada::http::session::MapSessionFactory session_factory;
+		const std::string client_id = register_client();
+		register_user("implicit.user","Rt7vNb3kQs8d");
+		web::http::http_request request;
+		web::http::http_response response;
+
+		granada::http::oauth2::OAuth2Parameters token_request;
+		token_request.client_id = client_id;
+		token_request.response_type = oauth2_strings_2::token;
+		token_request.username = "implicit.user";
+		token_request.password = "Rt7vNb3kQs8d";
+		token_request.scope = "msg.select";
+		granada::http::oauth2::MapOAuth2Authorization token_authorization(token_request,&session_factory);
+		const granada::http::oauth2::OAuth2Parameters& token_response = token_authorization.Grant(request,response);
+		VERIFY_ARE_EQUAL(token_response.error,"");
+		VERIFY_IS_TRUE(token_authorization.AccessToken(token_response.access_token)->Is("msg.select"));
+
+		granada::http::oauth2::OAuth2Parameters user_parameters;
+		user_parameters.username = "implicit.user";
+		granada::http::oauth2::MapOAuth2Authorization user_authorization(user_parameters,&session_factory);
+		VERIFY_IS_TRUE(information(user_authorization) == std::vector<std::string>(1,client_id));
+
+		user_parameters.client_id = client_id;
+		granada::http::oauth2::MapOAuth2Authorization client_authorization(user_parameters,&session_factory);
+		VERIFY_IS_TRUE(information(client_authorization).empty());
+
+		client_authorization.Delete();
+		VERIFY_IS_FALSE(token_authorization.AccessToken(token_response.access_token)->IsValid());
+		VERIFY_IS_TRUE(information(user_authorization).empty());
+	}
+
+
+	TEST(authorization_granted_before_indexing)
+	{
+		granada::http::session::MapSessionFactory session_factory;
+		const std::string client_id = register_client();
+		std::unique_ptr<granada::http::session::Session> session = session_factory.Session_unique_ptr();
+		session->Open();
+		session->roles()->Add("msg.select");
+
+		// authorization stored only with its key, as before the indexes.
+		granada::http::oauth2::OAuth2Parameters user_parameters;
+		user_parameters.username = "legacy.user";
+		granada::http::oauth2::MapOAuth2Authorization user_authorization(user_parameters,&session_factory);
+		user_authorization.cache()->Write(cache_namespaces::oauth2_authorization + std::string("legacy.user:") + client_id + ":V3fRk8sJq2LmNc5w:" + session->GetToken(),"0");
+		VERIFY_IS_TRUE(information(user_authorization) == std::vector<std::string>(1,client_id));
+
+		user_parameters.client_id = client_id;
+		granada::http::oauth2::MapOAuth2Authorization client_authorization(user_parameters,&session_factory);
+		VERIFY_IS_TRUE(information(client_authorization) == std::vector<std::string>(1,"V3fRk8sJq2LmNc5w"));
+		VERIFY_IS_TRUE(client_authorization.AccessToken(session->GetToken())->IsValid());
+
+		client_authorization.Delete();
+		VERIFY_IS_FALSE(client_authorization.AccessToken(session->GetToken())->IsValid());
+		VERIFY_IS_TRUE(information(user_authorization).empty());
+	}
+
+}
+
+} } } //namespaces
@@ -0,0 +1,103 @@
+/**
+ * Copyright (c) <2016> Web App SDK granada <afernandez@cookinapps.io>
+ *
+ * This source code is licensed under the MIT license.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * =+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+
+ * =+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+
+ *
+ * Tests for granada::http::oauth2::OAuth2Parameters::Parse
+ *
+ * =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-
+ **/
+#include "stdafx.h"
+#include <string>
+#include "granada/http/oauth2/oauth2.h"
+
+namespace granada { namespace test { namespace http {
+
+SUITE(oauth2_parameters)
+{
+
+	TEST(known_fields)
+	{
+		granada::http::oauth2::OAuth2Parameters parameters("grant_type=authorization_code&code=SplxlOBeZQQYbYS6WxSbIA&client_id=gida8fZEFh9abpkg&state=xyz");
+		VERIFY_ARE_EQUAL(parameters.grant_type,"authorization_code");
+		VERIFY_ARE_EQUAL(parameters.code,"SplxlOBeZQQYbYS6WxSbIA");
+		VERIFY_ARE_EQUAL(parameters.client_id,"gida8fZEFh9abpkg");
+		VERIFY_ARE_EQUAL(parameters.state,"xyz");
+		VERIFY_ARE_EQUAL(parameters.access_token,"");
+	}
+
+
+	TEST(repeated_keys)
+	{
+		// the last value is kept.
+		granada::http::oauth2::OAuth2Parameters parameters("scope=msg.select&scope=msg.insert&state=a&state=b");
+		VERIFY_ARE_EQUAL(parameters.scope,"msg.insert");
+		VERIFY_ARE_EQUAL(parameters.state,"b");
+	}
+
+
+	TEST(missing_values)
+	{
+		granada::http::oauth2::OAuth2Parameters parameters("code=&state&=orphan&&client_id=gida8fZEFh9abpkg&");
+		VERIFY_ARE_EQUAL(parameters.code,"");
+		VERIFY_ARE_EQUAL(parameters.state,"");
+		VERIFY_ARE_EQUAL(parameters.client_id,"gida8fZEFh9abpkg");
+
+		// an empty value does not clear a previous one.
+		parameters.Parse("client_id=");
+		VERIFY_ARE_EQUAL(parameters.client_id,"gida8fZEFh9abpkg");
+
+		granada::http::oauth2::OAuth2Parameters empty("");
+		VERIFY_ARE_EQUAL(empty.client_id,"");
+	}
+
+
+	TEST(percent_encoding)
+	{
+		granada::http::oauth2::OAuth2Parameters parameters("redirect_uri=https%3A%2F%2Fclient.example.com%2Fcb%3Fa%3D1%26b%3D2&scope=msg.select+msg.insert&state=%e2%82%ac");
+		VERIFY_ARE_EQUAL(parameters.redirect_uri,"https://client.example.com/cb?a=1&b=2");
+		// "+" is left as it is, the scope is normalized when granting.
+		VERIFY_ARE_EQUAL(parameters.scope,"msg.select+msg.insert");
+		VERIFY_ARE_EQUAL(parameters.state,"\xe2\x82\xac");
+
+		// malformed escapes are copied as they are.
+		parameters.Parse("state=100%&code=%zz%4");
+		VERIFY_ARE_EQUAL(parameters.state,"100%");
+		VERIFY_ARE_EQUAL(parameters.code,"%zz%4");
+	}
+
+
+	TEST(unknown_fields)
+	{
+		granada::http::oauth2::OAuth2Parameters parameters("nonce=n-0S6_WzA2Mj&codes=abc&CODE=abc&code_x=abc&code=def");
+		VERIFY_ARE_EQUAL(parameters.code,"def");
+		VERIFY_ARE_EQUAL(parameters.error,"");
+
+		granada::http::oauth2::OAuth2Parameters unknown("nonce=n-0S6_WzA2Mj");
+		VERIFY_ARE_EQUAL(unknown.code,"");
+		VERIFY_IS_TRUE(unknown.to_query_string().empty());
+	}
+
+}
+
+} } } //namespaces
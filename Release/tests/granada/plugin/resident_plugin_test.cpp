@@ -0,0 +1,204 @@
+/**
+ * Copyright (c) <2016> Web App SDK granada <afernandez@cookinapps.io>
+ *
+ * This source code is licensed under the MIT license.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * =+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+
+ *
+ * Tests for granada::plugin::ResidentPlugin
+ *
+ * =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-
+ **/
+#include "stdafx.h"
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <string>
+#include <thread>
+#include <vector>
+#include "cpprest/json.h"
+#include "granada/plugin/resident_plugin.h"
+
+
+namespace granada { namespace test { namespace plugin {
+
+// instance understanding a few scripts instead of javascript:
+// "incr" adds one to a counter and returns it, "block" waits
+// until the test releases it, "thread" returns the thread id.
+class CounterInstance : public granada::runner::Instance
+{
+  public:
+    CounterInstance(std::shared_future<void> release, std::promise<void>* blocked) : release_(release), blocked_(blocked){};
+
+    std::string Run(const std::string& script){
+      const std::string restore = "__PLUGIN.state = ";
+      const std::size_t restore_pos = script.find(restore);
+      if (restore_pos != std::string::npos){
+        count_ = std::stoi(script.substr(restore_pos + restore.size()));
+        return std::string();
+      }
+      if (script.find("JSON.stringify(__PLUGIN.state)") != std::string::npos){
+        return "state:" + std::to_string(count_);
+      }
+      if (script == "incr"){
+        return std::to_string(++count_);
+      }
+      if (script == "block"){
+        blocked_->set_value();
+        release_.wait();
+        return "released";
+      }
+      if (script == "thread"){
+        return std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id()));
+      }
+      return std::string();
+    };
+
+  private:
+    int count_ = 0;
+    std::shared_future<void> release_;
+    std::promise<void>* blocked_;
+};
+
+
+class CounterRunner : public granada::runner::Runner
+{
+  public:
+    CounterRunner() : release_(release_promise_.get_future().share()){};
+
+    virtual std::unique_ptr<granada::runner::Instance> Instance_unique_ptr(){
+      return std::unique_ptr<granada::runner::Instance>(new CounterInstance(release_, &blocked_));
+    };
+
+    void Release(){
+      release_promise_.set_value();
+    };
+
+    std::promise<void> blocked_;
+
+  private:
+    std::promise<void> release_promise_;
+    std::shared_future<void> release_;
+};
+
+
+std::string error(const std::string& response){
+  const web::json::value& json = web::json::value::parse(response);
+  return json.at("error").as_string();
+}
+
+
+SUITE(resident_plugin)
+{
+
+	TEST(calls_run_one_after_the_other)
+	{
+	    CounterRunner runner;
+	    std::string checkpointed;
+	    {
+	      granada::plugin::ResidentPlugin resident(&runner, "init", "", [&checkpointed](const std::string& state){ checkpointed = state; }, 1024, 5000, 60000);
+
+	      std::vector<std::thread> threads;
+	      for (int i = 0; i < 4; ++i){
+	        threads.push_back(std::thread([&resident]{
+	          for (int j = 0; j < 25; ++j){
+	            resident.Run("incr");
+	          }
+	        }));
+	      }
+	      for (auto& thread : threads){
+	        thread.join();
+	      }
+
+	      VERIFY_ARE_EQUAL(resident.Run("incr"), "101");
+	      VERIFY_ARE_EQUAL(resident.Run("thread"), resident.Run("thread"));
+	    }
+
+	    // checkpointed when stopped.
+	    VERIFY_ARE_EQUAL(checkpointed, "101");
+	}
+
+	TEST(starts_with_the_checkpointed_state)
+	{
+	    CounterRunner runner;
+	    granada::plugin::ResidentPlugin resident(&runner, "init", "41", [](const std::string& state){}, 1024, 5000, 0);
+	    VERIFY_ARE_EQUAL(resident.Run("incr"), "42");
+	}
+
+	TEST(checkpoints_after_the_interval)
+	{
+	    CounterRunner runner;
+	    std::promise<std::string> checkpointed;
+	    granada::plugin::ResidentPlugin resident(&runner, "init", "", [&checkpointed](const std::string& state){ checkpointed.set_value(state); }, 1024, 5000, 20);
+	    resident.Run("incr");
+
+	    // no other call comes, the checkpoint is done while waiting.
+	    std::future<std::string> state = checkpointed.get_future();
+	    VERIFY_IS_TRUE(state.wait_for(std::chrono::seconds(5)) == std::future_status::ready);
+	    VERIFY_ARE_EQUAL(state.get(), "1");
+	}
+
+	TEST(mailbox_full)
+	{
+	    CounterRunner runner;
+	    granada::plugin::ResidentPlugin resident(&runner, "init", "", [](const std::string& state){}, 1, 0, 0);
+
+	    std::future<std::string> blocked_call = std::async(std::launch::async, [&resident]{ return resident.Run("block"); });
+	    runner.blocked_.get_future().wait();
+	    std::future<std::string> waiting_call = std::async(std::launch::async, [&resident]{ return resident.Run("incr"); });
+	    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+	    VERIFY_ARE_EQUAL(error(resident.Run("incr")), "resident_mailbox_full");
+
+	    runner.Release();
+	    VERIFY_ARE_EQUAL(blocked_call.get(), "released");
+	    VERIFY_ARE_EQUAL(waiting_call.get(), "1");
+	}
+
+	TEST(timeout)
+	{
+	    CounterRunner runner;
+	    granada::plugin::ResidentPlugin resident(&runner, "init", "", [](const std::string& state){}, 1024, 50, 0);
+
+	    VERIFY_ARE_EQUAL(error(resident.Run("block")), "resident_timeout");
+
+	    // the call still runs.
+	    runner.Release();
+	    VERIFY_ARE_EQUAL(resident.Run("incr"), "1");
+	}
+
+	TEST(stopped)
+	{
+	    CounterRunner runner;
+	    granada::plugin::ResidentPlugin resident(&runner, "init", "", [](const std::string& state){}, 1024, 5000, 0);
+	    resident.Stop();
+	    VERIFY_ARE_EQUAL(error(resident.Run("incr")), "resident_stopped");
+	}
+
+	TEST(runner_without_instances)
+	{
+	    granada::runner::Runner runner;
+	    granada::plugin::ResidentPlugin resident(&runner, "init", "", [](const std::string& state){}, 1024, 5000, 0);
+	    VERIFY_ARE_EQUAL(error(resident.Run("incr")), "runner_initialization_error");
+	}
+
+}
+
+} } }
@@ -0,0 +1,142 @@
+/**
+ * Copyright (c) <2016> Web App SDK granada <afernandez@cookinapps.io>
+ *
+ * This source code is licensed under the MIT license.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * =+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+
+ *
+ * Tests for granada::runner::NativeRunner
+ *
+ * =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-
+ **/
+#include "stdafx.h"
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include "cpprest/json.h"
+#include "granada/runner/native_runner.h"
+
+
+namespace granada { namespace test { namespace runner {
+
+SUITE(native_runner)
+{
+
+	TEST(run)
+	{
+	    granada::runner::NativeRunner runner;
+	    const web::json::value& response = web::json::value::parse(runner.Run(GRANADA_NATIVE_TEST_PLUGIN, "test.native", "ph1", "{\"factor\":2}", "{\"a\":1}", ""));
+	    VERIFY_ARE_EQUAL(response.at("plugin_id").as_string(), "test.native");
+	    VERIFY_ARE_EQUAL(response.at("plugin_handler_id").as_string(), "ph1");
+	    VERIFY_ARE_EQUAL(response.at("configuration").at("factor").as_integer(), 2);
+	    VERIFY_ARE_EQUAL(response.at("parameters").at("a").as_integer(), 1);
+	    VERIFY_IS_TRUE(response.at("event_name").is_null());
+	}
+
+	TEST(run_event)
+	{
+	    granada::runner::NativeRunner runner;
+	    web::json::value response = web::json::value::parse(runner.Run(GRANADA_NATIVE_TEST_PLUGIN, "test.native", "ph1", "{}", "{\"a\":1}", "calculate"));
+	    VERIFY_ARE_EQUAL(response.at("on_event").as_string(), "calculate");
+	    VERIFY_ARE_EQUAL(response.at("parameters").at("a").as_integer(), 1);
+
+	    response = web::json::value::parse(runner.Run(GRANADA_NATIVE_TEST_PLUGIN, "test.native", "ph1", "{}", "{}", "run-event"));
+	    VERIFY_ARE_EQUAL(response.at("event_name").as_string(), "run-event");
+	}
+
+	TEST(on_message)
+	{
+	    granada::runner::NativeRunner runner;
+	    runner.functions()->Add("__echo", [](const web::json::value& parameters){
+	      web::json::value response = web::json::value::object();
+	      response["echoed"] = parameters;
+	      return response;
+	    });
+
+	    const web::json::value& response = web::json::value::parse(runner.OnMessage(GRANADA_NATIVE_TEST_PLUGIN, "test.native", "ph1", "{}", "{\"message\":\"hi\"}", "math.sum"));
+	    VERIFY_ARE_EQUAL(response.at("from").as_string(), "math.sum");
+	    VERIFY_ARE_EQUAL(response.at("echo").at("echoed").at("message").as_string(), "hi");
+	}
+
+	TEST(undefined_function)
+	{
+	    granada::runner::NativeRunner runner;
+	    const web::json::value& response = web::json::value::parse(runner.OnMessage(GRANADA_NATIVE_TEST_PLUGIN, "test.native", "ph1", "{}", "{}", "math.sum"));
+	    VERIFY_IS_TRUE(response.at("echo").has_field("error"));
+	}
+
+	TEST(missing_library)
+	{
+	    granada::runner::NativeRunner runner;
+	    for (int i = 0; i < 2; ++i){
+	      const web::json::value& response = web::json::value::parse(runner.Run("./granada_missing_plugin.so"));
+	      VERIFY_ARE_EQUAL(response.at("error").as_string(), "runner_initialization_error");
+	      VERIFY_IS_FALSE(response.at("error_description").as_string().empty());
+	    }
+	}
+
+	TEST(replaced_library)
+	{
+	    granada::runner::NativeRunner runner;
+	    const std::string library_path = "./granada_replaced_plugin.so";
+	    std::remove(library_path.c_str());
+
+	    // failed loads are not kept.
+	    web::json::value response = web::json::value::parse(runner.Run(library_path));
+	    VERIFY_ARE_EQUAL(response.at("error").as_string(), "runner_initialization_error");
+
+	    const std::string copy_path = library_path + ".new";
+	    {
+	      std::ifstream in(GRANADA_NATIVE_TEST_PLUGIN, std::ios::binary);
+	      std::ofstream out(copy_path, std::ios::binary);
+	      out << in.rdbuf();
+	    }
+	    VERIFY_ARE_EQUAL(std::rename(copy_path.c_str(), library_path.c_str()), 0);
+	    const std::string& version = granada::runner::NativeRunner::Version(library_path);
+	    VERIFY_IS_FALSE(version.empty());
+
+	    response = web::json::value::parse(runner.Run(library_path, "test.native", "ph1", "{}", "{\"a\":1}", ""));
+	    VERIFY_ARE_EQUAL(response.at("parameters").at("a").as_integer(), 1);
+
+	    // replacing the file gives a new version, opened again.
+	    {
+	      std::ifstream in(GRANADA_NATIVE_TEST_PLUGIN, std::ios::binary);
+	      std::ofstream out(copy_path, std::ios::binary);
+	      out << in.rdbuf();
+	    }
+	    VERIFY_ARE_EQUAL(std::rename(copy_path.c_str(), library_path.c_str()), 0);
+	    VERIFY_ARE_NOT_EQUAL(granada::runner::NativeRunner::Version(library_path), version);
+
+	    response = web::json::value::parse(runner.Run(library_path, "test.native", "ph1", "{}", "{\"a\":2}", ""));
+	    VERIFY_ARE_EQUAL(response.at("parameters").at("a").as_integer(), 2);
+
+	    std::remove(library_path.c_str());
+	}
+
+	TEST(extensions)
+	{
+	    granada::runner::NativeRunner runner;
+	    VERIFY_ARE_EQUAL(runner.extensions().size(), 1);
+	    VERIFY_ARE_EQUAL(runner.extensions()[0], "so");
+	}
+
+}
+
+} } }
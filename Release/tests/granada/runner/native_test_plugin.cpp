@@ -0,0 +1,87 @@
+/**
+ * Copyright (c) <2016> Web App SDK granada <afernandez@cookinapps.io>
+ *
+ * This source code is licensed under the MIT license.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * =+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+
+ *
+ * Native plug-in used by the granada::runner::NativeRunner tests,
+ * responds with what it receives.
+ *
+ * =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-
+ **/
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include "granada/plugin/native_plugin.h"
+
+
+namespace {
+
+	char* response(const std::string& str)
+	{
+	    char* response = static_cast<char*>(std::malloc(str.size() + 1));
+	    std::memcpy(response, str.c_str(), str.size() + 1);
+	    return response;
+	}
+
+	std::string quoted(const char* str)
+	{
+	    return str == NULL ? "null" : "\"" + std::string(str) + "\"";
+	}
+
+}
+
+
+extern "C" {
+
+	int granada_plugin_init(unsigned int abi_version)
+	{
+	    return abi_version == GRANADA_NATIVE_PLUGIN_ABI_VERSION ? 0 : 1;
+	}
+
+	char* granada_plugin_run(const granada_plugin_context* context, const char* parameters, const char* event_name)
+	{
+	    return response("{\"plugin_id\":" + quoted(context->plugin_id) + ",\"plugin_handler_id\":" + quoted(context->plugin_handler_id) + ",\"configuration\":" + context->configuration + ",\"parameters\":" + parameters + ",\"event_name\":" + quoted(event_name) + "}");
+	}
+
+	char* granada_plugin_on_event(const granada_plugin_context* context, const char* event_name, const char* parameters)
+	{
+	    if (std::strcmp(event_name, "run-event") == 0){
+	      return granada_plugin_run(context, parameters, event_name);
+	    }
+	    return response("{\"on_event\":" + quoted(event_name) + ",\"parameters\":" + parameters + "}");
+	}
+
+	char* granada_plugin_on_message(const granada_plugin_context* context, const char* message, const char* from)
+	{
+	    // answer with the response of a function of the host.
+	    char* echo = context->call(context->host, "__echo", message);
+	    const std::string& str = "{\"from\":" + quoted(from) + ",\"echo\":" + echo + "}";
+	    context->release(echo);
+	    return response(str);
+	}
+
+	void granada_plugin_free(char* response)
+	{
+	    std::free(response);
+	}
+
+}
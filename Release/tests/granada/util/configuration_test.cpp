@@ -0,0 +1,171 @@
+/**
+ * Copyright (c) <2016> Web App SDK granada <afernandez@cookinapps.io>
+ *
+ * This source code is licensed under the MIT license.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * =+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+
+ *
+ * Tests for granada::util::configuration
+ *
+ * =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-
+ **/
+#include "stdafx.h"
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include "granada/util/application.h"
+#include "granada/util/configuration.h"
+
+
+namespace granada { namespace test { namespace util {
+
+SUITE(configuration)
+{
+
+	/**
+	 * Writes a configuration file in the temporary directory.
+	 */
+	static std::string WriteConfiguration(const std::string& content)
+	{
+	    const std::string file_path = "/tmp/granada_configuration_test.conf";
+	    std::ofstream file(file_path, std::ios::trunc);
+	    file << content;
+	    return file_path;
+	}
+
+	TEST(parse_bool)
+	{
+	    bool value = false;
+	    VERIFY_IS_TRUE(granada::util::configuration::ParseBool("on", value));
+	    VERIFY_IS_TRUE(value);
+	    VERIFY_IS_TRUE(granada::util::configuration::ParseBool(" TRUE ", value));
+	    VERIFY_IS_TRUE(value);
+	    VERIFY_IS_TRUE(granada::util::configuration::ParseBool("off", value));
+	    VERIFY_IS_FALSE(value);
+	    VERIFY_IS_TRUE(granada::util::configuration::ParseBool("0", value));
+	    VERIFY_IS_FALSE(value);
+	    VERIFY_IS_FALSE(granada::util::configuration::ParseBool("maybe", value));
+	    VERIFY_IS_FALSE(granada::util::configuration::ParseBool("", value));
+	}
+
+	TEST(parse_duration)
+	{
+	    std::chrono::milliseconds value(0);
+	    VERIFY_IS_TRUE(granada::util::configuration::ParseDuration("250ms", value));
+	    VERIFY_ARE_EQUAL(value.count(), 250);
+	    VERIFY_IS_TRUE(granada::util::configuration::ParseDuration("30", value));
+	    VERIFY_ARE_EQUAL(value.count(), 30000);
+	    VERIFY_IS_TRUE(granada::util::configuration::ParseDuration("1.5 s", value));
+	    VERIFY_ARE_EQUAL(value.count(), 1500);
+	    VERIFY_IS_TRUE(granada::util::configuration::ParseDuration("5m", value));
+	    VERIFY_ARE_EQUAL(value.count(), 300000);
+	    VERIFY_IS_TRUE(granada::util::configuration::ParseDuration("1h", value));
+	    VERIFY_ARE_EQUAL(value.count(), 3600000);
+	    VERIFY_IS_FALSE(granada::util::configuration::ParseDuration("5 weeks", value));
+	    VERIFY_IS_FALSE(granada::util::configuration::ParseDuration("soon", value));
+	}
+
+	TEST(typed_properties)
+	{
+	    const std::string file_path = WriteConfiguration(
+	      "gzip_content=on\n"
+	      "maximum_cache_memory=64\n"
+	      "default_files=[\"index.html\"]\n"
+	      "content_types={\"text/html\":[\"html\"]}\n"
+	      "default_content_type=text/plain\n"
+	      "my_property=my value\n");
+	    granada::util::configuration::Load(file_path);
+
+	    VERIFY_IS_TRUE(granada::util::configuration::Bool(granada::util::configuration::gzip_content));
+	    VERIFY_ARE_EQUAL(granada::util::configuration::Int(granada::util::configuration::maximum_cache_memory), 64);
+	    VERIFY_ARE_EQUAL(granada::util::configuration::String(granada::util::configuration::default_content_type), "text/plain");
+	    VERIFY_IS_TRUE(granada::util::configuration::Json(granada::util::configuration::default_files).is_array());
+	    VERIFY_ARE_EQUAL(granada::util::configuration::Json(granada::util::configuration::default_files).size(), 1);
+	    VERIFY_IS_TRUE(granada::util::configuration::Json(granada::util::configuration::content_types).has_field(U("text/html")));
+	    VERIFY_ARE_EQUAL(granada::util::application::GetProperty("my_property"), "my value");
+	    VERIFY_ARE_EQUAL(granada::util::application::GetProperty("missing_property"), "");
+
+	    // properties not found take their default value.
+	    VERIFY_IS_FALSE(granada::util::configuration::Bool(granada::util::configuration::cache_content));
+	    VERIFY_ARE_EQUAL(granada::util::configuration::String(granada::util::configuration::root_path), "www");
+	    VERIFY_IS_TRUE(granada::util::configuration::Json(granada::util::configuration::error_paths).is_object());
+
+	    std::remove(file_path.c_str());
+	}
+
+	TEST(invalid_properties)
+	{
+	    const std::string file_path = WriteConfiguration(
+	      "gzip_content=maybe\n"
+	      "maximum_cache_memory=64MB\n"
+	      "default_files=[\"index.html\"\n");
+	    granada::util::configuration::Load(file_path);
+
+	    // properties that can't be parsed take their default value.
+	    VERIFY_IS_FALSE(granada::util::configuration::Bool(granada::util::configuration::gzip_content));
+	    VERIFY_ARE_EQUAL(granada::util::configuration::Int(granada::util::configuration::maximum_cache_memory), 0);
+	    VERIFY_IS_TRUE(granada::util::configuration::Json(granada::util::configuration::default_files).is_array());
+	    VERIFY_ARE_EQUAL(granada::util::configuration::Json(granada::util::configuration::default_files).size(), 0);
+
+	    std::remove(file_path.c_str());
+	}
+
+	TEST(reload)
+	{
+	    const std::string file_path = WriteConfiguration("default_content_type=text/plain\n");
+	    granada::util::configuration::Load(file_path);
+	    const unsigned long version = granada::util::configuration::version();
+	    const std::shared_ptr<const granada::util::configuration::Snapshot> before = granada::util::configuration::Current();
+
+	    WriteConfiguration("default_content_type=text/html\n");
+	    granada::util::configuration::Reload();
+
+	    VERIFY_ARE_EQUAL(granada::util::configuration::version(), version + 1);
+	    VERIFY_ARE_EQUAL(granada::util::configuration::String(granada::util::configuration::default_content_type), "text/html");
+	    // the previous snapshot remains valid while it is held.
+	    VERIFY_ARE_EQUAL((*before)[granada::util::configuration::default_content_type].string, "text/plain");
+
+	    std::remove(file_path.c_str());
+	}
+
+	TEST(reload_unchanged)
+	{
+	    const std::string file_path = WriteConfiguration("default_content_type=text/plain\n");
+	    granada::util::configuration::Load(file_path);
+	    const unsigned long version = granada::util::configuration::version();
+	    const std::shared_ptr<const granada::util::configuration::Snapshot> current = granada::util::configuration::Current();
+
+	    // the file has not changed, the snapshot is not replaced.
+	    granada::util::configuration::Reload();
+	    VERIFY_ARE_EQUAL(granada::util::configuration::version(), version);
+	    VERIFY_IS_TRUE(granada::util::configuration::Current() == current);
+
+	    WriteConfiguration("default_content_type=text/html\n");
+	    granada::util::configuration::Reload();
+	    VERIFY_ARE_EQUAL(granada::util::configuration::version(), version + 1);
+	    VERIFY_IS_FALSE(granada::util::configuration::Current() == current);
+
+	    std::remove(file_path.c_str());
+	}
+
+}
+
+} } }
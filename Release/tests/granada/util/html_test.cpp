@@ -0,0 +1,83 @@
+/**
+ * Copyright (c) <2016> Web App SDK granada <afernandez@cookinapps.io>
+ *
+ * This source code is licensed under the MIT license.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * =+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+
+ *
+ * Tests for granada::util::html
+ *
+ * =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-
+ **/
+#include "stdafx.h"
+#include "granada/util/html.h"
+#include <string>
+#include <unordered_map>
+
+
+namespace granada { namespace test { namespace util {
+    
+SUITE(html)
+{
+
+	TEST(escape)
+	{
+	    std::string buffer;
+	    granada::util::html::escape("<a href=\"x\">Tom & Jerry's</a>", buffer);
+	    VERIFY_ARE_EQUAL(buffer, "&lt;a href=&quot;x&quot;&gt;Tom &amp; Jerry&#39;s&lt;/a&gt;");
+
+	    buffer.assign("prefix ");
+	    granada::util::html::escape("plain", buffer);
+	    VERIFY_ARE_EQUAL(buffer, "prefix plain");
+	}
+
+
+	TEST(render)
+	{
+	    std::unordered_map<std::string,std::string> values;
+	    values["username"] = "John Doe";
+	    values["date"] = "Tuesday, May 17, 2016";
+
+	    granada::util::html::Template html_template("hello {{username}} !!! {{date}}, bye {{username}}");
+	    VERIFY_ARE_EQUAL(html_template.Render(values), "hello John Doe !!! Tuesday, May 17, 2016, bye John Doe");
+	    VERIFY_ARE_EQUAL(html_template.placeholders().size(), 2);
+
+	    // placeholders without value are kept.
+	    html_template.Parse("{{username}} {{unknown}} {{");
+	    VERIFY_ARE_EQUAL(html_template.Render(values), "John Doe {{unknown}} {{");
+
+	    html_template.Parse("");
+	    VERIFY_ARE_EQUAL(html_template.Render(values), "");
+	}
+
+
+	TEST(render_escaped)
+	{
+	    std::unordered_map<std::string,std::string> values;
+	    values["state"] = "\"><script>alert(1)</script>";
+
+	    granada::util::html::Template html_template("<input type=\"hidden\" name=\"state\" value=\"{{state}}\">");
+	    VERIFY_ARE_EQUAL(html_template.Render(values), "<input type=\"hidden\" name=\"state\" value=\"&quot;&gt;&lt;script&gt;alert(1)&lt;/script&gt;\">");
+	    VERIFY_ARE_EQUAL(html_template.Render(values, false), "<input type=\"hidden\" name=\"state\" value=\"\"><script>alert(1)</script>\">");
+	}
+
+}
+
+} } } //namespaces
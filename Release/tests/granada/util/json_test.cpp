@@ -29,6 +29,7 @@
 #include "stdafx.h"
 #include "granada/util/time.h"
 #include "granada/util/json.h"
+#include "granada/util/json_document.h"
 #include "cpprest/json.h"
 
 
@@ -168,6 +169,90 @@ SUITE(string)
 
 	}
 
+
+	TEST(canonical)
+	{
+	    const web::json::value& json1 = web::json::value::parse("{\"b\":1,\"a\":{\"d\":[2,{\"f\":null,\"e\":\"x\"}],\"c\":true}}");
+	    const web::json::value& json2 = web::json::value::parse("{\"a\":{\"c\":true,\"d\":[2,{\"e\":\"x\",\"f\":null}]},\"b\":1}");
+
+	    VERIFY_ARE_EQUAL(granada::util::json::canonical(json1),"{\"a\":{\"c\":true,\"d\":[2,{\"e\":\"x\",\"f\":null}]},\"b\":1}");
+
+	    VERIFY_ARE_EQUAL(granada::util::json::canonical(json1),granada::util::json::canonical(json2));
+
+	    VERIFY_ARE_EQUAL(granada::util::json::canonical(web::json::value::string("hello")),"\"hello\"");
+
+	}
+
+
+	TEST(document)
+	{
+	    granada::util::json::document doc(" {\"id\":\"math.sum\", \"events\":[\"calculate\",\"sum\"], \"order\":-12, \"factor\":0.5e1, \"run\":true, \"obj\":{\"a\":null}} ");
+	    VERIFY_IS_TRUE(doc.valid());
+	    VERIFY_IS_TRUE(doc.root().is_object());
+	    VERIFY_ARE_EQUAL(doc.root().size(),6);
+
+	    VERIFY_ARE_EQUAL(doc.root().find("id").as_string(),"math.sum");
+	    VERIFY_IS_TRUE(doc.root().find("id").equals("math.sum"));
+	    VERIFY_ARE_EQUAL(doc.root().find("id").raw().str(),"\"math.sum\"");
+	    VERIFY_ARE_EQUAL(doc.root().find("events").size(),2);
+	    VERIFY_ARE_EQUAL(doc.root().find("events").at(1).as_string(),"sum");
+	    VERIFY_IS_FALSE(doc.root().find("events").at(2).exists());
+	    VERIFY_ARE_EQUAL(doc.root().find("order").as_integer(),-12);
+	    VERIFY_IS_TRUE(doc.root().find("order").is_integer());
+	    VERIFY_ARE_EQUAL(doc.root().find("factor").as_double(),5);
+	    VERIFY_IS_FALSE(doc.root().find("factor").is_integer());
+	    VERIFY_IS_TRUE(doc.root().find("run").as_bool());
+	    VERIFY_IS_TRUE(doc.root().find("obj").find("a").is_null());
+	    VERIFY_IS_TRUE(doc.root().find("obj").find("a").exists());
+	    VERIFY_IS_FALSE(doc.root().find("other").exists());
+	    VERIFY_ARE_EQUAL(doc.root().find("obj").raw().str(),"{\"a\":null}");
+
+	    std::string keys;
+	    for (auto it = doc.root().begin(); it != doc.root().end(); ++it){
+	      keys += it.key().as_string() + ",";
+	    }
+	    VERIFY_ARE_EQUAL(keys,"id,events,order,factor,run,obj,");
+
+	    web::json::value json = doc.root().to_value();
+	    VERIFY_ARE_EQUAL(json,web::json::value::parse(doc.source()));
+
+	    VERIFY_IS_TRUE(granada::util::json::document("[]").root().is_array());
+	    VERIFY_ARE_EQUAL(granada::util::json::document("[]").root().size(),0);
+	    VERIFY_IS_TRUE(granada::util::json::document("\"str\"").root().is_string());
+	}
+
+
+	TEST(document_malformed)
+	{
+	    const char* malformed[] = {"", " ", "{", "}", "{\"a\":}", "{\"a\" 1}", "{a:1}", "[1,]", "[1 2]", "{\"a\":1,}",
+	                               "01", "-", "1.", "1e", ".5", "tru", "nulls", "\"abc", "\"\\x\"", "\"\\u12g4\"", "{} {}"};
+	    for (const char* json : malformed){
+	      granada::util::json::document doc(json);
+	      VERIFY_IS_FALSE(doc.valid());
+	      VERIFY_IS_FALSE(doc.root().exists());
+	      VERIFY_IS_FALSE(doc.root().find("a").exists());
+	      VERIFY_ARE_EQUAL(doc.root().size(),0);
+	    }
+
+	    std::string deep(1000,'[');
+	    deep += std::string(1000,']');
+	    VERIFY_IS_FALSE(granada::util::json::document(deep).valid());
+	}
+
+
+	TEST(document_escape)
+	{
+	    granada::util::json::document doc("{\"k\\\"ey\":\"a\\n\\u00e9\\ud83d\\ude00\\/\"}");
+	    VERIFY_IS_TRUE(doc.valid());
+	    VERIFY_ARE_EQUAL(doc.root().find("k\"ey").as_string(),"a\n\xc3\xa9\xf0\x9f\x98\x80/");
+	    VERIFY_IS_TRUE(doc.root().find("k\"ey").equals("a\n\xc3\xa9\xf0\x9f\x98\x80/"));
+
+	    std::string json;
+	    granada::util::json::document::Quote(json,"say \"hi\"\\\n\x01");
+	    VERIFY_ARE_EQUAL(json,"\"say \\\"hi\\\"\\\\\\n\\u0001\"");
+	    VERIFY_ARE_EQUAL(granada::util::json::document(json).root().as_string(),"say \"hi\"\\\n\x01");
+	}
+
 }
     
 }}} //namespaces
@@ -0,0 +1,112 @@
+/**
+ * Copyright (c) <2016> Web App SDK granada <afernandez@cookinapps.io>
+ *
+ * This source code is licensed under the MIT license.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * =+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+
+ *
+ * Tests for granada::util::metrics
+ *
+ * =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-
+ **/
+#include "stdafx.h"
+#include <string>
+#include <thread>
+#include <vector>
+#include "granada/util/metrics.h"
+
+
+namespace granada { namespace test { namespace util {
+
+SUITE(metrics)
+{
+
+	TEST(counter)
+	{
+	    granada::util::metrics::Counter& counter = granada::util::metrics::GetCounter("granada_test_counter_total", "Test counter.", "thread=\"many\"");
+	    VERIFY_ARE_EQUAL(&counter, &granada::util::metrics::GetCounter("granada_test_counter_total", "Test counter.", "thread=\"many\""));
+
+	    std::vector<std::thread> threads;
+	    for (int i = 0; i < 8; ++i){
+	      threads.emplace_back([&counter](){
+	        for (int j = 0; j < 10000; ++j){
+	          counter.Increment();
+	        }
+	      });
+	    }
+	    for (auto it = threads.begin(); it != threads.end(); ++it){
+	      it->join();
+	    }
+	    VERIFY_ARE_EQUAL(counter.value(), 80000);
+
+	    counter.Increment(5);
+	    VERIFY_ARE_EQUAL(counter.value(), 80005);
+	}
+
+	TEST(histogram_buckets)
+	{
+	    // every value is in a bucket whose upper bound is not lower
+	    // than the value and at most 12.5% higher.
+	    for (uint64_t value = 0; value < 100000; value += 7){
+	      const uint64_t upper_bound = granada::util::metrics::Histogram::UpperBound(granada::util::metrics::Histogram::Bucket(value));
+	      VERIFY_IS_TRUE(upper_bound >= value);
+	      VERIFY_IS_TRUE(upper_bound <= value + value / 8);
+	    }
+	    VERIFY_ARE_EQUAL(granada::util::metrics::Histogram::Bucket(7), 7);
+	    VERIFY_ARE_EQUAL(granada::util::metrics::Histogram::Bucket(8), 8);
+	    VERIFY_ARE_EQUAL(granada::util::metrics::Histogram::Bucket(16), 16);
+	    VERIFY_ARE_EQUAL(granada::util::metrics::Histogram::Bucket(~0ULL), granada::util::metrics::Histogram::bucket_count - 1);
+	}
+
+	TEST(histogram_quantiles)
+	{
+	    granada::util::metrics::Histogram histogram;
+	    for (uint64_t value = 1; value <= 1000; ++value){
+	      histogram.Record(value);
+	    }
+	    const granada::util::metrics::Histogram::Snapshot& snapshot = histogram.snapshot();
+	    VERIFY_ARE_EQUAL(snapshot.count, 1000);
+	    VERIFY_ARE_EQUAL(snapshot.sum, 500500);
+
+	    const uint64_t median = snapshot.Quantile(0.5);
+	    VERIFY_IS_TRUE(median >= 500 && median <= 563);
+	    const uint64_t p99 = snapshot.Quantile(0.99);
+	    VERIFY_IS_TRUE(p99 >= 990 && p99 <= 1114);
+	    VERIFY_ARE_EQUAL(granada::util::metrics::Histogram().snapshot().Quantile(0.5), 0);
+	}
+
+	TEST(text)
+	{
+	    granada::util::metrics::GetCounter("granada_test_text_total", "Test text counter.").Increment(3);
+	    granada::util::metrics::GetHistogram("granada_test_text_seconds", "Test text histogram.", "operation=\"test\"").Record(1500);
+
+	    const std::string& text = granada::util::metrics::Text();
+	    VERIFY_IS_TRUE(text.find("# HELP granada_test_text_total Test text counter.\n") != std::string::npos);
+	    VERIFY_IS_TRUE(text.find("# TYPE granada_test_text_total counter\n") != std::string::npos);
+	    VERIFY_IS_TRUE(text.find("granada_test_text_total 3\n") != std::string::npos);
+	    VERIFY_IS_TRUE(text.find("# TYPE granada_test_text_seconds summary\n") != std::string::npos);
+	    VERIFY_IS_TRUE(text.find("granada_test_text_seconds{operation=\"test\",quantile=\"0.5\"} 0.001535\n") != std::string::npos);
+	    VERIFY_IS_TRUE(text.find("granada_test_text_seconds_sum{operation=\"test\"} 0.001500\n") != std::string::npos);
+	    VERIFY_IS_TRUE(text.find("granada_test_text_seconds_count{operation=\"test\"} 1\n") != std::string::npos);
+	}
+
+}
+
+} } }
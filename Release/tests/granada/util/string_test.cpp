@@ -132,6 +132,102 @@ SUITE(string)
 	}
 
 
+	TEST(replace_one_pass)
+	{
+		// values are not searched again.
+		std::deque<std::pair<std::string,std::string>> values;
+		values.push_back(std::make_pair("a","{{b}}"));
+		values.push_back(std::make_pair("b","x"));
+		std::string str = "{{a}} {{b}} {{c}}";
+		granada::util::string::replace(str,values);
+		VERIFY_ARE_EQUAL(str,"{{b}} x {{c}}");
+
+		// the first value of a repeated tag is used.
+		values.push_back(std::make_pair("b","y"));
+		str = "{{b}}{{b}}";
+		granada::util::string::replace(str,values);
+		VERIFY_ARE_EQUAL(str,"xx");
+
+		// patterns sharing prefixes and suffixes.
+		granada::util::string::replacer patterns;
+		patterns.Add("he","1");
+		patterns.Add("she","2");
+		patterns.Add("hers","3");
+		patterns.Add("+"," ");
+		str = "ushers+she+hers";
+		patterns.Replace(str);
+		VERIFY_ARE_EQUAL(str,"u2rs 2 1rs");
+
+		str = "nothing to replace";
+		patterns.Replace(str);
+		VERIFY_ARE_EQUAL(str,"nothing to replace");
+
+		str = "";
+		patterns.Replace(str);
+		VERIFY_ARE_EQUAL(str,"");
+
+		str = "msg.select+msg.insert";
+		granada::util::string::replace(str,"+"," ");
+		VERIFY_ARE_EQUAL(str,"msg.select msg.insert");
+
+		str = "aaaa";
+		granada::util::string::replace(str,"aa","a");
+		VERIFY_ARE_EQUAL(str,"aa");
+	}
+
+
+	TEST(split)
+	{
+		std::vector<std::string> elems;
+		granada::util::string::split("a,b,,c",',',elems);
+		VERIFY_ARE_EQUAL(elems.size(),4);
+		VERIFY_ARE_EQUAL(elems[0],"a");
+		VERIFY_ARE_EQUAL(elems[2],"");
+		VERIFY_ARE_EQUAL(elems[3],"c");
+
+		// as std::getline, no empty part after the last delimiter.
+		elems.clear();
+		granada::util::string::split("a,b,",',',elems);
+		VERIFY_ARE_EQUAL(elems.size(),2);
+
+		elems.clear();
+		granada::util::string::split("",',',elems);
+		VERIFY_ARE_EQUAL(elems.size(),0);
+
+		elems.clear();
+		granada::util::string::split(",",',',elems);
+		VERIFY_ARE_EQUAL(elems.size(),1);
+		VERIFY_ARE_EQUAL(elems[0],"");
+
+		const std::string query = "id=0&quantity=2&";
+		std::vector<granada::util::string::view> parts;
+		for (const granada::util::string::view& part : granada::util::string::splitter(query,'&')){
+			parts.push_back(part);
+		}
+		VERIFY_ARE_EQUAL(parts.size(),2);
+		VERIFY_ARE_EQUAL(parts[0].str(),"id=0");
+		VERIFY_IS_TRUE(parts[1] == granada::util::string::view("quantity=2"));
+		VERIFY_IS_TRUE(parts[1].data() == query.data() + 5);
+
+		VERIFY_ARE_EQUAL(granada::util::string::trimmed(granada::util::string::view("  token=cc9s \t")).str(),"token=cc9s");
+		VERIFY_ARE_EQUAL(granada::util::string::trimmed(granada::util::string::view("   ")).str(),"");
+	}
+
+
+	TEST(find_first_of)
+	{
+		// longer than the 16 characters compared at a time.
+		const std::string str = "abcdefghijklmnopqrstuvwxyz&=0123456789";
+		const char* last = str.data() + str.size();
+		VERIFY_ARE_EQUAL(granada::util::string::find_first_of(str.data(),last,'=','&') - str.data(),26);
+		VERIFY_ARE_EQUAL(granada::util::string::find_first_of(str.data() + 27,last,'=','&') - str.data(),27);
+		VERIFY_ARE_EQUAL(granada::util::string::find_first_of(str.data(),last,'!','?') - str.data(),(long)str.size());
+		VERIFY_ARE_EQUAL(granada::util::string::find_first_of(str.data() + 30,last,'9','?') - str.data(),37);
+		VERIFY_ARE_EQUAL(granada::util::string::find(str.data(),last,'0') - str.data(),28);
+		VERIFY_ARE_EQUAL(granada::util::string::find(last,last,'0') - str.data(),(long)str.size());
+	}
+
+
 	TEST(replace_better_container){
 
 		// compare which container is the fastest for replace function.
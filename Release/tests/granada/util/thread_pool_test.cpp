@@ -0,0 +1,130 @@
+/**
+ * Copyright (c) <2016> Web App SDK granada <afernandez@cookinapps.io>
+ *
+ * This source code is licensed under the MIT license.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * =+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+
+ *
+ *
+ * Tests for granada::util::thread
+ *
+ * =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-
+ **/
+#include "stdafx.h"
+#include <atomic>
+#include <future>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "granada/util/thread_pool.h"
+
+
+namespace granada { namespace test { namespace util {
+
+SUITE(thread_pool)
+{
+
+	TEST(ordered_by_key)
+	{
+	    std::mutex mtx;
+	    std::vector<int> first;
+	    std::vector<int> second;
+	    {
+	      granada::util::thread::OrderedThreadPool pool(4, 1000);
+	      for (int i = 0; i < 500; ++i){
+	        VERIFY_IS_TRUE(pool.Submit("first", [&mtx, &first, i](){
+	          std::lock_guard<std::mutex> lg(mtx);
+	          first.push_back(i);
+	        }));
+	        VERIFY_IS_TRUE(pool.Submit("second", [&mtx, &second, i](){
+	          std::lock_guard<std::mutex> lg(mtx);
+	          second.push_back(i);
+	        }));
+	      }
+	      // the destructor runs the pending tasks.
+	    }
+
+	    VERIFY_ARE_EQUAL(first.size(), 500);
+	    VERIFY_ARE_EQUAL(second.size(), 500);
+	    for (int i = 0; i < 500; ++i){
+	      VERIFY_ARE_EQUAL(first[i], i);
+	      VERIFY_ARE_EQUAL(second[i], i);
+	    }
+	}
+
+	TEST(ordered_bounded)
+	{
+	    std::promise<void> release;
+	    std::shared_future<void> released = release.get_future().share();
+	    std::promise<void> started;
+
+	    granada::util::thread::OrderedThreadPool pool(1, 1);
+
+	    // keeps the only thread busy.
+	    VERIFY_IS_TRUE(pool.Submit("key", [&started, released](){
+	      started.set_value();
+	      released.wait();
+	    }));
+	    started.get_future().wait();
+
+	    VERIFY_IS_TRUE(pool.Submit("key", [](){}));
+	    VERIFY_ARE_EQUAL(pool.pending(), 1);
+	    VERIFY_IS_FALSE(pool.Submit("other", [](){}));
+
+	    release.set_value();
+	}
+
+	TEST(stop_drops_pending)
+	{
+	    std::promise<void> release;
+	    std::shared_future<void> released = release.get_future().share();
+	    std::promise<void> started;
+	    std::atomic<int> run(0);
+
+	    granada::util::thread::OrderedThreadPool pool(1, 10);
+
+	    // keeps the only thread busy.
+	    VERIFY_IS_TRUE(pool.Submit("key", [&started, &run, released](){
+	      started.set_value();
+	      released.wait();
+	      ++run;
+	    }));
+	    started.get_future().wait();
+	    VERIFY_IS_TRUE(pool.Submit("key", [&run](){ ++run; }));
+	    VERIFY_IS_TRUE(pool.Submit("key", [&run](){ ++run; }));
+
+	    std::thread stopper([&pool](){ pool.Stop(); });
+	    // the pending tasks are dropped before the running one is finished.
+	    while (pool.pending() > 0){
+	      std::this_thread::yield();
+	    }
+	    release.set_value();
+	    stopper.join();
+
+	    // the running task has been finished, the pending ones have not run.
+	    VERIFY_ARE_EQUAL(run.load(), 1);
+	    VERIFY_ARE_EQUAL(pool.pending(), 0);
+	    VERIFY_IS_FALSE(pool.Submit("key", [&run](){ ++run; }));
+	}
+
+}
+
+} } }
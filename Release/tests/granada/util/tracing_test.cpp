@@ -0,0 +1,131 @@
+/**
+ * Copyright (c) <2016> Web App SDK granada <afernandez@cookinapps.io>
+ *
+ * This source code is licensed under the MIT license.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * =+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+
+ *
+ * Tests for granada::util::tracing
+ *
+ * =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-
+ **/
+#include "stdafx.h"
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "cpprest/json.h"
+#include "granada/util/configuration.h"
+#include "granada/util/tracing.h"
+
+
+namespace granada { namespace test { namespace util {
+
+SUITE(tracing)
+{
+
+	/**
+	 * Loads a configuration with the given sampling.
+	 */
+	static void LoadSampling(const int sampling)
+	{
+	    const std::string file_path = "/tmp/granada_tracing_test.conf";
+	    {
+	      std::ofstream file(file_path, std::ios::trunc);
+	      file << "tracing_sampling=" << sampling << "\n";
+	    }
+	    granada::util::configuration::Load(file_path);
+	    std::remove(file_path.c_str());
+	    granada::util::tracing::Clear();
+	}
+
+	/**
+	 * Returns the recorded spans.
+	 */
+	static web::json::value Events()
+	{
+	    const web::json::value& trace = web::json::value::parse(utility::conversions::to_string_t(granada::util::tracing::Dump()));
+	    return trace.at(U("traceEvents"));
+	}
+
+	TEST(disabled)
+	{
+	    LoadSampling(0);
+	    {
+	      granada::util::tracing::Trace trace("test.trace");
+	      granada::util::tracing::Span span("test.span");
+	    }
+	    VERIFY_ARE_EQUAL(Events().size(), 0);
+	}
+
+	TEST(spans)
+	{
+	    LoadSampling(1);
+	    {
+	      granada::util::tracing::Trace trace("test.trace");
+	      {
+	        granada::util::tracing::Span span("test.span");
+	      }
+	    }
+	    // not in a trace.
+	    granada::util::tracing::Span span("test.orphan");
+
+	    const web::json::value& events = Events();
+	    VERIFY_ARE_EQUAL(events.size(), 2);
+	    const web::json::value& root = events.at(0);
+	    const web::json::value& child = events.at(1);
+	    VERIFY_ARE_EQUAL(utility::conversions::to_utf8string(root.at(U("name")).as_string()), "test.trace");
+	    VERIFY_ARE_EQUAL(utility::conversions::to_utf8string(child.at(U("name")).as_string()), "test.span");
+	    VERIFY_ARE_EQUAL(utility::conversions::to_utf8string(root.at(U("ph")).as_string()), "X");
+	    VERIFY_ARE_EQUAL(root.at(U("args")).at(U("trace")).as_integer(), child.at(U("args")).at(U("trace")).as_integer());
+	    VERIFY_IS_TRUE(root.at(U("dur")).as_integer() >= child.at(U("dur")).as_integer());
+	}
+
+	TEST(sampling)
+	{
+	    LoadSampling(4);
+	    for (int i = 0; i < 100; ++i){
+	      granada::util::tracing::Trace trace("test.trace");
+	      granada::util::tracing::Span span("test.span");
+	    }
+	    VERIFY_ARE_EQUAL(Events().size(), 50);
+	}
+
+	TEST(threads)
+	{
+	    LoadSampling(1);
+	    std::vector<std::thread> threads;
+	    for (int i = 0; i < 4; ++i){
+	      threads.emplace_back([](){
+	        for (int j = 0; j < 100; ++j){
+	          granada::util::tracing::Trace trace("test.trace");
+	        }
+	      });
+	    }
+	    for (auto it = threads.begin(); it != threads.end(); ++it){
+	      it->join();
+	    }
+	    VERIFY_ARE_EQUAL(Events().size(), 400);
+	}
+
+}
+
+} } }